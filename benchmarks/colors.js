@@ -0,0 +1,40 @@
+// Measures how many CSS colors per second can be parsed, with the parser used
+// by fillStyle and strokeStyle, with its cache of parsed colors, and with the
+// previous parser based on std::regex:
+//
+// $ out/windowjs.exe benchmarks/colors.js
+//
+// The results are logged to the console, and the process exits when done.
+
+const kIterations = 200000;
+
+function randomByte() {
+  return Math.floor(Math.random() * 256);
+}
+
+// Like a particle system that computes a new color for each particle.
+const particles = [];
+for (let i = 0; i < 1000; i++) {
+  particles.push(`rgba(${randomByte()},${randomByte()},${randomByte()},` +
+                 `${Math.random().toFixed(2)})`);
+}
+
+// Like a game that draws with a small palette.
+const palette = [
+  'red', 'dodgerblue', '#fff', '#00000080', 'rgb(255, 128, 0)',
+  'rgba(0, 0, 0, 0.5)', 'rgb(10, 20, 30)', 'orange',
+];
+
+const kBenchmarks = {particles, palette};
+
+for (const [name, colors] of Object.entries(kBenchmarks)) {
+  // Warm up.
+  window.debug.benchmarkColors(colors, 1000);
+
+  const result = window.debug.benchmarkColors(colors, kIterations);
+  console.log(`${name}: regex ${Math.round(result.regex)} colors/sec, ` +
+              `parser ${Math.round(result.parser)} colors/sec, ` +
+              `cache ${Math.round(result.cache)} colors/sec`);
+}
+
+window.close();
@@ -0,0 +1,42 @@
+// Measures how many input events per second can be created and dispatched to
+// a Javascript listener:
+//
+// $ out/windowjs.exe benchmarks/events.js
+//
+// The results are logged to the console, and the process exits when done.
+
+const kEventCount = 200000;
+
+const kTypes = [
+  'keydown', 'keyup', 'keypress', 'mousedown', 'mouseup', 'click',
+  'mousemove', 'wheel',
+];
+
+let received = 0;
+
+function onEvent(event) {
+  // Touch a couple of properties, like a real handler would.
+  if (event.type && event.shiftKey !== null) {
+    received++;
+  }
+}
+
+for (const type of kTypes) {
+  window.addEventListener(type, onEvent);
+}
+
+for (const type of kTypes) {
+  // Warm up, so that the templates and the listener are compiled.
+  window.debug.benchmarkEvents(type, 1000);
+
+  received = 0;
+  const eventsPerSecond = window.debug.benchmarkEvents(type, kEventCount);
+  console.log(`${type}: ${Math.round(eventsPerSecond)} events/sec ` +
+              `(${received} dispatched)`);
+}
+
+for (const type of kTypes) {
+  window.removeEventListener(type, onEvent);
+}
+
+window.close();
@@ -0,0 +1,61 @@
+// Measures how many JSON messages per second can be parsed and written, with
+// the arena-based JsonDocument and JsonWriter used for the console messages
+// and File.readJSON(), and with the previous Json implementation:
+//
+// $ out/windowjs.exe benchmarks/json.js
+//
+// The results are logged to the console, and the process exits when done.
+
+const kIterations = 2000;
+
+// Like a batch of logs sent to the console in a frame.
+const logs = {type: 'logs', messages: []};
+for (let i = 0; i < 200; i++) {
+  logs.messages.push({
+    message: `Frame ${i} took ${(Math.random() * 20).toFixed(3)} ms\n` +
+        'with "quotes" and a longer line of text to scan',
+    level: i % 10 == 0 ? 'warn' : 'info',
+  });
+}
+
+// Like an exception with a deep stack trace.
+const exception = {
+  type: 'exception',
+  message: 'TypeError: Cannot read properties of undefined (reading "x")',
+  stacktrace: [],
+};
+for (let i = 0; i < 50; i++) {
+  exception.stacktrace.push(`at update${i} (/games/demo/src/main.js:${i}:17)`);
+}
+
+// Like a level loaded from a file, with numbers and nested objects.
+const level = {name: 'level 1', entities: []};
+for (let i = 0; i < 500; i++) {
+  level.entities.push({
+    id: i,
+    x: Math.random() * 1000,
+    y: Math.random() * 1000,
+    tags: ['enemy', 'visible'],
+    active: i % 3 != 0,
+  });
+}
+
+const kBenchmarks = {
+  logs: JSON.stringify(logs),
+  exception: JSON.stringify(exception),
+  level: JSON.stringify(level, null, 2),
+};
+
+for (const [name, json] of Object.entries(kBenchmarks)) {
+  // Warm up.
+  window.debug.benchmarkJson(json, 10);
+
+  const result = window.debug.benchmarkJson(json, kIterations);
+  console.log(`${name} (${json.length} bytes): ` +
+              `parse ${Math.round(result.parse)}/sec, ` +
+              `legacy parse ${Math.round(result.legacyParse)}/sec, ` +
+              `write ${Math.round(result.write)}/sec, ` +
+              `legacy write ${Math.round(result.legacyWrite)}/sec`);
+}
+
+window.close();
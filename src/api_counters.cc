@@ -0,0 +1,79 @@
+#include "api_counters.h"
+
+#include <string.h>
+
+#include <algorithm>
+
+// static
+ApiCounters* ApiCounters::Get() {
+  static ApiCounters counters;
+  return &counters;
+}
+
+// static
+const char* ApiCounters::GetNativeName(Native counter) {
+  switch (counter) {
+    case FLUSHES:
+      return "flushes";
+    case SNAPSHOTS:
+      return "snapshots";
+    case TEXTURE_ALLOCATIONS:
+      return "textureAllocations";
+    case READ_PIXELS_BYTES:
+      return "readPixelsBytes";
+    case WRITE_PIXELS_BYTES:
+      return "writePixelsBytes";
+    case NATIVE_COUNT:
+      break;
+  }
+  return "";
+}
+
+ApiCounters::ApiCounters() {
+  current_.resize(API_COUNT * kMethods);
+  total_.resize(API_COUNT * kMethods);
+  Reset();
+}
+
+void ApiCounters::EndFrame() {
+  last_frame_.clear();
+  for (uint32_t index : touched_) {
+    Api api = static_cast<Api>(index / kMethods);
+    StringId method = static_cast<StringId>(index % kMethods);
+    last_frame_.push_back({api, method, current_[index]});
+    total_[index] += current_[index];
+    current_[index] = 0;
+  }
+  touched_.clear();
+
+  for (int i = 0; i < NATIVE_COUNT; i++) {
+    last_frame_native_[i] = current_native_[i];
+    total_native_[i] += current_native_[i];
+    current_native_[i] = 0;
+  }
+
+  frames_++;
+}
+
+void ApiCounters::Reset() {
+  std::fill(current_.begin(), current_.end(), 0);
+  std::fill(total_.begin(), total_.end(), 0);
+  touched_.clear();
+  last_frame_.clear();
+  memset(current_native_, 0, sizeof(current_native_));
+  memset(last_frame_native_, 0, sizeof(last_frame_native_));
+  memset(total_native_, 0, sizeof(total_native_));
+  frames_ = 0;
+}
+
+std::vector<ApiCounters::Call> ApiCounters::GetTotals() const {
+  std::vector<Call> totals;
+  for (size_t index = 0; index < total_.size(); index++) {
+    if (total_[index] > 0) {
+      totals.push_back({static_cast<Api>(index / kMethods),
+                        static_cast<StringId>(index % kMethods),
+                        total_[index]});
+    }
+  }
+  return totals;
+}
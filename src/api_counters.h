@@ -0,0 +1,108 @@
+#ifndef WINDOWJS_API_COUNTERS_H
+#define WINDOWJS_API_COUNTERS_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <vector>
+
+#include <v8/include/v8.h>
+
+#include "js_strings.h"
+
+// Counts the calls to native APIs, and some of the expensive operations that
+// they trigger, in each frame. Counting is just an increment, so this is always
+// enabled; it helps to find out why a frame was slow.
+//
+// All the counters are updated and read in the main thread only.
+class ApiCounters final {
+ public:
+  // The APIs whose calls are counted. Their methods are identified by the
+  // StringId of their names.
+  enum Api {
+    CANVAS,
+    FILE,
+    API_COUNT,
+  };
+
+  // Operations counted in the native code.
+  enum Native {
+    FLUSHES,
+    SNAPSHOTS,
+    TEXTURE_ALLOCATIONS,
+    READ_PIXELS_BYTES,
+    WRITE_PIXELS_BYTES,
+    NATIVE_COUNT,
+  };
+
+  struct Call {
+    Api api;
+    StringId method;
+    uint64_t count;
+  };
+
+  static constexpr size_t kMethods =
+      static_cast<size_t>(StringId::LAST_STRING_ID);
+
+  static ApiCounters* Get();
+
+  static const char* GetNativeName(Native counter);
+
+  void Count(Api api, StringId method) {
+    uint32_t& count = current_[api * kMethods + static_cast<size_t>(method)];
+    if (count++ == 0) {
+      touched_.push_back(api * kMethods + static_cast<size_t>(method));
+    }
+  }
+
+  void Count(Native counter, uint64_t n = 1) { current_native_[counter] += n; }
+
+  // Makes the current counts the counts of the last frame, and adds them to
+  // the totals. Only the calls made in the frame are visited.
+  void EndFrame();
+
+  void Reset();
+
+  // The calls made in the last frame, in no particular order.
+  const std::vector<Call>& last_frame() const { return last_frame_; }
+  const uint64_t* last_frame_native() const { return last_frame_native_; }
+
+  // The calls made since the last Reset(), ordered by API and method.
+  std::vector<Call> GetTotals() const;
+  const uint64_t* total_native() const { return total_native_; }
+
+  uint64_t frames() const { return frames_; }
+
+ private:
+  ApiCounters();
+
+  std::vector<uint32_t> current_;
+  std::vector<uint32_t> touched_;
+  uint64_t current_native_[NATIVE_COUNT];
+
+  std::vector<Call> last_frame_;
+  uint64_t last_frame_native_[NATIVE_COUNT];
+
+  std::vector<uint64_t> total_;
+  uint64_t total_native_[NATIVE_COUNT];
+  uint64_t frames_;
+};
+
+// Wraps the callback |F| so that its calls are counted as |method| of |api|.
+template <ApiCounters::Api api, StringId method, v8::FunctionCallback F>
+void CountCalls(const v8::FunctionCallbackInfo<v8::Value>& info) {
+  ApiCounters::Get()->Count(api, method);
+  F(info);
+}
+
+// Wraps the property setter |F| so that its calls are counted as |method| of
+// |api|.
+template <ApiCounters::Api api, StringId method, v8::AccessorSetterCallback F>
+void CountSetterCalls(v8::Local<v8::String> property,
+                      v8::Local<v8::Value> value,
+                      const v8::PropertyCallbackInfo<void>& info) {
+  ApiCounters::Get()->Count(api, method);
+  F(property, value, info);
+}
+
+#endif  // WINDOWJS_API_COUNTERS_H
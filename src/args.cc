@@ -1,5 +1,7 @@
 #include "args.h"
 
+#include <stdlib.h>
+
 #include <iostream>
 
 #include "config.h"
@@ -36,6 +38,31 @@ void InitArgs(int argc, char* argv[]) {
       args->headless = true;
       continue;
     }
+    if (strcmp(argv[i], "--no-window") == 0) {
+      args->no_window = true;
+      continue;
+    }
+    if (strncmp(argv[i], "--record-input=", 15) == 0) {
+      args->record_input = argv[i] + 15;
+      continue;
+    }
+    if (strncmp(argv[i], "--replay-input=", 15) == 0) {
+      args->replay_input = argv[i] + 15;
+      continue;
+    }
+    if (strncmp(argv[i], "--metrics-file=", 15) == 0) {
+      args->metrics_file = argv[i] + 15;
+      continue;
+    }
+    if (strncmp(argv[i], "--metrics-interval=", 19) == 0) {
+      char* end = nullptr;
+      args->metrics_interval = strtod(argv[i] + 19, &end);
+      if (end == argv[i] + 19 || *end != '\0' ||
+          !(args->metrics_interval > 0)) {
+        ErrorQuit("Invalid --metrics-interval: %s\n", argv[i] + 19);
+      }
+      continue;
+    }
     if (strcmp(argv[i], "--version") == 0) {
       args->version = true;
       continue;
@@ -62,6 +89,10 @@ void InitArgs(int argc, char* argv[]) {
     }
   }
 
+  if (!args->record_input.empty() && !args->replay_input.empty()) {
+    ErrorQuit("--record-input and --replay-input can't be used together.\n");
+  }
+
   if (args->initial_module.empty()) {
     args->initial_module = "--default";
   }
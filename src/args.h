@@ -15,6 +15,11 @@ struct CommandLineArgs {
   bool enable_crash_keys = false;
   bool version = false;
   bool headless = false;
+  bool no_window = false;
+  std::string record_input;
+  std::string replay_input;
+  std::string metrics_file;
+  double metrics_interval = 10;
   std::vector<std::string> args;
 };
 
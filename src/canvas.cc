@@ -3,9 +3,12 @@
 #include <GLES3/gl3.h>
 #include <GLFW/glfw3.h>
 #include <skia/include/core/SkColorSpace.h>
+#include <skia/include/core/SkTextBlob.h>
 #include <skia/include/gpu/gl/egl/GrGLMakeEGLInterface.h>
 
+#include "api_counters.h"
 #include "args.h"
+#include "clock.h"
 #include "console.h"
 #include "fail.h"
 #include "window.h"
@@ -14,25 +17,73 @@ CanvasSharedContext::CanvasSharedContext(Window* window) : owner_(window) {
   static bool first_render_context = true;
   if (Args().profile_startup && first_render_context) {
     $(DEV) << "[profile-startup] create CanvasSharedContext start: "
-           << glfwGetTime();
+           << GetClockTime();
   }
 
-  gr_interface_ = GrGLMakeEGLInterface();
-  ASSERT(gr_interface_);
-  gr_context_ = GrDirectContext::MakeGL(gr_interface_);
-  ASSERT(gr_context_);
+  // Without a window there's no GL context; Canvases use raster surfaces.
+  if (!Args().no_window) {
+    gr_interface_ = GrGLMakeEGLInterface();
+    ASSERT(gr_interface_);
+    gr_context_ = GrDirectContext::MakeGL(gr_interface_);
+    ASSERT(gr_context_);
+  }
 
   if (Args().profile_startup && first_render_context) {
     first_render_context = false;
     $(DEV) << "[profile-startup] create CanvasSharedContext end: "
-           << glfwGetTime();
+           << GetClockTime();
   }
 }
 
 CanvasSharedContext::~CanvasSharedContext() {}
 
 void CanvasSharedContext::Flush() {
-  gr_context_->flush();
+  if (gr_context_) {
+    ApiCounters::Get()->Count(ApiCounters::FLUSHES);
+    gr_context_->flush();
+  }
+}
+
+sk_sp<SkImage> CanvasSharedContext::MakeTextureImage(sk_sp<SkImage> image) {
+  if (!gr_context_) {
+    return image->makeRasterImage();
+  }
+  ApiCounters::Get()->Count(ApiCounters::TEXTURE_ALLOCATIONS);
+  return image->makeTextureImage(gr_context_.get(), GrMipMapped::kNo,
+                                 skgpu::Budgeted::kNo);
+}
+
+bool CanvasSharedContext::IsCompatibleImage(const SkImage* image) const {
+  return image->isTextureBacked() == (gr_context_ != nullptr);
+}
+
+void CanvasSharedContext::PrewarmGlyphs(const SkFont& font,
+                                        const SkGlyphID* glyphs, int count) {
+  // Glyphs bigger than this are drawn as paths, and don't go into the atlas.
+  constexpr int kGlyphCanvasSize = 256;
+
+  if (count <= 0) {
+    return;
+  }
+  if (!glyph_canvas_) {
+    glyph_canvas_ = std::make_unique<Canvas>(this, kGlyphCanvasSize,
+                                             kGlyphCanvasSize, Canvas::TEXTURE);
+  }
+
+  // All the glyphs are drawn at the same position, so that none of them is
+  // clipped out.
+  SkTextBlobBuilder builder;
+  const SkTextBlobBuilder::RunBuffer& run = builder.allocRunPos(font, count);
+  for (int i = 0; i < count; i++) {
+    run.glyphs[i] = glyphs[i];
+    run.points()[i] = SkPoint::Make(0, 0);
+  }
+
+  SkPaint paint;
+  paint.setAntiAlias(true);
+  glyph_canvas_->canvas()->drawTextBlob(builder.make(), kGlyphCanvasSize / 4,
+                                        kGlyphCanvasSize / 2, paint);
+  Flush();
 }
 
 Canvas::Canvas(CanvasSharedContext* shared_context, int width, int height,
@@ -79,7 +130,18 @@ void Canvas::Resize(int width, int height) {
     }
   }
 
-  if (target_ == FRAMEBUFFER_0) {
+  if (!shared_context_->skia_context()) {
+    ASSERT(target_ == TEXTURE);
+    SkImageInfo info = SkImageInfo::Make(width, height, color_type,
+                                         kPremul_SkAlphaType);
+    sk_sp<SkSurface> surface = SkSurface::MakeRaster(info);
+    ASSERT(surface);
+    surface->getCanvas()->clear(SK_ColorBLACK);
+    if (surface_) {
+      surface_->draw(surface->getCanvas(), 0, 0);
+    }
+    surface_ = surface;
+  } else if (target_ == FRAMEBUFFER_0) {
     GrGLFramebufferInfo info;
     // Framebuffer 0 is the screen/window buffer.
     info.fFBOID = 0;
@@ -99,6 +161,7 @@ void Canvas::Resize(int width, int height) {
         shared_context_->skia_context()->createBackendTexture(
             width, height, color_type, GrMipmapped::kNo, GrRenderable::kYes);
     ASSERT(texture.isValid());
+    ApiCounters::Get()->Count(ApiCounters::TEXTURE_ALLOCATIONS);
 
     sk_sp<SkSurface> surface = SkSurface::MakeFromBackendTexture(
         shared_context_->skia_context(), texture, kBottomLeft_GrSurfaceOrigin,
@@ -139,6 +202,7 @@ void Canvas::Resize(int width, int height) {
 }
 
 sk_sp<SkImage> Canvas::MakeImageSnapshot() {
+  ApiCounters::Get()->Count(ApiCounters::SNAPSHOTS);
   shared_context_->Flush();
   return surface_->makeImageSnapshot();
 }
@@ -155,6 +219,7 @@ void Canvas::ReadPixels(int x, int y, int width, int height,
   SkImageInfo info = SkImageInfo::Make(width, height, kRGBA_8888_SkColorType,
                                        kUnpremul_SkAlphaType);
   int stride = width * 4;
+  ApiCounters::Get()->Count(ApiCounters::READ_PIXELS_BYTES, stride * height);
   bool result = surface_->readPixels(info, destination, stride, x, y);
   ASSERT(result);
 }
@@ -164,5 +229,7 @@ void Canvas::WritePixels(const void* pixels, int x, int y, int width,
   SkImageInfo info = SkImageInfo::Make(width, height, kRGBA_8888_SkColorType,
                                        kUnpremul_SkAlphaType);
   SkPixmap pixmap{info, pixels, (size_t) row_stride};
+  ApiCounters::Get()->Count(ApiCounters::WRITE_PIXELS_BYTES,
+                            width * 4 * height);
   surface_->writePixels(pixmap, x, y);
 }
@@ -1,12 +1,16 @@
 #ifndef WINDOWJS_CANVAS_H
 #define WINDOWJS_CANVAS_H
 
+#include <memory>
+
 #include <skia/include/core/SkCanvas.h>
+#include <skia/include/core/SkFont.h>
 #include <skia/include/core/SkImage.h>
 #include <skia/include/core/SkSurface.h>
 #include <skia/include/gpu/GrDirectContext.h>
 #include <skia/include/gpu/gl/GrGLInterface.h>
 
+class Canvas;
 class Window;
 
 class CanvasSharedContext final {
@@ -16,7 +20,21 @@ class CanvasSharedContext final {
 
   void Flush();
 
+  // Returns a copy of "image" that can be drawn into Canvases of this context:
+  // a GPU texture normally, or a raster image when running with --no-window.
+  sk_sp<SkImage> MakeTextureImage(sk_sp<SkImage> image);
+
+  // Whether "image" is backed by the same kind of memory as MakeTextureImage.
+  bool IsCompatibleImage(const SkImage* image) const;
+
+  // Draws "glyphs" with "font" into a scratch canvas, so that Skia rasterizes
+  // them into its glyph cache and uploads them to its atlas now, instead of
+  // in the middle of the first frame that draws them.
+  void PrewarmGlyphs(const SkFont& font, const SkGlyphID* glyphs, int count);
+
   Window* owner() const { return owner_; }
+
+  // Null when running with --no-window.
   GrDirectContext* skia_context() const { return gr_context_.get(); }
 
  private:
@@ -24,6 +42,8 @@ class CanvasSharedContext final {
 
   sk_sp<const GrGLInterface> gr_interface_;
   sk_sp<GrDirectContext> gr_context_;
+  // Created on the first PrewarmGlyphs call. Deleted before gr_context_.
+  std::unique_ptr<Canvas> glyph_canvas_;
 };
 
 class Canvas final {
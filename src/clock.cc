@@ -0,0 +1,32 @@
+#include "clock.h"
+
+#include <atomic>
+#include <chrono>
+
+static std::atomic<std::chrono::steady_clock::rep> clock_base{0};
+static std::atomic<std::chrono::steady_clock::rep> init_base{0};
+
+static inline std::chrono::steady_clock::rep Ticks() {
+  return std::chrono::steady_clock::now().time_since_epoch().count();
+}
+
+void InitClock() {
+  init_base = Ticks();
+  ResetClock();
+}
+
+void ResetClock() {
+  clock_base = Ticks();
+}
+
+double GetClockTime() {
+  using Duration = std::chrono::steady_clock::duration;
+  Duration elapsed{Ticks() - clock_base.load()};
+  return std::chrono::duration<double>(elapsed).count();
+}
+
+double GetUptime() {
+  using Duration = std::chrono::steady_clock::duration;
+  Duration elapsed{Ticks() - init_base.load()};
+  return std::chrono::duration<double>(elapsed).count();
+}
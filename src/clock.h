@@ -0,0 +1,14 @@
+#ifndef WINDOWJS_CLOCK_H
+#define WINDOWJS_CLOCK_H
+
+// Monotonic time in seconds since InitClock() or the last ResetClock().
+// This replaces glfwGetTime(), which isn't available without a window.
+void InitClock();
+void ResetClock();
+double GetClockTime();
+
+// Monotonic time in seconds since InitClock(), which ResetClock() doesn't
+// change.
+double GetUptime();
+
+#endif  // WINDOWJS_CLOCK_H
@@ -22,6 +22,7 @@
 #include "css.h"
 #include "fail.h"
 #include "js.h"
+#include "log_formatter.h"
 #include "platform.h"
 #include "window.h"
 
@@ -42,32 +43,36 @@ class ConsoleDelegate : public v8::debug::ConsoleDelegate {
 
   void Clear(const v8::debug::ConsoleCallArguments& args,
              const v8::debug::ConsoleContext& context) override {
-    ClearLogs();
+    if (LogFormatter* formatter = GetLogFormatter()) {
+      formatter->PostClear();
+    } else {
+      ClearLogs();
+    }
   }
 
   void Debug(const v8::debug::ConsoleCallArguments& args,
              const v8::debug::ConsoleContext& context) override {
-    ::Log(GetConsoleOutput(args), ConsoleLogLevel::CONSOLE_DEBUG);
+    PostConsoleOutput(args, ConsoleLogLevel::CONSOLE_DEBUG);
   }
 
   void Log(const v8::debug::ConsoleCallArguments& args,
            const v8::debug::ConsoleContext& context) override {
-    ::Log(GetConsoleOutput(args), ConsoleLogLevel::CONSOLE_LOG);
+    PostConsoleOutput(args, ConsoleLogLevel::CONSOLE_LOG);
   }
 
   void Info(const v8::debug::ConsoleCallArguments& args,
             const v8::debug::ConsoleContext& context) override {
-    ::Log(GetConsoleOutput(args), ConsoleLogLevel::CONSOLE_INFO);
+    PostConsoleOutput(args, ConsoleLogLevel::CONSOLE_INFO);
   }
 
   void Warn(const v8::debug::ConsoleCallArguments& args,
             const v8::debug::ConsoleContext& context) override {
-    ::Log(GetConsoleOutput(args), ConsoleLogLevel::CONSOLE_WARN);
+    PostConsoleOutput(args, ConsoleLogLevel::CONSOLE_WARN);
   }
 
   void Error(const v8::debug::ConsoleCallArguments& args,
              const v8::debug::ConsoleContext& context) override {
-    ::Log(GetConsoleOutput(args), ConsoleLogLevel::CONSOLE_ERROR);
+    PostConsoleOutput(args, ConsoleLogLevel::CONSOLE_ERROR);
   }
 
   void Dir(const v8::debug::ConsoleCallArguments& args,
@@ -80,6 +85,18 @@ class ConsoleDelegate : public v8::debug::ConsoleDelegate {
     v8::Local<v8::Value> arg =
         args.Length() == 0 ? context->Global().As<v8::Value>() : args[0];
 
+    // Plain objects are formatted in the background, from a snapshot.
+    LogFormatter* formatter = GetLogFormatter();
+    if (formatter && formatter->IsOverBudget()) {
+      formatter->Drop();
+      return;
+    }
+    std::string snapshot;
+    if (formatter && CaptureDirSnapshot(js_, arg, &snapshot)) {
+      formatter->PostDir(std::move(snapshot));
+      return;
+    }
+
     std::string type = js_->ToString(arg->TypeOf(isolate));
 
     if (arg->IsArray()) {
@@ -129,18 +146,42 @@ class ConsoleDelegate : public v8::debug::ConsoleDelegate {
       out.pop_back();
     }
 
-    ::Log(std::move(out), ConsoleLogLevel::CONSOLE_LOG);
+    LogOrPost(std::move(out), ConsoleLogLevel::CONSOLE_LOG);
   }
 
-  std::string GetConsoleOutput(const v8::debug::ConsoleCallArguments& args) {
-    std::stringstream ss;
+  // Captures the arguments and formats them in the LogFormatter's thread, if
+  // there is one.
+  void PostConsoleOutput(const v8::debug::ConsoleCallArguments& args,
+                         ConsoleLogLevel level) {
+    LogFormatter* formatter = GetLogFormatter();
+    if (formatter && formatter->IsOverBudget()) {
+      formatter->Drop();
+      return;
+    }
+    std::vector<LogArgument> captured;
+    captured.reserve(args.Length());
     for (int i = 0; i < args.Length(); i++) {
-      if (i > 0) {
-        ss << " ";
-      }
-      ss << js_->ToString(args[i]);
+      captured.emplace_back(CaptureLogArgument(js_, args[i]));
+    }
+    if (formatter) {
+      formatter->Post(std::move(captured), level);
+    } else {
+      ::Log(FormatLogArguments(captured), level);
+    }
+  }
+
+  // Messages formatted in the main thread still go through the LogFormatter,
+  // so that they are logged in order.
+  void LogOrPost(std::string message, ConsoleLogLevel level) {
+    if (LogFormatter* formatter = GetLogFormatter()) {
+      LogArgument arg;
+      arg.text = std::move(message);
+      std::vector<LogArgument> args;
+      args.emplace_back(std::move(arg));
+      formatter->Post(std::move(args), level);
+    } else {
+      ::Log(std::move(message), level);
     }
-    return ss.str();
   }
 
   Js* js_;
@@ -270,9 +311,15 @@ void SetLogHandler(LogHandler* handler) {
 
 ConsoleOverlay::ConsoleOverlay(Window* window)
     : window_(window),
+      next_(0),
+      count_(0),
+      font_ratio_(0),
       text_color_(SK_ColorWHITE),
       redraw_(false),
-      enable_on_errors_(true) {}
+      scroll_(0),
+      enable_on_errors_(true) {
+  lines_.resize(kMaxLines);
+}
 
 ConsoleOverlay::~ConsoleOverlay() {}
 
@@ -293,6 +340,7 @@ void ConsoleOverlay::SetEnabled(bool enabled) {
     }
   } else {
     canvas_.reset();
+    back_canvas_.reset();
   }
 }
 
@@ -307,9 +355,6 @@ void ConsoleOverlay::OnLog(std::string message, ConsoleLogLevel level) {
   static const SkColor error = SkColorSetRGB(0xff, 0x00, 0x00);
   static const SkColor dev = SkColorSetRGB(0xff, 0x00, 0xff);
 
-  while (messages_.size() >= 10) {
-    messages_.pop_front();
-  }
   SkColor color = text_color_;
   if (level == ConsoleLogLevel::CONSOLE_DEBUG) {
     color = debug;
@@ -322,73 +367,131 @@ void ConsoleOverlay::OnLog(std::string message, ConsoleLogLevel level) {
   } else if (level == ConsoleLogLevel::CONSOLE_DEV) {
     color = dev;
   }
-  messages_.emplace_back(std::move(message), color);
 
-  redraw_ = true;
+  // Only the last kMaxLines lines of the message can be seen.
+  std::string_view text = message;
+  size_t end = text.size();
+  for (size_t i = 0; i < kMaxLines && end > 0; i++) {
+    size_t k = text.rfind('\n', end - 1);
+    if (k == std::string_view::npos) {
+      break;
+    }
+    if (i == kMaxLines - 1) {
+      text.remove_prefix(k + 1);
+    }
+    end = k;
+  }
+  for (;;) {
+    size_t k = text.find('\n');
+    AddLine(text.substr(0, k), color);
+    if (k == std::string_view::npos) {
+      break;
+    }
+    text.remove_prefix(k + 1);
+  }
 
   if (level == ConsoleLogLevel::CONSOLE_ERROR && enable_on_errors_) {
     SetEnabled(true);
   }
 }
 
+void ConsoleOverlay::AddLine(std::string_view text, SkColor color) {
+  if (text.size() > kMaxLineLength) {
+    size_t size = kMaxLineLength;
+    // Don't cut a UTF-8 sequence.
+    while (size > 0 && (text[size] & 0xC0) == 0x80) {
+      size--;
+    }
+    text = text.substr(0, size);
+  }
+  Line& line = lines_[next_];
+  line.text = text;
+  line.color = color;
+  line.blob.reset();
+  next_ = (next_ + 1) % kMaxLines;
+  count_ = std::min(count_ + 1, kMaxLines);
+  scroll_++;
+}
+
 void ConsoleOverlay::Clear() {
-  if (!messages_.empty()) {
-    messages_.clear();
+  if (count_ > 0) {
+    for (Line& line : lines_) {
+      line = Line();
+    }
+    next_ = 0;
+    count_ = 0;
     redraw_ = true;
   }
 }
 
-void ConsoleOverlay::Draw() {
-  ASSERT(is_enabled());
+void ConsoleOverlay::UpdateFont(float ratio) {
+  CSSFontToSkFont("11px monospace", &font_);
+  font_.setSize(11 * ratio);
+  font_.setScaleX(1.1);
+  font_.setSubpixel(true);
+  font_.setHinting(SkFontHinting::kFull);
+  font_ratio_ = ratio;
+  for (Line& line : lines_) {
+    line.blob.reset();
+  }
+}
 
-  if (!redraw_) {
+void ConsoleOverlay::DrawLine(SkCanvas* canvas, Line& line, size_t index) {
+  if (line.text.empty()) {
     return;
   }
-
-  SkCanvas* canvas = canvas_->canvas();
-  canvas->clear(SkColorSetARGB(0x80, 0x00, 0x00, 0x00));
-
-  const float ratio = window_->device_pixel_ratio();
-
-  SkFont font;
-  CSSFontToSkFont("11px monospace", &font);
-  font.setSize(11 * ratio);
-  font.setScaleX(1.1);
-  font.setSubpixel(true);
-  font.setHinting(SkFontHinting::kFull);
-
+  if (!line.blob) {
+    line.blob = SkTextBlob::MakeFromText(line.text.data(), line.text.size(),
+                                         font_, SkTextEncoding::kUTF8);
+    if (!line.blob) {
+      return;
+    }
+  }
+  const float ratio = font_ratio_;
   SkPaint paint;
   paint.setStyle(SkPaint::kFill_Style);
+  paint.setColor(line.color);
+  canvas->drawTextBlob(line.blob, 4, height() - (6 + 14 * index) * ratio,
+                       paint);
+}
 
-  std::vector<std::string_view> lines;
-  lines.reserve(10);
-  std::vector<SkColor> colors;
-  colors.reserve(10);
-  for (const auto& p : messages_) {
-    std::string_view line = p.first;
-    size_t k = line.find('\n');
-    while (k != std::string_view::npos) {
-      lines.push_back(line.substr(0, k));
-      colors.push_back(p.second);
-      line.remove_prefix(k + 1);
-      k = line.find('\n');
-    }
-    lines.push_back(line);
-    colors.push_back(p.second);
+void ConsoleOverlay::Draw() {
+  ASSERT(is_enabled());
+
+  const float ratio = window_->device_pixel_ratio();
+  if (ratio != font_ratio_) {
+    UpdateFont(ratio);
+    redraw_ = true;
   }
 
-  int count = std::min((int) lines.size(), 10);
-  int y = height() - 6 * ratio;
+  if (scroll_ > 0 && scroll_ >= count_) {
+    redraw_ = true;
+  }
 
-  for (int i = 0; i < count; i++) {
-    paint.setColor(colors[colors.size() - 1 - i]);
-    std::string text{lines[lines.size() - 1 - i]};
-    canvas->drawSimpleText(text.c_str(), text.size(), SkTextEncoding::kUTF8, 4,
-                           y, font, paint);
-    y -= 14 * ratio;
+  if (redraw_) {
+    SkCanvas* canvas = canvas_->canvas();
+    canvas->clear(SkColorSetARGB(0x80, 0x00, 0x00, 0x00));
+    for (size_t i = 0; i < count_; i++) {
+      DrawLine(canvas, GetLine(i), i);
+    }
+  } else if (scroll_ > 0) {
+    if (!back_canvas_) {
+      back_canvas_.reset(new Canvas(window_->shared_context(), width(),
+                                    height(), Canvas::TEXTURE));
+    }
+    SkCanvas* canvas = back_canvas_->canvas();
+    canvas->clear(SkColorSetARGB(0x80, 0x00, 0x00, 0x00));
+    SkPaint paint;
+    paint.setBlendMode(SkBlendMode::kSrc);
+    canvas_->surface()->draw(canvas, 0, -14 * ratio * scroll_, &paint);
+    for (size_t i = 0; i < scroll_; i++) {
+      DrawLine(canvas, GetLine(i), i);
+    }
+    std::swap(canvas_, back_canvas_);
   }
 
   redraw_ = false;
+  scroll_ = 0;
 }
 
 std::unique_ptr<v8::debug::ConsoleDelegate> MakeConsoleDelegate(Js* js) {
@@ -6,9 +6,12 @@
 #include <ostream>
 #include <sstream>
 #include <string>
+#include <string_view>
 #include <vector>
 
 #include <skia/include/core/SkColor.h>
+#include <skia/include/core/SkFont.h>
+#include <skia/include/core/SkTextBlob.h>
 #include <v8/include/v8.h>
 
 #define $(level) ConsoleLogHelper(::ConsoleLogLevel::CONSOLE_##level).ss()
@@ -57,8 +60,15 @@ class ConsoleLogHelper {
 class Canvas;
 class Window;
 
+// Shows the most recent console lines in the main window. Lines are shaped
+// into SkTextBlobs once, and new lines scroll the previous content up instead
+// of drawing all the lines again.
 class ConsoleOverlay {
  public:
+  static constexpr size_t kMaxLines = 10;
+  // Longer lines are cut, since they don't fit in the overlay anyway.
+  static constexpr size_t kMaxLineLength = 256;
+
   explicit ConsoleOverlay(Window* window);
   ~ConsoleOverlay();
 
@@ -81,11 +91,40 @@ class ConsoleOverlay {
   void Draw();
 
  private:
+  struct Line {
+    std::string text;
+    SkColor color = SK_ColorWHITE;
+    // Null until the line is drawn for the first time.
+    sk_sp<SkTextBlob> blob;
+  };
+
+  void AddLine(std::string_view text, SkColor color);
+  // Returns the line at |index| counting from the most recent one.
+  Line& GetLine(size_t index) {
+    return lines_[(next_ + kMaxLines - 1 - index) % kMaxLines];
+  }
+  void UpdateFont(float ratio);
+  void DrawLine(SkCanvas* canvas, Line& line, size_t index);
+
   Window* window_;
   std::unique_ptr<Canvas> canvas_;
-  std::deque<std::pair<std::string, SkColor>> messages_;
+  // The previous content is drawn into back_canvas_, scrolled up, and then the
+  // two are swapped.
+  std::unique_ptr<Canvas> back_canvas_;
+
+  // A ring with the most recent kMaxLines lines.
+  std::vector<Line> lines_;
+  size_t next_;
+  size_t count_;
+
+  SkFont font_;
+  float font_ratio_;
+
   SkColor text_color_;
+  // Whether all the lines have to be drawn again, or just the last
+  // |scroll_| lines after scrolling.
   bool redraw_;
+  size_t scroll_;
   bool enable_on_errors_;
 };
 
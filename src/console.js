@@ -264,18 +264,26 @@ function paste() {
   requestDraw();
 }
 
-function pushBlock(block) {
-  blocks.push(block);
-  while (blocks.length > 1000) {
-    blocks.shift();
+function pushBlocks(newBlocks) {
+  let lineCount = 0;
+  for (const block of newBlocks) {
+    blocks.push(block);
+    lineCount += block.lines.length;
+  }
+  if (blocks.length > 1000) {
+    blocks.splice(0, blocks.length - 1000);
   }
   updateBlocks();
 
-  if (scrollSkipLines > 0) updateScrollLines(block.lines.length);
+  if (scrollSkipLines > 0) updateScrollLines(lineCount);
 
   requestDraw();
 }
 
+function pushBlock(block) {
+  pushBlocks([block]);
+}
+
 function getColorForMessage(message) {
   if (message.type == 'exception') return '#ff0000ff';
   if (message.type != 'log') return '#000000ff';
@@ -296,10 +304,21 @@ function getColorForMessage(message) {
   return '#000000ff';
 }
 
-function onLog(message) {
+function makeLogBlock(message) {
   const color = getColorForMessage(message);
   const lines = message.message.trimRight().split('\n');
-  pushBlock({lines, color});
+  return {lines, color};
+}
+
+function onLog(message) {
+  pushBlock(makeLogBlock(message));
+}
+
+function onLogs(messages) {
+  pushBlocks(messages.map(message => {
+    message.type = 'log';
+    return makeLogBlock(message);
+  }));
 }
 
 function log(message) {
@@ -357,7 +376,10 @@ function requestEval(source) {
         'F4         Overlays console logs in the main window.\n' +
         'F5         Reloads the main application.\n' +
         'F6         Toggles always on top.\n' +
+        'F7         Toggles CPU profiling, saved to Profile.cpuprofile or\n' +
+        '           Profile-N.cpuprofile if that exists.\n' +
         'F8         Saves a screenshot.\n' +
+        'F9         Shows the most called APIs in the stats overlay.\n' +
         'Escape     Closes the console.\n');
     return;
   }
@@ -395,8 +417,12 @@ function onKeyDown(event) {
     sendRequest('reload');
   } else if (key == 'F6') {
     sendRequest('always-on-top');
+  } else if (key == 'F7') {
+    sendRequest('profile-cpu');
   } else if (key == 'F8') {
     sendRequest('screenshot');
+  } else if (key == 'F9') {
+    sendRequest('api-counters');
   } else if (key == 'PageUp') {
     updateScrollLines(10);
   } else if (key == 'PageDown') {
@@ -557,6 +583,8 @@ function onMessage(message) {
     window.focus();
   } else if (message.type == 'log') {
     onLog(message);
+  } else if (message.type == 'logs') {
+    onLogs(message.messages);
   } else if (message.type == 'exception') {
     onException(message);
   } else if (message.type == 'evalResponse') {
@@ -0,0 +1,131 @@
+#include "cpu_profiler.h"
+
+#include <sstream>
+
+#include "fail.h"
+#include "json.h"
+
+namespace {
+
+void CopyNodes(const v8::CpuProfileNode* node, CpuProfileData* data) {
+  data->nodes.emplace_back();
+  CpuProfileData::Node& copy = data->nodes.back();
+  copy.id = node->GetNodeId();
+  copy.function_name = node->GetFunctionNameStr();
+  copy.url = node->GetScriptResourceNameStr();
+  copy.script_id = node->GetScriptId();
+  // v8 line and column numbers are 1-based, and 0 when unknown.
+  copy.line_number = node->GetLineNumber() - 1;
+  copy.column_number = node->GetColumnNumber() - 1;
+  copy.hit_count = node->GetHitCount();
+  int count = node->GetChildrenCount();
+  copy.children.reserve(count);
+  for (int i = 0; i < count; i++) {
+    copy.children.push_back(node->GetChild(i)->GetNodeId());
+  }
+  // |copy| is invalidated by the recursive calls.
+  for (int i = 0; i < count; i++) {
+    CopyNodes(node->GetChild(i), data);
+  }
+}
+
+}  // namespace
+
+std::string CpuProfileData::ToJson() const {
+  std::stringstream json;
+  json << "{\"nodes\":[";
+  for (size_t i = 0; i < nodes.size(); i++) {
+    const Node& node = nodes[i];
+    if (i > 0) {
+      json << ",";
+    }
+    json << "{\"id\":" << node.id;
+    json << ",\"callFrame\":{\"functionName\":"
+         << Json::EscapeString(node.function_name);
+    json << ",\"scriptId\":\"" << node.script_id << "\"";
+    json << ",\"url\":" << Json::EscapeString(node.url);
+    json << ",\"lineNumber\":" << node.line_number;
+    json << ",\"columnNumber\":" << node.column_number << "}";
+    json << ",\"hitCount\":" << node.hit_count;
+    json << ",\"children\":[";
+    for (size_t j = 0; j < node.children.size(); j++) {
+      json << (j > 0 ? "," : "") << node.children[j];
+    }
+    json << "]}";
+  }
+  json << "],\"startTime\":" << start_time;
+  json << ",\"endTime\":" << end_time;
+  json << ",\"samples\":[";
+  for (size_t i = 0; i < samples.size(); i++) {
+    json << (i > 0 ? "," : "") << samples[i];
+  }
+  json << "],\"timeDeltas\":[";
+  for (size_t i = 0; i < time_deltas.size(); i++) {
+    json << (i > 0 ? "," : "") << time_deltas[i];
+  }
+  json << "]}";
+  return json.str();
+}
+
+CpuProfiler::CpuProfiler(v8::Isolate* isolate)
+    : isolate_(isolate), profiler_(nullptr) {}
+
+CpuProfiler::~CpuProfiler() {
+  if (profiler_) {
+    v8::Locker locker(isolate_);
+    profiler_->Dispose();
+  }
+}
+
+bool CpuProfiler::Start(const std::string& title, int sample_interval_us) {
+  ASSERT(sample_interval_us > 0);
+  if (IsProfiling(title)) {
+    return false;
+  }
+  if (!profiler_) {
+    profiler_ = v8::CpuProfiler::New(isolate_);
+  }
+  if (titles_.empty()) {
+    profiler_->SetSamplingInterval(sample_interval_us);
+  }
+  v8::HandleScope handle_scope(isolate_);
+  v8::Local<v8::String> name =
+      v8::String::NewFromUtf8(isolate_, title.c_str()).ToLocalChecked();
+  if (profiler_->StartProfiling(name, true) != v8::kStarted) {
+    return false;
+  }
+  titles_.insert(title);
+  return true;
+}
+
+std::unique_ptr<CpuProfileData> CpuProfiler::Stop(const std::string& title) {
+  if (!IsProfiling(title)) {
+    return nullptr;
+  }
+  titles_.erase(title);
+
+  v8::HandleScope handle_scope(isolate_);
+  v8::Local<v8::String> name =
+      v8::String::NewFromUtf8(isolate_, title.c_str()).ToLocalChecked();
+  v8::CpuProfile* profile = profiler_->StopProfiling(name);
+  if (!profile) {
+    return nullptr;
+  }
+
+  auto data = std::make_unique<CpuProfileData>();
+  CopyNodes(profile->GetTopDownRoot(), data.get());
+  data->start_time = profile->GetStartTime();
+  data->end_time = profile->GetEndTime();
+  int count = profile->GetSamplesCount();
+  data->samples.reserve(count);
+  data->time_deltas.reserve(count);
+  int64_t last = data->start_time;
+  for (int i = 0; i < count; i++) {
+    int64_t timestamp = profile->GetSampleTimestamp(i);
+    data->samples.push_back(profile->GetSample(i)->GetNodeId());
+    data->time_deltas.push_back(timestamp - last);
+    last = timestamp;
+  }
+  profile->Delete();
+  return data;
+}
@@ -0,0 +1,69 @@
+#ifndef WINDOWJS_CPU_PROFILER_H
+#define WINDOWJS_CPU_PROFILER_H
+
+#include <stdint.h>
+
+#include <memory>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+#include <v8/include/v8-profiler.h>
+#include <v8/include/v8.h>
+
+// A copy of a v8::CpuProfile that doesn't depend on v8, so that it can be
+// serialized in a background thread.
+struct CpuProfileData {
+  struct Node {
+    unsigned id;
+    std::string function_name;
+    std::string url;
+    int script_id;
+    // 0-based, or -1 if unknown.
+    int line_number;
+    int column_number;
+    unsigned hit_count;
+    std::vector<unsigned> children;
+  };
+
+  std::vector<Node> nodes;
+  // The node id of each sample, and the time since the previous sample.
+  std::vector<unsigned> samples;
+  std::vector<int64_t> time_deltas;
+  // In microseconds.
+  int64_t start_time = 0;
+  int64_t end_time = 0;
+
+  // Returns the profile in the .cpuprofile format used by the Chrome DevTools.
+  std::string ToJson() const;
+};
+
+// Sampling profiler for the JS code running in an isolate. The v8 profiler is
+// only created on the first call to Start(), since it has a startup cost.
+class CpuProfiler final {
+ public:
+  static constexpr int kDefaultSampleIntervalUs = 1000;
+  static constexpr int kMaxSampleIntervalUs = 1000000;
+
+  explicit CpuProfiler(v8::Isolate* isolate);
+  ~CpuProfiler();
+
+  bool is_profiling() const { return !titles_.empty(); }
+  bool IsProfiling(const std::string& title) const {
+    return titles_.find(title) != titles_.end();
+  }
+
+  // Returns false if a profile with the same |title| is already running.
+  // The |sample_interval_us| only takes effect if no other profile is running.
+  bool Start(const std::string& title, int sample_interval_us);
+
+  // Returns nullptr if there is no profile running with |title|.
+  std::unique_ptr<CpuProfileData> Stop(const std::string& title);
+
+ private:
+  v8::Isolate* isolate_;
+  v8::CpuProfiler* profiler_;
+  std::unordered_set<std::string> titles_;
+};
+
+#endif  // WINDOWJS_CPU_PROFILER_H
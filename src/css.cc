@@ -2,8 +2,11 @@
 
 #include <algorithm>
 #include <cctype>
+#include <cmath>
 #include <cstdlib>
-#include <regex>
+#include <cstring>
+#include <functional>
+#include <iterator>
 #include <sstream>
 #include <string>
 #include <unordered_map>
@@ -15,13 +18,31 @@
 
 namespace {
 
+// The <cctype> functions are undefined for negative chars, like the bytes of
+// non-ASCII UTF-8 characters.
+bool IsSpace(char c) {
+  return isspace(static_cast<unsigned char>(c));
+}
+
+bool IsDigit(char c) {
+  return isdigit(static_cast<unsigned char>(c));
+}
+
+bool IsAlnum(char c) {
+  return isalnum(static_cast<unsigned char>(c));
+}
+
+char ToLower(char c) {
+  return tolower(static_cast<unsigned char>(c));
+}
+
 int ToHex(int x) {
   return x < 10 ? '0' + x : 'a' + (x - 10);
 }
 
-bool ValidHex(const std::string& color) {
+bool ValidHex(std::string_view color) {
   for (unsigned i = 1; i < color.size(); i++) {
-    if (!isxdigit(color[i])) {
+    if (!isxdigit(static_cast<unsigned char>(color[i]))) {
       return false;
     }
   }
@@ -29,16 +50,633 @@ bool ValidHex(const std::string& color) {
 }
 
 int FromHex(char c) {
-  if (isdigit(c)) {
+  if (IsDigit(c)) {
     return c - '0';
   } else {
-    return tolower(c) - 'a' + 10;
+    return ToLower(c) - 'a' + 10;
+  }
+}
+
+constexpr double kPi = 3.14159265358979323846;
+
+// The CSS color keywords, sorted by name.
+struct NamedColor {
+  const char* name;
+  SkColor color;
+};
+
+const NamedColor kNamedColors[] = {
+    {"aliceblue", /*            */ SkColorSetRGB(0xf0, 0xf8, 0xff)},
+    {"antiquewhite", /*         */ SkColorSetRGB(0xfa, 0xeb, 0xd7)},
+    {"aqua", /*                 */ SkColorSetRGB(0x00, 0xff, 0xff)},
+    {"aquamarine", /*           */ SkColorSetRGB(0x7f, 0xff, 0xd4)},
+    {"azure", /*                */ SkColorSetRGB(0xf0, 0xff, 0xff)},
+    {"beige", /*                */ SkColorSetRGB(0xf5, 0xf5, 0xdc)},
+    {"bisque", /*               */ SkColorSetRGB(0xff, 0xe4, 0xc4)},
+    {"black", /*                */ SkColorSetRGB(0x00, 0x00, 0x00)},
+    {"blanchedalmond", /*       */ SkColorSetRGB(0xff, 0xeb, 0xcd)},
+    {"blue", /*                 */ SkColorSetRGB(0x00, 0x00, 0xff)},
+    {"blueviolet", /*           */ SkColorSetRGB(0x8a, 0x2b, 0xe2)},
+    {"brown", /*                */ SkColorSetRGB(0xa5, 0x2a, 0x2a)},
+    {"burlywood", /*            */ SkColorSetRGB(0xde, 0xb8, 0x87)},
+    {"cadetblue", /*            */ SkColorSetRGB(0x5f, 0x9e, 0xa0)},
+    {"chartreuse", /*           */ SkColorSetRGB(0x7f, 0xff, 0x00)},
+    {"chocolate", /*            */ SkColorSetRGB(0xd2, 0x69, 0x1e)},
+    {"coral", /*                */ SkColorSetRGB(0xff, 0x7f, 0x50)},
+    {"cornflowerblue", /*       */ SkColorSetRGB(0x64, 0x95, 0xed)},
+    {"cornsilk", /*             */ SkColorSetRGB(0xff, 0xf8, 0xdc)},
+    {"crimson", /*              */ SkColorSetRGB(0xdc, 0x14, 0x3c)},
+    {"cyan", /*                 */ SkColorSetRGB(0x00, 0xff, 0xff)},
+    {"darkblue", /*             */ SkColorSetRGB(0x00, 0x00, 0x8b)},
+    {"darkcyan", /*             */ SkColorSetRGB(0x00, 0x8b, 0x8b)},
+    {"darkgoldenrod", /*        */ SkColorSetRGB(0xb8, 0x86, 0x0b)},
+    {"darkgray", /*             */ SkColorSetRGB(0xa9, 0xa9, 0xa9)},
+    {"darkgreen", /*            */ SkColorSetRGB(0x00, 0x64, 0x00)},
+    {"darkgrey", /*             */ SkColorSetRGB(0xa9, 0xa9, 0xa9)},
+    {"darkkhaki", /*            */ SkColorSetRGB(0xbd, 0xb7, 0x6b)},
+    {"darkmagenta", /*          */ SkColorSetRGB(0x8b, 0x00, 0x8b)},
+    {"darkolivegreen", /*       */ SkColorSetRGB(0x55, 0x6b, 0x2f)},
+    {"darkorange", /*           */ SkColorSetRGB(0xff, 0x8c, 0x00)},
+    {"darkorchid", /*           */ SkColorSetRGB(0x99, 0x32, 0xcc)},
+    {"darkred", /*              */ SkColorSetRGB(0x8b, 0x00, 0x00)},
+    {"darksalmon", /*           */ SkColorSetRGB(0xe9, 0x96, 0x7a)},
+    {"darkseagreen", /*         */ SkColorSetRGB(0x8f, 0xbc, 0x8f)},
+    {"darkslateblue", /*        */ SkColorSetRGB(0x48, 0x3d, 0x8b)},
+    {"darkslategray", /*        */ SkColorSetRGB(0x2f, 0x4f, 0x4f)},
+    {"darkslategrey", /*        */ SkColorSetRGB(0x2f, 0x4f, 0x4f)},
+    {"darkturquoise", /*        */ SkColorSetRGB(0x00, 0xce, 0xd1)},
+    {"darkviolet", /*           */ SkColorSetRGB(0x94, 0x00, 0xd3)},
+    {"deeppink", /*             */ SkColorSetRGB(0xff, 0x14, 0x93)},
+    {"deepskyblue", /*          */ SkColorSetRGB(0x00, 0xbf, 0xff)},
+    {"dimgray", /*              */ SkColorSetRGB(0x69, 0x69, 0x69)},
+    {"dimgrey", /*              */ SkColorSetRGB(0x69, 0x69, 0x69)},
+    {"dodgerblue", /*           */ SkColorSetRGB(0x1e, 0x90, 0xff)},
+    {"firebrick", /*            */ SkColorSetRGB(0xb2, 0x22, 0x22)},
+    {"floralwhite", /*          */ SkColorSetRGB(0xff, 0xfa, 0xf0)},
+    {"forestgreen", /*          */ SkColorSetRGB(0x22, 0x8b, 0x22)},
+    {"fuchsia", /*              */ SkColorSetRGB(0xff, 0x00, 0xff)},
+    {"gainsboro", /*            */ SkColorSetRGB(0xdc, 0xdc, 0xdc)},
+    {"ghostwhite", /*           */ SkColorSetRGB(0xf8, 0xf8, 0xff)},
+    {"gold", /*                 */ SkColorSetRGB(0xff, 0xd7, 0x00)},
+    {"goldenrod", /*            */ SkColorSetRGB(0xda, 0xa5, 0x20)},
+    {"gray", /*                 */ SkColorSetRGB(0x80, 0x80, 0x80)},
+    {"green", /*                */ SkColorSetRGB(0x00, 0x80, 0x00)},
+    {"greenyellow", /*          */ SkColorSetRGB(0xad, 0xff, 0x2f)},
+    {"grey", /*                 */ SkColorSetRGB(0x80, 0x80, 0x80)},
+    {"honeydew", /*             */ SkColorSetRGB(0xf0, 0xff, 0xf0)},
+    {"hotpink", /*              */ SkColorSetRGB(0xff, 0x69, 0xb4)},
+    {"indianred", /*            */ SkColorSetRGB(0xcd, 0x5c, 0x5c)},
+    {"indigo", /*               */ SkColorSetRGB(0x4b, 0x00, 0x82)},
+    {"ivory", /*                */ SkColorSetRGB(0xff, 0xff, 0xf0)},
+    {"khaki", /*                */ SkColorSetRGB(0xf0, 0xe6, 0x8c)},
+    {"lavender", /*             */ SkColorSetRGB(0xe6, 0xe6, 0xfa)},
+    {"lavenderblush", /*        */ SkColorSetRGB(0xff, 0xf0, 0xf5)},
+    {"lawngreen", /*            */ SkColorSetRGB(0x7c, 0xfc, 0x00)},
+    {"lemonchiffon", /*         */ SkColorSetRGB(0xff, 0xfa, 0xcd)},
+    {"lightblue", /*            */ SkColorSetRGB(0xad, 0xd8, 0xe6)},
+    {"lightcoral", /*           */ SkColorSetRGB(0xf0, 0x80, 0x80)},
+    {"lightcyan", /*            */ SkColorSetRGB(0xe0, 0xff, 0xff)},
+    {"lightgoldenrodyellow", /* */ SkColorSetRGB(0xfa, 0xfa, 0xd2)},
+    {"lightgray", /*            */ SkColorSetRGB(0xd3, 0xd3, 0xd3)},
+    {"lightgreen", /*           */ SkColorSetRGB(0x90, 0xee, 0x90)},
+    {"lightgrey", /*            */ SkColorSetRGB(0xd3, 0xd3, 0xd3)},
+    {"lightpink", /*            */ SkColorSetRGB(0xff, 0xb6, 0xc1)},
+    {"lightsalmon", /*          */ SkColorSetRGB(0xff, 0xa0, 0x7a)},
+    {"lightseagreen", /*        */ SkColorSetRGB(0x20, 0xb2, 0xaa)},
+    {"lightskyblue", /*         */ SkColorSetRGB(0x87, 0xce, 0xfa)},
+    {"lightslategray", /*       */ SkColorSetRGB(0x77, 0x88, 0x99)},
+    {"lightslategrey", /*       */ SkColorSetRGB(0x77, 0x88, 0x99)},
+    {"lightsteelblue", /*       */ SkColorSetRGB(0xb0, 0xc4, 0xde)},
+    {"lightyellow", /*          */ SkColorSetRGB(0xff, 0xff, 0xe0)},
+    {"lime", /*                 */ SkColorSetRGB(0x00, 0xff, 0x00)},
+    {"limegreen", /*            */ SkColorSetRGB(0x32, 0xcd, 0x32)},
+    {"linen", /*                */ SkColorSetRGB(0xfa, 0xf0, 0xe6)},
+    {"magenta", /*              */ SkColorSetRGB(0xff, 0x00, 0xff)},
+    {"maroon", /*               */ SkColorSetRGB(0x80, 0x00, 0x00)},
+    {"mediumaquamarine", /*     */ SkColorSetRGB(0x66, 0xcd, 0xaa)},
+    {"mediumblue", /*           */ SkColorSetRGB(0x00, 0x00, 0xcd)},
+    {"mediumorchid", /*         */ SkColorSetRGB(0xba, 0x55, 0xd3)},
+    {"mediumpurple", /*         */ SkColorSetRGB(0x93, 0x70, 0xdb)},
+    {"mediumseagreen", /*       */ SkColorSetRGB(0x3c, 0xb3, 0x71)},
+    {"mediumslateblue", /*      */ SkColorSetRGB(0x7b, 0x68, 0xee)},
+    {"mediumspringgreen", /*    */ SkColorSetRGB(0x00, 0xfa, 0x9a)},
+    {"mediumturquoise", /*      */ SkColorSetRGB(0x48, 0xd1, 0xcc)},
+    {"mediumvioletred", /*      */ SkColorSetRGB(0xc7, 0x15, 0x85)},
+    {"midnightblue", /*         */ SkColorSetRGB(0x19, 0x19, 0x70)},
+    {"mintcream", /*            */ SkColorSetRGB(0xf5, 0xff, 0xfa)},
+    {"mistyrose", /*            */ SkColorSetRGB(0xff, 0xe4, 0xe1)},
+    {"moccasin", /*             */ SkColorSetRGB(0xff, 0xe4, 0xb5)},
+    {"navajowhite", /*          */ SkColorSetRGB(0xff, 0xde, 0xad)},
+    {"navy", /*                 */ SkColorSetRGB(0x00, 0x00, 0x80)},
+    {"oldlace", /*              */ SkColorSetRGB(0xfd, 0xf5, 0xe6)},
+    {"olive", /*                */ SkColorSetRGB(0x80, 0x80, 0x00)},
+    {"olivedrab", /*            */ SkColorSetRGB(0x6b, 0x8e, 0x23)},
+    {"orange", /*               */ SkColorSetRGB(0xff, 0xa5, 0x00)},
+    {"orangered", /*            */ SkColorSetRGB(0xff, 0x45, 0x00)},
+    {"orchid", /*               */ SkColorSetRGB(0xda, 0x70, 0xd6)},
+    {"palegoldenrod", /*        */ SkColorSetRGB(0xee, 0xe8, 0xaa)},
+    {"palegreen", /*            */ SkColorSetRGB(0x98, 0xfb, 0x98)},
+    {"paleturquoise", /*        */ SkColorSetRGB(0xaf, 0xee, 0xee)},
+    {"palevioletred", /*        */ SkColorSetRGB(0xdb, 0x70, 0x93)},
+    {"papayawhip", /*           */ SkColorSetRGB(0xff, 0xef, 0xd5)},
+    {"peachpuff", /*            */ SkColorSetRGB(0xff, 0xda, 0xb9)},
+    {"peru", /*                 */ SkColorSetRGB(0xcd, 0x85, 0x3f)},
+    {"pink", /*                 */ SkColorSetRGB(0xff, 0xc0, 0xcb)},
+    {"plum", /*                 */ SkColorSetRGB(0xdd, 0xa0, 0xdd)},
+    {"powderblue", /*           */ SkColorSetRGB(0xb0, 0xe0, 0xe6)},
+    {"purple", /*               */ SkColorSetRGB(0x80, 0x00, 0x80)},
+    {"rebeccapurple", /*        */ SkColorSetRGB(0x66, 0x33, 0x99)},
+    {"red", /*                  */ SkColorSetRGB(0xff, 0x00, 0x00)},
+    {"rosybrown", /*            */ SkColorSetRGB(0xbc, 0x8f, 0x8f)},
+    {"royalblue", /*            */ SkColorSetRGB(0x41, 0x69, 0xe1)},
+    {"saddlebrown", /*          */ SkColorSetRGB(0x8b, 0x45, 0x13)},
+    {"salmon", /*               */ SkColorSetRGB(0xfa, 0x80, 0x72)},
+    {"sandybrown", /*           */ SkColorSetRGB(0xf4, 0xa4, 0x60)},
+    {"seagreen", /*             */ SkColorSetRGB(0x2e, 0x8b, 0x57)},
+    {"seashell", /*             */ SkColorSetRGB(0xff, 0xf5, 0xee)},
+    {"sienna", /*               */ SkColorSetRGB(0xa0, 0x52, 0x2d)},
+    {"silver", /*               */ SkColorSetRGB(0xc0, 0xc0, 0xc0)},
+    {"skyblue", /*              */ SkColorSetRGB(0x87, 0xce, 0xeb)},
+    {"slateblue", /*            */ SkColorSetRGB(0x6a, 0x5a, 0xcd)},
+    {"slategray", /*            */ SkColorSetRGB(0x70, 0x80, 0x90)},
+    {"slategrey", /*            */ SkColorSetRGB(0x70, 0x80, 0x90)},
+    {"snow", /*                 */ SkColorSetRGB(0xff, 0xfa, 0xfa)},
+    {"springgreen", /*          */ SkColorSetRGB(0x00, 0xff, 0x7f)},
+    {"steelblue", /*            */ SkColorSetRGB(0x46, 0x82, 0xb4)},
+    {"tan", /*                  */ SkColorSetRGB(0xd2, 0xb4, 0x8c)},
+    {"teal", /*                 */ SkColorSetRGB(0x00, 0x80, 0x80)},
+    {"thistle", /*              */ SkColorSetRGB(0xd8, 0xbf, 0xd8)},
+    {"tomato", /*               */ SkColorSetRGB(0xff, 0x63, 0x47)},
+    {"turquoise", /*            */ SkColorSetRGB(0x40, 0xe0, 0xd0)},
+    {"violet", /*               */ SkColorSetRGB(0xee, 0x82, 0xee)},
+    {"wheat", /*                */ SkColorSetRGB(0xf5, 0xde, 0xb3)},
+    {"white", /*                */ SkColorSetRGB(0xff, 0xff, 0xff)},
+    {"whitesmoke", /*           */ SkColorSetRGB(0xf5, 0xf5, 0xf5)},
+    {"yellow", /*               */ SkColorSetRGB(0xff, 0xff, 0x00)},
+    {"yellowgreen", /*          */ SkColorSetRGB(0x9a, 0xcd, 0x32)},
+};
+
+bool LookupNamedColor(std::string_view name, SkColor* out) {
+  // The longest name is "lightgoldenrodyellow".
+  char lower[24];
+  if (name.size() >= sizeof(lower)) {
+    return false;
+  }
+  for (size_t i = 0; i < name.size(); i++) {
+    lower[i] = ToLower(name[i]);
+  }
+  lower[name.size()] = '\0';
+  if (strcmp(lower, "transparent") == 0) {
+    *out = SK_ColorTRANSPARENT;
+    return true;
+  }
+  const NamedColor* end = kNamedColors + std::size(kNamedColors);
+  const NamedColor* it = std::lower_bound(
+      kNamedColors, end, lower, [](const NamedColor& color, const char* name) {
+        return strcmp(color.name, name) < 0;
+      });
+  if (it == end || strcmp(it->name, lower) != 0) {
+    return false;
+  }
+  *out = it->color;
+  return true;
+}
+
+// A component of a color function, like "12", "50%", "30deg" or "none".
+struct ColorComponent {
+  enum Type {
+    NUMBER,
+    PERCENTAGE,
+    // Converted to degrees in |value|.
+    ANGLE,
+    NONE,
+  };
+
+  Type type = NONE;
+  double value = 0;
+
+  // Returns the value for components where 100% is |percent_scale|.
+  double Get(double percent_scale) const {
+    if (type == PERCENTAGE) {
+      return value / 100 * percent_scale;
+    }
+    return type == NONE ? 0 : value;
+  }
+};
+
+// Parses the arguments of color functions in a single pass, without
+// allocating. Both the legacy syntax with commas, like "rgba(1, 2, 3, 0.5)",
+// and the modern syntax, like "rgb(1 2 3 / 50%)", are supported.
+class ColorFunctionParser final {
+ public:
+  explicit ColorFunctionParser(std::string_view s) : s_(s), pos_(0) {}
+
+  // Consumes |name| followed by '(', ignoring case.
+  bool ParseName(const char* name) {
+    size_t size = strlen(name);
+    if (s_.size() < size + 1) {
+      return false;
+    }
+    for (size_t i = 0; i < size; i++) {
+      if (ToLower(s_[i]) != name[i]) {
+        return false;
+      }
+    }
+    if (s_[size] != '(') {
+      return false;
+    }
+    pos_ = size + 1;
+    return true;
+  }
+
+  // Consumes an identifier, like the color space of color(), ignoring case.
+  bool ParseIdentifier(std::string_view* identifier) {
+    SkipSpaces();
+    size_t start = pos_;
+    while (pos_ < s_.size() && (IsAlnum(s_[pos_]) || s_[pos_] == '-')) {
+      pos_++;
+    }
+    *identifier = s_.substr(start, pos_ - start);
+    return pos_ > start;
+  }
+
+  // Parses 3 components and an optional alpha, which defaults to 1, and the
+  // closing ')'.
+  bool ParseArguments(ColorComponent c[3], double* alpha, bool allow_legacy) {
+    if (!ParseComponent(&c[0])) {
+      return false;
+    }
+    SkipSpaces();
+    bool legacy = allow_legacy && Eat(',');
+    for (int i = 1; i < 3; i++) {
+      if (!ParseComponent(&c[i])) {
+        return false;
+      }
+      SkipSpaces();
+      if (legacy && i < 2 && !Eat(',')) {
+        return false;
+      }
+    }
+    *alpha = 1;
+    if (legacy ? Eat(',') : Eat('/')) {
+      ColorComponent a;
+      if (!ParseComponent(&a) || a.type == ColorComponent::ANGLE) {
+        return false;
+      }
+      *alpha = std::clamp(a.Get(1), 0.0, 1.0);
+      SkipSpaces();
+    }
+    if (!Eat(')')) {
+      return false;
+    }
+    SkipSpaces();
+    return pos_ == s_.size();
+  }
+
+ private:
+  void SkipSpaces() {
+    while (pos_ < s_.size() && IsSpace(s_[pos_])) {
+      pos_++;
+    }
+  }
+
+  bool Eat(char c) {
+    if (pos_ < s_.size() && s_[pos_] == c) {
+      pos_++;
+      return true;
+    }
+    return false;
+  }
+
+  bool EatIgnoringCase(const char* word) {
+    size_t size = strlen(word);
+    if (s_.size() - pos_ < size) {
+      return false;
+    }
+    for (size_t i = 0; i < size; i++) {
+      if (ToLower(s_[pos_ + i]) != word[i]) {
+        return false;
+      }
+    }
+    pos_ += size;
+    return true;
+  }
+
+  bool ParseNumber(double* value) {
+    double sign = 1;
+    if (Eat('-')) {
+      sign = -1;
+    } else {
+      Eat('+');
+    }
+    double n = 0;
+    bool has_digits = false;
+    while (pos_ < s_.size() && IsDigit(s_[pos_])) {
+      n = n * 10 + (s_[pos_++] - '0');
+      has_digits = true;
+    }
+    if (Eat('.')) {
+      double scale = 0.1;
+      while (pos_ < s_.size() && IsDigit(s_[pos_])) {
+        n += (s_[pos_++] - '0') * scale;
+        scale *= 0.1;
+        has_digits = true;
+      }
+    }
+    if (!has_digits) {
+      return false;
+    }
+    if (pos_ + 1 < s_.size() && ToLower(s_[pos_]) == 'e' &&
+        (IsDigit(s_[pos_ + 1]) || s_[pos_ + 1] == '-' ||
+         s_[pos_ + 1] == '+')) {
+      pos_++;
+      double exponent_sign = Eat('-') ? -1 : (Eat('+'), 1);
+      int exponent = 0;
+      while (pos_ < s_.size() && IsDigit(s_[pos_])) {
+        exponent = std::min(exponent * 10 + (s_[pos_++] - '0'), 1000);
+      }
+      n *= pow(10, exponent_sign * exponent);
+    }
+    *value = sign * n;
+    return true;
+  }
+
+  bool ParseComponent(ColorComponent* c) {
+    SkipSpaces();
+    if (EatIgnoringCase("none")) {
+      c->type = ColorComponent::NONE;
+      c->value = 0;
+      return true;
+    }
+    if (!ParseNumber(&c->value)) {
+      return false;
+    }
+    c->type = ColorComponent::NUMBER;
+    if (Eat('%')) {
+      c->type = ColorComponent::PERCENTAGE;
+    } else if (EatIgnoringCase("deg")) {
+      c->type = ColorComponent::ANGLE;
+    } else if (EatIgnoringCase("grad")) {
+      c->type = ColorComponent::ANGLE;
+      c->value *= 0.9;
+    } else if (EatIgnoringCase("rad")) {
+      c->type = ColorComponent::ANGLE;
+      c->value *= 180 / kPi;
+    } else if (EatIgnoringCase("turn")) {
+      c->type = ColorComponent::ANGLE;
+      c->value *= 360;
+    }
+    return true;
+  }
+
+  std::string_view s_;
+  size_t pos_;
+};
+
+int ToByte(double value) {
+  return std::clamp(static_cast<int>(lround(value * 255)), 0, 255);
+}
+
+SkColor MakeColor(double r, double g, double b, double alpha) {
+  return SkColorSetARGB(ToByte(alpha), ToByte(r), ToByte(g), ToByte(b));
+}
+
+// Converts linear sRGB to gamma encoded sRGB. Colors out of the sRGB gamut
+// are clamped later by ToByte().
+double GammaEncode(double v) {
+  double abs = fabs(v);
+  double encoded =
+      abs <= 0.0031308 ? 12.92 * abs : 1.055 * pow(abs, 1 / 2.4) - 0.055;
+  return v < 0 ? -encoded : encoded;
+}
+
+double GammaDecode(double v) {
+  double abs = fabs(v);
+  double decoded =
+      abs <= 0.04045 ? abs / 12.92 : pow((abs + 0.055) / 1.055, 2.4);
+  return v < 0 ? -decoded : decoded;
+}
+
+void Multiply(const double m[3][3], double v[3]) {
+  double r[3];
+  for (int i = 0; i < 3; i++) {
+    r[i] = m[i][0] * v[0] + m[i][1] * v[1] + m[i][2] * v[2];
+  }
+  v[0] = r[0];
+  v[1] = r[1];
+  v[2] = r[2];
+}
+
+// The conversion matrices from the CSS Color 4 spec.
+const double kD50ToD65[3][3] = {
+    {0.9554734527042182, -0.023098536874261423, 0.0632593086610217},
+    {-0.028369706963208136, 1.0099954580058226, 0.021041398966943008},
+    {0.012314001688319899, -0.020507696433477912, 1.3303659366080753},
+};
+
+const double kXyzD65ToLinearSrgb[3][3] = {
+    {3.2409699419045226, -1.537383177570094, -0.4986107602930034},
+    {-0.9692436362808796, 1.8759675015077202, 0.04155505740717559},
+    {0.05563007969699366, -0.20397695888897652, 1.0569715142428786},
+};
+
+const double kLinearP3ToXyzD65[3][3] = {
+    {0.48657094864821626, 0.26566769316909294, 0.1982172852343625},
+    {0.22897456406974884, 0.6917385218365062, 0.079286914093745},
+    {0.0, 0.04511338185890257, 1.0439443689009757},
+};
+
+SkColor XyzD65ToColor(double xyz[3], double alpha) {
+  Multiply(kXyzD65ToLinearSrgb, xyz);
+  return MakeColor(GammaEncode(xyz[0]), GammaEncode(xyz[1]),
+                   GammaEncode(xyz[2]), alpha);
+}
+
+// |hue| in degrees, and |s| and |l| between 0 and 1.
+void HslToRgb(double hue, double s, double l, double rgb[3]) {
+  hue = fmod(hue, 360);
+  if (hue < 0) {
+    hue += 360;
+  }
+  s = std::clamp(s, 0.0, 1.0);
+  l = std::clamp(l, 0.0, 1.0);
+  double a = s * std::min(l, 1 - l);
+  const double n[3] = {0, 8, 4};
+  for (int i = 0; i < 3; i++) {
+    double k = fmod(n[i] + hue / 30, 12);
+    rgb[i] = l - a * std::max(-1.0, std::min({k - 3, 9 - k, 1.0}));
+  }
+}
+
+SkColor LabToColor(double l, double a, double b, double alpha) {
+  constexpr double kappa = 24389.0 / 27;
+  constexpr double epsilon = 216.0 / 24389;
+  double f1 = (l + 16) / 116;
+  double f0 = a / 500 + f1;
+  double f2 = f1 - b / 200;
+  double xyz[3] = {
+      pow(f0, 3) > epsilon ? pow(f0, 3) : (116 * f0 - 16) / kappa,
+      l > kappa * epsilon ? pow(f1, 3) : l / kappa,
+      pow(f2, 3) > epsilon ? pow(f2, 3) : (116 * f2 - 16) / kappa,
+  };
+  // The D50 white point.
+  xyz[0] *= 0.3457 / 0.3585;
+  xyz[2] *= (1 - 0.3457 - 0.3585) / 0.3585;
+  Multiply(kD50ToD65, xyz);
+  return XyzD65ToColor(xyz, alpha);
+}
+
+SkColor OklabToColor(double l, double a, double b, double alpha) {
+  double lms[3] = {
+      pow(l + 0.3963377774 * a + 0.2158037573 * b, 3),
+      pow(l - 0.1055613458 * a - 0.0638541728 * b, 3),
+      pow(l - 0.0894841775 * a - 1.2914855480 * b, 3),
+  };
+  static const double kLmsToLinearSrgb[3][3] = {
+      {4.0767416621, -3.3077115913, 0.2309699292},
+      {-1.2684380046, 2.6097574011, -0.3413193965},
+      {-0.0041960863, -0.7034186147, 1.7076147010},
+  };
+  Multiply(kLmsToLinearSrgb, lms);
+  return MakeColor(GammaEncode(lms[0]), GammaEncode(lms[1]),
+                   GammaEncode(lms[2]), alpha);
+}
+
+// Hues are numbers in degrees, or angles.
+bool IsHue(const ColorComponent& c) {
+  return c.type != ColorComponent::PERCENTAGE;
+}
+
+bool ParseColorFunction(std::string_view color, SkColor* out) {
+  ColorFunctionParser parser(color);
+  ColorComponent c[3];
+  double alpha;
+
+  if (parser.ParseName("rgb") || parser.ParseName("rgba")) {
+    if (!parser.ParseArguments(c, &alpha, true)) {
+      return false;
+    }
+    for (int i = 0; i < 3; i++) {
+      if (c[i].type == ColorComponent::ANGLE) {
+        return false;
+      }
+    }
+    *out = MakeColor(c[0].Get(255) / 255, c[1].Get(255) / 255,
+                     c[2].Get(255) / 255, alpha);
+    return true;
+  }
+
+  if (parser.ParseName("hsl") || parser.ParseName("hsla")) {
+    if (!parser.ParseArguments(c, &alpha, true) || !IsHue(c[0])) {
+      return false;
+    }
+    double rgb[3];
+    HslToRgb(c[0].Get(0), c[1].Get(100) / 100, c[2].Get(100) / 100, rgb);
+    *out = MakeColor(rgb[0], rgb[1], rgb[2], alpha);
+    return true;
+  }
+
+  if (parser.ParseName("hwb")) {
+    if (!parser.ParseArguments(c, &alpha, false) || !IsHue(c[0])) {
+      return false;
+    }
+    double white = std::clamp(c[1].Get(100) / 100, 0.0, 1.0);
+    double black = std::clamp(c[2].Get(100) / 100, 0.0, 1.0);
+    double rgb[3];
+    if (white + black >= 1) {
+      double gray = white / (white + black);
+      rgb[0] = rgb[1] = rgb[2] = gray;
+    } else {
+      HslToRgb(c[0].Get(0), 1, 0.5, rgb);
+      for (double& v : rgb) {
+        v = v * (1 - white - black) + white;
+      }
+    }
+    *out = MakeColor(rgb[0], rgb[1], rgb[2], alpha);
+    return true;
+  }
+
+  if (parser.ParseName("lab") || parser.ParseName("lch")) {
+    bool lch = ToLower(color[1]) == 'c';
+    if (!parser.ParseArguments(c, &alpha, false) || (lch && !IsHue(c[2]))) {
+      return false;
+    }
+    double l = std::max(c[0].Get(100), 0.0);
+    double a = c[1].Get(lch ? 150 : 125);
+    double b = c[2].Get(125);
+    if (lch) {
+      double hue = c[2].Get(0) * kPi / 180;
+      b = std::max(a, 0.0) * sin(hue);
+      a = std::max(a, 0.0) * cos(hue);
+    }
+    *out = LabToColor(l, a, b, alpha);
+    return true;
+  }
+
+  if (parser.ParseName("oklab") || parser.ParseName("oklch")) {
+    bool lch = ToLower(color[3]) == 'c';
+    if (!parser.ParseArguments(c, &alpha, false) || (lch && !IsHue(c[2]))) {
+      return false;
+    }
+    double l = std::max(c[0].Get(1), 0.0);
+    double a = c[1].Get(0.4);
+    double b = c[2].Get(0.4);
+    if (lch) {
+      double hue = c[2].Get(0) * kPi / 180;
+      b = std::max(a, 0.0) * sin(hue);
+      a = std::max(a, 0.0) * cos(hue);
+    }
+    *out = OklabToColor(l, a, b, alpha);
+    return true;
+  }
+
+  if (parser.ParseName("color")) {
+    std::string_view space;
+    if (!parser.ParseIdentifier(&space) ||
+        !parser.ParseArguments(c, &alpha, false)) {
+      return false;
+    }
+    double v[3];
+    for (int i = 0; i < 3; i++) {
+      if (c[i].type == ColorComponent::ANGLE) {
+        return false;
+      }
+      v[i] = c[i].Get(1);
+    }
+    auto is = [space](const char* name) {
+      return space.size() == strlen(name) &&
+             std::equal(space.begin(), space.end(), name,
+                        [](char a, char b) { return ToLower(a) == b; });
+    };
+    if (is("srgb")) {
+      *out = MakeColor(v[0], v[1], v[2], alpha);
+    } else if (is("srgb-linear")) {
+      *out = MakeColor(GammaEncode(v[0]), GammaEncode(v[1]),
+                       GammaEncode(v[2]), alpha);
+    } else if (is("display-p3")) {
+      for (double& x : v) {
+        x = GammaDecode(x);
+      }
+      Multiply(kLinearP3ToXyzD65, v);
+      *out = XyzD65ToColor(v, alpha);
+    } else if (is("xyz") || is("xyz-d65")) {
+      *out = XyzD65ToColor(v, alpha);
+    } else if (is("xyz-d50")) {
+      Multiply(kD50ToD65, v);
+      *out = XyzD65ToColor(v, alpha);
+    } else {
+      return false;
+    }
+    return true;
   }
+
+  return false;
 }
 
 }  // namespace
 
 //   "colorname"
+//   transparent
 //   #rgb
 //   #rgba
 //   #rrggbb
@@ -59,7 +697,21 @@ int FromHex(char c) {
 //   color: hsla(30 100% 50% / 0.6);
 //   color: hsl(30.0 100% 50% / 60%);
 //   color: hsla(30.2 100% 50% / 60%);
-bool CSSColorToSkColor(std::string color, SkColor* out) {
+//
+//   /* Other CSS Color 4 functions, clamped to sRGB */
+//   color: hwb(12 50% 0%);
+//   color: lab(29.2345% 39.3825 20.0664);
+//   color: lch(52.2345% 72.2 56.2 / 0.5);
+//   color: oklab(40.101% 0.1147 0.0453);
+//   color: oklch(59.69% 0.156 49.77);
+//   color: color(display-p3 1 0.5 0);
+bool CSSColorToSkColor(std::string_view color, SkColor* out) {
+  while (!color.empty() && IsSpace(color.front())) {
+    color.remove_prefix(1);
+  }
+  while (!color.empty() && IsSpace(color.back())) {
+    color.remove_suffix(1);
+  }
   if (color.empty()) {
     return false;
   }
@@ -100,194 +752,24 @@ bool CSSColorToSkColor(std::string color, SkColor* out) {
     return true;
   }
 
-  for (auto& c : color) {
-    c = tolower(c);
-  }
-
-  if (strncmp(color.c_str(), "rgb(", 4) == 0 ||
-      strncmp(color.c_str(), "rgba(", 5) == 0) {
-    // TODO: parse more formats.
-    static const std::regex re{
-        "rgba?\\( *([0-9]+) *, *([0-9]+) *, *([0-9]+)( *, *(0?.?([0-9]+)?))? "
-        "*\\)"};
-    std::smatch m;
-    if (std::regex_match(color, m, re)) {
-      int r = std::clamp(std::stoi(m[1]), 0, 255);
-      int g = std::clamp(std::stoi(m[2]), 0, 255);
-      int b = std::clamp(std::stoi(m[3]), 0, 255);
-      int a = 255;
-      if (m.size() >= 6 && m[5].length() > 0) {
-        a = std::clamp(static_cast<int>(255 * std::stof(m[5])), 0, 255);
-      }
-      *out = SkColorSetARGB(a, r, g, b);
-      return true;
-    } else {
-      return false;
-    }
-  } else if (strncmp(color.c_str(), "hsv(", 4) == 0 ||
-             strncmp(color.c_str(), "hsva(", 5) == 0) {
-    // TODO: parse hsv() color formats.
-    return false;
+  if (color.back() == ')') {
+    return ParseColorFunction(color, out);
   }
 
-  static const std::unordered_map<std::string, SkColor> map{
-      {"aliceblue", /*            */ SkColorSetRGB(0xf0, 0xf8, 0xff)},
-      {"antiquewhite", /*         */ SkColorSetRGB(0xfa, 0xeb, 0xd7)},
-      {"aqua", /*                 */ SkColorSetRGB(0x00, 0xff, 0xff)},
-      {"aquamarine", /*           */ SkColorSetRGB(0x7f, 0xff, 0xd4)},
-      {"azure", /*                */ SkColorSetRGB(0xf0, 0xff, 0xff)},
-      {"beige", /*                */ SkColorSetRGB(0xf5, 0xf5, 0xdc)},
-      {"bisque", /*               */ SkColorSetRGB(0xff, 0xe4, 0xc4)},
-      {"black", /*                */ SkColorSetRGB(0x00, 0x00, 0x00)},
-      {"blanchedalmond", /*       */ SkColorSetRGB(0xff, 0xeb, 0xcd)},
-      {"blue", /*                 */ SkColorSetRGB(0x00, 0x00, 0xff)},
-      {"blueviolet", /*           */ SkColorSetRGB(0x8a, 0x2b, 0xe2)},
-      {"brown", /*                */ SkColorSetRGB(0xa5, 0x2a, 0x2a)},
-      {"burlywood", /*            */ SkColorSetRGB(0xde, 0xb8, 0x87)},
-      {"cadetblue", /*            */ SkColorSetRGB(0x5f, 0x9e, 0xa0)},
-      {"chartreuse", /*           */ SkColorSetRGB(0x7f, 0xff, 0x00)},
-      {"chocolate", /*            */ SkColorSetRGB(0xd2, 0x69, 0x1e)},
-      {"coral", /*                */ SkColorSetRGB(0xff, 0x7f, 0x50)},
-      {"cornflowerblue", /*       */ SkColorSetRGB(0x64, 0x95, 0xed)},
-      {"cornsilk", /*             */ SkColorSetRGB(0xff, 0xf8, 0xdc)},
-      {"crimson", /*              */ SkColorSetRGB(0xdc, 0x14, 0x3c)},
-      {"cyan", /*                 */ SkColorSetRGB(0x00, 0xff, 0xff)},
-      {"darkblue", /*             */ SkColorSetRGB(0x00, 0x00, 0x8b)},
-      {"darkcyan", /*             */ SkColorSetRGB(0x00, 0x8b, 0x8b)},
-      {"darkgoldenrod", /*        */ SkColorSetRGB(0xb8, 0x86, 0x0b)},
-      {"darkgray", /*             */ SkColorSetRGB(0xa9, 0xa9, 0xa9)},
-      {"darkgreen", /*            */ SkColorSetRGB(0x00, 0x64, 0x00)},
-      {"darkgrey", /*             */ SkColorSetRGB(0xa9, 0xa9, 0xa9)},
-      {"darkkhaki", /*            */ SkColorSetRGB(0xbd, 0xb7, 0x6b)},
-      {"darkmagenta", /*          */ SkColorSetRGB(0x8b, 0x00, 0x8b)},
-      {"darkolivegreen", /*       */ SkColorSetRGB(0x55, 0x6b, 0x2f)},
-      {"darkorange", /*           */ SkColorSetRGB(0xff, 0x8c, 0x00)},
-      {"darkorchid", /*           */ SkColorSetRGB(0x99, 0x32, 0xcc)},
-      {"darkred", /*              */ SkColorSetRGB(0x8b, 0x00, 0x00)},
-      {"darksalmon", /*           */ SkColorSetRGB(0xe9, 0x96, 0x7a)},
-      {"darkseagreen", /*         */ SkColorSetRGB(0x8f, 0xbc, 0x8f)},
-      {"darkslateblue", /*        */ SkColorSetRGB(0x48, 0x3d, 0x8b)},
-      {"darkslategray", /*        */ SkColorSetRGB(0x2f, 0x4f, 0x4f)},
-      {"darkslategrey", /*        */ SkColorSetRGB(0x2f, 0x4f, 0x4f)},
-      {"darkturquoise", /*        */ SkColorSetRGB(0x00, 0xce, 0xd1)},
-      {"darkviolet", /*           */ SkColorSetRGB(0x94, 0x00, 0xd3)},
-      {"deeppink", /*             */ SkColorSetRGB(0xff, 0x14, 0x93)},
-      {"deepskyblue", /*          */ SkColorSetRGB(0x00, 0xbf, 0xff)},
-      {"dimgray", /*              */ SkColorSetRGB(0x69, 0x69, 0x69)},
-      {"dimgrey", /*              */ SkColorSetRGB(0x69, 0x69, 0x69)},
-      {"dodgerblue", /*           */ SkColorSetRGB(0x1e, 0x90, 0xff)},
-      {"firebrick", /*            */ SkColorSetRGB(0xb2, 0x22, 0x22)},
-      {"floralwhite", /*          */ SkColorSetRGB(0xff, 0xfa, 0xf0)},
-      {"forestgreen", /*          */ SkColorSetRGB(0x22, 0x8b, 0x22)},
-      {"fuchsia", /*              */ SkColorSetRGB(0xff, 0x00, 0xff)},
-      {"gainsboro", /*            */ SkColorSetRGB(0xdc, 0xdc, 0xdc)},
-      {"ghostwhite", /*           */ SkColorSetRGB(0xf8, 0xf8, 0xff)},
-      {"gold", /*                 */ SkColorSetRGB(0xff, 0xd7, 0x00)},
-      {"goldenrod", /*            */ SkColorSetRGB(0xda, 0xa5, 0x20)},
-      {"gray", /*                 */ SkColorSetRGB(0x80, 0x80, 0x80)},
-      {"green", /*                */ SkColorSetRGB(0x00, 0x80, 0x00)},
-      {"greenyellow", /*          */ SkColorSetRGB(0xad, 0xff, 0x2f)},
-      {"grey", /*                 */ SkColorSetRGB(0x80, 0x80, 0x80)},
-      {"honeydew", /*             */ SkColorSetRGB(0xf0, 0xff, 0xf0)},
-      {"hotpink", /*              */ SkColorSetRGB(0xff, 0x69, 0xb4)},
-      {"indianred", /*            */ SkColorSetRGB(0xcd, 0x5c, 0x5c)},
-      {"indigo", /*               */ SkColorSetRGB(0x4b, 0x00, 0x82)},
-      {"ivory", /*                */ SkColorSetRGB(0xff, 0xff, 0xf0)},
-      {"khaki", /*                */ SkColorSetRGB(0xf0, 0xe6, 0x8c)},
-      {"lavender", /*             */ SkColorSetRGB(0xe6, 0xe6, 0xfa)},
-      {"lavenderblush", /*        */ SkColorSetRGB(0xff, 0xf0, 0xf5)},
-      {"lawngreen", /*            */ SkColorSetRGB(0x7c, 0xfc, 0x00)},
-      {"lemonchiffon", /*         */ SkColorSetRGB(0xff, 0xfa, 0xcd)},
-      {"lightblue", /*            */ SkColorSetRGB(0xad, 0xd8, 0xe6)},
-      {"lightcoral", /*           */ SkColorSetRGB(0xf0, 0x80, 0x80)},
-      {"lightcyan", /*            */ SkColorSetRGB(0xe0, 0xff, 0xff)},
-      {"lightgoldenrodyellow", /* */ SkColorSetRGB(0xfa, 0xfa, 0xd2)},
-      {"lightgray", /*            */ SkColorSetRGB(0xd3, 0xd3, 0xd3)},
-      {"lightgreen", /*           */ SkColorSetRGB(0x90, 0xee, 0x90)},
-      {"lightgrey", /*            */ SkColorSetRGB(0xd3, 0xd3, 0xd3)},
-      {"lightpink", /*            */ SkColorSetRGB(0xff, 0xb6, 0xc1)},
-      {"lightsalmon", /*          */ SkColorSetRGB(0xff, 0xa0, 0x7a)},
-      {"lightseagreen", /*        */ SkColorSetRGB(0x20, 0xb2, 0xaa)},
-      {"lightskyblue", /*         */ SkColorSetRGB(0x87, 0xce, 0xfa)},
-      {"lightslategray", /*       */ SkColorSetRGB(0x77, 0x88, 0x99)},
-      {"lightslategrey", /*       */ SkColorSetRGB(0x77, 0x88, 0x99)},
-      {"lightsteelblue", /*       */ SkColorSetRGB(0xb0, 0xc4, 0xde)},
-      {"lightyellow", /*          */ SkColorSetRGB(0xff, 0xff, 0xe0)},
-      {"lime", /*                 */ SkColorSetRGB(0x00, 0xff, 0x00)},
-      {"limegreen", /*            */ SkColorSetRGB(0x32, 0xcd, 0x32)},
-      {"linen", /*                */ SkColorSetRGB(0xfa, 0xf0, 0xe6)},
-      {"magenta", /*              */ SkColorSetRGB(0xff, 0x00, 0xff)},
-      {"maroon", /*               */ SkColorSetRGB(0x80, 0x00, 0x00)},
-      {"mediumaquamarine", /*     */ SkColorSetRGB(0x66, 0xcd, 0xaa)},
-      {"mediumblue", /*           */ SkColorSetRGB(0x00, 0x00, 0xcd)},
-      {"mediumorchid", /*         */ SkColorSetRGB(0xba, 0x55, 0xd3)},
-      {"mediumpurple", /*         */ SkColorSetRGB(0x93, 0x70, 0xdb)},
-      {"mediumseagreen", /*       */ SkColorSetRGB(0x3c, 0xb3, 0x71)},
-      {"mediumslateblue", /*      */ SkColorSetRGB(0x7b, 0x68, 0xee)},
-      {"mediumspringgreen", /*    */ SkColorSetRGB(0x00, 0xfa, 0x9a)},
-      {"mediumturquoise", /*      */ SkColorSetRGB(0x48, 0xd1, 0xcc)},
-      {"mediumvioletred", /*      */ SkColorSetRGB(0xc7, 0x15, 0x85)},
-      {"midnightblue", /*         */ SkColorSetRGB(0x19, 0x19, 0x70)},
-      {"mintcream", /*            */ SkColorSetRGB(0xf5, 0xff, 0xfa)},
-      {"mistyrose", /*            */ SkColorSetRGB(0xff, 0xe4, 0xe1)},
-      {"moccasin", /*             */ SkColorSetRGB(0xff, 0xe4, 0xb5)},
-      {"navajowhite", /*          */ SkColorSetRGB(0xff, 0xde, 0xad)},
-      {"navy", /*                 */ SkColorSetRGB(0x00, 0x00, 0x80)},
-      {"oldlace", /*              */ SkColorSetRGB(0xfd, 0xf5, 0xe6)},
-      {"olive", /*                */ SkColorSetRGB(0x80, 0x80, 0x00)},
-      {"olivedrab", /*            */ SkColorSetRGB(0x6b, 0x8e, 0x23)},
-      {"orange", /*               */ SkColorSetRGB(0xff, 0xa5, 0x00)},
-      {"orangered", /*            */ SkColorSetRGB(0xff, 0x45, 0x00)},
-      {"orchid", /*               */ SkColorSetRGB(0xda, 0x70, 0xd6)},
-      {"palegoldenrod", /*        */ SkColorSetRGB(0xee, 0xe8, 0xaa)},
-      {"palegreen", /*            */ SkColorSetRGB(0x98, 0xfb, 0x98)},
-      {"paleturquoise", /*        */ SkColorSetRGB(0xaf, 0xee, 0xee)},
-      {"palevioletred", /*        */ SkColorSetRGB(0xdb, 0x70, 0x93)},
-      {"papayawhip", /*           */ SkColorSetRGB(0xff, 0xef, 0xd5)},
-      {"peachpuff", /*            */ SkColorSetRGB(0xff, 0xda, 0xb9)},
-      {"peru", /*                 */ SkColorSetRGB(0xcd, 0x85, 0x3f)},
-      {"pink", /*                 */ SkColorSetRGB(0xff, 0xc0, 0xcb)},
-      {"plum", /*                 */ SkColorSetRGB(0xdd, 0xa0, 0xdd)},
-      {"powderblue", /*           */ SkColorSetRGB(0xb0, 0xe0, 0xe6)},
-      {"purple", /*               */ SkColorSetRGB(0x80, 0x00, 0x80)},
-      {"rebeccapurple", /*        */ SkColorSetRGB(0x66, 0x33, 0x99)},
-      {"red", /*                  */ SkColorSetRGB(0xff, 0x00, 0x00)},
-      {"rosybrown", /*            */ SkColorSetRGB(0xbc, 0x8f, 0x8f)},
-      {"royalblue", /*            */ SkColorSetRGB(0x41, 0x69, 0xe1)},
-      {"saddlebrown", /*          */ SkColorSetRGB(0x8b, 0x45, 0x13)},
-      {"salmon", /*               */ SkColorSetRGB(0xfa, 0x80, 0x72)},
-      {"sandybrown", /*           */ SkColorSetRGB(0xf4, 0xa4, 0x60)},
-      {"seagreen", /*             */ SkColorSetRGB(0x2e, 0x8b, 0x57)},
-      {"seashell", /*             */ SkColorSetRGB(0xff, 0xf5, 0xee)},
-      {"sienna", /*               */ SkColorSetRGB(0xa0, 0x52, 0x2d)},
-      {"silver", /*               */ SkColorSetRGB(0xc0, 0xc0, 0xc0)},
-      {"skyblue", /*              */ SkColorSetRGB(0x87, 0xce, 0xeb)},
-      {"slateblue", /*            */ SkColorSetRGB(0x6a, 0x5a, 0xcd)},
-      {"slategray", /*            */ SkColorSetRGB(0x70, 0x80, 0x90)},
-      {"slategrey", /*            */ SkColorSetRGB(0x70, 0x80, 0x90)},
-      {"snow", /*                 */ SkColorSetRGB(0xff, 0xfa, 0xfa)},
-      {"springgreen", /*          */ SkColorSetRGB(0x00, 0xff, 0x7f)},
-      {"steelblue", /*            */ SkColorSetRGB(0x46, 0x82, 0xb4)},
-      {"tan", /*                  */ SkColorSetRGB(0xd2, 0xb4, 0x8c)},
-      {"teal", /*                 */ SkColorSetRGB(0x00, 0x80, 0x80)},
-      {"thistle", /*              */ SkColorSetRGB(0xd8, 0xbf, 0xd8)},
-      {"tomato", /*               */ SkColorSetRGB(0xff, 0x63, 0x47)},
-      {"turquoise", /*            */ SkColorSetRGB(0x40, 0xe0, 0xd0)},
-      {"violet", /*               */ SkColorSetRGB(0xee, 0x82, 0xee)},
-      {"wheat", /*                */ SkColorSetRGB(0xf5, 0xde, 0xb3)},
-      {"white", /*                */ SkColorSetRGB(0xff, 0xff, 0xff)},
-      {"whitesmoke", /*           */ SkColorSetRGB(0xf5, 0xf5, 0xf5)},
-      {"yellow", /*               */ SkColorSetRGB(0xff, 0xff, 0x00)},
-      {"yellowgreen", /*          */ SkColorSetRGB(0x9a, 0xcd, 0x32)},
-  };
+  return LookupNamedColor(color, out);
+}
 
-  auto it = map.find(color);
-  if (it != map.end()) {
-    *out = it->second;
-    return true;
+bool CSSColorCache::Parse(std::string_view css, SkColor* out) {
+  Entry& entry = entries_[std::hash<std::string_view>()(css) % kSize];
+  if (entry.css != css) {
+    // Invalid colors are cached too.
+    entry.css = css;
+    entry.valid = CSSColorToSkColor(css, &entry.color);
   }
-
-  return false;
+  if (entry.valid) {
+    *out = entry.color;
+  }
+  return entry.valid;
 }
 
 std::string SkColorToCSSColor(SkColor color) {
@@ -311,82 +793,299 @@ std::string SkColorToCSSColor(SkColor color) {
   return result;
 }
 
-// [italic] [bold] [Npx] font-name | "font name"
-bool CSSFontToSkFont(
-    const std::string& css_font, SkFont* out,
-    const std::unordered_map<std::string, sk_sp<SkTypeface>>& fonts,
-    std::unordered_map<std::string, sk_sp<SkTypeface>>* cache) {
-  bool italic = false;
-  bool bold = false;
-  float size = 12.0f;
+namespace {
 
-  const char* s = css_font.c_str();
+bool EqualsIgnoringCase(std::string_view s, const char* lowercase) {
+  return s.size() == strlen(lowercase) &&
+         std::equal(s.begin(), s.end(), lowercase,
+                    [](char a, char b) { return ToLower(a) == b; });
+}
+
+// Splits the font shorthand into tokens. Quoted strings are a single token
+// without the quotes, and '/' and ',' are tokens too.
+class FontTokenizer final {
+ public:
+  explicit FontTokenizer(std::string_view s) : s_(s), pos_(0) {}
 
-  while (*s == ' ') {
-    s++;
+  bool AtEnd() {
+    SkipSpaces();
+    return pos_ == s_.size();
   }
-  if (strncmp(s, "italic ", 7) == 0) {
-    italic = true;
-    s += 7;
-    while (*s == ' ') {
-      s++;
+
+  // Returns false at the end, or on unterminated quotes.
+  bool Next(std::string_view* token, bool* quoted) {
+    SkipSpaces();
+    if (pos_ == s_.size()) {
+      return false;
     }
-  }
-  if (strncmp(s, "bold ", 5) == 0) {
-    bold = true;
-    s += 5;
-    while (*s == ' ') {
-      s++;
+    *quoted = false;
+    char c = s_[pos_];
+    if (c == '"' || c == '\'') {
+      size_t end = s_.find(c, pos_ + 1);
+      if (end == std::string_view::npos) {
+        return false;
+      }
+      *token = s_.substr(pos_ + 1, end - pos_ - 1);
+      *quoted = true;
+      pos_ = end + 1;
+      return true;
     }
-  }
-  if (isdigit(*s)) {
-    size = std::strtof(s, const_cast<char**>(&s));
-    if (size < 0.0f) {
-      size = 0.0f;
+    if (c == '/' || c == ',') {
+      *token = s_.substr(pos_++, 1);
+      return true;
     }
-    if (s[0] != 'p' || s[1] != 'x') {
-      return false;
+    size_t start = pos_;
+    while (pos_ < s_.size() && !IsSpace(s_[pos_]) && s_[pos_] != '/' &&
+           s_[pos_] != ',' && s_[pos_] != '"' && s_[pos_] != '\'') {
+      pos_++;
     }
-    s += 2;
-    while (*s == ' ') {
-      s++;
+    *token = s_.substr(start, pos_ - start);
+    return true;
+  }
+
+  bool Peek(std::string_view* token, bool* quoted) {
+    size_t pos = pos_;
+    bool ok = Next(token, quoted);
+    pos_ = pos;
+    return ok;
+  }
+
+ private:
+  void SkipSpaces() {
+    while (pos_ < s_.size() && IsSpace(s_[pos_])) {
+      pos_++;
     }
   }
 
-  const char* end = s + strlen(s) - 1;
-  while (end > s && *end == ' ') {
-    end--;
+  std::string_view s_;
+  size_t pos_;
+};
+
+// The font-size that "em", "rem" and percentages are relative to.
+constexpr float kMediumFontSize = 16;
+
+// Parses a CSS number followed by an optional unit.
+bool ParseDimension(std::string_view token, float* value,
+                    std::string_view* unit) {
+  std::string number(token);
+  char* end = nullptr;
+  *value = std::strtof(number.c_str(), &end);
+  if (end == number.c_str() || !std::isfinite(*value)) {
+    return false;
+  }
+  *unit = token.substr(end - number.c_str());
+  return true;
+}
+
+bool ParseFontSize(std::string_view token, float* size) {
+  static const std::pair<const char*, float> kKeywords[] = {
+      {"xx-small", 9},  {"x-small", 10},  {"small", 13},
+      {"medium", 16},   {"large", 18},    {"x-large", 24},
+      {"xx-large", 32}, {"xxx-large", 48}, {"larger", 16 * 1.2f},
+      {"smaller", 16 / 1.2f},
+  };
+  for (const auto& [keyword, value] : kKeywords) {
+    if (EqualsIgnoringCase(token, keyword)) {
+      *size = value;
+      return true;
+    }
   }
 
-  if (end > s && *s == '"' && *end == '"') {
-    s++;
-    end--;
+  static const std::pair<const char*, float> kUnits[] = {
+      {"px", 1},
+      {"pt", 96.0f / 72},
+      {"pc", 16},
+      {"in", 96},
+      {"cm", 96 / 2.54f},
+      {"mm", 96 / 25.4f},
+      {"q", 96 / 101.6f},
+      {"em", kMediumFontSize},
+      {"rem", kMediumFontSize},
+      {"%", kMediumFontSize / 100},
+  };
+  float value;
+  std::string_view unit;
+  if (!ParseDimension(token, &value, &unit)) {
+    return false;
+  }
+  for (const auto& [name, scale] : kUnits) {
+    if (EqualsIgnoringCase(unit, name)) {
+      *size = std::max(value * scale, 0.0f);
+      return true;
+    }
   }
+  return false;
+}
+
+// Parses the keywords before the font-size. Returns false if |token| isn't
+// one of them.
+bool ParseFontKeyword(std::string_view token, int* weight,
+                      SkFontStyle::Slant* slant, SkFontStyle::Width* width,
+                      bool* small_caps) {
+  static const std::pair<const char*, SkFontStyle::Width> kWidths[] = {
+      {"ultra-condensed", SkFontStyle::kUltraCondensed_Width},
+      {"extra-condensed", SkFontStyle::kExtraCondensed_Width},
+      {"condensed", SkFontStyle::kCondensed_Width},
+      {"semi-condensed", SkFontStyle::kSemiCondensed_Width},
+      {"semi-expanded", SkFontStyle::kSemiExpanded_Width},
+      {"expanded", SkFontStyle::kExpanded_Width},
+      {"extra-expanded", SkFontStyle::kExtraExpanded_Width},
+      {"ultra-expanded", SkFontStyle::kUltraExpanded_Width},
+  };
 
-  std::string font(s, end - s + 1);
+  if (EqualsIgnoringCase(token, "normal")) {
+    return true;
+  } else if (EqualsIgnoringCase(token, "italic")) {
+    *slant = SkFontStyle::kItalic_Slant;
+  } else if (EqualsIgnoringCase(token, "oblique")) {
+    *slant = SkFontStyle::kOblique_Slant;
+  } else if (EqualsIgnoringCase(token, "small-caps")) {
+    *small_caps = true;
+  } else if (EqualsIgnoringCase(token, "bold") ||
+             EqualsIgnoringCase(token, "bolder")) {
+    *weight = SkFontStyle::kBold_Weight;
+  } else if (EqualsIgnoringCase(token, "lighter")) {
+    *weight = SkFontStyle::kThin_Weight;
+  } else if (!token.empty() && IsDigit(token[0]) &&
+             token.find_first_not_of("0123456789") == std::string_view::npos) {
+    int value = atoi(std::string(token).c_str());
+    if (value < 1 || value > 1000) {
+      return false;
+    }
+    *weight = value;
+  } else {
+    for (const auto& [name, value] : kWidths) {
+      if (EqualsIgnoringCase(token, name)) {
+        *width = value;
+        return true;
+      }
+    }
+    return false;
+  }
+  return true;
+}
 
-  if (font == "sans" || font == "sans-serif") {
-    font = "Arial";
-  } else if (font == "serif") {
-    font = "Times New Roman";
-  } else if (font == "monospace") {
+// The families used for the CSS generic families.
+std::string_view GetGenericFontFamily(std::string_view family) {
+  if (EqualsIgnoringCase(family, "sans") ||
+      EqualsIgnoringCase(family, "sans-serif") ||
+      EqualsIgnoringCase(family, "system-ui")) {
+    return "Arial";
+  } else if (EqualsIgnoringCase(family, "serif")) {
+    return "Times New Roman";
+  } else if (EqualsIgnoringCase(family, "monospace")) {
 #if defined(WINDOWJS_MAC)
-    font = "Monaco";
+    return "Monaco";
 #elif defined(WINDOWJS_LINUX)
-    font = "DejaVu Sans Mono";
+    return "DejaVu Sans Mono";
 #else
-    font = "Consolas";
+    return "Consolas";
 #endif
   }
+  return family;
+}
 
-  sk_sp<SkTypeface> typeface;
+}  // namespace
 
-  auto it = fonts.find(font);
-  if (it != fonts.end()) {
-    typeface = it->second;
-  } else {
-    std::string key = font + (bold ? "\tb" : "") + (italic ? "\ti" : "");
+//   [ <style> || <variant> || <weight> || <stretch> ]?
+//   <size> [/ <line-height>]? <family> [, <family>]*
+//
+// For example: italic bold 12px/30px Georgia, "Times New Roman", serif
+//
+// The size can be omitted too, for compatibility with older versions.
+bool ParseCSSFont(std::string_view css, CSSFont* out) {
+  FontTokenizer tokenizer(css);
+  CSSFont font;
+  int weight = SkFontStyle::kNormal_Weight;
+  SkFontStyle::Slant slant = SkFontStyle::kUpright_Slant;
+  SkFontStyle::Width width = SkFontStyle::kNormal_Width;
+
+  std::string_view token;
+  bool quoted = false;
+
+  // The keywords before the size.
+  for (;;) {
+    if (!tokenizer.Peek(&token, &quoted) || token.empty()) {
+      return false;
+    }
+    if (quoted ||
+        !ParseFontKeyword(token, &weight, &slant, &width, &font.small_caps)) {
+      break;
+    }
+    tokenizer.Next(&token, &quoted);
+  }
 
+  if (!quoted && ParseFontSize(token, &font.size)) {
+    tokenizer.Next(&token, &quoted);
+    if (tokenizer.Peek(&token, &quoted) && !quoted && token == "/") {
+      tokenizer.Next(&token, &quoted);
+      if (!tokenizer.Next(&token, &quoted)) {
+        return false;
+      }
+      float value;
+      std::string_view unit;
+      if (EqualsIgnoringCase(token, "normal")) {
+        font.line_height = 0;
+      } else if (!ParseDimension(token, &value, &unit)) {
+        return false;
+      } else if (unit.empty() || EqualsIgnoringCase(unit, "em")) {
+        font.line_height = value * font.size;
+      } else if (unit == "%") {
+        font.line_height = value / 100 * font.size;
+      } else if (ParseFontSize(token, &value)) {
+        font.line_height = value;
+      } else {
+        return false;
+      }
+    }
+  } else if (!quoted && (IsDigit(token[0]) || token[0] == '.')) {
+    // A size with an invalid unit.
+    return false;
+  }
+
+  // The families, separated by commas. Unquoted names can have spaces.
+  std::string family;
+  while (tokenizer.Next(&token, &quoted)) {
+    if (!quoted && token == ",") {
+      if (family.empty()) {
+        return false;
+      }
+      font.families.emplace_back(std::move(family));
+      family.clear();
+      continue;
+    }
+    if (!family.empty()) {
+      family.push_back(' ');
+    }
+    family.append(token);
+  }
+  if (family.empty()) {
+    return false;
+  }
+  font.families.emplace_back(std::move(family));
+
+  font.style = SkFontStyle(weight, width, slant);
+  *out = std::move(font);
+  return true;
+}
+
+sk_sp<SkTypeface> MatchCSSFontTypeface(
+    const CSSFont& font,
+    const std::unordered_map<std::string, sk_sp<SkTypeface>>& fonts,
+    std::unordered_map<std::string, sk_sp<SkTypeface>>* cache) {
+  for (const std::string& css_family : font.families) {
+    // Fonts from window.loadFont() are used for every style.
+    auto it = fonts.find(css_family);
+    if (it != fonts.end() && it->second) {
+      return it->second;
+    }
+
+    std::string family(GetGenericFontFamily(css_family));
+    std::string key = family + "\t" + std::to_string(font.style.weight()) +
+                      "\t" + std::to_string(font.style.width()) + "\t" +
+                      std::to_string(font.style.slant());
+
+    sk_sp<SkTypeface> typeface;
     bool has_cached_result = false;
     if (cache) {
       auto it = cache->find(key);
@@ -398,14 +1097,10 @@ bool CSSFontToSkFont(
 
     if (!has_cached_result) {
       sk_sp<SkFontMgr> font_manager = SkFontMgr::RefDefault();
-      sk_sp<SkFontStyleSet> set(font_manager->matchFamily(font.c_str()));
-
-      SkFontStyle font_style(
-          bold ? SkFontStyle::kBold_Weight : SkFontStyle::kNormal_Weight,
-          SkFontStyle::kNormal_Width,
-          italic ? SkFontStyle::kItalic_Slant : SkFontStyle::kUpright_Slant);
-
-      typeface.reset(set->matchStyle(font_style));
+      sk_sp<SkFontStyleSet> set(font_manager->matchFamily(family.c_str()));
+      if (set && set->count() > 0) {
+        typeface.reset(set->matchStyle(font.style));
+      }
 
       // Note: cache missing typefaces as well, so that future lookups fail
       // fast.
@@ -413,13 +1108,29 @@ bool CSSFontToSkFont(
         cache->emplace(key, typeface);
       }
     }
+
+    if (typeface) {
+      return typeface;
+    }
+  }
+  return nullptr;
+}
+
+bool CSSFontToSkFont(
+    const std::string& css_font, SkFont* out,
+    const std::unordered_map<std::string, sk_sp<SkTypeface>>& fonts,
+    std::unordered_map<std::string, sk_sp<SkTypeface>>* cache) {
+  CSSFont font;
+  if (!ParseCSSFont(css_font, &font)) {
+    return false;
   }
 
+  sk_sp<SkTypeface> typeface = MatchCSSFontTypeface(font, fonts, cache);
   if (typeface) {
     out->setTypeface(typeface);
   }
 
-  out->setSize(size);
+  out->setSize(font.size);
 
   return true;
 }
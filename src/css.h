@@ -1,17 +1,71 @@
 #ifndef WINDOWJS_CSS_H
 #define WINDOWJS_CSS_H
 
+#include <array>
 #include <string>
+#include <string_view>
 #include <unordered_map>
+#include <vector>
 
 #include <skia/include/core/SkColor.h>
 #include <skia/include/core/SkFont.h>
+#include <skia/include/core/SkFontStyle.h>
 #include <skia/include/core/SkTypeface.h>
 
-bool CSSColorToSkColor(std::string color, SkColor* out);
+// Parses all the CSS Color 4 syntaxes in a single pass. Colors outside of the
+// sRGB gamut are clamped.
+bool CSSColorToSkColor(std::string_view color, SkColor* out);
+
+// A small cache of parsed colors, for setters like fillStyle that often get
+// the same few strings again, e.g. in a loop.
+//
+// The entries are keyed by the contents of the strings rather than by the
+// identity of the v8 strings, so each lookup still reads and hashes the
+// string; that's much cheaper than parsing it, and also hits for equal
+// strings built at runtime, like template literals.
+class CSSColorCache final {
+ public:
+  static constexpr size_t kSize = 64;
+
+  bool Parse(std::string_view css, SkColor* out);
+
+ private:
+  struct Entry {
+    std::string css;
+    SkColor color = SK_ColorTRANSPARENT;
+    bool valid = false;
+  };
+
+  // Direct mapped by the hash of the string.
+  std::array<Entry, kSize> entries_;
+};
 
 std::string SkColorToCSSColor(SkColor color);
 
+// The CSS font shorthand, like "italic bold 12px/30px Georgia, serif".
+struct CSSFont {
+  SkFontStyle style;
+  // In pixels.
+  float size = 12;
+  // In pixels, or 0 for "normal". Text is drawn in a single line, so this is
+  // parsed but not used yet.
+  float line_height = 0;
+  bool small_caps = false;
+  // The families in order of preference, without quotes.
+  std::vector<std::string> families;
+};
+
+bool ParseCSSFont(std::string_view css, CSSFont* out);
+
+// Returns the typeface for the first family of |font| that is in |fonts|, or
+// installed in the system. Generic families like "serif" and "monospace" are
+// mapped to a system font. The results of the system lookups are stored in
+// |cache|, if given.
+sk_sp<SkTypeface> MatchCSSFontTypeface(
+    const CSSFont& font,
+    const std::unordered_map<std::string, sk_sp<SkTypeface>>& fonts,
+    std::unordered_map<std::string, sk_sp<SkTypeface>>* cache = nullptr);
+
 bool CSSFontToSkFont(
     const std::string& font, SkFont* out,
     const std::unordered_map<std::string, sk_sp<SkTypeface>>& fonts = {},
@@ -0,0 +1,39 @@
+#include "css_legacy.h"
+
+#include <ctype.h>
+#include <string.h>
+
+#include <algorithm>
+#include <regex>
+
+#include "css.h"
+
+bool CSSColorToSkColorWithRegex(std::string color, SkColor* out) {
+  for (auto& c : color) {
+    c = tolower(static_cast<unsigned char>(c));
+  }
+
+  if (strncmp(color.c_str(), "rgb(", 4) != 0 &&
+      strncmp(color.c_str(), "rgba(", 5) != 0) {
+    return CSSColorToSkColor(color, out);
+  }
+
+  static const std::regex re{
+      "rgba?\\( *([0-9]+) *, *([0-9]+) *, *([0-9]+)( *, *(0?.?([0-9]+)?))? "
+      "*\\)"};
+
+  std::smatch m;
+  if (!std::regex_match(color, m, re)) {
+    return false;
+  }
+
+  int r = std::clamp(std::stoi(m[1]), 0, 255);
+  int g = std::clamp(std::stoi(m[2]), 0, 255);
+  int b = std::clamp(std::stoi(m[3]), 0, 255);
+  int a = 255;
+  if (m.size() >= 6 && m[5].length() > 0) {
+    a = std::clamp(static_cast<int>(255 * std::stof(m[5])), 0, 255);
+  }
+  *out = SkColorSetARGB(a, r, g, b);
+  return true;
+}
@@ -0,0 +1,12 @@
+#ifndef WINDOWJS_CSS_LEGACY_H
+#define WINDOWJS_CSS_LEGACY_H
+
+#include <string>
+
+#include <skia/include/core/SkColor.h>
+
+// The previous color parser, based on std::regex. It's kept only to compare
+// it with CSSColorToSkColor() in window.debug.benchmarkColors().
+bool CSSColorToSkColorWithRegex(std::string color, SkColor* out);
+
+#endif  // WINDOWJS_CSS_LEGACY_H
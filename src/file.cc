@@ -30,6 +30,23 @@ bool WriteFile(const std::filesystem::path& path, const void* data, size_t size,
   return true;
 }
 
+bool AppendFile(const std::filesystem::path& path, const std::string& content,
+                std::string* error) {
+  std::ofstream file(path, std::ios::binary | std::ios::app);
+  if (!file.is_open()) {
+    *error = "Failed to open " + path.u8string() +
+             " for writing: " + strerror(errno);
+    return false;
+  }
+  file.write(content.data(), content.size());
+  file.close();
+  if (file.fail()) {
+    *error = "Failed to write to " + path.u8string() + ": " + strerror(errno);
+    return false;
+  }
+  return true;
+}
+
 bool ReadFile(const std::filesystem::path& path, std::string* content,
               std::string* error) {
   std::ifstream file(path, std::ios::binary);
@@ -59,6 +76,24 @@ sk_sp<SkData> ReadFile(const std::filesystem::path& path, std::string* error) {
   return data;
 }
 
+bool ReadFileRange(const std::filesystem::path& path, uint64_t offset,
+                   size_t size, std::string* content, std::string* error) {
+  std::ifstream file(path, std::ios::binary);
+  if (!file) {
+    *error = "Failed to read " + path.u8string() + ": " + strerror(errno);
+    return false;
+  }
+  content->resize(size);
+  file.seekg(offset, std::ios::beg);
+  file.read(content->data(), size);
+  if (file.bad()) {
+    *error = "Failed to read " + path.u8string() + ": read failed";
+    return false;
+  }
+  content->resize(file.gcount());
+  return true;
+}
+
 bool IsDir(const std::filesystem::path& path, std::string* error) {
   std::error_code error_code;
   bool result = std::filesystem::exists(path, error_code);
@@ -178,6 +213,23 @@ std::filesystem::path GetCwd() {
   return result;
 }
 
+std::filesystem::path GetNewFilePath(const std::string& name,
+                                     const std::string& extension) {
+  std::filesystem::path cwd = GetCwd();
+  for (int i = 1; i < 1000; i++) {
+    std::string filename = name;
+    if (i > 1) {
+      filename += "-" + std::to_string(i);
+    }
+    std::filesystem::path path = cwd / (filename + extension);
+    std::string error;
+    if (!IsFile(path, &error) && error.empty()) {
+      return path;
+    }
+  }
+  return {};
+}
+
 std::filesystem::path Dirname(const std::filesystem::path& path) {
   return path.parent_path();
 }
@@ -1,6 +1,8 @@
 #ifndef WINDOWJS_FILE_H
 #define WINDOWJS_FILE_H
 
+#include <stdint.h>
+
 #include <filesystem>
 #include <string>
 #include <vector>
@@ -13,11 +15,20 @@ bool WriteFile(const std::filesystem::path& path, const std::string& content,
 bool WriteFile(const std::filesystem::path& path, const void* data, size_t size,
                std::string* error);
 
+// Appends |content| to the end of |path|, creating it if needed.
+bool AppendFile(const std::filesystem::path& path, const std::string& content,
+                std::string* error);
+
 bool ReadFile(const std::filesystem::path& path, std::string* content,
               std::string* error);
 
 sk_sp<SkData> ReadFile(const std::filesystem::path& path, std::string* error);
 
+// Reads up to |size| bytes of |path| starting at |offset|. |content| is
+// shorter than |size| at the end of the file.
+bool ReadFileRange(const std::filesystem::path& path, uint64_t offset,
+                   size_t size, std::string* content, std::string* error);
+
 bool IsDir(const std::filesystem::path& path, std::string* error);
 bool IsFile(const std::filesystem::path& path, std::string* error);
 
@@ -43,6 +54,12 @@ std::vector<std::filesystem::path> ListTree(const std::filesystem::path& path,
                                             std::string* error);
 
 std::filesystem::path GetCwd();
+
+// Returns the first path in the current directory named |name| + |extension|,
+// |name| + "-2" + |extension|, and so on, that doesn't exist yet. Returns an
+// empty path if there are already too many of them.
+std::filesystem::path GetNewFilePath(const std::string& name,
+                                     const std::string& extension);
 std::string GetExePath(std::string* error);
 std::string GetUserHomePath(std::string* error);
 std::string GetTmpDir(std::string* error);
@@ -0,0 +1,81 @@
+#include "font_cache.h"
+
+#include <algorithm>
+
+#include <skia/include/core/SkPaint.h>
+
+#include "fail.h"
+
+FontCache::FontCache() : generation_(1) {}
+
+std::shared_ptr<FontCache::Font> FontCache::Get(std::string_view css) {
+  key_.assign(css);
+  auto it = fonts_.find(key_);
+  if (it != fonts_.end()) {
+    return it->second;
+  }
+
+  auto font = std::make_shared<Font>();
+  if (!ParseCSSFont(css, &font->css_)) {
+    return nullptr;
+  }
+  if (fonts_.size() >= kMaxFonts) {
+    fonts_.clear();
+  }
+  fonts_.emplace(key_, font);
+  return font;
+}
+
+const SkFont& FontCache::Resolve(Font* font) {
+  ASSERT(font);
+  if (font->generation_ != generation_) {
+    sk_sp<SkTypeface> typeface =
+        MatchCSSFontTypeface(font->css_, loaded_fonts_, &typefaces_);
+    font->font_ = SkFont(std::move(typeface), font->css_.size);
+    font->generation_ = generation_;
+    font->metrics_.clear();
+  }
+  return font->font_;
+}
+
+const FontCache::TextMetrics& FontCache::Measure(Font* font,
+                                                 std::string_view text,
+                                                 const SkPaint* paint) {
+  const SkFont& sk_font = Resolve(font);
+  key_.assign(text);
+  auto it = font->metrics_.find(key_);
+  if (it != font->metrics_.end()) {
+    return it->second;
+  }
+
+  ASSERT(!paint || (paint->getStyle() == SkPaint::kFill_Style &&
+                    !paint->getPathEffect()));
+  TextMetrics metrics;
+  metrics.bounds = SkRect::MakeEmpty();
+  metrics.width = sk_font.measureText(text.data(), text.size(),
+                                      SkTextEncoding::kUTF8, &metrics.bounds,
+                                      paint);
+  if (font->metrics_.size() >= kMaxTextMetrics) {
+    font->metrics_.clear();
+  }
+  return font->metrics_.emplace(key_, metrics).first->second;
+}
+
+void FontCache::AddFont(std::string family, sk_sp<SkTypeface> typeface) {
+  loaded_fonts_[std::move(family)] = std::move(typeface);
+  generation_++;
+}
+
+std::vector<SkGlyphID> GetUniqueGlyphs(const SkFont& font,
+                                       std::string_view text) {
+  int count = font.countText(text.data(), text.size(), SkTextEncoding::kUTF8);
+  if (count <= 0) {
+    return {};
+  }
+  std::vector<SkGlyphID> glyphs(count);
+  font.textToGlyphs(text.data(), text.size(), SkTextEncoding::kUTF8,
+                    glyphs.data(), count);
+  std::sort(glyphs.begin(), glyphs.end());
+  glyphs.erase(std::unique(glyphs.begin(), glyphs.end()), glyphs.end());
+  return glyphs;
+}
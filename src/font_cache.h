@@ -0,0 +1,91 @@
+#ifndef WINDOWJS_FONT_CACHE_H
+#define WINDOWJS_FONT_CACHE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include <skia/include/core/SkFont.h>
+#include <skia/include/core/SkRect.h>
+#include <skia/include/core/SkRefCnt.h>
+#include <skia/include/core/SkTypeface.h>
+
+#include "css.h"
+
+// Caches the fonts assigned to ctx.font by their exact CSS string, so that
+// setting the same font again doesn't parse it again. The typeface of each
+// font is resolved when it's first used to draw or measure text, since the
+// system font lookups are slow and many fonts are set without drawing any
+// text with them.
+class FontCache final {
+ public:
+  // The cache is cleared when it grows over this size. Fonts that are still
+  // in use stay valid.
+  static constexpr size_t kMaxFonts = 256;
+  // Same for the text measured with each font.
+  static constexpr size_t kMaxTextMetrics = 1024;
+
+  struct TextMetrics {
+    float width;
+    SkRect bounds;
+  };
+
+  class Font final {
+   public:
+    const CSSFont& css() const { return css_; }
+
+   private:
+    friend class FontCache;
+
+    CSSFont css_;
+    SkFont font_;
+    // The generation of the FontCache when font_ was resolved.
+    uint32_t generation_ = 0;
+    // Cleared when font_ is resolved again.
+    std::unordered_map<std::string, TextMetrics> metrics_;
+  };
+
+  FontCache();
+
+  FontCache(const FontCache&) = delete;
+  FontCache& operator=(const FontCache&) = delete;
+
+  // Returns the font for |css|, or null if |css| isn't a valid CSS font.
+  std::shared_ptr<Font> Get(std::string_view css);
+
+  // Returns the SkFont for |font|, resolving its typeface if needed.
+  const SkFont& Resolve(Font* font);
+
+  // Returns the advance and bounds of the UTF-8 |text| with |font|, like
+  // SkFont::measureText. The results are cached per font, so |paint| must
+  // not change the bounds: it can't have a stroke or a path effect.
+  const TextMetrics& Measure(Font* font, std::string_view text,
+                             const SkPaint* paint);
+
+  // Fonts loaded with window.loadFont() are matched by their family name,
+  // before the system fonts. Adding a font resolves all the fonts again on
+  // their next use.
+  void AddFont(std::string family, sk_sp<SkTypeface> typeface);
+
+ private:
+  // The maps are keyed by std::string, so lookups copy the key here first.
+  // Its capacity is reused, so that hits don't allocate.
+  std::string key_;
+  std::unordered_map<std::string, std::shared_ptr<Font>> fonts_;
+  std::unordered_map<std::string, sk_sp<SkTypeface>> loaded_fonts_;
+  // The system typefaces, by family and style.
+  std::unordered_map<std::string, sk_sp<SkTypeface>> typefaces_;
+  uint32_t generation_;
+};
+
+// Returns the glyphs of |font| for the UTF-8 |text|, sorted and without
+// duplicates. Characters without a glyph in |font| map to glyph 0.
+std::vector<SkGlyphID> GetUniqueGlyphs(const SkFont& font,
+                                       std::string_view text);
+
+#endif  // WINDOWJS_FONT_CACHE_H
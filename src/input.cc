@@ -0,0 +1,71 @@
+#include "input.h"
+
+#include <string.h>
+
+namespace {
+
+void SetBit(uint8_t* bitset, int index) {
+  bitset[index >> 3] |= 1 << (index & 7);
+}
+
+}  // namespace
+
+InputState::InputState() {
+  memset(keys_, 0, sizeof(keys_));
+  memset(pressed_, 0, sizeof(pressed_));
+  memset(released_, 0, sizeof(released_));
+  for (int i = 0; i < POINTER_SIZE; i++) {
+    pointer_[i] = 0;
+  }
+}
+
+void InputState::OnKey(int key, int action) {
+  if (key < 0 || key >= (int) kKeysSize) {
+    return;
+  }
+  if (action == GLFW_PRESS) {
+    keys_[key] = 1;
+    SetBit(pressed_, key);
+  } else if (action == GLFW_RELEASE) {
+    keys_[key] = 0;
+    SetBit(released_, key);
+  }
+}
+
+void InputState::OnMouseMove(double x, double y) {
+  pointer_[POINTER_X] = x;
+  pointer_[POINTER_Y] = y;
+}
+
+void InputState::OnMouseButton(int button, bool pressed) {
+  if (button < 0 || button > GLFW_MOUSE_BUTTON_LAST) {
+    return;
+  }
+  // GLFW's left, right and middle buttons map to the same bits as in
+  // MouseEvent.buttons.
+  int bit = 1 << button;
+  int buttons = (int) pointer_[POINTER_BUTTONS];
+  if (pressed) {
+    pointer_[POINTER_BUTTONS] = buttons | bit;
+    pointer_[POINTER_BUTTONS_PRESSED] =
+        (int) pointer_[POINTER_BUTTONS_PRESSED] | bit;
+  } else {
+    pointer_[POINTER_BUTTONS] = buttons & ~bit;
+    pointer_[POINTER_BUTTONS_RELEASED] =
+        (int) pointer_[POINTER_BUTTONS_RELEASED] | bit;
+  }
+}
+
+void InputState::OnMouseWheel(double x, double y) {
+  pointer_[POINTER_WHEEL_X] += x;
+  pointer_[POINTER_WHEEL_Y] += y;
+}
+
+void InputState::EndFrame() {
+  memset(pressed_, 0, sizeof(pressed_));
+  memset(released_, 0, sizeof(released_));
+  pointer_[POINTER_BUTTONS_PRESSED] = 0;
+  pointer_[POINTER_BUTTONS_RELEASED] = 0;
+  pointer_[POINTER_WHEEL_X] = 0;
+  pointer_[POINTER_WHEEL_Y] = 0;
+}
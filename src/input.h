@@ -0,0 +1,59 @@
+#ifndef WINDOWJS_INPUT_H
+#define WINDOWJS_INPUT_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <GLFW/glfw3.h>
+
+// The current state of the keyboard and mouse. This is updated directly from
+// the GLFW callbacks in Window, and its buffers back the typed arrays in
+// window.input, so that Javascript can poll the input state without
+// dispatching any events.
+class InputState final {
+ public:
+  // keys() has one entry per GLFW key code, which is 1 while that key is down.
+  static constexpr size_t kKeysSize = GLFW_KEY_LAST + 1;
+
+  // pressed() and released() are bitsets with one bit per GLFW key code.
+  static constexpr size_t kKeyBitsetSize = (kKeysSize + 7) / 8;
+
+  // Indices into pointer().
+  enum Pointer {
+    POINTER_X,
+    POINTER_Y,
+    // Bitmask of the mouse buttons that are down, like MouseEvent.buttons.
+    POINTER_BUTTONS,
+    // Bitmasks of the buttons that went down or up since the last frame.
+    POINTER_BUTTONS_PRESSED,
+    POINTER_BUTTONS_RELEASED,
+    // Wheel deltas accumulated since the last frame.
+    POINTER_WHEEL_X,
+    POINTER_WHEEL_Y,
+    POINTER_SIZE,
+  };
+
+  InputState();
+
+  uint8_t* keys() { return keys_; }
+  uint8_t* pressed() { return pressed_; }
+  uint8_t* released() { return released_; }
+  double* pointer() { return pointer_; }
+
+  void OnKey(int key, int action);
+  void OnMouseMove(double x, double y);
+  void OnMouseButton(int button, bool pressed);
+  void OnMouseWheel(double x, double y);
+
+  // Clears the state that only lasts for one frame: the pressed and released
+  // bitsets, and the wheel accumulators.
+  void EndFrame();
+
+ private:
+  uint8_t keys_[kKeysSize];
+  uint8_t pressed_[kKeyBitsetSize];
+  uint8_t released_[kKeyBitsetSize];
+  double pointer_[POINTER_SIZE];
+};
+
+#endif  // WINDOWJS_INPUT_H
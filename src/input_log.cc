@@ -0,0 +1,182 @@
+#include "input_log.h"
+
+#include <string.h>
+
+#include <utility>
+
+#include "console.h"
+#include "fail.h"
+#include "file.h"
+
+namespace {
+
+constexpr char kMagic[] = "WJSINPUT";
+constexpr uint32_t kVersion = 1;
+
+class Reader {
+ public:
+  explicit Reader(const std::string& data)
+      : data_(data), offset_(0), failed_(false) {}
+
+  bool failed() const { return failed_; }
+  bool done() const { return offset_ >= data_.size(); }
+
+  template <typename T>
+  T Read() {
+    T value{};
+    if (offset_ + sizeof(T) > data_.size()) {
+      failed_ = true;
+      offset_ = data_.size();
+      return value;
+    }
+    memcpy(&value, data_.data() + offset_, sizeof(T));
+    offset_ += sizeof(T);
+    return value;
+  }
+
+ private:
+  const std::string& data_;
+  size_t offset_;
+  bool failed_;
+};
+
+}  // namespace
+
+InputRecorder::InputRecorder(std::filesystem::path path)
+    : path_(std::move(path)), last_frame_(0) {
+  buffer_.append(kMagic, sizeof(kMagic) - 1);
+  Append(kVersion);
+}
+
+InputRecorder::~InputRecorder() {
+  RecordedInput end;
+  end.type = RecordedInput::END;
+  end.frame = last_frame_;
+  Record(end);
+
+  std::string error;
+  if (!WriteFile(path_, buffer_, &error)) {
+    $(ERROR) << "Failed to write the input recording to " << path_ << ": "
+             << error;
+  }
+}
+
+template <typename T>
+void InputRecorder::Append(T value) {
+  buffer_.append(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+void InputRecorder::Record(const RecordedInput& input) {
+  Append(input.type);
+  Append(input.frame);
+  Append(input.timestamp);
+
+  switch (input.type) {
+    case RecordedInput::KEY:
+      Append(input.key);
+      Append(input.scancode);
+      Append(input.action);
+      Append(input.mods);
+      break;
+    case RecordedInput::CHARACTER:
+      Append(input.key);
+      break;
+    case RecordedInput::MOUSE_MOVE:
+    case RecordedInput::MOUSE_WHEEL:
+      Append(input.x);
+      Append(input.y);
+      break;
+    case RecordedInput::MOUSE_BUTTON:
+      Append(input.key);
+      Append(input.action);
+      Append(input.x);
+      Append(input.y);
+      break;
+    case RecordedInput::MOUSE_ENTER:
+      Append(input.action);
+      break;
+    case RecordedInput::END:
+      break;
+  }
+}
+
+InputReplayer::InputReplayer(const std::filesystem::path& path) : next_(0) {
+  std::string data;
+  std::string error;
+  if (!ReadFile(path, &data, &error)) {
+    ErrorQuit("Failed to read the input recording %s: %s\n",
+              path.string().c_str(), error.c_str());
+  }
+
+  constexpr size_t kMagicSize = sizeof(kMagic) - 1;
+  if (data.size() < kMagicSize || data.compare(0, kMagicSize, kMagic) != 0) {
+    ErrorQuit("Not an input recording: %s\n", path.string().c_str());
+  }
+
+  Reader reader(data);
+  for (size_t i = 0; i < kMagicSize; i++) {
+    reader.Read<char>();
+  }
+  if (reader.Read<uint32_t>() != kVersion) {
+    ErrorQuit("Unsupported input recording version: %s\n",
+              path.string().c_str());
+  }
+
+  while (!reader.done()) {
+    RecordedInput input;
+    input.type = reader.Read<RecordedInput::Type>();
+    input.frame = reader.Read<uint32_t>();
+    input.timestamp = reader.Read<double>();
+
+    switch (input.type) {
+      case RecordedInput::KEY:
+        input.key = reader.Read<int32_t>();
+        input.scancode = reader.Read<int32_t>();
+        input.action = reader.Read<int32_t>();
+        input.mods = reader.Read<int32_t>();
+        break;
+      case RecordedInput::CHARACTER:
+        input.key = reader.Read<int32_t>();
+        break;
+      case RecordedInput::MOUSE_MOVE:
+      case RecordedInput::MOUSE_WHEEL:
+        input.x = reader.Read<double>();
+        input.y = reader.Read<double>();
+        break;
+      case RecordedInput::MOUSE_BUTTON:
+        input.key = reader.Read<int32_t>();
+        input.action = reader.Read<int32_t>();
+        input.x = reader.Read<double>();
+        input.y = reader.Read<double>();
+        break;
+      case RecordedInput::MOUSE_ENTER:
+        input.action = reader.Read<int32_t>();
+        break;
+      case RecordedInput::END:
+        break;
+      default:
+        ErrorQuit("Corrupted input recording: %s\n", path.string().c_str());
+    }
+
+    if (reader.failed()) {
+      ErrorQuit("Truncated input recording: %s\n", path.string().c_str());
+    }
+
+    inputs_.push_back(input);
+
+    if (input.type == RecordedInput::END) {
+      break;
+    }
+  }
+
+  if (inputs_.empty() || inputs_.back().type != RecordedInput::END) {
+    ErrorQuit("Truncated input recording: %s\n", path.string().c_str());
+  }
+}
+
+const RecordedInput* InputReplayer::Next(uint32_t frame) {
+  if (finished() || inputs_[next_].frame > frame) {
+    return nullptr;
+  }
+  return &inputs_[next_++];
+}
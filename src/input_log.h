@@ -0,0 +1,88 @@
+#ifndef WINDOWJS_INPUT_LOG_H
+#define WINDOWJS_INPUT_LOG_H
+
+#include <stdint.h>
+
+#include <filesystem>
+#include <string>
+#include <vector>
+
+// An input received by the main window, as stored by --record-input.
+struct RecordedInput {
+  enum Type : uint8_t {
+    KEY,
+    CHARACTER,
+    MOUSE_MOVE,
+    MOUSE_BUTTON,
+    MOUSE_WHEEL,
+    MOUSE_ENTER,
+    // The last entry of a log, marking the frame when the recording ended.
+    END,
+  };
+
+  Type type = END;
+
+  // The main loop iteration that received this input.
+  uint32_t frame = 0;
+
+  // When the input was received, from GetClockTime().
+  double timestamp = 0;
+
+  // KEY: the GLFW key, scancode, action and mods.
+  // CHARACTER: the codepoint is in |key|.
+  // MOUSE_BUTTON: the GLFW button is in |key|, and |action| is 1 if pressed.
+  // MOUSE_ENTER: |action| is 1 if entered.
+  int32_t key = 0;
+  int32_t scancode = 0;
+  int32_t action = 0;
+  int32_t mods = 0;
+
+  // MOUSE_MOVE and MOUSE_BUTTON: the position in pixels.
+  // MOUSE_WHEEL: the deltas.
+  double x = 0;
+  double y = 0;
+};
+
+// Writes RecordedInputs to a compact binary log. Each input only stores the
+// fields that are used by its type.
+class InputRecorder final {
+ public:
+  explicit InputRecorder(std::filesystem::path path);
+  // Writes the log to |path|, after recording an END input.
+  ~InputRecorder();
+
+  void Record(const RecordedInput& input);
+
+  // The frame of the END input written at the end of the log.
+  void SetLastFrame(uint32_t frame) { last_frame_ = frame; }
+
+ private:
+  template <typename T>
+  void Append(T value);
+
+  std::filesystem::path path_;
+  std::string buffer_;
+  uint32_t last_frame_;
+};
+
+// Reads a log written by InputRecorder. Exits with an error if the log can't
+// be read.
+class InputReplayer final {
+ public:
+  explicit InputReplayer(const std::filesystem::path& path);
+
+  size_t size() const { return inputs_.size(); }
+
+  // Whether all the inputs up to the END have been replayed.
+  bool finished() const { return next_ >= inputs_.size(); }
+
+  // Returns the next input recorded at or before |frame|, or null if there
+  // are none.
+  const RecordedInput* Next(uint32_t frame);
+
+ private:
+  std::vector<RecordedInput> inputs_;
+  size_t next_;
+};
+
+#endif  // WINDOWJS_INPUT_LOG_H
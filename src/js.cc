@@ -2,7 +2,6 @@
 
 #include <sstream>
 
-#include <GLFW/glfw3.h>
 #include <v8/include/libplatform/libplatform.h>
 
 #if defined(__clang__)
@@ -17,6 +16,7 @@
 #endif
 
 #include "args.h"
+#include "clock.h"
 #include "file.h"
 #include "js_scope.h"
 #include "json.h"
@@ -105,7 +105,7 @@ Js::Js(Delegate* delegate, std::filesystem::path base_path,
       task_queue_(task_queue),
       suppress_next_script_result_(false) {
   if (Args().profile_startup) {
-    $(DEV) << "[profile-startup] create JS context start: " << glfwGetTime();
+    $(DEV) << "[profile-startup] create JS context start: " << GetClockTime();
   }
 
   allocator_ = v8::ArrayBuffer::Allocator::NewDefaultAllocator();
@@ -132,10 +132,13 @@ Js::Js(Delegate* delegate, std::filesystem::path base_path,
   v8::HandleScope handle_scope(isolate_);
   context_.Reset(isolate_, v8::Context::New(isolate_));
 
-  strings_ = std::make_unique<JsStrings>(isolate_);
+  const double strings_start = GetClockTime();
+  strings_ = std::make_unique<JsStrings>();
 
   if (Args().profile_startup) {
-    $(DEV) << "[profile-startup] create JS context end: " << glfwGetTime();
+    $(DEV) << "[profile-startup] string table: "
+           << (GetClockTime() - strings_start) * 1000 << " ms";
+    $(DEV) << "[profile-startup] create JS context end: " << GetClockTime();
   }
 }
 
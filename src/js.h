@@ -1,7 +1,10 @@
 #ifndef WINDOWJS_JS_H
 #define WINDOWJS_JS_H
 
+#include <stddef.h>
+
 #include <filesystem>
+#include <initializer_list>
 #include <memory>
 #include <string>
 #include <string_view>
@@ -65,6 +68,19 @@ class Js final {
   v8::Local<v8::String> GetConstantString(StringId id) const {
     return strings_->GetConstantString(id, isolate_);
   }
+  // See JsStrings::Match().
+  StringId MatchConstantString(v8::Local<v8::Value> value,
+                               std::initializer_list<StringId> ids) {
+    return strings_->Match(value, ids, isolate_);
+  }
+  template <typename Entry, size_t N>
+  const Entry* MatchConstantString(v8::Local<v8::Value> value,
+                                   const Entry (&entries)[N]) {
+    return strings_->Match(value, entries, isolate_);
+  }
+
+  // Arguments that are only needed during a call can use JsStringView
+  // instead, which doesn't allocate for short strings.
   std::string ToString(v8::Local<v8::Value> value);
   std::string ToStringOr(v8::Local<v8::Value> value,
                          std::string_view or_string);
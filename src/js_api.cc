@@ -1,19 +1,32 @@
 #include "js_api.h"
 
 #include <stdlib.h>
+#include <string.h>
+
+#include <algorithm>
+#include <atomic>
+#include <iterator>
+#include <memory>
 
 #include <skia/include/core/SkFont.h>
 #include <skia/include/core/SkFontMgr.h>
+#include <skia/include/core/SkGraphics.h>
 #include <skia/include/core/SkTypeface.h>
 
+#include "api_counters.h"
 #include "args.h"
+#include "clock.h"
 #include "console.h"
 #include "css.h"
+#include "css_legacy.h"
 #include "file.h"
 #include "js_api_canvas.h"
 #include "js_api_codec.h"
 #include "js_api_file.h"
 #include "js_api_process.h"
+#include "json.h"
+#include "json_legacy.h"
+#include "log_formatter.h"
 #include "platform.h"
 #include "version.h"
 
@@ -27,7 +40,346 @@
 namespace {
 
 void Now(const v8::FunctionCallbackInfo<v8::Value>& args) {
-  args.GetReturnValue().Set(glfwGetTime() * 1000);
+  args.GetReturnValue().Set(GetClockTime() * 1000);
+}
+
+v8::Local<v8::Object> MakeLatency(const LatencySamples& samples,
+                                  const JsScope& scope) {
+  v8::Local<v8::Object> latency = v8::Object::New(scope.isolate);
+  scope.Set(latency, StringId::count, (double) samples.count());
+  scope.Set(latency, StringId::p50, samples.Percentile(50) * 1000);
+  scope.Set(latency, StringId::p90, samples.Percentile(90) * 1000);
+  scope.Set(latency, StringId::p99, samples.Percentile(99) * 1000);
+  scope.Set(latency, StringId::max, samples.max() * 1000);
+  return latency;
+}
+
+void GetInputLatency(const v8::FunctionCallbackInfo<v8::Value>& args) {
+  JsApi* api = JsApi::Get(args.GetIsolate());
+  JsScope scope(api->js());
+  Stats* stats = api->window()->stats();
+  v8::Local<v8::Object> result = v8::Object::New(scope.isolate);
+  scope.SetValue(result, StringId::dispatch,
+                 MakeLatency(stats->input_to_dispatch(), scope));
+  scope.SetValue(result, StringId::swap,
+                 MakeLatency(stats->input_to_swap(), scope));
+  args.GetReturnValue().Set(result);
+}
+
+v8::Local<v8::Float64Array> MakeFloat64Array(v8::Isolate* isolate,
+                                             const double* data, size_t size) {
+  v8::Local<v8::ArrayBuffer> buffer =
+      v8::ArrayBuffer::New(isolate, size * sizeof(double));
+  memcpy(buffer->GetBackingStore()->Data(), data, size * sizeof(double));
+  return v8::Float64Array::New(buffer, 0, size);
+}
+
+v8::Local<v8::Uint32Array> MakeUint32Array(v8::Isolate* isolate,
+                                           const uint32_t* data, size_t size) {
+  v8::Local<v8::ArrayBuffer> buffer =
+      v8::ArrayBuffer::New(isolate, size * sizeof(uint32_t));
+  memcpy(buffer->GetBackingStore()->Data(), data, size * sizeof(uint32_t));
+  return v8::Uint32Array::New(buffer, 0, size);
+}
+
+void GetFrameStats(const v8::FunctionCallbackInfo<v8::Value>& args) {
+  JsApi* api = JsApi::Get(args.GetIsolate());
+  JsScope scope(api->js());
+  Stats* stats = api->window()->stats();
+
+  static constexpr StringId phases[] = {
+      StringId::wait, StringId::gc,   StringId::js,
+      StringId::raf,  StringId::swap, StringId::total,
+  };
+  static_assert(std::size(phases) == Stats::PHASE_COUNT);
+
+  v8::Local<v8::Object> result = v8::Object::New(scope.isolate);
+  scope.Set(result, StringId::frames, (double) stats->frames());
+  scope.Set(result, StringId::refreshInterval, stats->refresh_interval());
+  scope.SetValue(result, StringId::jank,
+                 MakeUint32Array(scope.isolate, stats->jank(),
+                                 Stats::kJankCounters));
+
+  std::vector<double> frames(stats->frame_history_size());
+  v8::Local<v8::Object> history = v8::Object::New(scope.isolate);
+  v8::Local<v8::Object> histograms = v8::Object::New(scope.isolate);
+  for (int i = 0; i < Stats::PHASE_COUNT; i++) {
+    Stats::Phase phase = static_cast<Stats::Phase>(i);
+    stats->CopyFrameHistory(phase, frames.data());
+    scope.SetValue(history, phases[i],
+                   MakeFloat64Array(scope.isolate, frames.data(),
+                                    frames.size()));
+    scope.SetValue(histograms, phases[i],
+                   MakeUint32Array(scope.isolate,
+                                   stats->histogram(phase).counts(),
+                                   DurationHistogram::kBuckets));
+  }
+  scope.SetValue(result, StringId::history, history);
+  scope.SetValue(result, StringId::histograms, histograms);
+
+  double bounds[DurationHistogram::kBuckets];
+  for (size_t i = 0; i < DurationHistogram::kBuckets; i++) {
+    bounds[i] = DurationHistogram::BucketLowerBound(i);
+  }
+  scope.SetValue(result, StringId::histogramBounds,
+                 MakeFloat64Array(scope.isolate, bounds,
+                                  DurationHistogram::kBuckets));
+
+  const LongTasks* long_tasks = stats->long_tasks();
+  v8::Local<v8::Object> tasks = v8::Object::New(scope.isolate);
+  scope.Set(tasks, StringId::count, (double) long_tasks->count());
+  scope.Set(tasks, StringId::duration, long_tasks->total_duration() * 1000);
+  scope.Set(tasks, StringId::maxDuration, long_tasks->max_duration() * 1000);
+  scope.SetValue(result, StringId::longTasks, tasks);
+
+  v8::Local<v8::Object> glyphs = v8::Object::New(scope.isolate);
+  scope.Set(glyphs, StringId::used, (double) SkGraphics::GetFontCacheUsed());
+  scope.Set(glyphs, StringId::limit, (double) SkGraphics::GetFontCacheLimit());
+  scope.Set(glyphs, StringId::count,
+            (double) SkGraphics::GetFontCacheCountUsed());
+  scope.SetValue(result, StringId::glyphCache, glyphs);
+
+  args.GetReturnValue().Set(result);
+}
+
+void ResetFrameStats(const v8::FunctionCallbackInfo<v8::Value>& args) {
+  JsApi* api = JsApi::Get(args.GetIsolate());
+  api->window()->stats()->ResetFrameStats();
+}
+
+UserTiming* GetUserTiming(JsApi* api) {
+  return api->window()->stats()->user_timing();
+}
+
+// Returns the time of the most recent mark named |value|, or throws and
+// returns a negative number if there is no such mark.
+double GetMarkTimeOrThrow(JsApi* api, v8::Local<v8::Value> value) {
+  if (!value->IsString()) {
+    api->js()->ThrowInvalidArgument();
+    return -1;
+  }
+  std::string name = api->js()->ToString(value);
+  UserTiming* timing = GetUserTiming(api);
+  uint32_t id;
+  double time = timing->FindName(name, &id) ? timing->GetMarkTime(id) : -1;
+  if (time < 0) {
+    api->js()->ThrowError("No mark named " + name);
+  }
+  return time;
+}
+
+void Mark(const v8::FunctionCallbackInfo<v8::Value>& args) {
+  JsApi* api = JsApi::Get(args.GetIsolate());
+  if (args.Length() < 1 || !args[0]->IsString()) {
+    api->js()->ThrowInvalidArgument();
+    return;
+  }
+  UserTiming* timing = GetUserTiming(api);
+  timing->Mark(timing->InternName(api->js()->ToString(args[0])),
+               GetClockTime());
+}
+
+void Measure(const v8::FunctionCallbackInfo<v8::Value>& args) {
+  JsApi* api = JsApi::Get(args.GetIsolate());
+  double end = GetClockTime();
+  if (args.Length() < 1 || !args[0]->IsString()) {
+    api->js()->ThrowInvalidArgument();
+    return;
+  }
+
+  // Measures from the start of the process by default, until now.
+  double start = 0;
+  if (args.Length() >= 2 && !args[1]->IsUndefined()) {
+    start = GetMarkTimeOrThrow(api, args[1]);
+    if (start < 0) {
+      return;
+    }
+  }
+  if (args.Length() >= 3 && !args[2]->IsUndefined()) {
+    end = GetMarkTimeOrThrow(api, args[2]);
+    if (end < 0) {
+      return;
+    }
+  }
+
+  UserTiming* timing = GetUserTiming(api);
+  timing->Measure(timing->InternName(api->js()->ToString(args[0])), start,
+                  end);
+}
+
+void GetEntriesByName(const v8::FunctionCallbackInfo<v8::Value>& args) {
+  JsApi* api = JsApi::Get(args.GetIsolate());
+  if (args.Length() < 1 || !args[0]->IsString()) {
+    api->js()->ThrowInvalidArgument();
+    return;
+  }
+
+  bool marks = true;
+  bool measures = true;
+  if (args.Length() >= 2 && !args[1]->IsUndefined()) {
+    std::string type = api->js()->ToString(args[1]);
+    marks = type == "mark";
+    measures = type == "measure";
+  }
+
+  JsScope scope(api->js());
+  UserTiming* timing = GetUserTiming(api);
+  v8::Local<v8::Array> entries = v8::Array::New(scope.isolate);
+  uint32_t name;
+  if (!timing->FindName(api->js()->ToString(args[0]), &name)) {
+    args.GetReturnValue().Set(entries);
+    return;
+  }
+  uint32_t index = 0;
+
+  timing->ForEach([&](const UserTiming::Entry& entry) {
+    bool is_mark = entry.type == UserTiming::MARK;
+    if (entry.name != name || (is_mark && !marks) || (!is_mark && !measures)) {
+      return;
+    }
+    v8::Local<v8::Object> object = v8::Object::New(scope.isolate);
+    scope.SetValue(object, StringId::name, args[0]);
+    scope.Set(object, StringId::entryType,
+              is_mark ? StringId::mark : StringId::measure);
+    scope.Set(object, StringId::startTime, entry.start * 1000);
+    scope.Set(object, StringId::duration, entry.duration * 1000);
+    IGNORE_RESULT(entries->Set(scope.context, index++, object));
+  });
+
+  args.GetReturnValue().Set(entries);
+}
+
+void ClearEntries(const v8::FunctionCallbackInfo<v8::Value>& args,
+                  UserTiming::Type type) {
+  JsApi* api = JsApi::Get(args.GetIsolate());
+  UserTiming* timing = GetUserTiming(api);
+  if (args.Length() < 1 || args[0]->IsUndefined()) {
+    timing->Clear(type);
+  } else if (args[0]->IsString()) {
+    uint32_t name;
+    if (timing->FindName(api->js()->ToString(args[0]), &name)) {
+      timing->Clear(type, name);
+    }
+  } else {
+    api->js()->ThrowInvalidArgument();
+  }
+}
+
+void ClearMarks(const v8::FunctionCallbackInfo<v8::Value>& args) {
+  ClearEntries(args, UserTiming::MARK);
+}
+
+void ClearMeasures(const v8::FunctionCallbackInfo<v8::Value>& args) {
+  ClearEntries(args, UserTiming::MEASURE);
+}
+
+v8::Local<v8::Object> MakeApiCounters(
+    const std::vector<ApiCounters::Call>& calls, const uint64_t* native,
+    const JsScope& scope) {
+  v8::Local<v8::Object> apis[ApiCounters::API_COUNT] = {
+      v8::Object::New(scope.isolate),
+      v8::Object::New(scope.isolate),
+  };
+  for (const ApiCounters::Call& call : calls) {
+    scope.Set(apis[call.api], call.method, (double) call.count);
+  }
+
+  v8::Local<v8::Object> natives = v8::Object::New(scope.isolate);
+  for (int i = 0; i < ApiCounters::NATIVE_COUNT; i++) {
+    ApiCounters::Native counter = static_cast<ApiCounters::Native>(i);
+    scope.Set(natives, ApiCounters::GetNativeName(counter),
+              (double) native[counter]);
+  }
+
+  v8::Local<v8::Object> result = v8::Object::New(scope.isolate);
+  scope.SetValue(result, StringId::canvas, apis[ApiCounters::CANVAS]);
+  scope.SetValue(result, StringId::file, apis[ApiCounters::FILE]);
+  scope.SetValue(result, StringId::native, natives);
+  return result;
+}
+
+void GetApiCounters(const v8::FunctionCallbackInfo<v8::Value>& args) {
+  JsApi* api = JsApi::Get(args.GetIsolate());
+  JsScope scope(api->js());
+  const ApiCounters* counters = ApiCounters::Get();
+  v8::Local<v8::Object> result = v8::Object::New(scope.isolate);
+  scope.Set(result, StringId::frames, (double) counters->frames());
+  scope.SetValue(result, StringId::frame,
+                 MakeApiCounters(counters->last_frame(),
+                                 counters->last_frame_native(), scope));
+  scope.SetValue(result, StringId::total,
+                 MakeApiCounters(counters->GetTotals(),
+                                 counters->total_native(), scope));
+  args.GetReturnValue().Set(result);
+}
+
+void StartProfiling(const v8::FunctionCallbackInfo<v8::Value>& args) {
+  JsApi* api = JsApi::Get(args.GetIsolate());
+  if (args.Length() < 1 || !args[0]->IsString()) {
+    api->js()->ThrowInvalidArgument();
+    return;
+  }
+
+  int sample_interval_us = CpuProfiler::kDefaultSampleIntervalUs;
+  if (args.Length() >= 2 && !args[1]->IsUndefined()) {
+    if (!args[1]->IsObject()) {
+      api->js()->ThrowInvalidArgument();
+      return;
+    }
+    JsScope scope(api->js());
+    v8::Local<v8::Value> value;
+    if (!args[1]
+             .As<v8::Object>()
+             ->Get(scope.context,
+                   scope.GetConstantString(StringId::sampleIntervalUs))
+             .ToLocal(&value)) {
+      return;
+    }
+    if (!value->IsUndefined()) {
+      // Also rejects NaN, and values that don't fit in an int.
+      double interval = value->IsNumber() ? value.As<v8::Number>()->Value() : 0;
+      if (!(interval >= 1 && interval <= CpuProfiler::kMaxSampleIntervalUs)) {
+        api->js()->ThrowError(
+            "sampleIntervalUs must be a number between 1 and " +
+            std::to_string(CpuProfiler::kMaxSampleIntervalUs) + ".");
+        return;
+      }
+      sample_interval_us = static_cast<int>(interval);
+    }
+  }
+
+  std::string name = api->js()->ToString(args[0]);
+  if (!api->cpu_profiler()->Start(name, sample_interval_us)) {
+    api->js()->ThrowError("Profile \"" + name + "\" is already running.");
+  }
+}
+
+void StopProfiling(const v8::FunctionCallbackInfo<v8::Value>& args) {
+  JsApi* api = JsApi::Get(args.GetIsolate());
+  if (args.Length() < 2 || !args[0]->IsString() || !args[1]->IsString()) {
+    api->js()->ThrowInvalidArgument();
+    return;
+  }
+
+  std::string name = api->js()->ToString(args[0]);
+  std::string path = api->js()->ToString(args[1]);
+  std::shared_ptr<CpuProfileData> profile = api->cpu_profiler()->Stop(name);
+  if (!profile) {
+    api->js()->ThrowError("Profile \"" + name + "\" is not running.");
+    return;
+  }
+
+  // The profile was copied out of v8, so serializing it and writing it to disk
+  // can happen in the background.
+  args.GetReturnValue().Set(api->PostToBackgroundAndResolve(
+      [profile, path = std::move(path)]() -> JsApi::ResolveFunction {
+        std::string error;
+        if (!WriteFile(path, profile->ToJson(), &error)) {
+          return JsApi::Reject("Failed to write profile to " + path + ": " +
+                               error);
+        }
+        return JsApi::Resolve();
+      }));
 }
 
 void JsHeapSizeLimit(v8::Local<v8::Name> property,
@@ -51,12 +403,59 @@ void UsedJsHeapSize(v8::Local<v8::Name> property,
   info.GetReturnValue().Set((double) stats.used_heap_size());
 }
 
+// The memory is owned by the Window, which outlives the JsApi.
+v8::Local<v8::ArrayBuffer> WrapInputBuffer(v8::Isolate* isolate, void* data,
+                                           size_t size) {
+  std::unique_ptr<v8::BackingStore> store = v8::ArrayBuffer::NewBackingStore(
+      data, size, v8::BackingStore::EmptyDeleter, nullptr);
+  return v8::ArrayBuffer::New(isolate, std::move(store));
+}
+
+v8::Local<v8::Object> MakeInput(InputState* input, const JsScope& scope) {
+  v8::Local<v8::Object> object = v8::Object::New(scope.isolate);
+
+  v8::Local<v8::ArrayBuffer> keys = WrapInputBuffer(
+      scope.isolate, input->keys(), InputState::kKeysSize);
+  scope.SetValue(object, StringId::keys,
+                 v8::Uint8Array::New(keys, 0, InputState::kKeysSize));
+
+  v8::Local<v8::ArrayBuffer> pressed = WrapInputBuffer(
+      scope.isolate, input->pressed(), InputState::kKeyBitsetSize);
+  scope.SetValue(object, StringId::pressed,
+                 v8::Uint8Array::New(pressed, 0, InputState::kKeyBitsetSize));
+
+  v8::Local<v8::ArrayBuffer> released = WrapInputBuffer(
+      scope.isolate, input->released(), InputState::kKeyBitsetSize);
+  scope.SetValue(object, StringId::released,
+                 v8::Uint8Array::New(released, 0, InputState::kKeyBitsetSize));
+
+  v8::Local<v8::ArrayBuffer> pointer =
+      WrapInputBuffer(scope.isolate, input->pointer(),
+                      InputState::POINTER_SIZE * sizeof(double));
+  scope.SetValue(object, StringId::pointer,
+                 v8::Float64Array::New(pointer, 0, InputState::POINTER_SIZE));
+
+  // Maps each KeyboardEvent.code to its index in the keys array and in the
+  // pressed and released bitsets.
+  v8::Local<v8::Object> codes = v8::Object::New(scope.isolate);
+  for (int key = 0; key < (int) InputState::kKeysSize; key++) {
+    StringId code = GetCode(key);
+    if (code != StringId::Unidentified) {
+      scope.Set(codes, code, key);
+    }
+  }
+  codes->SetIntegrityLevel(scope.context, v8::IntegrityLevel::kFrozen);
+  scope.SetValue(object, StringId::codes, codes);
+
+  object->SetIntegrityLevel(scope.context, v8::IntegrityLevel::kFrozen);
+  return object;
+}
+
 void Close(const v8::FunctionCallbackInfo<v8::Value>& args) {
   JsApi* api = JsApi::Get(args.GetIsolate());
   // window.close() doesn't trigger the 'close' event, and can be used
   // to force a window close at a later time.
-  glfwSetWindowShouldClose(api->glfw_window(), GLFW_TRUE);
-  glfwPostEmptyEvent();
+  api->window()->Close();
 }
 
 void Focus(const v8::FunctionCallbackInfo<v8::Value>& args) {
@@ -392,11 +791,7 @@ void GetJs(v8::Local<v8::Name> property,
 
 void GetClipboardText(const v8::FunctionCallbackInfo<v8::Value>& args) {
   JsApi* api = JsApi::Get(args.GetIsolate());
-  std::string text;
-  const char* ptr = glfwGetClipboardString(api->glfw_window());
-  if (ptr) {
-    text = ptr;
-  }
+  std::string text = api->window()->GetClipboardText();
   args.GetReturnValue().Set(api->js()->MakeString(text));
 }
 
@@ -404,7 +799,7 @@ void SetClipboardText(const v8::FunctionCallbackInfo<v8::Value>& args) {
   if (args.Length() >= 1 && args[0]->IsString()) {
     JsApi* api = JsApi::Get(args.GetIsolate());
     std::string text = api->js()->ToString(args[0]);
-    glfwSetClipboardString(api->glfw_window(), text.c_str());
+    api->window()->SetClipboardText(text);
   }
 }
 
@@ -505,6 +900,25 @@ void SetProfileFrameTimes(v8::Local<v8::Name> property,
   }
 }
 
+void GetLongTaskThreshold(v8::Local<v8::Name> property,
+                          const v8::PropertyCallbackInfo<v8::Value>& info) {
+  ASSERT(IsMainThread());
+  JsApi* api = JsApi::Get(info.GetIsolate());
+  info.GetReturnValue().Set(
+      api->window()->stats()->long_tasks()->threshold() * 1000);
+}
+
+void SetLongTaskThreshold(v8::Local<v8::Name> property,
+                          v8::Local<v8::Value> value,
+                          const v8::PropertyCallbackInfo<void>& info) {
+  ASSERT(IsMainThread());
+  if (value->IsNumber() && value.As<v8::Number>()->Value() >= 0) {
+    JsApi* api = JsApi::Get(info.GetIsolate());
+    api->window()->stats()->long_tasks()->SetThreshold(
+        value.As<v8::Number>()->Value() / 1000);
+  }
+}
+
 void Open(const v8::FunctionCallbackInfo<v8::Value>& args) {
   if (args.Length() >= 1 && args[0]->IsString()) {
     JsApi* api = JsApi::Get(args.GetIsolate());
@@ -576,6 +990,22 @@ void GetLazyCanvas(v8::Local<v8::Name> property,
   info.GetReturnValue().Set(canvas);
 }
 
+// Reads and decodes the font at |path|. Called in a background thread, so that
+// the main thread only has to register the typeface.
+sk_sp<SkTypeface> LoadTypeface(const std::string& path, std::string* error) {
+  sk_sp<SkData> data = ReadFile(path, error);
+  if (!data) {
+    *error = "Failed to load font at " + path + ": " + *error;
+    return nullptr;
+  }
+  sk_sp<SkTypeface> typeface = SkTypeface::MakeFromData(std::move(data));
+  if (!typeface) {
+    *error = "Failed to load font at " + path + ": failed to decode";
+    return nullptr;
+  }
+  return typeface;
+}
+
 }  // namespace
 
 JsApi::JsApi(Window* win, Js* js, JsEvents* events, TaskQueue* task_queue,
@@ -594,9 +1024,10 @@ JsApi::JsApi(Window* win, Js* js, JsEvents* events, TaskQueue* task_queue,
       cursor_x_(0),
       cursor_y_(0),
       cursor_(nullptr),
+      cpu_profiler_(js->isolate()),
       parent_process_(nullptr) {
   if (Args().profile_startup) {
-    $(DEV) << "[profile-startup] create JS APIs start: " << glfwGetTime();
+    $(DEV) << "[profile-startup] create JS APIs start: " << GetClockTime();
   }
 
   v8::Locker locker(js->isolate());
@@ -619,6 +1050,17 @@ JsApi::JsApi(Window* win, Js* js, JsEvents* events, TaskQueue* task_queue,
 
   v8::Local<v8::Object> performance = v8::Object::New(scope.isolate);
   scope.Set(performance, StringId::now, Now);
+  scope.Set(performance, StringId::mark, Mark);
+  scope.Set(performance, StringId::measure, Measure);
+  scope.Set(performance, StringId::getEntriesByName, GetEntriesByName);
+  scope.Set(performance, StringId::clearMarks, ClearMarks);
+  scope.Set(performance, StringId::clearMeasures, ClearMeasures);
+  scope.Set(performance, StringId::startProfiling, StartProfiling);
+  scope.Set(performance, StringId::stopProfiling, StopProfiling);
+  scope.Set(performance, StringId::getInputLatency, GetInputLatency);
+  scope.Set(performance, StringId::getApiCounters, GetApiCounters);
+  scope.Set(performance, StringId::getFrameStats, GetFrameStats);
+  scope.Set(performance, StringId::resetFrameStats, ResetFrameStats);
   scope.SetValue(performance, StringId::memory, memory);
   scope.SetValue(global, StringId::performance, performance);
 
@@ -662,10 +1104,13 @@ JsApi::JsApi(Window* win, Js* js, JsEvents* events, TaskQueue* task_queue,
   scope.Set(window, StringId::getClipboardText, GetClipboardText);
   scope.Set(window, StringId::setClipboardText, SetClipboardText);
   scope.Set(window, StringId::loadFont, LoadFont);
+  scope.Set(window, StringId::loadFonts, LoadFonts);
+  scope.Set(window, StringId::prewarmFonts, PrewarmFonts);
   scope.Set(window, StringId::open, Open);
   scope.Set(window, StringId::retinaScale, GetRetinaScale);
   scope.Set(window, StringId::version, GetVersion);
   scope.Set(window, StringId::platform, GetPlatform);
+  scope.SetValue(window, StringId::input, MakeInput(win->input(), scope));
   scope.Set(global, StringId::window, window);
 
   v8::Local<v8::Object> debug = v8::Object::New(scope.isolate);
@@ -679,6 +1124,14 @@ JsApi::JsApi(Window* win, Js* js, JsEvents* events, TaskQueue* task_queue,
             SetShowOverlayStats);
   scope.Set(debug, StringId::profileFrameTimes, GetProfileFrameTimes,
             SetProfileFrameTimes);
+  scope.Set(debug, StringId::longTaskThreshold, GetLongTaskThreshold,
+            SetLongTaskThreshold);
+  scope.Set(debug, StringId::benchmarkEvents, BenchmarkEvents);
+  scope.Set(debug, StringId::benchmarkColors, BenchmarkColors);
+  scope.Set(debug, StringId::benchmarkJson, BenchmarkJson);
+  scope.Set(debug, StringId::rewriteJson, RewriteJson);
+  scope.Set(debug, StringId::formatLog, FormatLog);
+  scope.Set(debug, StringId::formatDir, FormatDir);
   scope.SetValue(window, StringId::debug, debug);
 
   v8::Local<v8::Object> screen = v8::Object::New(scope.isolate);
@@ -722,13 +1175,18 @@ JsApi::JsApi(Window* win, Js* js, JsEvents* events, TaskQueue* task_queue,
   path2d_constructor_.Reset(scope.isolate, path2d);
   scope.Set(global, StringId::Path2D, path2d);
 
+  v8::Local<v8::Function> text_layout =
+      TextLayoutApi::GetConstructor(this, scope);
+  text_layout_constructor_.Reset(scope.isolate, text_layout);
+  scope.Set(global, StringId::TextLayout, text_layout);
+
   scope.SetLazy(window, StringId::canvas, GetLazyCanvas);
 
   scope.Set(global, StringId::Codec, MakeCodecApi(this, scope));
   scope.Set(global, StringId::File, MakeFileApi(this, scope));
 
   if (Args().profile_startup) {
-    $(DEV) << "[profile-startup] create JS APIs end: " << glfwGetTime();
+    $(DEV) << "[profile-startup] create JS APIs end: " << GetClockTime();
   }
 }
 
@@ -807,13 +1265,24 @@ void JsApi::CallTimeout(uint32_t id) {
   v8::Local<v8::Function> callback = it->second.Get(scope.isolate);
   timeouts_.erase(it);
 
+  double start = GetClockTime();
   IGNORE_RESULT(callback->Call(scope.context, js_->global(), 0, {}));
+  ReportIfLongTask("setTimeout", callback, start);
 
   if (try_catch.HasCaught()) {
     js_->ReportException(try_catch.Message());
   }
 }
 
+void JsApi::ReportIfLongTask(const char* name, v8::Local<v8::Function> f,
+                             double start) {
+  double duration = GetClockTime() - start;
+  LongTasks* long_tasks = window_->stats()->long_tasks();
+  if (long_tasks->IsLong(duration)) {
+    long_tasks->Report(name, DescribeFunction(isolate(), f), start, duration);
+  }
+}
+
 // static
 void JsApi::RequestAnimationFrame(
     const v8::FunctionCallbackInfo<v8::Value>& args) {
@@ -867,7 +1336,7 @@ void JsApi::CallAnimationFrameCallbacks(const JsScope& scope) {
   v8::TryCatch try_catch(scope.isolate);
 
   v8::Local<v8::Number> now =
-      v8::Number::New(scope.isolate, glfwGetTime() * 1000);
+      v8::Number::New(scope.isolate, GetClockTime() * 1000);
   v8::Local<v8::Value> args[] = {now};
 
   for (const v8::Global<v8::Function>& callback : callbacks) {
@@ -877,7 +1346,9 @@ void JsApi::CallAnimationFrameCallbacks(const JsScope& scope) {
     }
 
     v8::Local<v8::Function> f = callback.Get(scope.isolate);
+    double start = GetClockTime();
     IGNORE_RESULT(f->Call(scope.context, scope.context->Global(), 1, args));
+    ReportIfLongTask("requestAnimationFrame", f, start);
 
     if (try_catch.HasCaught()) {
       js_->ReportException(try_catch.Message());
@@ -889,6 +1360,56 @@ void JsApi::CallAnimationFrameCallbacks(const JsScope& scope) {
   }
 }
 
+void JsApi::RunFontPrewarms(const JsScope& scope, double budget) {
+  // Each step draws and flushes this many glyphs at most, so that the budget
+  // is checked often enough.
+  constexpr size_t kGlyphsPerStep = 64;
+
+  double deadline = GetClockTime() + budget;
+  while (!font_prewarms_.empty() && GetClockTime() < deadline) {
+    FontPrewarm& prewarm = font_prewarms_.front();
+    size_t count =
+        std::min(kGlyphsPerStep, prewarm.glyphs.size() - prewarm.done);
+    canvas_shared_context()->PrewarmGlyphs(
+        prewarm.font, prewarm.glyphs.data() + prewarm.done, count);
+    prewarm.done += count;
+    if (prewarm.done < prewarm.glyphs.size()) {
+      continue;
+    }
+    if (prewarm.resolve) {
+      v8::Local<v8::Promise::Resolver> resolver =
+          ReleasePendingPromise(scope.isolate, prewarm.promise);
+      IGNORE_RESULT(
+          resolver->Resolve(scope.context, v8::Undefined(scope.isolate)));
+    }
+    font_prewarms_.pop_front();
+  }
+}
+
+void JsApi::QueueJsonConversion(std::shared_ptr<const JsonDocument> document,
+                                v8::Local<v8::Promise::Resolver> resolver) {
+  JsonConversion conversion;
+  conversion.converter = std::make_unique<JsonConverter>(document->root());
+  conversion.document = std::move(document);
+  conversion.resolver.Reset(isolate(), resolver);
+  json_conversions_.push_back(std::move(conversion));
+}
+
+void JsApi::RunJsonConversions(const JsScope& scope, double budget) {
+  double deadline = GetClockTime() + budget;
+  while (!json_conversions_.empty() && GetClockTime() < deadline) {
+    JsonConversion& conversion = json_conversions_.front();
+    if (!conversion.converter->Run(scope, deadline)) {
+      return;
+    }
+    v8::Local<v8::Promise::Resolver> resolver =
+        conversion.resolver.Get(scope.isolate);
+    v8::Local<v8::Value> value = conversion.converter->result(scope.isolate);
+    json_conversions_.pop_front();
+    IGNORE_RESULT(resolver->Resolve(scope.context, value));
+  }
+}
+
 v8::Local<v8::Promise> JsApi::PostToBackgroundAndResolve(
     BackgroundFunction background_task) {
   ASSERT(IsMainThread());
@@ -904,45 +1425,87 @@ v8::Local<v8::Promise> JsApi::PostToBackgroundAndResolve(
   background_queue_->Post(
       [weak_this, task_queue, index, b = std::move(background_task)] {
         ASSERT(!IsMainThread());
+        PostResolve(weak_this, task_queue, index, b());
+      });
 
-        ResolveFunction resolve_task = b();
+  return resolver->GetPromise();
+}
 
-        // Subtle: this is safe because the task_queue_ is deleted *after* the
-        // background_queue_, and the background_queue_ joins its threads at
-        // shutdown. So as long as the background task is executing, the
-        // TaskQueue* instance is still valid.
-        task_queue->Post([weak_this, index, r = std::move(resolve_task)] {
-          ASSERT(IsMainThread());
+v8::Local<v8::Promise> JsApi::PostToBackgroundAndResolve(
+    std::vector<std::function<void()>> parallel_tasks,
+    BackgroundFunction background_task) {
+  ASSERT(IsMainThread());
 
-          JsApi* thiz = weak_this.Get();
-          if (!thiz) {
-            // The original JsApi instance was deleted while the background task
-            // was executing.
-            return;
-          }
+  if (parallel_tasks.empty()) {
+    return PostToBackgroundAndResolve(std::move(background_task));
+  }
 
-          JsScope scope(thiz->js_);
-          v8::TryCatch try_catch(scope.isolate);
-          v8::Local<v8::Promise::Resolver> resolver =
-              thiz->ReleasePendingPromise(scope.isolate, index);
-          r(thiz, scope, *resolver);
-          if (try_catch.HasCaught()) {
-            if (resolver->GetPromise()->State() == v8::Promise::kPending) {
-              IGNORE_RESULT(
-                  resolver->Reject(scope.context, try_catch.Message()->Get()));
-            }
+  v8::Isolate* isolate = v8::Isolate::GetCurrent();
+  v8::Local<v8::Promise::Resolver> resolver =
+      v8::Promise::Resolver::New(isolate->GetCurrentContext()).ToLocalChecked();
+  size_t index = StorePendingPromise(isolate, resolver);
+
+  WeakPtr<JsApi> weak_this = weak_factory_.MakeWeakPtr();
+  TaskQueue* task_queue = task_queue_;
+
+  auto remaining =
+      std::make_shared<std::atomic<size_t>>(parallel_tasks.size());
+  auto b = std::make_shared<BackgroundFunction>(std::move(background_task));
+
+  for (std::function<void()>& task : parallel_tasks) {
+    background_queue_->Post(
+        [weak_this, task_queue, index, remaining, b, t = std::move(task)] {
+          ASSERT(!IsMainThread());
+          t();
+          if (remaining->fetch_sub(1) == 1) {
+            PostResolve(weak_this, task_queue, index, (*b)());
           }
-          ASSERT(resolver->GetPromise()->State() != v8::Promise::kPending);
         });
-      });
+  }
 
   return resolver->GetPromise();
 }
 
+// static
+void JsApi::PostResolve(WeakPtr<JsApi> weak_this, TaskQueue* task_queue,
+                        size_t index, ResolveFunction resolve_task) {
+  // Subtle: this is safe because the task_queue_ is deleted *after* the
+  // background_queue_, and the background_queue_ joins its threads at
+  // shutdown. So as long as the background task is executing, the
+  // TaskQueue* instance is still valid.
+  task_queue->Post([weak_this, index, r = std::move(resolve_task)] {
+    ASSERT(IsMainThread());
+
+    JsApi* thiz = weak_this.Get();
+    if (!thiz) {
+      // The original JsApi instance was deleted while the background task
+      // was executing.
+      return;
+    }
+
+    JsScope scope(thiz->js_);
+    v8::TryCatch try_catch(scope.isolate);
+    v8::Local<v8::Promise::Resolver> resolver =
+        thiz->ReleasePendingPromise(scope.isolate, index);
+    r(thiz, scope, resolver);
+    if (try_catch.HasCaught()) {
+      if (resolver->GetPromise()->State() == v8::Promise::kPending) {
+        IGNORE_RESULT(
+            resolver->Reject(scope.context, try_catch.Message()->Get()));
+      }
+    }
+    // The promise is resolved, unless |r| queued a JSON conversion that
+    // resolves it in a later frame.
+    ASSERT(resolver->GetPromise()->State() != v8::Promise::kPending ||
+           (!thiz->json_conversions_.empty() &&
+            thiz->json_conversions_.back().resolver == resolver));
+  });
+}
+
 // static
 JsApi::ResolveFunction JsApi::Reject(std::string reason) {
   return [s = std::move(reason)](JsApi* api, const JsScope& scope,
-                                 v8::Promise::Resolver* resolver) {
+                                 v8::Local<v8::Promise::Resolver> resolver) {
     IGNORE_RESULT(
         resolver->Reject(scope.context, api->js()->MakeString(std::move(s))));
   };
@@ -950,7 +1513,8 @@ JsApi::ResolveFunction JsApi::Reject(std::string reason) {
 
 // static
 JsApi::ResolveFunction JsApi::Resolve() {
-  return [](JsApi* api, const JsScope& scope, v8::Promise::Resolver* resolver) {
+  return [](JsApi* api, const JsScope& scope,
+            v8::Local<v8::Promise::Resolver> resolver) {
     IGNORE_RESULT(
         resolver->Resolve(scope.context, v8::Undefined(scope.isolate)));
   };
@@ -959,7 +1523,7 @@ JsApi::ResolveFunction JsApi::Resolve() {
 // static
 JsApi::ResolveFunction JsApi::Resolve(bool value) {
   return [value](JsApi* api, const JsScope& scope,
-                 v8::Promise::Resolver* resolver) {
+                 v8::Local<v8::Promise::Resolver> resolver) {
     IGNORE_RESULT(
         resolver->Resolve(scope.context, value ? v8::True(scope.isolate)
                                                : v8::False(scope.isolate)));
@@ -969,7 +1533,7 @@ JsApi::ResolveFunction JsApi::Resolve(bool value) {
 // static
 JsApi::ResolveFunction JsApi::Resolve(double value) {
   return [value](JsApi* api, const JsScope& scope,
-                 v8::Promise::Resolver* resolver) {
+                 v8::Local<v8::Promise::Resolver> resolver) {
     IGNORE_RESULT(resolver->Resolve(scope.context,
                                     v8::Number::New(scope.isolate, value)));
   };
@@ -978,7 +1542,7 @@ JsApi::ResolveFunction JsApi::Resolve(double value) {
 // static
 JsApi::ResolveFunction JsApi::Resolve(std::string value) {
   return [s = std::move(value)](JsApi* api, const JsScope& scope,
-                                v8::Promise::Resolver* resolver) {
+                                v8::Local<v8::Promise::Resolver> resolver) {
     IGNORE_RESULT(
         resolver->Resolve(scope.context, api->js()->MakeString(std::move(s))));
   };
@@ -1071,10 +1635,10 @@ void JsApi::SetCursor(v8::Local<v8::Name> property, v8::Local<v8::Value> value,
     } else if (shape == "vresize") {
       api->cursor_shape_ = GLFW_VRESIZE_CURSOR;
     } else if (shape == "hidden") {
-      glfwSetInputMode(api->glfw_window(), GLFW_CURSOR, GLFW_CURSOR_HIDDEN);
+      api->window()->SetCursorMode(GLFW_CURSOR_HIDDEN);
       return;
     } else if (shape == "locked") {
-      glfwSetInputMode(api->glfw_window(), GLFW_CURSOR, GLFW_CURSOR_DISABLED);
+      api->window()->SetCursorMode(GLFW_CURSOR_DISABLED);
       api->window_cursor_.Reset(api->js()->isolate(), value);
       return;
     } else {
@@ -1089,7 +1653,7 @@ void JsApi::SetCursor(v8::Local<v8::Name> property, v8::Local<v8::Value> value,
     api->js()->ThrowInvalidArgument();
     return;
   }
-  glfwSetInputMode(api->glfw_window(), GLFW_CURSOR, GLFW_CURSOR_NORMAL);
+  api->window()->SetCursorMode(GLFW_CURSOR_NORMAL);
   api->window_cursor_.Reset(api->js()->isolate(), value);
   api->UpdateCursor();
 }
@@ -1143,6 +1707,10 @@ void JsApi::SetCursorOffsetY(v8::Local<v8::Name> property,
 }
 
 void JsApi::UpdateCursor() {
+  if (!glfw_window()) {
+    // GLFW isn't initialized with --no-window.
+    return;
+  }
   if (cursor_) {
     glfwDestroyCursor(cursor_);
     cursor_ = nullptr;
@@ -1189,6 +1757,222 @@ void JsApi::RemoveEventListener(
   api->events_->RemoveEventListener(type, f);
 }
 
+// static
+void JsApi::BenchmarkEvents(const v8::FunctionCallbackInfo<v8::Value>& args) {
+  JsApi* api = JsApi::Get(args.GetIsolate());
+
+  if (args.Length() < 2 || !args[0]->IsString() || !args[1]->IsUint32()) {
+    api->js()->ThrowInvalidArgument();
+    return;
+  }
+
+  JsEventType type = GetEventType(api->js()->ToString(args[0]));
+  uint32_t count = args[1].As<v8::Uint32>()->Value();
+
+  // Makes synthetic input events, the same way Main does for real events.
+  std::function<v8::Local<v8::Value>(uint32_t, const JsScope&)> make;
+  if (type == JsEventType::KEYDOWN || type == JsEventType::KEYUP) {
+    int action = type == JsEventType::KEYDOWN ? GLFW_PRESS : GLFW_RELEASE;
+    make = [action](uint32_t i, const JsScope& scope) {
+      return MakeKeyEvent(GLFW_KEY_A, 0, action, 0, GetClockTime(), scope);
+    };
+  } else if (type == JsEventType::KEYPRESS) {
+    make = [](uint32_t i, const JsScope& scope) {
+      return MakeKeyPressEvent('a', GetClockTime(), scope);
+    };
+  } else if (type == JsEventType::MOUSEDOWN || type == JsEventType::MOUSEUP ||
+             type == JsEventType::CLICK) {
+    make = [type](uint32_t i, const JsScope& scope) {
+      return MakeMouseButtonEvent(type, GLFW_MOUSE_BUTTON_LEFT, i % 800,
+                                  i % 600, GetClockTime(), scope);
+    };
+  } else if (type == JsEventType::MOUSEMOVE) {
+    make = [](uint32_t i, const JsScope& scope) {
+      return MakeMouseMoveEvent(i % 800, i % 600, GetClockTime(), scope);
+    };
+  } else if (type == JsEventType::WHEEL) {
+    make = [](uint32_t i, const JsScope& scope) {
+      return MakeMouseWheelEvent(0, 1, GetClockTime(), scope);
+    };
+  } else {
+    api->js()->ThrowError("benchmarkEvents only supports input events");
+    return;
+  }
+
+  JsScope scope(api->js());
+  v8::TryCatch try_catch(scope.isolate);
+
+  double start = GetClockTime();
+  for (uint32_t i = 0; i < count; i++) {
+    v8::HandleScope handle_scope(scope.isolate);
+    api->events_->Dispatch(type, make(i, scope), scope);
+    if (try_catch.HasCaught()) {
+      try_catch.ReThrow();
+      return;
+    }
+  }
+  double elapsed = GetClockTime() - start;
+
+  // Returns the number of events created and dispatched per second.
+  args.GetReturnValue().Set(elapsed > 0 ? count / elapsed : 0.0);
+}
+
+// static
+void JsApi::BenchmarkColors(const v8::FunctionCallbackInfo<v8::Value>& args) {
+  JsApi* api = JsApi::Get(args.GetIsolate());
+
+  if (args.Length() < 2 || !args[0]->IsArray() || !args[1]->IsUint32()) {
+    api->js()->ThrowInvalidArgument();
+    return;
+  }
+
+  JsScope scope(api->js());
+  v8::Local<v8::Array> array = args[0].As<v8::Array>();
+  std::vector<std::string> colors;
+  for (uint32_t i = 0; i < array->Length(); i++) {
+    v8::Local<v8::Value> value;
+    if (!array->Get(scope.context, i).ToLocal(&value)) {
+      return;
+    }
+    colors.emplace_back(api->js()->ToString(value));
+  }
+  uint32_t count = args[1].As<v8::Uint32>()->Value();
+  if (colors.empty() || count == 0) {
+    api->js()->ThrowInvalidArgument();
+    return;
+  }
+
+  // Returns how many colors per second |parse| converts.
+  auto run = [&colors, count](auto parse) {
+    SkColor color;
+    double start = GetClockTime();
+    for (uint32_t i = 0; i < count; i++) {
+      parse(colors[i % colors.size()], &color);
+    }
+    double elapsed = GetClockTime() - start;
+    return elapsed > 0 ? count / elapsed : 0.0;
+  };
+
+  CSSColorCache cache;
+  v8::Local<v8::Object> result = v8::Object::New(scope.isolate);
+  scope.Set(result, StringId::parser,
+            run([](const std::string& css, SkColor* color) {
+              return CSSColorToSkColor(css, color);
+            }));
+  scope.Set(result, StringId::cache,
+            run([&cache](const std::string& css, SkColor* color) {
+              return cache.Parse(css, color);
+            }));
+  scope.Set(result, StringId::regex,
+            run([](const std::string& css, SkColor* color) {
+              return CSSColorToSkColorWithRegex(css, color);
+            }));
+  args.GetReturnValue().Set(result);
+}
+
+// static
+void JsApi::BenchmarkJson(const v8::FunctionCallbackInfo<v8::Value>& args) {
+  JsApi* api = JsApi::Get(args.GetIsolate());
+
+  if (args.Length() < 2 || !args[0]->IsString() || !args[1]->IsUint32()) {
+    api->js()->ThrowInvalidArgument();
+    return;
+  }
+
+  std::string json = api->js()->ToString(args[0]);
+  uint32_t count = args[1].As<v8::Uint32>()->Value();
+
+  std::string error;
+  std::unique_ptr<JsonDocument> document = JsonDocument::Parse(json, &error);
+  if (!document) {
+    api->js()->ThrowError(error);
+    return;
+  }
+  // The previous implementation is the baseline. It accepts all the inputs
+  // that JsonDocument accepts, except for duplicated keys.
+  std::unique_ptr<LegacyJson> legacy = LegacyJson::Parse(json);
+  if (!legacy) {
+    api->js()->ThrowError("Invalid JSON for the legacy parser");
+    return;
+  }
+
+  // Returns how many times per second |f| runs.
+  auto run = [count](auto f) {
+    double start = GetClockTime();
+    for (uint32_t i = 0; i < count; i++) {
+      f();
+    }
+    double elapsed = GetClockTime() - start;
+    return elapsed > 0 ? count / elapsed : 0.0;
+  };
+
+  JsScope scope(api->js());
+  v8::Local<v8::Object> result = v8::Object::New(scope.isolate);
+  scope.Set(result, StringId::parse,
+            run([&json] { JsonDocument::Parse(json); }));
+  scope.Set(result, StringId::legacyParse,
+            run([&json] { LegacyJson::Parse(json); }));
+  scope.Set(result, StringId::write, run([&document] {
+              std::string out;
+              JsonWriter(&out).Value(document->root());
+            }));
+  scope.Set(result, StringId::legacyWrite,
+            run([&legacy] { legacy->ToString(); }));
+  args.GetReturnValue().Set(result);
+}
+
+// static
+void JsApi::RewriteJson(const v8::FunctionCallbackInfo<v8::Value>& args) {
+  JsApi* api = JsApi::Get(args.GetIsolate());
+
+  if (args.Length() < 1 || !args[0]->IsString()) {
+    api->js()->ThrowInvalidArgument();
+    return;
+  }
+
+  // Parses the argument with JsonDocument and writes it again with
+  // JsonWriter, so that tests can compare both with JSON.parse().
+  std::string error;
+  std::unique_ptr<JsonDocument> document =
+      JsonDocument::Parse(api->js()->ToString(args[0]), &error);
+  if (!document) {
+    api->js()->ThrowError(error);
+    return;
+  }
+  std::string out;
+  JsonWriter(&out).Value(document->root());
+  args.GetReturnValue().Set(api->js()->MakeString(out));
+}
+
+// static
+void JsApi::FormatLog(const v8::FunctionCallbackInfo<v8::Value>& args) {
+  JsApi* api = JsApi::Get(args.GetIsolate());
+
+  // Captures and formats the arguments like console.log() does, so that
+  // tests can check the snapshots written by the v8 in use.
+  std::vector<LogArgument> captured;
+  captured.reserve(args.Length());
+  for (int i = 0; i < args.Length(); i++) {
+    captured.emplace_back(CaptureLogArgument(api->js(), args[i]));
+  }
+  args.GetReturnValue().Set(
+      api->js()->MakeString(FormatLogArguments(captured)));
+}
+
+// static
+void JsApi::FormatDir(const v8::FunctionCallbackInfo<v8::Value>& args) {
+  JsApi* api = JsApi::Get(args.GetIsolate());
+
+  // Like console.dir(), for the plain objects that it formats from a
+  // snapshot.
+  std::string snapshot;
+  if (args.Length() < 1 || !CaptureDirSnapshot(api->js(), args[0], &snapshot)) {
+    api->js()->ThrowInvalidArgument();
+    return;
+  }
+  args.GetReturnValue().Set(api->js()->MakeString(FormatDirSnapshot(snapshot)));
+}
+
 // static
 void JsApi::LoadFont(const v8::FunctionCallbackInfo<v8::Value>& args) {
   JsApi* api = JsApi::Get(args.GetIsolate());
@@ -1203,29 +1987,164 @@ void JsApi::LoadFont(const v8::FunctionCallbackInfo<v8::Value>& args) {
   args.GetReturnValue().Set(api->PostToBackgroundAndResolve(
       [path = std::move(path),
        name = std::move(name)]() -> JsApi::ResolveFunction {
-        std::string content;
         std::string error;
-        if (!ReadFile(path, &content, &error)) {
-          return JsApi::Reject("Failed to load font at " + path + ": " + error);
+        sk_sp<SkTypeface> typeface = LoadTypeface(path, &error);
+        if (!typeface) {
+          return JsApi::Reject(std::move(error));
         }
-        return [path = std::move(path), name = std::move(name),
-                content = std::move(content)](JsApi* api, const JsScope& scope,
-                                              v8::Promise::Resolver* resolver) {
-          sk_sp<SkData> data =
-              SkData::MakeWithCopy(content.data(), content.size());
-          sk_sp<SkTypeface> font = SkTypeface::MakeFromData(data);
-          if (!font) {
-            IGNORE_RESULT(resolver->Reject(
-                scope.context, scope.MakeString("Failed to load font at " +
-                                                path + ": failed to decode")));
-          }
-          api->fonts_[name] = font;
+        return [name = std::move(name), typeface = std::move(typeface)](
+                   JsApi* api, const JsScope& scope,
+                   v8::Local<v8::Promise::Resolver> resolver) {
+          api->font_cache_.AddFont(name, typeface);
           IGNORE_RESULT(
               resolver->Resolve(scope.context, v8::Undefined(scope.isolate)));
         };
       }));
 }
 
+// static
+void JsApi::LoadFonts(const v8::FunctionCallbackInfo<v8::Value>& args) {
+  JsApi* api = JsApi::Get(args.GetIsolate());
+  if (args.Length() < 1 || !args[0]->IsArray()) {
+    api->js()->ThrowInvalidArgument();
+    return;
+  }
+
+  struct Font {
+    std::string path;
+    std::string name;
+    sk_sp<SkTypeface> typeface;
+    std::string error;
+  };
+
+  JsScope scope(api->js());
+  v8::Local<v8::Array> array = args[0].As<v8::Array>();
+  auto fonts = std::make_shared<std::vector<Font>>(array->Length());
+  for (uint32_t i = 0; i < array->Length(); i++) {
+    v8::Local<v8::Value> value;
+    if (!array->Get(scope.context, i).ToLocal(&value)) {
+      return;
+    }
+    if (!value->IsObject()) {
+      api->js()->ThrowInvalidArgument();
+      return;
+    }
+    v8::Local<v8::Object> object = value.As<v8::Object>();
+    v8::Local<v8::Value> path;
+    v8::Local<v8::Value> name;
+    if (!object->Get(scope.context, scope.GetConstantString(StringId::path))
+             .ToLocal(&path) ||
+        !object->Get(scope.context, scope.GetConstantString(StringId::name))
+             .ToLocal(&name)) {
+      return;
+    }
+    if (!path->IsString() || !name->IsString()) {
+      api->js()->ThrowInvalidArgument();
+      return;
+    }
+    (*fonts)[i].path = api->js()->ToString(path);
+    (*fonts)[i].name = api->js()->ToString(name);
+  }
+
+  // Each font is read and decoded in its own background task. Each task
+  // writes only to its own Font, and the last one to finish reads them all.
+  std::vector<std::function<void()>> tasks;
+  for (Font& font : *fonts) {
+    tasks.emplace_back([&font, fonts] {
+      font.typeface = LoadTypeface(font.path, &font.error);
+    });
+  }
+
+  args.GetReturnValue().Set(api->PostToBackgroundAndResolve(
+      std::move(tasks), [fonts]() -> JsApi::ResolveFunction {
+        return [fonts](JsApi* api, const JsScope& scope,
+                       v8::Local<v8::Promise::Resolver> resolver) {
+          // The fonts that loaded are registered even if others failed.
+          const std::string* error = nullptr;
+          for (Font& font : *fonts) {
+            if (font.typeface) {
+              api->font_cache_.AddFont(std::move(font.name),
+                                       std::move(font.typeface));
+            } else if (!error) {
+              error = &font.error;
+            }
+          }
+          if (error) {
+            IGNORE_RESULT(
+                resolver->Reject(scope.context, scope.MakeString(*error)));
+          } else {
+            IGNORE_RESULT(resolver->Resolve(scope.context,
+                                            v8::Undefined(scope.isolate)));
+          }
+        };
+      }));
+}
+
+// static
+void JsApi::PrewarmFonts(const v8::FunctionCallbackInfo<v8::Value>& args) {
+  JsApi* api = JsApi::Get(args.GetIsolate());
+  if (args.Length() < 1 || !args[0]->IsArray()) {
+    api->js()->ThrowInvalidArgument();
+    return;
+  }
+
+  JsScope scope(api->js());
+  v8::Local<v8::Array> array = args[0].As<v8::Array>();
+  std::vector<FontPrewarm> prewarms;
+  for (uint32_t i = 0; i < array->Length(); i++) {
+    v8::Local<v8::Value> value;
+    if (!array->Get(scope.context, i).ToLocal(&value)) {
+      return;
+    }
+    if (!value->IsObject()) {
+      api->js()->ThrowInvalidArgument();
+      return;
+    }
+    v8::Local<v8::Object> object = value.As<v8::Object>();
+    v8::Local<v8::Value> font;
+    v8::Local<v8::Value> characters;
+    if (!object->Get(scope.context, scope.GetConstantString(StringId::font))
+             .ToLocal(&font) ||
+        !object
+             ->Get(scope.context,
+                   scope.GetConstantString(StringId::characters))
+             .ToLocal(&characters)) {
+      return;
+    }
+    if (!font->IsString() || !characters->IsString()) {
+      api->js()->ThrowInvalidArgument();
+      return;
+    }
+    std::shared_ptr<FontCache::Font> css_font =
+        api->font_cache_.Get(api->js()->ToString(font));
+    if (!css_font) {
+      api->js()->ThrowInvalidArgument();
+      return;
+    }
+    // The glyphs are resolved now, like ctx.prewarmText() does, and drawn
+    // later in RunFontPrewarms().
+    FontPrewarm prewarm;
+    prewarm.font = api->font_cache_.Resolve(css_font.get());
+    prewarm.glyphs =
+        GetUniqueGlyphs(prewarm.font, api->js()->ToString(characters));
+    prewarms.emplace_back(std::move(prewarm));
+  }
+
+  v8::Local<v8::Promise::Resolver> resolver =
+      v8::Promise::Resolver::New(scope.context).ToLocalChecked();
+  if (prewarms.empty()) {
+    IGNORE_RESULT(
+        resolver->Resolve(scope.context, v8::Undefined(scope.isolate)));
+  } else {
+    prewarms.back().resolve = true;
+    prewarms.back().promise = api->StorePendingPromise(scope.isolate, resolver);
+    for (FontPrewarm& prewarm : prewarms) {
+      api->font_prewarms_.emplace_back(std::move(prewarm));
+    }
+  }
+  args.GetReturnValue().Set(resolver->GetPromise());
+}
+
 JsApiWrapper::JsApiWrapper(v8::Isolate* isolate, v8::Local<v8::Object> thiz)
     : isolate_(isolate) {
   thiz->SetAlignedPointerInInternalField(0, this);
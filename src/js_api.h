@@ -1,15 +1,23 @@
 #ifndef WINDOWJS_JS_API_H
 #define WINDOWJS_JS_API_H
 
+#include <deque>
 #include <functional>
+#include <memory>
 #include <unordered_map>
 #include <vector>
 
+#include <skia/include/core/SkFont.h>
 #include <skia/include/core/SkRefCnt.h>
 
+#include "cpu_profiler.h"
+#include "css.h"
 #include "fail.h"
+#include "font_cache.h"
 #include "js.h"
 #include "js_events.h"
+#include "json.h"
+#include "json_converter.h"
 #include "task_queue.h"
 #include "thread.h"
 #include "weak.h"
@@ -23,6 +31,7 @@ class ImageDataApi;
 class Path2DApi;
 class ProcessApi;
 class SkTypeface;
+class TextLayoutApi;
 
 // Custom APIs added to v8 by Window.js.
 class JsApi final {
@@ -46,13 +55,13 @@ class JsApi final {
     return window_->shared_context();
   }
 
-  const std::unordered_map<std::string, sk_sp<SkTypeface>>& fonts() const {
-    return fonts_;
-  }
+  FontCache* font_cache() { return &font_cache_; }
 
-  std::unordered_map<std::string, sk_sp<SkTypeface>>* fonts_cache() {
-    return &fonts_cache_;
-  }
+  CSSColorCache* color_cache() { return &color_cache_; }
+
+  JsEventTemplates* event_templates() { return &event_templates_; }
+
+  CpuProfiler* cpu_profiler() { return &cpu_profiler_; }
 
   bool has_animation_frame_callbacks() const {
     return !animation_frame_callbacks_.empty();
@@ -60,8 +69,26 @@ class JsApi final {
 
   void CallAnimationFrameCallbacks(const JsScope& scope);
 
+  bool has_font_prewarms() const { return !font_prewarms_.empty(); }
+
+  // Prewarms the glyphs queued with window.prewarmFonts() for up to |budget|
+  // seconds, and resolves the promises of the calls that are finished.
+  void RunFontPrewarms(const JsScope& scope, double budget);
+
+  bool has_json_conversions() const { return !json_conversions_.empty(); }
+
+  // Queues |document| to be converted to Javascript values across frames by
+  // RunJsonConversions(), which then resolves |resolver| with the result.
+  void QueueJsonConversion(std::shared_ptr<const JsonDocument> document,
+                           v8::Local<v8::Promise::Resolver> resolver);
+
+  // Converts the queued documents for up to |budget| seconds, and resolves
+  // the promises of the ones that are finished.
+  void RunJsonConversions(const JsScope& scope, double budget);
+
   using ResolveFunction =
-      std::function<void(JsApi*, const JsScope&, v8::Promise::Resolver*)>;
+      std::function<void(JsApi*, const JsScope&,
+                         v8::Local<v8::Promise::Resolver>)>;
   using BackgroundFunction = std::function<ResolveFunction()>;
 
   // Posts a "background_task" that gets executed in a background thread. Its
@@ -74,7 +101,8 @@ class JsApi final {
   //   std::string content;
   //   ReadFile(some_path_from_args, &content);
   //   return [content = std::move(content)](
-  //      JsApi* api, const JsScope& scope, v8::Promise::Resolver* resolver) {
+  //      JsApi* api, const JsScope& scope,
+  //      v8::Local<v8::Promise::Resolver> resolver) {
   //     // Runs on the main thread.
   //     resolver->Resolver(scope.context, api->js()->MakeString(content));
   //   };
@@ -84,6 +112,13 @@ class JsApi final {
   v8::Local<v8::Promise> PostToBackgroundAndResolve(
       BackgroundFunction background_task);
 
+  // Like PostToBackgroundAndResolve, but each of the "parallel_tasks" is
+  // posted to the background threads separately. The "background_task" runs
+  // after all of them have finished, in the thread that finished last.
+  v8::Local<v8::Promise> PostToBackgroundAndResolve(
+      std::vector<std::function<void()>> parallel_tasks,
+      BackgroundFunction background_task);
+
   // Helper to return a failure from PostToBackgroundAndResolve.
   static ResolveFunction Reject(std::string reason);
 
@@ -157,6 +192,15 @@ class JsApi final {
     return GetWrappedInstanceOrThrow<Path2DApi>(thiz, GetPath2DConstructor());
   }
 
+  v8::Local<v8::Function> GetTextLayoutConstructor() {
+    return text_layout_constructor_.Get(js_->isolate());
+  }
+
+  TextLayoutApi* GetTextLayoutApi(v8::Local<v8::Value> thiz) {
+    return GetWrappedInstanceOrThrow<TextLayoutApi>(
+        thiz, GetTextLayoutConstructor());
+  }
+
   v8::Local<v8::Function> GetProcessConstructor() {
     return process_constructor_.Get(js_->isolate());
   }
@@ -179,6 +223,10 @@ class JsApi final {
   static void ClearTimeout(const v8::FunctionCallbackInfo<v8::Value>& args);
   void CallTimeout(uint32_t id);
 
+  // Reports |f| to the LongTasks of the Stats if it ran for too long.
+  void ReportIfLongTask(const char* name, v8::Local<v8::Function> f,
+                        double start);
+
   static void RequestAnimationFrame(
       const v8::FunctionCallbackInfo<v8::Value>& args);
   static void CancelAnimationFrame(
@@ -211,10 +259,24 @@ class JsApi final {
       const v8::FunctionCallbackInfo<v8::Value>& args);
 
   static void LoadFont(const v8::FunctionCallbackInfo<v8::Value>& args);
+  static void LoadFonts(const v8::FunctionCallbackInfo<v8::Value>& args);
+  static void PrewarmFonts(const v8::FunctionCallbackInfo<v8::Value>& args);
+
+  static void BenchmarkEvents(const v8::FunctionCallbackInfo<v8::Value>& args);
+  static void BenchmarkColors(const v8::FunctionCallbackInfo<v8::Value>& args);
+  static void BenchmarkJson(const v8::FunctionCallbackInfo<v8::Value>& args);
+  static void RewriteJson(const v8::FunctionCallbackInfo<v8::Value>& args);
+  static void FormatLog(const v8::FunctionCallbackInfo<v8::Value>& args);
+  static void FormatDir(const v8::FunctionCallbackInfo<v8::Value>& args);
 
   size_t StorePendingPromise(v8::Isolate* isolate,
                              v8::Local<v8::Promise::Resolver> resolver);
 
+  // Posts |resolve_task| from a background thread to the main thread, to
+  // resolve the pending promise at |index|.
+  static void PostResolve(WeakPtr<JsApi> weak_this, TaskQueue* task_queue,
+                          size_t index, ResolveFunction resolve_task);
+
   v8::Local<v8::Promise::Resolver> ReleasePendingPromise(v8::Isolate* isolate,
                                                          size_t index);
 
@@ -234,12 +296,32 @@ class JsApi final {
 
   std::vector<v8::Global<v8::Promise::Resolver>> pending_promises_;
 
+  // The glyphs queued with window.prewarmFonts(). The last FontPrewarm of
+  // each call resolves its promise.
+  struct FontPrewarm {
+    SkFont font;
+    std::vector<SkGlyphID> glyphs;
+    size_t done = 0;
+    bool resolve = false;
+    size_t promise = 0;
+  };
+  std::deque<FontPrewarm> font_prewarms_;
+
+  // The documents queued by File.readJSON() with {incremental: true}.
+  struct JsonConversion {
+    std::shared_ptr<const JsonDocument> document;
+    std::unique_ptr<JsonConverter> converter;
+    v8::Global<v8::Promise::Resolver> resolver;
+  };
+  std::deque<JsonConversion> json_conversions_;
+
   v8::Global<v8::Function> canvas_rendering_context_2d_constructor_;
   v8::Global<v8::Function> canvas_gradient_constructor_;
   v8::Global<v8::Function> canvas_pattern_constructor_;
   v8::Global<v8::Function> image_data_constructor_;
   v8::Global<v8::Function> image_bitmap_constructor_;
   v8::Global<v8::Function> path2d_constructor_;
+  v8::Global<v8::Function> text_layout_constructor_;
   v8::Global<v8::Function> process_constructor_;
 
   v8::Global<v8::Array> window_icon_;
@@ -250,8 +332,13 @@ class JsApi final {
   int cursor_y_;
   GLFWcursor* cursor_;
 
-  std::unordered_map<std::string, sk_sp<SkTypeface>> fonts_;
-  std::unordered_map<std::string, sk_sp<SkTypeface>> fonts_cache_;
+  FontCache font_cache_;
+
+  CSSColorCache color_cache_;
+
+  JsEventTemplates event_templates_;
+
+  CpuProfiler cpu_profiler_;
 
   ProcessApi* parent_process_;
 };
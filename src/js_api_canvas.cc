@@ -1,7 +1,5 @@
 #include "js_api_canvas.h"
 
-#include <unordered_map>
-
 #include <skia/include/core/SkEncodedImageFormat.h>
 #include <skia/include/core/SkFontMetrics.h>
 #include <skia/include/core/SkFontMgr.h>
@@ -12,9 +10,11 @@
 #include <skia/include/effects/SkImageFilters.h>
 #include <skia/include/utils/SkParsePath.h>
 
+#include "api_counters.h"
 #include "console.h"
 #include "css.h"
 #include "fail.h"
+#include "js_string_view.h"
 #include "js_strings.h"
 #include "thread.h"
 
@@ -164,14 +164,12 @@ void ImageBitmap(const v8::FunctionCallbackInfo<v8::Value>& info) {
     SkPixmap pixmap{image_info, image_data->backing_store()->Data(),
                     image_data->width() * 4u};
     sk_sp<SkImage> image = SkImage::MakeRasterCopy(pixmap);
-    texture =
-        image->makeTextureImage(api->canvas_shared_context()->skia_context(),
-                                GrMipMapped::kNo, skgpu::Budgeted::kNo);
+    texture = api->canvas_shared_context()->MakeTextureImage(image);
     ASSERT(texture);
-    ASSERT(texture->isTextureBacked());
+    ASSERT(api->canvas_shared_context()->IsCompatibleImage(texture.get()));
   } else if (info[0]->IsExternal()) {
     texture.reset(static_cast<SkImage*>(info[0].As<v8::External>()->Value()));
-    ASSERT(texture->isTextureBacked());
+    ASSERT(api->canvas_shared_context()->IsCompatibleImage(texture.get()));
   } else {
     api->js()->ThrowInvalidArgument();
     return;
@@ -200,7 +198,7 @@ void ImageBitmap(const v8::FunctionCallbackInfo<v8::Value>& info) {
     texture =
         texture->makeSubset(rect, api->canvas_shared_context()->skia_context());
     ASSERT(texture);
-    ASSERT(texture->isTextureBacked());
+    ASSERT(api->canvas_shared_context()->IsCompatibleImage(texture.get()));
   }
 
   v8::Local<v8::Object> thiz = info.This();
@@ -235,6 +233,85 @@ void Path2D(const v8::FunctionCallbackInfo<v8::Value>& info) {
   new Path2DApi(api, thiz, path);
 }
 
+// new TextLayout(text, font, maxWidth?, align?, lineHeight?)
+void NewTextLayout(const v8::FunctionCallbackInfo<v8::Value>& info) {
+  if (!info.IsConstructCall()) {
+    info.GetIsolate()->ThrowError("TextLayout is a constructor");
+    return;
+  }
+
+  JsApi* api = JsApi::Get(info.GetIsolate());
+  if (info.Length() < 2 || !info[0]->IsString() || !info[1]->IsString()) {
+    api->js()->ThrowInvalidArgument();
+    return;
+  }
+
+  float max_width = 0;
+  if (info.Length() >= 3 && !info[2]->IsUndefined()) {
+    if (!info[2]->IsNumber()) {
+      api->js()->ThrowInvalidArgument();
+      return;
+    }
+    max_width = info[2].As<v8::Number>()->Value();
+  }
+
+  TextLayout::Align align = TextLayout::LEFT;
+  if (info.Length() >= 4 && !info[3]->IsUndefined()) {
+    StringId s = api->js()->MatchConstantString(
+        info[3], {StringId::left, StringId::right, StringId::center,
+                  StringId::start, StringId::end});
+    if (s == StringId::center) {
+      align = TextLayout::CENTER;
+    } else if (s == StringId::right || s == StringId::end) {
+      align = TextLayout::RIGHT;
+    } else if (s == StringId::LAST_STRING_ID) {
+      api->js()->ThrowInvalidArgument();
+      return;
+    }
+  }
+
+  float line_height = 0;
+  if (info.Length() >= 5 && !info[4]->IsUndefined()) {
+    if (!info[4]->IsNumber()) {
+      api->js()->ThrowInvalidArgument();
+      return;
+    }
+    line_height = info[4].As<v8::Number>()->Value();
+  }
+
+  FontCache* font_cache = api->font_cache();
+  std::shared_ptr<FontCache::Font> font =
+      font_cache->Get(JsStringView(info.GetIsolate(), info[1]).view());
+  if (!font) {
+    api->js()->ThrowInvalidArgument();
+    return;
+  }
+
+  // The offsets of the lines are in UTF-16, like Javascript strings.
+  v8::String::Value text(info.GetIsolate(), info[0]);
+  auto layout = std::make_unique<TextLayout>(
+      std::u16string_view(reinterpret_cast<const char16_t*>(*text),
+                          text.length()),
+      font_cache->Resolve(font.get()), max_width, align, line_height);
+
+  v8::Local<v8::Object> thiz = info.This();
+  new TextLayoutApi(api, thiz, std::move(layout));
+}
+
+// Returns a typed array of |Array| with the |field| of each line of |layout|.
+template <typename Array, typename T>
+v8::Local<Array> MakeLineArray(v8::Isolate* isolate, const TextLayout& layout,
+                               T TextLayout::Line::*field) {
+  const std::vector<TextLayout::Line>& lines = layout.lines();
+  v8::Local<v8::ArrayBuffer> buffer =
+      v8::ArrayBuffer::New(isolate, lines.size() * sizeof(T));
+  T* data = static_cast<T*>(buffer->GetBackingStore()->Data());
+  for (size_t i = 0; i < lines.size(); i++) {
+    data[i] = lines[i].*field;
+  }
+  return Array::New(buffer, 0, lines.size());
+}
+
 void UnrefData(void* ptr, size_t length, void* data) {
   static_cast<SkData*>(data)->unref();
 }
@@ -260,15 +337,15 @@ v8::Local<v8::Promise> EncodeInBackground(
     sk_sp<SkData> data = image->encodeToData(format, quality);
     ASSERT(data);
     data->ref();
-    return
-        [=](JsApi* api, const JsScope& scope, v8::Promise::Resolver* resolver) {
-          std::unique_ptr<v8::BackingStore> store =
-              v8::ArrayBuffer::NewBackingStore(
-                  (void*) data->data(), data->size(), UnrefData, data.get());
-          v8::Local<v8::ArrayBuffer> buffer =
-              v8::ArrayBuffer::New(api->isolate(), std::move(store));
-          IGNORE_RESULT(resolver->Resolve(scope.context, buffer));
-        };
+    return [=](JsApi* api, const JsScope& scope,
+               v8::Local<v8::Promise::Resolver> resolver) {
+      std::unique_ptr<v8::BackingStore> store =
+          v8::ArrayBuffer::NewBackingStore((void*) data->data(), data->size(),
+                                           UnrefData, data.get());
+      v8::Local<v8::ArrayBuffer> buffer =
+          v8::ArrayBuffer::New(api->isolate(), std::move(store));
+      IGNORE_RESULT(resolver->Resolve(scope.context, buffer));
+    };
   });
 }
 
@@ -363,7 +440,7 @@ CanvasRenderingContext2DApi::CanvasRenderingContext2DApi(
   state_.shadow_offsety = 0;
   state_.shadow_blur = 0;
 
-  state_.font.setSize(16.0f);
+  state_.font = api->font_cache()->Get("16px sans-serif");
 }
 
 CanvasRenderingContext2DApi::~CanvasRenderingContext2DApi() {
@@ -392,76 +469,88 @@ v8::Local<v8::Function> CanvasRenderingContext2DApi::GetConstructor(
   v8::Local<v8::ObjectTemplate> prototype =
       canvas_rendering_context_2d->PrototypeTemplate();
 
+  // Calls to the methods and property setters are counted in
+  // performance.getApiCounters().
+#define SET_PROPERTY(name, get, set)     \
+  scope.Set(instance, StringId::name, get, \
+            CountSetterCalls<ApiCounters::CANVAS, StringId::name, set>)
+#define SET_METHOD(name, function)       \
+  scope.Set(prototype, StringId::name,   \
+            CountCalls<ApiCounters::CANVAS, StringId::name, function>)
+
   // Properties.
-  scope.Set(instance, StringId::width, GetWidth, SetWidth);
-  scope.Set(instance, StringId::height, GetHeight, SetHeight);
-  scope.Set(instance, StringId::fillStyle, GetFillStyle, SetFillStyle);
-  scope.Set(instance, StringId::strokeStyle, GetStrokeStyle, SetStrokeStyle);
-  scope.Set(instance, StringId::font, GetFont, SetFont);
-  scope.Set(instance, StringId::lineWidth, GetLineWidth, SetLineWidth);
-  scope.Set(instance, StringId::lineCap, GetLineCap, SetLineCap);
-  scope.Set(instance, StringId::lineJoin, GetLineJoin, SetLineJoin);
-  scope.Set(instance, StringId::miterLimit, GetMiterLimit, SetMiterLimit);
-  scope.Set(instance, StringId::lineDashOffset, GetLineDashOffset,
-            SetLineDashOffset);
-  scope.Set(instance, StringId::textAlign, GetTextAlign, SetTextAlign);
-  scope.Set(instance, StringId::textBaseline, GetTextBaseline, SetTextBaseline);
-  scope.Set(instance, StringId::globalAlpha, GetGlobalAlpha, SetGlobalAlpha);
-  scope.Set(instance, StringId::globalCompositeOperation,
-            GetGlobalCompositeOperation, SetGlobalCompositeOperation);
-  scope.Set(instance, StringId::shadowBlur, GetShadowBlur, SetShadowBlur);
-  scope.Set(instance, StringId::shadowColor, GetShadowColor, SetShadowColor);
-  scope.Set(instance, StringId::shadowOffsetX, GetShadowOffsetX,
-            SetShadowOffsetX);
-  scope.Set(instance, StringId::shadowOffsetY, GetShadowOffsetY,
-            SetShadowOffsetY);
-  scope.Set(instance, StringId::antialias, GetAntiAlias, SetAntiAlias);
-  scope.Set(instance, StringId::imageSmoothingEnabled, GetImageSmoothingEnabled,
-            SetImageSmoothingEnabled);
-  scope.Set(instance, StringId::imageSmoothingQuality, GetImageSmoothingQuality,
-            SetImageSmoothingQuality);
+  SET_PROPERTY(width, GetWidth, SetWidth);
+  SET_PROPERTY(height, GetHeight, SetHeight);
+  SET_PROPERTY(fillStyle, GetFillStyle, SetFillStyle);
+  SET_PROPERTY(strokeStyle, GetStrokeStyle, SetStrokeStyle);
+  SET_PROPERTY(font, GetFont, SetFont);
+  SET_PROPERTY(lineWidth, GetLineWidth, SetLineWidth);
+  SET_PROPERTY(lineCap, GetLineCap, SetLineCap);
+  SET_PROPERTY(lineJoin, GetLineJoin, SetLineJoin);
+  SET_PROPERTY(miterLimit, GetMiterLimit, SetMiterLimit);
+  SET_PROPERTY(lineDashOffset, GetLineDashOffset, SetLineDashOffset);
+  SET_PROPERTY(textAlign, GetTextAlign, SetTextAlign);
+  SET_PROPERTY(textBaseline, GetTextBaseline, SetTextBaseline);
+  SET_PROPERTY(globalAlpha, GetGlobalAlpha, SetGlobalAlpha);
+  SET_PROPERTY(globalCompositeOperation, GetGlobalCompositeOperation,
+               SetGlobalCompositeOperation);
+  SET_PROPERTY(shadowBlur, GetShadowBlur, SetShadowBlur);
+  SET_PROPERTY(shadowColor, GetShadowColor, SetShadowColor);
+  SET_PROPERTY(shadowOffsetX, GetShadowOffsetX, SetShadowOffsetX);
+  SET_PROPERTY(shadowOffsetY, GetShadowOffsetY, SetShadowOffsetY);
+  SET_PROPERTY(antialias, GetAntiAlias, SetAntiAlias);
+  SET_PROPERTY(imageSmoothingEnabled, GetImageSmoothingEnabled,
+               SetImageSmoothingEnabled);
+  SET_PROPERTY(imageSmoothingQuality, GetImageSmoothingQuality,
+               SetImageSmoothingQuality);
 
   // Functions.
-  scope.Set(prototype, StringId::clearRect, ClearRect);
-  scope.Set(prototype, StringId::fillRect, FillRect);
-  scope.Set(prototype, StringId::strokeRect, StrokeRect);
-  scope.Set(prototype, StringId::fillText, FillText);
-  scope.Set(prototype, StringId::strokeText, StrokeText);
-  scope.Set(prototype, StringId::measureText, MeasureText);
-  scope.Set(prototype, StringId::getLineDash, GetLineDash);
-  scope.Set(prototype, StringId::setLineDash, SetLineDash);
-  scope.Set(prototype, StringId::beginPath, BeginPath);
-  scope.Set(prototype, StringId::closePath, ClosePath);
-  scope.Set(prototype, StringId::moveTo, MoveTo);
-  scope.Set(prototype, StringId::lineTo, LineTo);
-  scope.Set(prototype, StringId::bezierCurveTo, BezierCurveTo);
-  scope.Set(prototype, StringId::quadraticCurveTo, QuadraticCurveTo);
-  scope.Set(prototype, StringId::arc, Arc);
-  scope.Set(prototype, StringId::arcTo, ArcTo);
-  scope.Set(prototype, StringId::ellipse, Ellipse);
-  scope.Set(prototype, StringId::rect, Rect);
-  scope.Set(prototype, StringId::fill, Fill);
-  scope.Set(prototype, StringId::stroke, Stroke);
-  scope.Set(prototype, StringId::clip, Clip);
-  scope.Set(prototype, StringId::isPointInPath, IsPointInPath);
-  scope.Set(prototype, StringId::isPointInStroke, IsPointInStroke);
-  scope.Set(prototype, StringId::rotate, Rotate);
-  scope.Set(prototype, StringId::scale, Scale);
-  scope.Set(prototype, StringId::translate, Translate);
-  scope.Set(prototype, StringId::transform, Transform);
-  scope.Set(prototype, StringId::getTransform, GetTransform);
-  scope.Set(prototype, StringId::setTransform, SetTransform);
-  scope.Set(prototype, StringId::resetTransform, ResetTransform);
-  scope.Set(prototype, StringId::save, Save);
-  scope.Set(prototype, StringId::restore, Restore);
-  scope.Set(prototype, StringId::createLinearGradient, CreateLinearGradient);
-  scope.Set(prototype, StringId::createRadialGradient, CreateRadialGradient);
-  scope.Set(prototype, StringId::createPattern, CreatePattern);
-  scope.Set(prototype, StringId::createImageData, CreateImageData);
-  scope.Set(prototype, StringId::getImageData, GetImageData);
-  scope.Set(prototype, StringId::putImageData, PutImageData);
-  scope.Set(prototype, StringId::encode, Encode);
-  scope.Set(prototype, StringId::drawImage, DrawImage);
+  SET_METHOD(clearRect, ClearRect);
+  SET_METHOD(fillRect, FillRect);
+  SET_METHOD(strokeRect, StrokeRect);
+  SET_METHOD(fillText, FillText);
+  SET_METHOD(strokeText, StrokeText);
+  SET_METHOD(measureText, MeasureText);
+  SET_METHOD(measureTextBatch, MeasureTextBatch);
+  SET_METHOD(prewarmText, PrewarmText);
+  SET_METHOD(drawTextLayout, DrawTextLayout);
+  SET_METHOD(getLineDash, GetLineDash);
+  SET_METHOD(setLineDash, SetLineDash);
+  SET_METHOD(beginPath, BeginPath);
+  SET_METHOD(closePath, ClosePath);
+  SET_METHOD(moveTo, MoveTo);
+  SET_METHOD(lineTo, LineTo);
+  SET_METHOD(bezierCurveTo, BezierCurveTo);
+  SET_METHOD(quadraticCurveTo, QuadraticCurveTo);
+  SET_METHOD(arc, Arc);
+  SET_METHOD(arcTo, ArcTo);
+  SET_METHOD(ellipse, Ellipse);
+  SET_METHOD(rect, Rect);
+  SET_METHOD(fill, Fill);
+  SET_METHOD(stroke, Stroke);
+  SET_METHOD(clip, Clip);
+  SET_METHOD(isPointInPath, IsPointInPath);
+  SET_METHOD(isPointInStroke, IsPointInStroke);
+  SET_METHOD(rotate, Rotate);
+  SET_METHOD(scale, Scale);
+  SET_METHOD(translate, Translate);
+  SET_METHOD(transform, Transform);
+  SET_METHOD(getTransform, GetTransform);
+  SET_METHOD(setTransform, SetTransform);
+  SET_METHOD(resetTransform, ResetTransform);
+  SET_METHOD(save, Save);
+  SET_METHOD(restore, Restore);
+  SET_METHOD(createLinearGradient, CreateLinearGradient);
+  SET_METHOD(createRadialGradient, CreateRadialGradient);
+  SET_METHOD(createPattern, CreatePattern);
+  SET_METHOD(createImageData, CreateImageData);
+  SET_METHOD(getImageData, GetImageData);
+  SET_METHOD(putImageData, PutImageData);
+  SET_METHOD(encode, Encode);
+  SET_METHOD(drawImage, DrawImage);
+
+#undef SET_PROPERTY
+#undef SET_METHOD
 
   return canvas_rendering_context_2d->GetFunction(scope.context)
       .ToLocalChecked();
@@ -564,9 +653,9 @@ void CanvasRenderingContext2DApi::SetFillStyle(
   }
 
   if (value->IsString()) {
-    std::string s = api->js()->ToString(value);
+    JsStringView css(info.GetIsolate(), value);
     SkColor color;
-    if (CSSColorToSkColor(s, &color)) {
+    if (api->api()->color_cache()->Parse(css.view(), &color)) {
       State& state = api->state_;
       state.ResetFillStyle();
       state.fill_color = color;
@@ -620,9 +709,9 @@ void CanvasRenderingContext2DApi::SetStrokeStyle(
     return;
   }
   if (value->IsString()) {
-    std::string s = api->js()->ToString(value);
+    JsStringView css(info.GetIsolate(), value);
     SkColor color;
-    if (CSSColorToSkColor(s, &color)) {
+    if (api->api()->color_cache()->Parse(css.view(), &color)) {
       State& state = api->state_;
       state.ResetStrokeStyle();
       state.stroke_color = color;
@@ -701,7 +790,7 @@ void CanvasRenderingContext2DApi::GetFont(
       JsApi::Get(info.GetIsolate())
           ->GetCanvasRenderingContext2DApi(info.This());
   if (api) {
-    std::string font = SkFontToCSSFont(api->state_.font);
+    std::string font = SkFontToCSSFont(api->font());
     info.GetReturnValue().Set(api->js()->MakeString(font));
   }
 }
@@ -717,9 +806,12 @@ void CanvasRenderingContext2DApi::SetFont(
       JsApi::Get(info.GetIsolate())
           ->GetCanvasRenderingContext2DApi(info.This());
   if (api) {
-    std::string font = api->js()->ToString(value);
-    CSSFontToSkFont(font, &api->state_.font, api->api()->fonts(),
-                    api->api()->fonts_cache());
+    JsStringView css(info.GetIsolate(), value);
+    std::shared_ptr<FontCache::Font> font =
+        api->api()->font_cache()->Get(css.view());
+    if (font) {
+      api->state_.font = std::move(font);
+    }
   }
 }
 
@@ -785,12 +877,13 @@ void CanvasRenderingContext2DApi::SetLineCap(
   if (!api) {
     return;
   }
-  std::string cap = api->js()->ToString(value);
-  if (cap == "butt") {
+  StringId cap = api->js()->MatchConstantString(
+      value, {StringId::butt, StringId::round, StringId::square});
+  if (cap == StringId::butt) {
     api->state_.stroke_paint.setStrokeCap(SkPaint::kButt_Cap);
-  } else if (cap == "round") {
+  } else if (cap == StringId::round) {
     api->state_.stroke_paint.setStrokeCap(SkPaint::kRound_Cap);
-  } else if (cap == "square") {
+  } else if (cap == StringId::square) {
     api->state_.stroke_paint.setStrokeCap(SkPaint::kSquare_Cap);
   }
 }
@@ -829,12 +922,13 @@ void CanvasRenderingContext2DApi::SetLineJoin(
   if (!api || !value->IsString()) {
     return;
   }
-  std::string join = api->js()->ToString(value);
-  if (join == "miter") {
+  StringId join = api->js()->MatchConstantString(
+      value, {StringId::miter, StringId::round, StringId::bevel});
+  if (join == StringId::miter) {
     api->state_.stroke_paint.setStrokeJoin(SkPaint::kMiter_Join);
-  } else if (join == "round") {
+  } else if (join == StringId::round) {
     api->state_.stroke_paint.setStrokeJoin(SkPaint::kRound_Join);
-  } else if (join == "bevel") {
+  } else if (join == StringId::bevel) {
     api->state_.stroke_paint.setStrokeJoin(SkPaint::kBevel_Join);
   }
 }
@@ -979,17 +1073,11 @@ void CanvasRenderingContext2DApi::SetTextAlign(
   if (!api || !value->IsString()) {
     return;
   }
-  std::string align = api->js()->ToString(value);
-  if (align == "left") {
-    api->state_.text_align = StringId::left;
-  } else if (align == "right") {
-    api->state_.text_align = StringId::right;
-  } else if (align == "center") {
-    api->state_.text_align = StringId::center;
-  } else if (align == "start") {
-    api->state_.text_align = StringId::start;
-  } else if (align == "end") {
-    api->state_.text_align = StringId::end;
+  StringId align = api->js()->MatchConstantString(
+      value, {StringId::left, StringId::right, StringId::center,
+              StringId::start, StringId::end});
+  if (align != StringId::LAST_STRING_ID) {
+    api->state_.text_align = align;
   }
 }
 
@@ -1016,19 +1104,11 @@ void CanvasRenderingContext2DApi::SetTextBaseline(
   if (!api || !value->IsString()) {
     return;
   }
-  std::string baseline = api->js()->ToString(value);
-  if (baseline == "top") {
-    api->state_.text_baseline = StringId::top;
-  } else if (baseline == "hanging") {
-    api->state_.text_baseline = StringId::hanging;
-  } else if (baseline == "middle") {
-    api->state_.text_baseline = StringId::middle;
-  } else if (baseline == "alphabetic") {
-    api->state_.text_baseline = StringId::alphabetic;
-  } else if (baseline == "ideographic") {
-    api->state_.text_baseline = StringId::ideographic;
-  } else if (baseline == "bottom") {
-    api->state_.text_baseline = StringId::bottom;
+  StringId baseline = api->js()->MatchConstantString(
+      value, {StringId::top, StringId::hanging, StringId::middle,
+              StringId::alphabetic, StringId::ideographic, StringId::bottom});
+  if (baseline != StringId::LAST_STRING_ID) {
+    api->state_.text_baseline = baseline;
   }
 }
 
@@ -1129,38 +1209,41 @@ void CanvasRenderingContext2DApi::SetGlobalCompositeOperation(
   if (!api || !value->IsString()) {
     return;
   }
-  std::string s = api->js()->ToString(value);
-  static const std::unordered_map<std::string, SkBlendMode> ops{
-      {"source-over", SkBlendMode::kSrcOver},
-      {"source-in", SkBlendMode::kSrcIn},
-      {"source-out", SkBlendMode::kSrcOut},
-      {"source-atop", SkBlendMode::kSrcATop},
-      {"destination-over", SkBlendMode::kDstOver},
-      {"destination-in", SkBlendMode::kDstIn},
-      {"destination-out", SkBlendMode::kDstOut},
-      {"destination-atop", SkBlendMode::kDstATop},
-      {"lighter", SkBlendMode::kPlus},
-      {"copy", SkBlendMode::kSrc},
-      {"xor", SkBlendMode::kXor},
-      {"multiply", SkBlendMode::kMultiply},
-      {"screen", SkBlendMode::kScreen},
-      {"overlay", SkBlendMode::kOverlay},
-      {"darken", SkBlendMode::kDarken},
-      {"lighten", SkBlendMode::kLighten},
-      {"color-dodge", SkBlendMode::kColorDodge},
-      {"color-burn", SkBlendMode::kColorBurn},
-      {"hard-light", SkBlendMode::kHardLight},
-      {"soft-light", SkBlendMode::kSoftLight},
-      {"difference", SkBlendMode::kDifference},
-      {"exclusion", SkBlendMode::kExclusion},
-      {"hue", SkBlendMode::kHue},
-      {"saturation", SkBlendMode::kSaturation},
-      {"color", SkBlendMode::kColor},
-      {"luminosity", SkBlendMode::kLuminosity},
+  struct CompositeOperation {
+    StringId name;
+    SkBlendMode mode;
+  };
+  static constexpr CompositeOperation ops[] = {
+      {StringId::sourceOver, SkBlendMode::kSrcOver},
+      {StringId::sourceIn, SkBlendMode::kSrcIn},
+      {StringId::sourceOut, SkBlendMode::kSrcOut},
+      {StringId::sourceAtop, SkBlendMode::kSrcATop},
+      {StringId::destinationOver, SkBlendMode::kDstOver},
+      {StringId::destinationIn, SkBlendMode::kDstIn},
+      {StringId::destinationOut, SkBlendMode::kDstOut},
+      {StringId::destinationAtop, SkBlendMode::kDstATop},
+      {StringId::lighter, SkBlendMode::kPlus},
+      {StringId::copy, SkBlendMode::kSrc},
+      {StringId::_XOR_, SkBlendMode::kXor},
+      {StringId::multiply, SkBlendMode::kMultiply},
+      {StringId::screen, SkBlendMode::kScreen},
+      {StringId::overlay, SkBlendMode::kOverlay},
+      {StringId::darken, SkBlendMode::kDarken},
+      {StringId::lighten, SkBlendMode::kLighten},
+      {StringId::colorDodge, SkBlendMode::kColorDodge},
+      {StringId::colorBurn, SkBlendMode::kColorBurn},
+      {StringId::hardLight, SkBlendMode::kHardLight},
+      {StringId::softLight, SkBlendMode::kSoftLight},
+      {StringId::difference, SkBlendMode::kDifference},
+      {StringId::exclusion, SkBlendMode::kExclusion},
+      {StringId::hue, SkBlendMode::kHue},
+      {StringId::saturation, SkBlendMode::kSaturation},
+      {StringId::color, SkBlendMode::kColor},
+      {StringId::luminosity, SkBlendMode::kLuminosity},
   };
-  auto it = ops.find(s);
-  if (it != ops.end()) {
-    SkBlendMode op = it->second;
+  const CompositeOperation* it = api->js()->MatchConstantString(value, ops);
+  if (it) {
+    SkBlendMode op = it->mode;
     if (op != api->state_.global_composite_op) {
       api->state_.global_composite_op = op;
       api->state_.fill_paint.setBlendMode(op);
@@ -1225,9 +1308,9 @@ void CanvasRenderingContext2DApi::SetShadowColor(
   if (!api || !value->IsString()) {
     return;
   }
-  std::string css = api->js()->ToString(value);
+  JsStringView css(info.GetIsolate(), value);
   SkColor color;
-  if (!CSSColorToSkColor(css, &color)) {
+  if (!api->api()->color_cache()->Parse(css.view(), &color)) {
     return;
   }
   State& state = api->state_;
@@ -1381,12 +1464,13 @@ void CanvasRenderingContext2DApi::SetImageSmoothingQuality(
   if (!api || !value->IsString()) {
     return;
   }
-  std::string quality = api->js()->ToString(value);
-  if (quality == "low") {
+  StringId quality = api->js()->MatchConstantString(
+      value, {StringId::low, StringId::medium, StringId::high});
+  if (quality == StringId::low) {
     api->state_.image_smoothing_quality = 0;
-  } else if (quality == "medium") {
+  } else if (quality == StringId::medium) {
     api->state_.image_smoothing_quality = 1;
-  } else if (quality == "high") {
+  } else if (quality == StringId::high) {
     api->state_.image_smoothing_quality = 2;
   } else {
     return;
@@ -1434,17 +1518,18 @@ void CanvasRenderingContext2DApi::DrawText(
     return;
   }
 
-  std::string text = api->js()->ToString(info[0]);
+  JsStringView text(info.GetIsolate(), info[0]);
   double x = info[1].As<v8::Number>()->Value();
   double y = info[2].As<v8::Number>()->Value();
 
   State& state = api->state_;
+  const SkFont& font = api->font();
   if (state.text_align == StringId::center ||
       state.text_align == StringId::right ||
       state.text_align == StringId::end) {
     SkRect bounds = SkRect::MakeEmpty();
-    float advance = state.font.measureText(
-        text.c_str(), text.size(), SkTextEncoding::kUTF8, &bounds, &paint);
+    float advance = font.measureText(text.data(), text.size(),
+                                     SkTextEncoding::kUTF8, &bounds, &paint);
     if (state.text_align == StringId::center) {
       x -= advance / 2;
     } else {
@@ -1454,7 +1539,7 @@ void CanvasRenderingContext2DApi::DrawText(
 
   if (state.text_baseline != StringId::alphabetic) {
     SkFontMetrics metrics;
-    state.font.getMetrics(&metrics);
+    font.getMetrics(&metrics);
     if (state.text_baseline == StringId::top ||
         state.text_baseline == StringId::hanging) {
       y += fabs(metrics.fCapHeight);
@@ -1466,9 +1551,8 @@ void CanvasRenderingContext2DApi::DrawText(
     }
   }
 
-  api->skia_canvas()->drawSimpleText(text.c_str(), text.size(),
-                                     SkTextEncoding::kUTF8, x, y, state.font,
-                                     paint);
+  api->skia_canvas()->drawSimpleText(text.data(), text.size(),
+                                     SkTextEncoding::kUTF8, x, y, font, paint);
 }
 
 // static
@@ -1499,17 +1583,15 @@ void CanvasRenderingContext2DApi::MeasureText(
     return;
   }
 
-  std::string text = api->js()->ToString(info[0]);
-
-  SkRect bounds = SkRect::MakeEmpty();
-  float advance = api->state_.font.measureText(text.c_str(), text.size(),
-                                               SkTextEncoding::kUTF8, &bounds,
-                                               &api->state_.fill_paint);
+  JsStringView text(info.GetIsolate(), info[0]);
+  const FontCache::TextMetrics& text_metrics =
+      api->MeasureWithFont(text.view());
+  const SkRect& bounds = text_metrics.bounds;
 
   JsScope scope(api->js());
 
   v8::Local<v8::Object> metrics = v8::Object::New(scope.isolate);
-  scope.Set(metrics, StringId::width, advance);
+  scope.Set(metrics, StringId::width, text_metrics.width);
   scope.Set(metrics, StringId::actualBoundingBoxAscent, bounds.top());
   scope.Set(metrics, StringId::actualBoundingBoxDescent, bounds.bottom());
   scope.Set(metrics, StringId::actualBoundingBoxLeft, bounds.left());
@@ -1518,6 +1600,126 @@ void CanvasRenderingContext2DApi::MeasureText(
   info.GetReturnValue().Set(metrics);
 }
 
+void CanvasRenderingContext2DApi::MeasureTextBatch(
+    const v8::FunctionCallbackInfo<v8::Value>& info) {
+  CanvasRenderingContext2DApi* api =
+      JsApi::Get(info.GetIsolate())
+          ->GetCanvasRenderingContext2DApi(info.This());
+  if (!api) {
+    return;
+  }
+
+  if (info.Length() < 1 || !info[0]->IsArray() ||
+      (info.Length() >= 2 && !info[1]->IsUndefined() &&
+       !info[1]->IsFloat32Array())) {
+    api->js()->ThrowInvalidArgument();
+    return;
+  }
+
+  JsScope scope(api->js());
+
+  // The width and the 4 bounding box values of each string, in the same order
+  // as the TextMetrics properties.
+  constexpr size_t kStride = 5;
+  v8::Local<v8::Array> strings = info[0].As<v8::Array>();
+  const size_t count = strings->Length();
+
+  v8::Local<v8::Float32Array> out;
+  if (info.Length() >= 2 && info[1]->IsFloat32Array()) {
+    out = info[1].As<v8::Float32Array>();
+    if (out->Length() < count * kStride) {
+      api->js()->ThrowError("Float32Array is too small");
+      return;
+    }
+  } else {
+    v8::Local<v8::ArrayBuffer> buffer =
+        v8::ArrayBuffer::New(scope.isolate, count * kStride * sizeof(float));
+    out = v8::Float32Array::New(buffer, 0, count * kStride);
+  }
+
+  // The store stays valid even if the buffer is detached while reading the
+  // strings.
+  std::shared_ptr<v8::BackingStore> store = out->Buffer()->GetBackingStore();
+  float* data = reinterpret_cast<float*>(static_cast<char*>(store->Data()) +
+                                         out->ByteOffset());
+
+  for (size_t i = 0; i < count; i++) {
+    v8::Local<v8::Value> value;
+    if (!strings->Get(scope.context, i).ToLocal(&value)) {
+      return;
+    }
+    if (!value->IsString()) {
+      api->js()->ThrowInvalidArgument();
+      return;
+    }
+    const FontCache::TextMetrics& metrics =
+        api->MeasureWithFont(JsStringView(scope.isolate, value).view());
+    float* entry = data + i * kStride;
+    entry[0] = metrics.width;
+    entry[1] = metrics.bounds.top();
+    entry[2] = metrics.bounds.bottom();
+    entry[3] = metrics.bounds.left();
+    entry[4] = metrics.bounds.right();
+  }
+
+  info.GetReturnValue().Set(out);
+}
+
+// static
+void CanvasRenderingContext2DApi::PrewarmText(
+    const v8::FunctionCallbackInfo<v8::Value>& info) {
+  CanvasRenderingContext2DApi* api =
+      JsApi::Get(info.GetIsolate())
+          ->GetCanvasRenderingContext2DApi(info.This());
+  if (!api) {
+    return;
+  }
+  if (info.Length() < 2 || !info[0]->IsString() || !info[1]->IsString()) {
+    api->js()->ThrowInvalidArgument();
+    return;
+  }
+
+  FontCache* font_cache = api->api()->font_cache();
+  std::shared_ptr<FontCache::Font> font =
+      font_cache->Get(JsStringView(info.GetIsolate(), info[0]).view());
+  if (!font) {
+    api->js()->ThrowInvalidArgument();
+    return;
+  }
+
+  // The glyphs are resolved like in DrawText, so that they hit the same
+  // entries in the glyph cache.
+  JsStringView text(info.GetIsolate(), info[1]);
+  const SkFont& sk_font = font_cache->Resolve(font.get());
+  std::vector<SkGlyphID> glyphs = GetUniqueGlyphs(sk_font, text.view());
+  api->canvas()->shared_context()->PrewarmGlyphs(sk_font, glyphs.data(),
+                                                 glyphs.size());
+
+  info.GetReturnValue().Set(static_cast<uint32_t>(glyphs.size()));
+}
+
+// static
+void CanvasRenderingContext2DApi::DrawTextLayout(
+    const v8::FunctionCallbackInfo<v8::Value>& info) {
+  JsApi* js_api = JsApi::Get(info.GetIsolate());
+  CanvasRenderingContext2DApi* api =
+      js_api->GetCanvasRenderingContext2DApi(info.This());
+  if (!api) {
+    return;
+  }
+  if (info.Length() < 3 ||
+      !js_api->IsInstanceOf(info[0], js_api->GetTextLayoutConstructor()) ||
+      !info[1]->IsNumber() || !info[2]->IsNumber()) {
+    api->js()->ThrowInvalidArgument();
+    return;
+  }
+
+  TextLayoutApi* layout = js_api->GetTextLayoutApi(info[0]);
+  float x = info[1].As<v8::Number>()->Value();
+  float y = info[2].As<v8::Number>()->Value();
+  layout->layout().Draw(api->skia_canvas(), x, y, api->state_.fill_paint);
+}
+
 // static
 void CanvasRenderingContext2DApi::BeginPath(
     const v8::FunctionCallbackInfo<v8::Value>& info) {
@@ -1804,8 +2006,8 @@ bool CanvasRenderingContext2DApi::ParseFillParameters(
         return false;
       }
 
-      std::string fill_type = js()->ToString(info[index]);
-      if (fill_type == "evenodd") {
+      if (js()->MatchConstantString(info[index], {StringId::evenodd}) ==
+          StringId::evenodd) {
         path->setFillType(SkPathFillType::kEvenOdd);
       } else {
         path->setFillType(SkPathFillType::kWinding);
@@ -1881,8 +2083,8 @@ void CanvasRenderingContext2DApi::IsPointInPath(
   SkPathFillType fill_type = SkPathFillType::kWinding;
 
   if (info.Length() >= 3 && info[2]->IsString()) {
-    std::string rule = api->js()->ToString(info[2]);
-    if (rule == "evenodd") {
+    if (api->js()->MatchConstantString(info[2], {StringId::evenodd}) ==
+        StringId::evenodd) {
       fill_type = SkPathFillType::kEvenOdd;
     }
   }
@@ -2387,7 +2589,8 @@ void CanvasRenderingContext2DApi::DrawImage(
     source_width = source_canvas->canvas()->width();
     source_height = source_canvas->canvas()->height();
     source_image = source_canvas->canvas()->MakeImageSnapshot();
-    ASSERT(source_image->isTextureBacked());
+    ASSERT(api->canvas_shared_context()->IsCompatibleImage(
+        source_image.get()));
   }
 
   float sx = 0;
@@ -2874,7 +3077,7 @@ void ImageDataApi::Decode(const v8::FunctionCallbackInfo<v8::Value>& info) {
           return JsApi::Reject("Failed to decode image");
         }
         return [image](JsApi* api, const JsScope& scope,
-                       v8::Promise::Resolver* resolver) {
+                       v8::Local<v8::Promise::Resolver> resolver) {
           v8::Local<v8::Value> args[] = {
               v8::Number::New(api->isolate(), image->width()),
               v8::Number::New(api->isolate(), image->height()),
@@ -2898,7 +3101,7 @@ void ImageDataApi::Decode(const v8::FunctionCallbackInfo<v8::Value>& info) {
 ImageBitmapApi::ImageBitmapApi(JsApi* api, v8::Local<v8::Object> thiz,
                                sk_sp<SkImage> texture)
     : JsApiWrapper(api->isolate(), thiz), texture_(texture) {
-  ASSERT(texture->isTextureBacked());
+  ASSERT(api->canvas_shared_context()->IsCompatibleImage(texture.get()));
 }
 
 ImageBitmapApi::~ImageBitmapApi() {}
@@ -2975,12 +3178,11 @@ void ImageBitmapApi::Decode(const v8::FunctionCallbackInfo<v8::Value>& info) {
           return JsApi::Reject("Failed to decode image");
         }
         return [image](JsApi* api, const JsScope& scope,
-                       v8::Promise::Resolver* resolver) {
+                       v8::Local<v8::Promise::Resolver> resolver) {
           CanvasSharedContext* context = api->canvas_shared_context();
-          sk_sp<SkImage> texture = image->makeTextureImage(
-              context->skia_context(), GrMipMapped::kNo, skgpu::Budgeted::kNo);
+          sk_sp<SkImage> texture = context->MakeTextureImage(image);
           ASSERT(texture);
-          ASSERT(texture->isTextureBacked());
+          ASSERT(context->IsCompatibleImage(texture.get()));
           v8::Local<v8::Value> args[] = {
               v8::External::New(api->isolate(), texture.release()),
           };
@@ -3116,3 +3318,95 @@ void Path2DApi::Rect(const v8::FunctionCallbackInfo<v8::Value>& info) {
     ::Rect(info, &thiz->path_);
   }
 }
+
+TextLayoutApi::TextLayoutApi(JsApi* api, v8::Local<v8::Object> thiz,
+                             std::unique_ptr<TextLayout> layout)
+    : JsApiWrapper(api->isolate(), thiz), layout_(std::move(layout)) {
+  v8::Isolate* isolate = api->isolate();
+  const TextLayout& layout = *layout_;
+  line_arrays_[0].Reset(isolate,
+                        MakeLineArray<v8::Uint32Array>(
+                            isolate, layout, &TextLayout::Line::start));
+  line_arrays_[1].Reset(isolate,
+                        MakeLineArray<v8::Uint32Array>(
+                            isolate, layout, &TextLayout::Line::end));
+  line_arrays_[2].Reset(isolate,
+                        MakeLineArray<v8::Float32Array>(
+                            isolate, layout, &TextLayout::Line::left));
+  line_arrays_[3].Reset(isolate,
+                        MakeLineArray<v8::Float32Array>(
+                            isolate, layout, &TextLayout::Line::width));
+  line_arrays_[4].Reset(isolate,
+                        MakeLineArray<v8::Float32Array>(
+                            isolate, layout, &TextLayout::Line::baseline));
+}
+
+TextLayoutApi::~TextLayoutApi() {}
+
+// static
+v8::Local<v8::Function> TextLayoutApi::GetConstructor(JsApi* api,
+                                                      const JsScope& scope) {
+  v8::Local<v8::FunctionTemplate> text_layout =
+      v8::FunctionTemplate::New(scope.isolate, NewTextLayout);
+  text_layout->SetClassName(scope.GetConstantString(StringId::TextLayout));
+
+  v8::Local<v8::ObjectTemplate> instance = text_layout->InstanceTemplate();
+  // Used in JsApiWrapper to track this.
+  instance->SetInternalFieldCount(1);
+
+  v8::Local<v8::ObjectTemplate> prototype = text_layout->PrototypeTemplate();
+
+  scope.Set(prototype, StringId::width, GetWidth);
+  scope.Set(prototype, StringId::height, GetHeight);
+  scope.Set(prototype, StringId::lineHeight, GetLineHeight);
+  scope.Set(prototype, StringId::lineStarts, GetLineArray<0>);
+  scope.Set(prototype, StringId::lineEnds, GetLineArray<1>);
+  scope.Set(prototype, StringId::lineLefts, GetLineArray<2>);
+  scope.Set(prototype, StringId::lineWidths, GetLineArray<3>);
+  scope.Set(prototype, StringId::lineBaselines, GetLineArray<4>);
+
+  return text_layout->GetFunction(scope.context).ToLocalChecked();
+}
+
+// static
+void TextLayoutApi::GetWidth(v8::Local<v8::String> property,
+                             const v8::PropertyCallbackInfo<v8::Value>& info) {
+  TextLayoutApi* thiz =
+      JsApi::Get(info.GetIsolate())->GetTextLayoutApi(info.This());
+  if (thiz) {
+    info.GetReturnValue().Set(thiz->layout_->width());
+  }
+}
+
+// static
+void TextLayoutApi::GetHeight(v8::Local<v8::String> property,
+                              const v8::PropertyCallbackInfo<v8::Value>& info) {
+  TextLayoutApi* thiz =
+      JsApi::Get(info.GetIsolate())->GetTextLayoutApi(info.This());
+  if (thiz) {
+    info.GetReturnValue().Set(thiz->layout_->height());
+  }
+}
+
+// static
+void TextLayoutApi::GetLineHeight(
+    v8::Local<v8::String> property,
+    const v8::PropertyCallbackInfo<v8::Value>& info) {
+  TextLayoutApi* thiz =
+      JsApi::Get(info.GetIsolate())->GetTextLayoutApi(info.This());
+  if (thiz) {
+    info.GetReturnValue().Set(thiz->layout_->line_height());
+  }
+}
+
+// static
+template <size_t Index>
+void TextLayoutApi::GetLineArray(
+    v8::Local<v8::String> property,
+    const v8::PropertyCallbackInfo<v8::Value>& info) {
+  TextLayoutApi* thiz =
+      JsApi::Get(info.GetIsolate())->GetTextLayoutApi(info.This());
+  if (thiz) {
+    info.GetReturnValue().Set(thiz->line_arrays_[Index].Get(info.GetIsolate()));
+  }
+}
@@ -14,6 +14,7 @@
 #include "canvas.h"
 #include "js_api.h"
 #include "js_scope.h"
+#include "text_layout.h"
 
 class CanvasGradientApi;
 class CanvasPatternApi;
@@ -158,6 +159,10 @@ class CanvasRenderingContext2DApi final
   static void FillText(const v8::FunctionCallbackInfo<v8::Value>& info);
   static void StrokeText(const v8::FunctionCallbackInfo<v8::Value>& info);
   static void MeasureText(const v8::FunctionCallbackInfo<v8::Value>& info);
+  static void MeasureTextBatch(
+      const v8::FunctionCallbackInfo<v8::Value>& info);
+  static void PrewarmText(const v8::FunctionCallbackInfo<v8::Value>& info);
+  static void DrawTextLayout(const v8::FunctionCallbackInfo<v8::Value>& info);
   static void BeginPath(const v8::FunctionCallbackInfo<v8::Value>& info);
   static void ClosePath(const v8::FunctionCallbackInfo<v8::Value>& info);
   static void MoveTo(const v8::FunctionCallbackInfo<v8::Value>& info);
@@ -198,6 +203,19 @@ class CanvasRenderingContext2DApi final
   static void Encode(const v8::FunctionCallbackInfo<v8::Value>& info);
   static void DrawImage(const v8::FunctionCallbackInfo<v8::Value>& info);
 
+  // Returns the font of the current state. Its typeface is resolved lazily,
+  // and again after new fonts are loaded.
+  const SkFont& font() {
+    return api()->font_cache()->Resolve(state_.font.get());
+  }
+
+  // Measures |text| with the font of the current state. The results are
+  // cached per font.
+  const FontCache::TextMetrics& MeasureWithFont(std::string_view text) {
+    return api()->font_cache()->Measure(state_.font.get(), text,
+                                        &state_.fill_paint);
+  }
+
   std::unique_ptr<Canvas> canvas_;
   int64_t allocated_in_bytes_;
 
@@ -214,7 +232,7 @@ class CanvasRenderingContext2DApi final
     CanvasPatternApi* stroke_pattern = nullptr;
     float global_alpha;
     SkBlendMode global_composite_op;
-    SkFont font;
+    std::shared_ptr<FontCache::Font> font;
     std::vector<float> line_dash;
     float line_dash_offset;
     StringId text_align;
@@ -386,4 +404,32 @@ class Path2DApi final : public JsApiWrapper {
   SkPath path_;
 };
 
+class TextLayoutApi final : public JsApiWrapper {
+ public:
+  TextLayoutApi(JsApi* api, v8::Local<v8::Object> thiz,
+                std::unique_ptr<TextLayout> layout);
+  ~TextLayoutApi() override;
+
+  const TextLayout& layout() const { return *layout_; }
+
+  static v8::Local<v8::Function> GetConstructor(JsApi* api,
+                                                const JsScope& scope);
+
+ private:
+  static void GetWidth(v8::Local<v8::String> property,
+                       const v8::PropertyCallbackInfo<v8::Value>& info);
+  static void GetHeight(v8::Local<v8::String> property,
+                        const v8::PropertyCallbackInfo<v8::Value>& info);
+  static void GetLineHeight(v8::Local<v8::String> property,
+                            const v8::PropertyCallbackInfo<v8::Value>& info);
+  template <size_t Index>
+  static void GetLineArray(v8::Local<v8::String> property,
+                           const v8::PropertyCallbackInfo<v8::Value>& info);
+
+  std::unique_ptr<TextLayout> layout_;
+  // The lineStarts, lineEnds, lineLefts, lineWidths and lineBaselines
+  // arrays, made once so that hit-testing doesn't allocate.
+  v8::Global<v8::Object> line_arrays_[5];
+};
+
 #endif  // WINDOWJS_JS_API_CANVAS_H
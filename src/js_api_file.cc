@@ -1,9 +1,12 @@
 #include "js_api_file.h"
 
+#include "api_counters.h"
 #include "console.h"
 #include "fail.h"
 #include "file.h"
 #include "js_api_canvas.h"
+#include "json.h"
+#include "json_converter.h"
 #include "thread.h"
 
 namespace {
@@ -38,24 +41,162 @@ void ReadJson(const v8::FunctionCallbackInfo<v8::Value>& args) {
   }
   std::string path = api->js()->ToString(args[0]);
 
+  bool incremental = false;
+  if (args.Length() >= 2 && args[1]->IsObject()) {
+    JsScope scope(api->js());
+    v8::Local<v8::Object> options = args[1].As<v8::Object>();
+    v8::Local<v8::Value> value;
+    if (!options
+             ->Get(scope.context,
+                   scope.GetConstantString(StringId::incremental))
+             .ToLocal(&value)) {
+      return;
+    }
+    incremental = value->BooleanValue(scope.isolate);
+  }
+
   args.GetReturnValue().Set(api->PostToBackgroundAndResolve(
-      [p = std::move(path)]() -> JsApi::ResolveFunction {
+      [p = std::move(path), incremental]() -> JsApi::ResolveFunction {
         std::string content;
         std::string error;
         ReadFile(p, &content, &error);
         if (!error.empty()) {
           return JsApi::Reject(std::move(error));
         }
-        return [c = std::move(content)](JsApi* api, const JsScope& scope,
-                                        v8::Promise::Resolver* resolver) {
-          v8::Local<v8::String> s = api->js()->MakeString(std::move(c));
-          // v8::JSON::Parse throws an exception on failures, which gets
-          // propagated to the promise by PostToBackgroundAndResolve.
-          v8::MaybeLocal<v8::Value> value = v8::JSON::Parse(scope.context, s);
-          if (!value.IsEmpty()) {
-            IGNORE_RESULT(
-                resolver->Resolve(scope.context, value.ToLocalChecked()));
-          };
+        // Parsed in this thread, so that the main thread only has to make the
+        // Javascript values.
+        std::shared_ptr<const JsonDocument> document =
+            JsonDocument::Parse(content, &error);
+        if (!document) {
+          return JsApi::Reject("Failed to parse " + p + ": " + error);
+        }
+        return [document = std::move(document), incremental](
+                   JsApi* api, const JsScope& scope,
+                   v8::Local<v8::Promise::Resolver> resolver) {
+          if (incremental) {
+            api->QueueJsonConversion(document, resolver);
+          } else {
+            v8::Local<v8::Value> value =
+                JsonConverter::Convert(document->root(), scope);
+            IGNORE_RESULT(resolver->Resolve(scope.context, value));
+          }
+        };
+      }));
+}
+
+void ReadJsonLines(const v8::FunctionCallbackInfo<v8::Value>& args) {
+  ASSERT(IsMainThread());
+  JsApi* api = JsApi::Get(args.GetIsolate());
+  if (args.Length() < 1 || !args[0]->IsString()) {
+    api->js()->ThrowError("String argument is required.");
+    return;
+  }
+  std::string path = api->js()->ToString(args[0]);
+
+  uint64_t offset = 0;
+  size_t max_lines = 1000;
+  if (args.Length() >= 2 && args[1]->IsObject()) {
+    JsScope scope(api->js());
+    v8::Local<v8::Object> options = args[1].As<v8::Object>();
+    v8::Local<v8::Value> offset_value;
+    v8::Local<v8::Value> max_lines_value;
+    if (!options->Get(scope.context, scope.GetConstantString(StringId::offset))
+             .ToLocal(&offset_value) ||
+        !options
+             ->Get(scope.context, scope.GetConstantString(StringId::maxLines))
+             .ToLocal(&max_lines_value)) {
+      return;
+    }
+    if (!offset_value->IsUndefined()) {
+      if (!offset_value->IsNumber() ||
+          offset_value.As<v8::Number>()->Value() < 0) {
+        api->js()->ThrowInvalidArgument();
+        return;
+      }
+      offset = offset_value.As<v8::Number>()->Value();
+    }
+    if (!max_lines_value->IsUndefined()) {
+      if (!max_lines_value->IsUint32() ||
+          max_lines_value.As<v8::Uint32>()->Value() == 0) {
+        api->js()->ThrowInvalidArgument();
+        return;
+      }
+      max_lines = max_lines_value.As<v8::Uint32>()->Value();
+    }
+  }
+
+  args.GetReturnValue().Set(api->PostToBackgroundAndResolve(
+      [p = std::move(path), offset, max_lines]() -> JsApi::ResolveFunction {
+        // The file is read in chunks, so that only the lines returned are
+        // read and kept in memory.
+        constexpr size_t kChunkSize = 1024 * 1024;
+
+        std::vector<std::shared_ptr<const JsonDocument>> documents;
+        std::string data;
+        // The offset of |data| in the file, and of the next line in |data|.
+        uint64_t data_offset = offset;
+        size_t start = 0;
+        bool eof = false;
+        std::string error;
+        while (documents.size() < max_lines) {
+          std::string_view line;
+          size_t line_offset = start;
+          size_t newline = data.find('\n', start);
+          if (newline != std::string::npos) {
+            line = std::string_view(data).substr(start, newline - start);
+            start = newline + 1;
+          } else if (!eof) {
+            data.erase(0, start);
+            data_offset += start;
+            start = 0;
+            std::string chunk;
+            if (!ReadFileRange(p, data_offset + data.size(), kChunkSize,
+                               &chunk, &error)) {
+              return JsApi::Reject(std::move(error));
+            }
+            eof = chunk.size() < kChunkSize;
+            data.append(chunk);
+            continue;
+          } else if (start < data.size()) {
+            // The last line doesn't need to end with a newline.
+            line = std::string_view(data).substr(start);
+            start = data.size();
+          } else {
+            break;
+          }
+
+          if (line.find_first_not_of(" \t\r") == std::string_view::npos) {
+            continue;
+          }
+          std::shared_ptr<const JsonDocument> document =
+              JsonDocument::Parse(line, &error);
+          if (!document) {
+            return JsApi::Reject(
+                "Failed to parse the line at offset " +
+                std::to_string(data_offset + line_offset) + " of " + p + ": " +
+                error);
+          }
+          documents.push_back(std::move(document));
+        }
+        bool done = eof && start == data.size();
+        uint64_t next_offset = data_offset + start;
+
+        return [documents = std::move(documents), next_offset, done](
+                   JsApi* api, const JsScope& scope,
+                   v8::Local<v8::Promise::Resolver> resolver) {
+          std::vector<v8::Local<v8::Value>> values;
+          values.reserve(documents.size());
+          for (const std::shared_ptr<const JsonDocument>& document :
+               documents) {
+            values.push_back(JsonConverter::Convert(document->root(), scope));
+          }
+          v8::Local<v8::Object> result = v8::Object::New(scope.isolate);
+          scope.SetValue(
+              result, StringId::values,
+              v8::Array::New(scope.isolate, values.data(), values.size()));
+          scope.Set(result, StringId::offset, static_cast<double>(next_offset));
+          scope.Set(result, StringId::done, done);
+          IGNORE_RESULT(resolver->Resolve(scope.context, result));
         };
       }));
 }
@@ -77,8 +218,9 @@ void ReadArrayBuffer(const v8::FunctionCallbackInfo<v8::Value>& args) {
         if (!error.empty()) {
           return JsApi::Reject(std::move(error));
         }
-        return [c = std::move(content)](JsApi* api, const JsScope& scope,
-                                        v8::Promise::Resolver* resolver) {
+        return [c = std::move(content)](
+                   JsApi* api, const JsScope& scope,
+                   v8::Local<v8::Promise::Resolver> resolver) {
           v8::Local<v8::ArrayBuffer> buffer =
               v8::ArrayBuffer::New(scope.isolate, c.size());
           std::memcpy(buffer->GetBackingStore()->Data(), c.data(), c.size());
@@ -109,7 +251,7 @@ void ReadImageData(const v8::FunctionCallbackInfo<v8::Value>& args) {
           return JsApi::Reject("Failed to decode image");
         }
         return [image](JsApi* api, const JsScope& scope,
-                       v8::Promise::Resolver* resolver) {
+                       v8::Local<v8::Promise::Resolver> resolver) {
           v8::Local<v8::Value> args[] = {
               v8::Number::New(api->isolate(), image->width()),
               v8::Number::New(api->isolate(), image->height()),
@@ -152,12 +294,11 @@ void ReadImageBitmap(const v8::FunctionCallbackInfo<v8::Value>& args) {
           return JsApi::Reject("Failed to decode image");
         }
         return [image](JsApi* api, const JsScope& scope,
-                       v8::Promise::Resolver* resolver) {
+                       v8::Local<v8::Promise::Resolver> resolver) {
           CanvasSharedContext* context = api->canvas_shared_context();
-          sk_sp<SkImage> texture = image->makeTextureImage(
-              context->skia_context(), GrMipMapped::kNo, skgpu::Budgeted::kNo);
+          sk_sp<SkImage> texture = context->MakeTextureImage(image);
           ASSERT(texture);
-          ASSERT(texture->isTextureBacked());
+          ASSERT(context->IsCompatibleImage(texture.get()));
           v8::Local<v8::Value> args[] = {
               v8::External::New(api->isolate(), texture.release()),
           };
@@ -302,8 +443,9 @@ void ListFunction(const v8::FunctionCallbackInfo<v8::Value>& args,
         if (!error.empty()) {
           return JsApi::Reject(std::move(error));
         }
-        return [list = std::move(list)](JsApi* api, const JsScope& scope,
-                                        v8::Promise::Resolver* resolver) {
+        return [list = std::move(list)](
+                   JsApi* api, const JsScope& scope,
+                   v8::Local<v8::Promise::Resolver> resolver) {
           std::vector<v8::Local<v8::Value>> elements;
           elements.resize(list.size());
           for (unsigned i = 0; i < list.size(); i++) {
@@ -444,26 +586,34 @@ void GetSep(v8::Local<v8::Name> property,
 v8::Local<v8::Object> MakeFileApi(JsApi* api, const JsScope& scope) {
   v8::Local<v8::Object> file = v8::Object::New(scope.isolate);
 
-  scope.Set(file, StringId::readText, ReadText);
-  scope.Set(file, StringId::readJSON, ReadJson);
-  scope.Set(file, StringId::readArrayBuffer, ReadArrayBuffer);
-  scope.Set(file, StringId::readImageBitmap, ReadImageBitmap);
-  scope.Set(file, StringId::readImageData, ReadImageData);
-  scope.Set(file, StringId::write, Write);
-
-  scope.Set(file, StringId::isDir, IsDir);
-  scope.Set(file, StringId::isFile, IsFile);
-  scope.Set(file, StringId::size, Size);
-
-  scope.Set(file, StringId::list, List);
-  scope.Set(file, StringId::listTree, ListTree);
-  scope.Set(file, StringId::copy, Copy);
-  scope.Set(file, StringId::copyTree, CopyTree);
-  scope.Set(file, StringId::remove, Remove);
-  scope.Set(file, StringId::removeTree, RemoveTree);
-  scope.Set(file, StringId::rename, Rename);
-
-  scope.Set(file, StringId::mkdirs, MkDirs);
+  // Calls to the methods are counted in performance.getApiCounters().
+#define SET_METHOD(name, function) \
+  scope.Set(file, StringId::name,  \
+            CountCalls<ApiCounters::FILE, StringId::name, function>)
+
+  SET_METHOD(readText, ReadText);
+  SET_METHOD(readJSON, ReadJson);
+  SET_METHOD(readJSONLines, ReadJsonLines);
+  SET_METHOD(readArrayBuffer, ReadArrayBuffer);
+  SET_METHOD(readImageBitmap, ReadImageBitmap);
+  SET_METHOD(readImageData, ReadImageData);
+  SET_METHOD(write, Write);
+
+  SET_METHOD(isDir, IsDir);
+  SET_METHOD(isFile, IsFile);
+  SET_METHOD(size, Size);
+
+  SET_METHOD(list, List);
+  SET_METHOD(listTree, ListTree);
+  SET_METHOD(copy, Copy);
+  SET_METHOD(copyTree, CopyTree);
+  SET_METHOD(remove, Remove);
+  SET_METHOD(removeTree, RemoveTree);
+  SET_METHOD(rename, Rename);
+
+  SET_METHOD(mkdirs, MkDirs);
+
+#undef SET_METHOD
 
   scope.Set(file, StringId::cwd, GetCwd);
   scope.Set(file, StringId::home, GetHome);
@@ -158,10 +158,12 @@ void ProcessApi::Spawn(const v8::FunctionCallbackInfo<v8::Value>& info) {
   }
 
   bool headless = false;
+  bool window = true;
   bool log = Args().log;
   if (info.Length() >= 3 && info[2]->IsObject()) {
     v8::Local<v8::Object> options = info[2].As<v8::Object>();
     headless = api->js()->GetBooleanOr(options, "headless", headless);
+    window = api->js()->GetBooleanOr(options, "window", window);
     if (log) {
       log = api->js()->GetBooleanOr(options, "log", log);
     }
@@ -172,12 +174,15 @@ void ProcessApi::Spawn(const v8::FunctionCallbackInfo<v8::Value>& info) {
   ASSERT(error.empty());
 
   std::vector<std::string> args;
-  args.reserve(6 + args_to_js.size());
+  args.reserve(7 + args_to_js.size());
   args.emplace_back(Basename(exe).string());
   args.emplace_back("--child");
   if (headless) {
     args.emplace_back("--headless");
   }
+  if (!window) {
+    args.emplace_back("--no-window");
+  }
   if (!log) {
     args.emplace_back("--no-log");
   }
@@ -256,8 +261,7 @@ void ProcessApi::Exit(const v8::FunctionCallbackInfo<v8::Value>& info) {
 #endif
   } else {
     JsApi* api = JsApi::Get(info.GetIsolate());
-    glfwSetWindowShouldClose(api->glfw_window(), GLFW_TRUE);
-    glfwPostEmptyEvent();
+    api->window()->Close();
   }
 }
 
@@ -1,10 +1,16 @@
 #include "js_events.h"
 
+#include <cmath>
+
 #include <GLFW/glfw3.h>
 
+#include "clock.h"
 #include "fail.h"
+#include "js_api.h"
 
-JsEventType GetEventType(const std::string& type) {
+namespace {
+
+const std::unordered_map<std::string, JsEventType>& GetEventTypes() {
   static const std::unordered_map<std::string, JsEventType> types{
       {"keydown", JsEventType::KEYDOWN},
       {"keyup", JsEventType::KEYUP},
@@ -28,12 +34,29 @@ JsEventType GetEventType(const std::string& type) {
       {"log", JsEventType::CHILD_LOG},
       {"exception", JsEventType::CHILD_EXCEPTION},
       {"exit", JsEventType::CHILD_EXIT},
+      {"longtask", JsEventType::LONGTASK},
   };
+  return types;
+}
+
+}  // namespace
+
+JsEventType GetEventType(const std::string& type) {
+  const auto& types = GetEventTypes();
   auto it = types.find(type);
   return it == types.end() ? JsEventType::NO_EVENT : it->second;
 }
 
-JsEvents::JsEvents() {}
+std::string GetEventTypeName(JsEventType type) {
+  for (const auto& [name, t] : GetEventTypes()) {
+    if (t == type) {
+      return name;
+    }
+  }
+  return "";
+}
+
+JsEvents::JsEvents() : long_tasks_(nullptr) {}
 
 JsEvents::~JsEvents() {}
 
@@ -79,8 +102,17 @@ bool JsEvents::Dispatch(JsEventType type, v8::Local<v8::Value> event,
   bool any_handled = false;
   for (const auto& listener : listeners) {
     v8::Local<v8::Function> f = listener.Get(scope.isolate);
+    double start = GetClockTime();
     v8::MaybeLocal<v8::Value> result =
         f->Call(scope.context, scope.context->Global(), 1, argv);
+    double duration = GetClockTime() - start;
+    // Slow longtask listeners aren't reported, so that they don't keep
+    // reporting themselves.
+    if (long_tasks_ && long_tasks_->IsLong(duration) &&
+        type != JsEventType::LONGTASK) {
+      long_tasks_->Report(GetEventTypeName(type),
+                          DescribeFunction(scope.isolate, f), start, duration);
+    }
     v8::Local<v8::Value> value;
     if (result.ToLocal(&value) && value->BooleanValue(scope.isolate)) {
       any_handled = true;
@@ -89,8 +121,94 @@ bool JsEvents::Dispatch(JsEventType type, v8::Local<v8::Value> event,
   return any_handled;
 }
 
+JsEventTemplates::JsEventTemplates() {}
+
+JsEventTemplates::~JsEventTemplates() {}
+
+v8::Local<v8::Object> JsEventTemplates::NewInstance(Shape shape,
+                                                    const JsScope& scope) {
+  v8::Global<v8::ObjectTemplate>& global = templates_[shape];
+  if (global.IsEmpty()) {
+    global.Reset(scope.isolate, MakeTemplate(shape, scope));
+  }
+  return global.Get(scope.isolate)->NewInstance(scope.context).ToLocalChecked();
+}
+
+v8::Local<v8::ObjectTemplate> JsEventTemplates::MakeTemplate(
+    Shape shape, const JsScope& scope) const {
+  v8::Local<v8::ObjectTemplate> t = v8::ObjectTemplate::New(scope.isolate);
+
+  // The placeholders have the same types as the final values, so that the
+  // field representations in the hidden class don't change afterwards.
+  // The properties are listed in the same order as they're set in the Make*
+  // functions below.
+  v8::Local<v8::Value> string = scope.GetConstantString(StringId::_EMPTY_);
+  v8::Local<v8::Value> boolean = v8::False(scope.isolate);
+  v8::Local<v8::Value> integer = v8::Integer::New(scope.isolate, 0);
+  v8::Local<v8::Value> number = v8::Number::New(scope.isolate, NAN);
+
+  auto add = [&](StringId id, v8::Local<v8::Value> value) {
+    t->Set(scope.GetConstantString(id), value);
+  };
+
+  add(StringId::type, string);
+
+  // Input events also carry the time when they were received.
+  if (shape != EVENT) {
+    add(StringId::timeStamp, number);
+  }
+
+  switch (shape) {
+    case EVENT:
+      break;
+    case KEY:
+      add(StringId::repeat, boolean);
+      add(StringId::altKey, boolean);
+      add(StringId::ctrlKey, boolean);
+      add(StringId::metaKey, boolean);
+      add(StringId::shiftKey, boolean);
+      add(StringId::location, integer);
+      add(StringId::key, string);
+      add(StringId::code, string);
+      break;
+    case KEYPRESS:
+      add(StringId::code, integer);
+      break;
+    case MOUSE_BUTTON:
+      add(StringId::x, number);
+      add(StringId::y, number);
+      add(StringId::clientX, number);
+      add(StringId::clientY, number);
+      add(StringId::button, integer);
+      break;
+    case MOUSE_MOVE:
+      add(StringId::x, number);
+      add(StringId::y, number);
+      add(StringId::clientX, number);
+      add(StringId::clientY, number);
+      add(StringId::offsetX, number);
+      add(StringId::offsetY, number);
+      break;
+    case MOUSE_WHEEL:
+      add(StringId::deltaX, number);
+      add(StringId::deltaY, number);
+      break;
+    case LAST_SHAPE:
+      ASSERT(false);
+      break;
+  }
+
+  return t;
+}
+
 namespace {
 
+v8::Local<v8::Object> NewEvent(JsEventTemplates::Shape shape,
+                               const JsScope& scope) {
+  JsApi* api = JsApi::Get(scope.isolate);
+  return api->event_templates()->NewInstance(shape, scope);
+}
+
 int GetLocation(int key) {
   switch (key) {
     case GLFW_KEY_LEFT_ALT:
@@ -237,6 +355,8 @@ StringId GetKey(int key) {
   return StringId::Unidentified;
 }
 
+}  // namespace
+
 StringId GetCode(int key) {
   switch (key) {
     case GLFW_KEY_SPACE: return StringId::Space;
@@ -365,18 +485,16 @@ StringId GetCode(int key) {
   return StringId::Unidentified;
 }
 
-}  // namespace
-
 v8::Local<v8::Object> MakeEvent(StringId type, const JsScope& scope) {
-  v8::Local<v8::Object> event = v8::Object::New(scope.isolate);
+  v8::Local<v8::Object> event = NewEvent(JsEventTemplates::EVENT, scope);
   scope.Set(event, StringId::type, type);
   event->SetIntegrityLevel(scope.context, v8::IntegrityLevel::kFrozen);
   return event;
 }
 
 v8::Local<v8::Value> MakeKeyEvent(int key, int scancode, int action, int mods,
-                                  const JsScope& scope) {
-  v8::Local<v8::Object> event = v8::Object::New(scope.isolate);
+                                  double timestamp, const JsScope& scope) {
+  v8::Local<v8::Object> event = NewEvent(JsEventTemplates::KEY, scope);
 
   StringId type = StringId::keydown;
   bool repeat = false;
@@ -395,6 +513,7 @@ v8::Local<v8::Value> MakeKeyEvent(int key, int scancode, int action, int mods,
   }
 
   scope.Set(event, StringId::type, type);
+  scope.Set(event, StringId::timeStamp, timestamp * 1000);
   scope.Set(event, StringId::repeat, repeat);
   scope.Set(event, StringId::altKey, (mods & GLFW_MOD_ALT) != 0);
   scope.Set(event, StringId::ctrlKey, (mods & GLFW_MOD_CONTROL) != 0);
@@ -410,10 +529,12 @@ v8::Local<v8::Value> MakeKeyEvent(int key, int scancode, int action, int mods,
 }
 
 v8::Local<v8::Object> MakeKeyPressEvent(unsigned int codepoint,
+                                        double timestamp,
                                         const JsScope& scope) {
-  v8::Local<v8::Object> event = v8::Object::New(scope.isolate);
+  v8::Local<v8::Object> event = NewEvent(JsEventTemplates::KEYPRESS, scope);
 
   scope.Set(event, StringId::type, StringId::keypress);
+  scope.Set(event, StringId::timeStamp, timestamp * 1000);
   scope.Set(event, StringId::code, (int) codepoint);
 
   event->SetIntegrityLevel(scope.context, v8::IntegrityLevel::kFrozen);
@@ -423,8 +544,9 @@ v8::Local<v8::Object> MakeKeyPressEvent(unsigned int codepoint,
 
 v8::Local<v8::Object> MakeMouseButtonEvent(JsEventType type, int button,
                                            double x, double y,
+                                           double timestamp,
                                            const JsScope& scope) {
-  v8::Local<v8::Object> event = v8::Object::New(scope.isolate);
+  v8::Local<v8::Object> event = NewEvent(JsEventTemplates::MOUSE_BUTTON, scope);
 
   StringId type_id = StringId::LAST_STRING_ID;
   if (type == JsEventType::MOUSEDOWN) {
@@ -438,6 +560,7 @@ v8::Local<v8::Object> MakeMouseButtonEvent(JsEventType type, int button,
   }
 
   scope.Set(event, StringId::type, type_id);
+  scope.Set(event, StringId::timeStamp, timestamp * 1000);
   scope.Set(event, StringId::x, x);
   scope.Set(event, StringId::y, y);
   scope.Set(event, StringId::clientX, x);
@@ -457,11 +580,12 @@ v8::Local<v8::Object> MakeMouseButtonEvent(JsEventType type, int button,
   return event;
 }
 
-v8::Local<v8::Object> MakeMouseMoveEvent(double x, double y,
+v8::Local<v8::Object> MakeMouseMoveEvent(double x, double y, double timestamp,
                                          const JsScope& scope) {
-  v8::Local<v8::Object> event = v8::Object::New(scope.isolate);
+  v8::Local<v8::Object> event = NewEvent(JsEventTemplates::MOUSE_MOVE, scope);
 
   scope.Set(event, StringId::type, StringId::mousemove);
+  scope.Set(event, StringId::timeStamp, timestamp * 1000);
   scope.Set(event, StringId::x, x);
   scope.Set(event, StringId::y, y);
   scope.Set(event, StringId::clientX, x);
@@ -474,11 +598,12 @@ v8::Local<v8::Object> MakeMouseMoveEvent(double x, double y,
   return event;
 }
 
-v8::Local<v8::Object> MakeMouseWheelEvent(double x, double y,
+v8::Local<v8::Object> MakeMouseWheelEvent(double x, double y, double timestamp,
                                           const JsScope& scope) {
-  v8::Local<v8::Object> event = v8::Object::New(scope.isolate);
+  v8::Local<v8::Object> event = NewEvent(JsEventTemplates::MOUSE_WHEEL, scope);
 
   scope.Set(event, StringId::type, StringId::wheel);
+  scope.Set(event, StringId::timeStamp, timestamp * 1000);
   scope.Set(event, StringId::deltaX, x);
   scope.Set(event, StringId::deltaY, y);
 
@@ -519,6 +644,18 @@ v8::Local<v8::Object> MakeExceptionEvent(std::string error,
   return event;
 }
 
+v8::Local<v8::Object> MakeLongTaskEvent(const LongTasks::Task& task,
+                                        const JsScope& scope) {
+  v8::Local<v8::Object> event = v8::Object::New(scope.isolate);
+  scope.Set(event, StringId::type, StringId::longtask);
+  scope.SetValue(event, StringId::name, scope.MakeString(task.name));
+  scope.SetValue(event, StringId::source, scope.MakeString(task.source));
+  scope.Set(event, StringId::startTime, task.start * 1000);
+  scope.Set(event, StringId::duration, task.duration * 1000);
+  event->SetIntegrityLevel(scope.context, v8::IntegrityLevel::kFrozen);
+  return event;
+}
+
 v8::Local<v8::Object> MakeExitEvent(std::string error, int64_t status,
                                     const JsScope& scope) {
   v8::Local<v8::Object> event = v8::Object::New(scope.isolate);
@@ -1,6 +1,7 @@
 #ifndef WINDOWJS_JS_EVENTS_H
 #define WINDOWJS_JS_EVENTS_H
 
+#include <array>
 #include <string>
 #include <unordered_map>
 #include <vector>
@@ -8,6 +9,7 @@
 #include <v8/include/v8.h>
 
 #include "js_scope.h"
+#include "long_tasks.h"
 
 enum class JsEventType {
   KEYDOWN,
@@ -32,10 +34,12 @@ enum class JsEventType {
   CHILD_LOG,
   CHILD_EXCEPTION,
   CHILD_EXIT,
+  LONGTASK,
   NO_EVENT,  // Must be the last entry; this is also the number of JsEventTypes.
 };
 
 JsEventType GetEventType(const std::string& type);
+std::string GetEventTypeName(JsEventType type);
 
 class JsEvents final {
  public:
@@ -53,30 +57,72 @@ class JsEvents final {
 
   bool HasListeners(JsEventType type) const;
 
+  // Listeners that take longer than its threshold are reported to
+  // |long_tasks|, which must outlive this.
+  void SetLongTasks(LongTasks* long_tasks) { long_tasks_ = long_tasks; }
+
   // Returns "true" if any listener returned true.
   bool Dispatch(JsEventType type, v8::Local<v8::Value> event,
                 const JsScope& scope);
 
  private:
   std::unordered_map<JsEventType, Listeners> listeners_;
+  LongTasks* long_tasks_;
 };
 
+// The events that are created on every frame for input have a fixed shape.
+// Their ObjectTemplates are cached here, so that V8 creates all instances of
+// each event with the same hidden class and all of its properties in a single
+// allocation, instead of adding the properties one by one.
+class JsEventTemplates final {
+ public:
+  enum Shape {
+    EVENT,
+    KEY,
+    KEYPRESS,
+    MOUSE_BUTTON,
+    MOUSE_MOVE,
+    MOUSE_WHEEL,
+    LAST_SHAPE,
+  };
+
+  JsEventTemplates();
+  ~JsEventTemplates();
+
+  // Returns a new object with all the properties of "shape", set to
+  // placeholder values.
+  v8::Local<v8::Object> NewInstance(Shape shape, const JsScope& scope);
+
+ private:
+  v8::Local<v8::ObjectTemplate> MakeTemplate(Shape shape,
+                                             const JsScope& scope) const;
+
+  std::array<v8::Global<v8::ObjectTemplate>, LAST_SHAPE> templates_;
+};
+
+// Returns the KeyboardEvent.code for a GLFW key code.
+StringId GetCode(int key);
+
 v8::Local<v8::Object> MakeEvent(StringId type, const JsScope& scope);
 
+// The timestamps of input events are in seconds, from GetClockTime().
+
 v8::Local<v8::Value> MakeKeyEvent(int key, int scancode, int action, int mods,
-                                  const JsScope& scope);
+                                  double timestamp, const JsScope& scope);
 
 v8::Local<v8::Object> MakeKeyPressEvent(unsigned int codepoint,
+                                        double timestamp,
                                         const JsScope& scope);
 
 v8::Local<v8::Object> MakeMouseButtonEvent(JsEventType type, int button,
                                            double x, double y,
+                                           double timestamp,
                                            const JsScope& scope);
 
-v8::Local<v8::Object> MakeMouseMoveEvent(double x, double y,
+v8::Local<v8::Object> MakeMouseMoveEvent(double x, double y, double timestamp,
                                          const JsScope& scope);
 
-v8::Local<v8::Object> MakeMouseWheelEvent(double x, double y,
+v8::Local<v8::Object> MakeMouseWheelEvent(double x, double y, double timestamp,
                                           const JsScope& scope);
 
 v8::Local<v8::Object> MakeDropEvent(std::vector<std::string> paths,
@@ -88,6 +134,9 @@ v8::Local<v8::Object> MakeLogEvent(std::string log, std::string level,
 v8::Local<v8::Object> MakeExceptionEvent(std::string error,
                                          const JsScope& scope);
 
+v8::Local<v8::Object> MakeLongTaskEvent(const LongTasks::Task& task,
+                                        const JsScope& scope);
+
 v8::Local<v8::Object> MakeExitEvent(std::string error, int64_t status,
                                     const JsScope& scope);
 
@@ -0,0 +1,54 @@
+#include "js_string_view.h"
+
+#include <stdint.h>
+
+#include "js.h"
+
+namespace {
+
+bool IsASCII(const char* s, int size) {
+  for (int i = 0; i < size; i++) {
+    if (static_cast<unsigned char>(s[i]) >= 0x80) {
+      return false;
+    }
+  }
+  return true;
+}
+
+}  // namespace
+
+JsStringView::JsStringView(v8::Isolate* isolate, v8::Local<v8::Value> value) {
+  if (!value->IsString()) {
+    heap_ = Js::Get(isolate)->ToString(value);
+    view_ = heap_;
+    return;
+  }
+
+  v8::Local<v8::String> string = value.As<v8::String>();
+  const int length = string->Length();
+  if (length <= kStackSize) {
+    if (string->IsOneByte()) {
+      // One byte strings are Latin-1, which is also UTF-8 if it's ASCII.
+      string->WriteOneByte(isolate, reinterpret_cast<uint8_t*>(stack_), 0,
+                           length, v8::String::NO_NULL_TERMINATION);
+      if (IsASCII(stack_, length)) {
+        view_ = std::string_view(stack_, length);
+        return;
+      }
+    }
+    // Each character can take up to 3 bytes, so this may not fit. WriteUtf8
+    // only writes whole characters, and returns how many it wrote.
+    int written = 0;
+    int size = string->WriteUtf8(isolate, stack_, kStackSize, &written,
+                                 v8::String::NO_NULL_TERMINATION);
+    if (written == length) {
+      view_ = std::string_view(stack_, size);
+      return;
+    }
+  }
+
+  heap_.resize(string->Utf8Length(isolate));
+  string->WriteUtf8(isolate, heap_.data(), heap_.size(), nullptr,
+                    v8::String::NO_NULL_TERMINATION);
+  view_ = heap_;
+}
@@ -0,0 +1,43 @@
+#ifndef WINDOWJS_JS_STRING_VIEW_H
+#define WINDOWJS_JS_STRING_VIEW_H
+
+#include <stddef.h>
+
+#include <string>
+#include <string_view>
+
+#include <v8/include/v8.h>
+
+// The UTF-8 contents of a Javascript value, for arguments that are only needed
+// during a call, like a CSS color or the text to draw:
+//
+//   JsStringView css(isolate, value);
+//   color_cache->Parse(css.view(), &color);
+//
+// Js::ToString() measures the UTF-8 length and then writes a new std::string.
+// This writes short strings to a buffer on the stack instead. Strings with
+// one byte per character are copied as is when they are ASCII, which is the
+// common case.
+class JsStringView final {
+ public:
+  // Longer strings are written to the heap.
+  static constexpr int kStackSize = 256;
+
+  // Values that aren't strings are converted like Js::ToString() does.
+  JsStringView(v8::Isolate* isolate, v8::Local<v8::Value> value);
+
+  JsStringView(const JsStringView&) = delete;
+  JsStringView& operator=(const JsStringView&) = delete;
+
+  // Only valid while this object is alive.
+  std::string_view view() const { return view_; }
+  const char* data() const { return view_.data(); }
+  size_t size() const { return view_.size(); }
+
+ private:
+  char stack_[kStackSize];
+  std::string heap_;
+  std::string_view view_;
+};
+
+#endif  // WINDOWJS_JS_STRING_VIEW_H
@@ -1,15 +1,16 @@
 #include "js_strings.h"
 
-JsStrings::JsStrings(v8::Isolate* isolate) {
-#define SET_STRING(string)                          \
-  strings_[static_cast<int>(StringId::string)].Set( \
-      isolate, v8::String::NewFromUtf8Literal(      \
-                   isolate, #string, v8::NewStringType::kInternalized))
+#include <string.h>
 
-#define SET_SPECIAL(name, string)                 \
-  strings_[static_cast<int>(StringId::name)].Set( \
-      isolate, v8::String::NewFromUtf8Literal(    \
-                   isolate, string, v8::NewStringType::kInternalized))
+#include "clock.h"
+#include "fail.h"
+
+JsStrings::JsStrings() : names_{}, made_count_(0), made_time_(0) {
+  // Only the names are set here. The v8 strings are made on first use.
+#define SET_STRING(string) names_[static_cast<int>(StringId::string)] = #string
+
+#define SET_SPECIAL(name, string) \
+  names_[static_cast<int>(StringId::name)] = string
 
   SET_STRING(a);
   SET_STRING(actualBoundingBoxAscent);
@@ -42,6 +43,9 @@ JsStrings::JsStrings(v8::Isolate* isolate) {
   SET_STRING(base64ToArrayBuffer);
   SET_STRING(basename);
   SET_STRING(beginPath);
+  SET_STRING(benchmarkColors);
+  SET_STRING(benchmarkEvents);
+  SET_STRING(benchmarkJson);
   SET_STRING(bevel);
   SET_STRING(bezierCurveTo);
   SET_STRING(blur);
@@ -51,6 +55,7 @@ JsStrings::JsStrings(v8::Isolate* isolate) {
   SET_STRING(butt);
   SET_STRING(button);
   SET_STRING(c);
+  SET_STRING(cache);
   SET_STRING(cancelAnimationFrame);
   SET_STRING(canvas);
   SET_STRING(CanvasGradient);
@@ -58,6 +63,9 @@ JsStrings::JsStrings(v8::Isolate* isolate) {
   SET_STRING(CanvasRenderingContext2D);
   SET_STRING(CapsLock);
   SET_STRING(center);
+  SET_STRING(characters);
+  SET_STRING(clearMarks);
+  SET_STRING(clearMeasures);
   SET_STRING(clearRect);
   SET_STRING(clearTimeout);
   SET_STRING(click);
@@ -68,6 +76,7 @@ JsStrings::JsStrings(v8::Isolate* isolate) {
   SET_STRING(closePath);
   SET_STRING(code);
   SET_STRING(Codec);
+  SET_STRING(codes);
   SET_STRING(color);
   SET_STRING(Comma);
   SET_STRING(content);
@@ -77,6 +86,7 @@ JsStrings::JsStrings(v8::Isolate* isolate) {
   SET_STRING(ControlRight);
   SET_STRING(copy);
   SET_STRING(copyTree);
+  SET_STRING(count);
   SET_STRING(cpus);
   SET_STRING(createImageData);
   SET_STRING(createLinearGradient);
@@ -110,17 +120,23 @@ JsStrings::JsStrings(v8::Isolate* isolate) {
   SET_STRING(Digit8);
   SET_STRING(Digit9);
   SET_STRING(dirname);
+  SET_STRING(dispatch);
+  SET_STRING(done);
   SET_STRING(drawImage);
+  SET_STRING(drawTextLayout);
   SET_STRING(drop);
+  SET_STRING(duration);
   SET_STRING(e);
   SET_STRING(ellipse);
   SET_STRING(encode);
   SET_STRING(end);
   SET_STRING(End);  // Keep after | sort | uniq.
   SET_STRING(Enter);
+  SET_STRING(entryType);
   SET_STRING(Equal);
   SET_STRING(error);
   SET_STRING(Escape);
+  SET_STRING(evenodd);
   SET_STRING(exception);
   SET_STRING(exclusion);
   SET_STRING(exit);
@@ -151,6 +167,7 @@ JsStrings::JsStrings(v8::Isolate* isolate) {
   SET_STRING(F8);
   SET_STRING(F9);
   SET_STRING(File);
+  SET_STRING(file);
   SET_STRING(files);
   SET_STRING(fill);
   SET_STRING(fillRect);
@@ -160,21 +177,35 @@ JsStrings::JsStrings(v8::Isolate* isolate) {
   SET_STRING(focused);
   SET_STRING(font);
   SET_STRING(fonts);
+  SET_STRING(formatDir);
+  SET_STRING(formatLog);
+  SET_STRING(frame);
   SET_STRING(frameBottom);
   SET_STRING(frameLeft);
   SET_STRING(frameRight);
+  SET_STRING(frames);
   SET_STRING(frameTop);
   SET_STRING(fullscreen);
   SET_STRING(g);
+  SET_STRING(gc);
+  SET_STRING(getApiCounters);
   SET_STRING(getClipboardText);
+  SET_STRING(getEntriesByName);
+  SET_STRING(getFrameStats);
   SET_STRING(getImageData);
+  SET_STRING(getInputLatency);
   SET_STRING(getLineDash);
   SET_STRING(getTransform);
   SET_STRING(globalAlpha);
   SET_STRING(globalCompositeOperation);
+  SET_STRING(glyphCache);
   SET_STRING(h);
   SET_STRING(hanging);
   SET_STRING(height);
+  SET_STRING(high);
+  SET_STRING(histogramBounds);
+  SET_STRING(histograms);
+  SET_STRING(history);
   SET_STRING(Home);
   SET_STRING(home);
   SET_STRING(hue);
@@ -185,12 +216,15 @@ JsStrings::JsStrings(v8::Isolate* isolate) {
   SET_STRING(imageSmoothingQuality);
   SET_STRING(ImageBitmap);
   SET_STRING(ImageData);
+  SET_STRING(incremental);
+  SET_STRING(input);
   SET_STRING(Insert);
   SET_STRING(isDir);
   SET_STRING(isFile);
   SET_STRING(isPointInPath);
   SET_STRING(isPointInStroke);
   SET_STRING(j);
+  SET_STRING(jank);
   SET_STRING(js);
   SET_STRING(jsHeapSizeLimit);
   SET_STRING(k);
@@ -217,6 +251,7 @@ JsStrings::JsStrings(v8::Isolate* isolate) {
   SET_STRING(KeyQ);
   SET_STRING(KeyR);
   SET_STRING(KeyS);
+  SET_STRING(keys);
   SET_STRING(KeyT);
   SET_STRING(KeyU);
   SET_STRING(keyup);
@@ -227,24 +262,45 @@ JsStrings::JsStrings(v8::Isolate* isolate) {
   SET_STRING(KeyZ);
   SET_STRING(l);
   SET_STRING(left);
+  SET_STRING(legacyParse);
+  SET_STRING(legacyWrite);
   SET_STRING(level);
   SET_STRING(lighten);
   SET_STRING(lighter);
+  SET_STRING(limit);
+  SET_STRING(lineBaselines);
   SET_STRING(lineCap);
   SET_STRING(lineDashOffset);
+  SET_STRING(lineEnds);
+  SET_STRING(lineHeight);
   SET_STRING(lineJoin);
+  SET_STRING(lineLefts);
+  SET_STRING(lineStarts);
   SET_STRING(lineTo);
   SET_STRING(lineWidth);
+  SET_STRING(lineWidths);
   SET_STRING(list);
   SET_STRING(listTree);
   SET_STRING(loadFont);
+  SET_STRING(loadFonts);
   SET_STRING(location);
   SET_STRING(log);
+  SET_STRING(longtask);
+  SET_STRING(longTasks);
+  SET_STRING(longTaskThreshold);
+  SET_STRING(low);
   SET_STRING(luminosity);
   SET_STRING(m);
+  SET_STRING(mark);
+  SET_STRING(max);
+  SET_STRING(maxDuration);
   SET_STRING(maximize);
   SET_STRING(maximized);
+  SET_STRING(maxLines);
+  SET_STRING(measure);
   SET_STRING(measureText);
+  SET_STRING(measureTextBatch);
+  SET_STRING(medium);
   SET_STRING(memory);
   SET_STRING(message);
   SET_STRING(Meta);
@@ -266,6 +322,8 @@ JsStrings::JsStrings(v8::Isolate* isolate) {
   SET_STRING(moveTo);
   SET_STRING(multiply);
   SET_STRING(n);
+  SET_STRING(name);
+  SET_STRING(native);
   SET_STRING(now);
   SET_STRING(NumLock);
   SET_STRING(Numpad0);
@@ -285,21 +343,33 @@ JsStrings::JsStrings(v8::Isolate* isolate) {
   SET_STRING(NumpadMultiply);
   SET_STRING(NumpadSubtract);
   SET_STRING(o);
+  SET_STRING(Object);
+  SET_STRING(offset);
   SET_STRING(offsetX);
   SET_STRING(offsetY);
   SET_STRING(open);
   SET_STRING(overlay);
   SET_STRING(overlayConsoleTextColor);
   SET_STRING(p);
+  SET_STRING(p50);
+  SET_STRING(p90);
+  SET_STRING(p99);
   SET_STRING(PageDown);
   SET_STRING(PageUp);
   SET_STRING(parent);
+  SET_STRING(parse);
+  SET_STRING(parser);
+  SET_STRING(path);
   SET_STRING(Path2D);
   SET_STRING(Pause);
   SET_STRING(performance);
   SET_STRING(Period);
   SET_STRING(platform);
+  SET_STRING(pointer);
   SET_STRING(postMessage);
+  SET_STRING(pressed);
+  SET_STRING(prewarmFonts);
+  SET_STRING(prewarmText);
   SET_STRING(PrintScreen);
   SET_STRING(Process);
   SET_STRING(profileFrameTimes);
@@ -308,12 +378,17 @@ JsStrings::JsStrings(v8::Isolate* isolate) {
   SET_STRING(quadraticCurveTo);
   SET_STRING(Quote);
   SET_STRING(r);
+  SET_STRING(raf);
   SET_STRING(readArrayBuffer);
   SET_STRING(readImageBitmap);
   SET_STRING(readImageData);
   SET_STRING(readJSON);
+  SET_STRING(readJSONLines);
   SET_STRING(readText);
   SET_STRING(rect);
+  SET_STRING(refreshInterval);
+  SET_STRING(regex);
+  SET_STRING(released);
   SET_STRING(remove);
   SET_STRING(removeEventListener);
   SET_STRING(removeTree);
@@ -321,15 +396,18 @@ JsStrings::JsStrings(v8::Isolate* isolate) {
   SET_STRING(repeat);
   SET_STRING(requestAnimationFrame);
   SET_STRING(requestAttention);
+  SET_STRING(resetFrameStats);
   SET_STRING(resetTransform);
   SET_STRING(resizable);
   SET_STRING(resize);
   SET_STRING(restore);
   SET_STRING(retinaScale);
+  SET_STRING(rewriteJson);
   SET_STRING(right);
   SET_STRING(rotate);
   SET_STRING(round);
   SET_STRING(s);
+  SET_STRING(sampleIntervalUs);
   SET_STRING(saturation);
   SET_STRING(save);
   SET_STRING(scale);
@@ -355,35 +433,46 @@ JsStrings::JsStrings(v8::Isolate* isolate) {
   SET_STRING(showOverlayStats);
   SET_STRING(size);
   SET_STRING(Slash);
+  SET_STRING(source);
   SET_STRING(Space);
   SET_STRING(spawn);
   SET_STRING(square);
   SET_STRING(start);
+  SET_STRING(startProfiling);
+  SET_STRING(startTime);
   SET_STRING(status);
+  SET_STRING(stopProfiling);
   SET_STRING(stroke);
   SET_STRING(strokeRect);
   SET_STRING(strokeStyle);
   SET_STRING(strokeText);
+  SET_STRING(swap);
   SET_STRING(t);
   SET_STRING(Tab);
   SET_STRING(textAlign);
   SET_STRING(textBaseline);
+  SET_STRING(TextLayout);
+  SET_STRING(timeStamp);
   SET_STRING(title);
   SET_STRING(tmp);
   SET_STRING(toBase64);
   SET_STRING(top);
+  SET_STRING(total);
   SET_STRING(totalJSHeapSize);
   SET_STRING(transform);
   SET_STRING(translate);
   SET_STRING(type);
   SET_STRING(u);
   SET_STRING(Unidentified);
+  SET_STRING(used);
   SET_STRING(usedJSHeapSize);
   SET_STRING(v);
+  SET_STRING(values);
   SET_STRING(version);
   SET_STRING(visible);
   SET_STRING(vsync);
   SET_STRING(w);
+  SET_STRING(wait);
   SET_STRING(wheel);
   SET_STRING(width);
   SET_STRING(window);
@@ -435,3 +524,40 @@ JsStrings::JsStrings(v8::Isolate* isolate) {
 }
 
 JsStrings::~JsStrings() {}
+
+v8::Local<v8::String> JsStrings::MakeConstantString(StringId id,
+                                                    v8::Isolate* isolate) {
+  const double start = GetClockTime();
+  const char* name = GetName(id);
+  ASSERT(name);
+  v8::Local<v8::String> string =
+      v8::String::NewFromUtf8(isolate, name, v8::NewStringType::kInternalized,
+                              strlen(name))
+          .ToLocalChecked();
+  strings_[static_cast<int>(id)].Set(isolate, string);
+  made_count_++;
+  made_time_ += GetClockTime() - start;
+  return string;
+}
+
+StringId JsStrings::Match(v8::Local<v8::Value> value,
+                          std::initializer_list<StringId> ids,
+                          v8::Isolate* isolate) {
+  for (StringId id : ids) {
+    if (value == GetConstantString(id, isolate)) {
+      return id;
+    }
+  }
+  for (StringId id : ids) {
+    if (Equals(value, id, isolate)) {
+      return id;
+    }
+  }
+  return StringId::LAST_STRING_ID;
+}
+
+bool JsStrings::Equals(v8::Local<v8::Value> value, StringId id,
+                       v8::Isolate* isolate) {
+  return value->IsString() &&
+         value.As<v8::String>()->StringEquals(GetConstantString(id, isolate));
+}
@@ -1,7 +1,10 @@
 #ifndef WINDOWJS_STRINGS_H
 #define WINDOWJS_STRINGS_H
 
+#include <stddef.h>
+
 #include <array>
+#include <initializer_list>
 
 #include <v8/include/v8.h>
 
@@ -37,6 +40,9 @@ enum class StringId {
   base64ToArrayBuffer,
   basename,
   beginPath,
+  benchmarkColors,
+  benchmarkEvents,
+  benchmarkJson,
   bevel,
   bezierCurveTo,
   blur,
@@ -46,6 +52,7 @@ enum class StringId {
   butt,
   button,
   c,
+  cache,
   cancelAnimationFrame,
   canvas,
   CanvasGradient,
@@ -53,6 +60,9 @@ enum class StringId {
   CanvasRenderingContext2D,
   CapsLock,
   center,
+  characters,
+  clearMarks,
+  clearMeasures,
   clearRect,
   clearTimeout,
   click,
@@ -63,6 +73,7 @@ enum class StringId {
   closePath,
   code,
   Codec,
+  codes,
   color,
   Comma,
   content,
@@ -72,6 +83,7 @@ enum class StringId {
   ControlRight,
   copy,
   copyTree,
+  count,
   cpus,
   createImageData,
   createLinearGradient,
@@ -105,17 +117,23 @@ enum class StringId {
   Digit8,
   Digit9,
   dirname,
+  dispatch,
+  done,
   drawImage,
+  drawTextLayout,
   drop,
+  duration,
   e,
   ellipse,
   encode,
   end,
   End,  // Keep after | sort | uniq.
   Enter,
+  entryType,
   Equal,
   error,
   Escape,
+  evenodd,
   exception,
   exclusion,
   exit,
@@ -146,6 +164,7 @@ enum class StringId {
   F8,
   F9,
   File,
+  file,
   files,
   fill,
   fillRect,
@@ -155,21 +174,35 @@ enum class StringId {
   focused,
   font,
   fonts,
+  formatDir,
+  formatLog,
+  frame,
   frameBottom,
   frameLeft,
   frameRight,
+  frames,
   frameTop,
   fullscreen,
   g,
+  gc,
+  getApiCounters,
   getClipboardText,
+  getEntriesByName,
+  getFrameStats,
   getImageData,
+  getInputLatency,
   getLineDash,
   getTransform,
   globalAlpha,
   globalCompositeOperation,
+  glyphCache,
   h,
   hanging,
   height,
+  high,
+  histogramBounds,
+  histograms,
+  history,
   Home,
   home,
   hue,
@@ -180,12 +213,15 @@ enum class StringId {
   imageSmoothingQuality,
   ImageBitmap,
   ImageData,
+  incremental,
+  input,
   Insert,
   isDir,
   isFile,
   isPointInPath,
   isPointInStroke,
   j,
+  jank,
   js,
   jsHeapSizeLimit,
   k,
@@ -212,6 +248,7 @@ enum class StringId {
   KeyQ,
   KeyR,
   KeyS,
+  keys,
   KeyT,
   KeyU,
   keyup,
@@ -222,24 +259,45 @@ enum class StringId {
   KeyZ,
   l,
   left,
+  legacyParse,
+  legacyWrite,
   level,
   lighten,
   lighter,
+  limit,
+  lineBaselines,
   lineCap,
   lineDashOffset,
+  lineEnds,
+  lineHeight,
   lineJoin,
+  lineLefts,
+  lineStarts,
   lineTo,
   lineWidth,
+  lineWidths,
   list,
   listTree,
   loadFont,
+  loadFonts,
   location,
   log,
+  longtask,
+  longTasks,
+  longTaskThreshold,
+  low,
   luminosity,
   m,
+  mark,
+  max,
+  maxDuration,
   maximize,
   maximized,
+  maxLines,
+  measure,
   measureText,
+  measureTextBatch,
+  medium,
   memory,
   message,
   Meta,
@@ -261,6 +319,8 @@ enum class StringId {
   moveTo,
   multiply,
   n,
+  name,
+  native,
   now,
   NumLock,
   Numpad0,
@@ -280,21 +340,33 @@ enum class StringId {
   NumpadMultiply,
   NumpadSubtract,
   o,
+  Object,
+  offset,
   offsetX,
   offsetY,
   open,
   overlay,
   overlayConsoleTextColor,
   p,
+  p50,
+  p90,
+  p99,
   PageDown,
   PageUp,
   parent,
+  parse,
+  parser,
+  path,
   Path2D,
   Pause,
   performance,
   Period,
   platform,
+  pointer,
   postMessage,
+  pressed,
+  prewarmFonts,
+  prewarmText,
   PrintScreen,
   Process,
   profileFrameTimes,
@@ -303,12 +375,17 @@ enum class StringId {
   quadraticCurveTo,
   Quote,
   r,
+  raf,
   readArrayBuffer,
   readImageBitmap,
   readImageData,
   readJSON,
+  readJSONLines,
   readText,
   rect,
+  refreshInterval,
+  regex,
+  released,
   remove,
   removeEventListener,
   removeTree,
@@ -316,15 +393,18 @@ enum class StringId {
   repeat,
   requestAnimationFrame,
   requestAttention,
+  resetFrameStats,
   resetTransform,
   resizable,
   resize,
   restore,
   retinaScale,
+  rewriteJson,
   right,
   rotate,
   round,
   s,
+  sampleIntervalUs,
   saturation,
   save,
   scale,
@@ -350,35 +430,46 @@ enum class StringId {
   showOverlayStats,
   size,
   Slash,
+  source,
   Space,
   spawn,
   square,
   start,
+  startProfiling,
+  startTime,
   status,
+  stopProfiling,
   stroke,
   strokeRect,
   strokeStyle,
   strokeText,
+  swap,
   t,
   Tab,
   textAlign,
   textBaseline,
+  TextLayout,
+  timeStamp,
   title,
   tmp,
   toBase64,
   top,
+  total,
   totalJSHeapSize,
   transform,
   translate,
   type,
   u,
   Unidentified,
+  used,
   usedJSHeapSize,
   v,
+  values,
   version,
   visible,
   vsync,
   w,
+  wait,
   wheel,
   width,
   window,
@@ -433,17 +524,72 @@ enum class StringId {
 
 class JsStrings final {
  public:
-  explicit JsStrings(v8::Isolate* isolate);
+  JsStrings();
   ~JsStrings();
 
+  // Each string is internalized on its first use, since most programs only
+  // use some of them; e.g. the key codes and the properties of APIs that
+  // aren't used. This must be called with the isolate locked, like the
+  // other v8 calls.
   v8::Local<v8::String> GetConstantString(StringId id, v8::Isolate* isolate) {
-    return strings_[static_cast<int>(id)].Get(isolate);
+    v8::Eternal<v8::String>& string = strings_[static_cast<int>(id)];
+    if (string.IsEmpty()) {
+      return MakeConstantString(id, isolate);
+    }
+    return string.Get(isolate);
+  }
+
+  // How many of the strings were used so far, and the time spent making them
+  // in seconds. These are logged with --profile-startup.
+  int made_count() const { return made_count_; }
+  double made_time() const { return made_time_; }
+
+  // The same string as GetConstantString(), without going through v8. This
+  // can be used without locking the isolate.
+  const char* GetName(StringId id) const {
+    return names_[static_cast<int>(id)];
+  }
+
+  // Returns the first of |ids| whose constant string equals |value|, or
+  // StringId::LAST_STRING_ID. This is meant for setters that take one of a
+  // few keywords, like textAlign.
+  //
+  // String literals in Javascript are internalized like the constants, so
+  // they are usually the same string and are matched by identity, without
+  // reading their characters. Other strings are compared afterwards.
+  StringId Match(v8::Local<v8::Value> value,
+                 std::initializer_list<StringId> ids, v8::Isolate* isolate);
+
+  // Same, for a table of entries that have a StringId |name|. Returns null if
+  // no entry matches.
+  template <typename Entry, size_t N>
+  const Entry* Match(v8::Local<v8::Value> value, const Entry (&entries)[N],
+                     v8::Isolate* isolate) {
+    for (const Entry& entry : entries) {
+      if (value == GetConstantString(entry.name, isolate)) {
+        return &entry;
+      }
+    }
+    for (const Entry& entry : entries) {
+      if (Equals(value, entry.name, isolate)) {
+        return &entry;
+      }
+    }
+    return nullptr;
   }
 
  private:
+  v8::Local<v8::String> MakeConstantString(StringId id, v8::Isolate* isolate);
+
+  // Compares the characters of |value| with the constant string for |id|.
+  bool Equals(v8::Local<v8::Value> value, StringId id, v8::Isolate* isolate);
+
   std::array<v8::Eternal<v8::String>,
              static_cast<int>(StringId::LAST_STRING_ID)>
       strings_;
+  std::array<const char*, static_cast<int>(StringId::LAST_STRING_ID)> names_;
+  int made_count_;
+  double made_time_;
 };
 
 #endif  // WINDOWJS_STRINGS_H
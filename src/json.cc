@@ -1,408 +1,895 @@
 #include "json.h"
 
-Json::~Json() {
-  Nullify();
-}
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
 
-Json& Json::operator=(const Json& json) {
-  if (this == &json) {
-    return *this;
-  }
+#include <algorithm>
+#include <charconv>
+#include <functional>
+#include <unordered_map>
 
-  Nullify();
-  type_ = json.type_;
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
 
-  switch (type_) {
-    case NUL: break;
-    case BOOL: b_ = json.b_; break;
-    case INT: i_ = json.i_; break;
-    case DOUBLE: d_ = json.d_; break;
-    case STRING: s_ = new std::string(*json.s_); break;
-    case LIST: l_ = new ListType(*json.l_); break;
-    case DICTIONARY: o_ = new DictionaryType(*json.o_); break;
-  }
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define JSON_USE_SSE2
+#elif defined(__aarch64__) && defined(__ARM_NEON)
+#include <arm_neon.h>
+#define JSON_USE_NEON
+#endif
 
-  return *this;
+namespace {
+
+// Deeper inputs are rejected, so that parsing can't overflow the stack.
+constexpr int kMaxDepth = 512;
+
+bool IsWhitespace(char c) {
+  return c == ' ' || c == '\n' || c == '\r' || c == '\t';
 }
 
-Json& Json::operator=(Json&& json) {
-  if (this == &json) {
-    return *this;
-  }
+bool NeedsEscape(char c) {
+  return c == '"' || c == '\\' || static_cast<unsigned char>(c) < 0x20;
+}
 
-  Nullify();
-  type_ = json.type_;
+bool IsDigit(char c) {
+  return c >= '0' && c <= '9';
+}
 
-  switch (type_) {
-    case NUL: break;
-    case BOOL: b_ = json.b_; break;
-    case INT: i_ = json.i_; break;
-    case DOUBLE: d_ = json.d_; break;
-    case STRING: s_ = json.s_; break;
-    case LIST: l_ = json.l_; break;
-    case DICTIONARY: o_ = json.o_; break;
-  }
+// |mask| must not be 0.
+int CountTrailingZeros(uint32_t mask) {
+#if defined(_MSC_VER)
+  unsigned long index;
+  _BitScanForward(&index, mask);
+  return static_cast<int>(index);
+#else
+  return __builtin_ctz(mask);
+#endif
+}
 
-  json.type_ = NUL;
+// The functions below scan 16 bytes at a time when SIMD is available, and
+// finish the last bytes one at a time.
 
-  return *this;
+const char* SkipWhitespace(const char* p, const char* end) {
+  // Compact JSON has no whitespace, so this is the common case.
+  if (p == end || !IsWhitespace(*p)) {
+    return p;
+  }
+#if defined(JSON_USE_SSE2)
+  const __m128i space = _mm_set1_epi8(' ');
+  const __m128i newline = _mm_set1_epi8('\n');
+  const __m128i carriage_return = _mm_set1_epi8('\r');
+  const __m128i tab = _mm_set1_epi8('\t');
+  while (end - p >= 16) {
+    __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+    __m128i white = _mm_or_si128(
+        _mm_or_si128(_mm_cmpeq_epi8(chunk, space),
+                     _mm_cmpeq_epi8(chunk, newline)),
+        _mm_or_si128(_mm_cmpeq_epi8(chunk, carriage_return),
+                     _mm_cmpeq_epi8(chunk, tab)));
+    uint32_t mask = ~_mm_movemask_epi8(white) & 0xFFFF;
+    if (mask != 0) {
+      return p + CountTrailingZeros(mask);
+    }
+    p += 16;
+  }
+#elif defined(JSON_USE_NEON)
+  const uint8x16_t space = vdupq_n_u8(' ');
+  const uint8x16_t newline = vdupq_n_u8('\n');
+  const uint8x16_t carriage_return = vdupq_n_u8('\r');
+  const uint8x16_t tab = vdupq_n_u8('\t');
+  while (end - p >= 16) {
+    uint8x16_t chunk = vld1q_u8(reinterpret_cast<const uint8_t*>(p));
+    uint8x16_t white =
+        vorrq_u8(vorrq_u8(vceqq_u8(chunk, space), vceqq_u8(chunk, newline)),
+                 vorrq_u8(vceqq_u8(chunk, carriage_return),
+                          vceqq_u8(chunk, tab)));
+    if (vminvq_u8(white) == 0) {
+      break;
+    }
+    p += 16;
+  }
+#endif
+  while (p < end && IsWhitespace(*p)) {
+    p++;
+  }
+  return p;
 }
 
-bool Json::operator==(const Json& json) const {
-  if (type_ != json.type_) {
-    return false;
+// Returns the first character in [p, end) that must be escaped in a JSON
+// string, or |end|. If |kSurrogates| is set then this also stops at 0xED,
+// the first byte of the WTF-8 surrogates.
+template <bool kSurrogates>
+const char* FindEscape(const char* p, const char* end) {
+#if defined(JSON_USE_SSE2)
+  const __m128i quote = _mm_set1_epi8('"');
+  const __m128i backslash = _mm_set1_epi8('\\');
+  const __m128i control = _mm_set1_epi8(0x1F);
+  const __m128i surrogate = _mm_set1_epi8(static_cast<char>(0xED));
+  while (end - p >= 16) {
+    __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+    // max(c, 0x1F) == 0x1F for the control characters, as unsigned bytes.
+    __m128i match = _mm_or_si128(
+        _mm_or_si128(_mm_cmpeq_epi8(chunk, quote),
+                     _mm_cmpeq_epi8(chunk, backslash)),
+        _mm_cmpeq_epi8(_mm_max_epu8(chunk, control), control));
+    if (kSurrogates) {
+      match = _mm_or_si128(match, _mm_cmpeq_epi8(chunk, surrogate));
+    }
+    uint32_t mask = _mm_movemask_epi8(match);
+    if (mask != 0) {
+      return p + CountTrailingZeros(mask);
+    }
+    p += 16;
   }
+#elif defined(JSON_USE_NEON)
+  const uint8x16_t quote = vdupq_n_u8('"');
+  const uint8x16_t backslash = vdupq_n_u8('\\');
+  const uint8x16_t control = vdupq_n_u8(0x1F);
+  const uint8x16_t surrogate = vdupq_n_u8(0xED);
+  while (end - p >= 16) {
+    uint8x16_t chunk = vld1q_u8(reinterpret_cast<const uint8_t*>(p));
+    uint8x16_t match =
+        vorrq_u8(vorrq_u8(vceqq_u8(chunk, quote), vceqq_u8(chunk, backslash)),
+                 vcleq_u8(chunk, control));
+    if (kSurrogates) {
+      match = vorrq_u8(match, vceqq_u8(chunk, surrogate));
+    }
+    if (vmaxvq_u8(match) != 0) {
+      break;
+    }
+    p += 16;
+  }
+#endif
+  while (p < end && !NeedsEscape(*p) &&
+         !(kSurrogates && static_cast<unsigned char>(*p) == 0xED)) {
+    p++;
+  }
+  return p;
+}
 
-  switch (type_) {
-    case NUL: return true;
-    case BOOL: return b_ == json.b_;
-    case INT: return i_ == json.i_;
-    case DOUBLE: return d_ == json.d_;
-    case STRING: return *s_ == *json.s_;
-    case LIST: return *l_ == *json.l_;
-    case DICTIONARY: return *o_ == *json.o_;
+int HexValue(char c) {
+  if (c >= '0' && c <= '9') {
+    return c - '0';
+  } else if (c >= 'a' && c <= 'f') {
+    return c - 'a' + 10;
+  } else if (c >= 'A' && c <= 'F') {
+    return c - 'A' + 10;
   }
-  ASSERT(false);
-  return false;
+  return -1;
 }
 
-void Json::Nullify() {
-  if (type_ == STRING) {
-    delete s_;
-  } else if (type_ == LIST) {
-    delete l_;
-  } else if (type_ == DICTIONARY) {
-    delete o_;
+void AppendUTF8(uint32_t c, std::string* out) {
+  if (c < 0x80) {
+    out->push_back(c);
+  } else if (c < 0x800) {
+    out->push_back(0xC0 | (c >> 6));
+    out->push_back(0x80 | (c & 0x3F));
+  } else if (c < 0x10000) {
+    out->push_back(0xE0 | (c >> 12));
+    out->push_back(0x80 | ((c >> 6) & 0x3F));
+    out->push_back(0x80 | (c & 0x3F));
+  } else {
+    out->push_back(0xF0 | (c >> 18));
+    out->push_back(0x80 | ((c >> 12) & 0x3F));
+    out->push_back(0x80 | ((c >> 6) & 0x3F));
+    out->push_back(0x80 | (c & 0x3F));
   }
-  type_ = NUL;
 }
 
-std::string Json::ToString() const {
-  switch (type_) {
-    case NUL: return "null";
-    case BOOL: return b_ ? "true" : "false";
-    case INT: return std::to_string(i_);
-    case DOUBLE: return std::to_string(d_);
-    case STRING: return EscapeString(*s_);
-    case LIST: {
-      std::string result;
-      result.append(1, '[');
-      bool first = true;
-      for (const auto& json : *l_) {
-        if (first) {
-          first = false;
-        } else {
-          result.append(1, ',');
+}  // namespace
+
+// Parses a JsonDocument. Lists and dictionaries are parsed into stacks of
+// items and members that are reused for the whole document, and then copied
+// into the arena once their size is known.
+class JsonParser final {
+ public:
+  JsonParser(std::string_view input, JsonDocument* document,
+             std::string* error)
+      : p_(input.data()),
+        end_(input.data() + input.size()),
+        document_(document),
+        error_(error) {}
+
+  bool ParseDocument(Json* json) {
+    p_ = SkipWhitespace(p_, end_);
+    if (p_ == end_) {
+      return Fail("Empty input");
+    }
+    if (!ParseValue(json, 0)) {
+      return false;
+    }
+    p_ = SkipWhitespace(p_, end_);
+    if (p_ != end_) {
+      return Fail("Trailing characters");
+    }
+    return true;
+  }
+
+ private:
+  bool Fail(std::string_view message) {
+    if (error_) {
+      *error_ = message;
+    }
+    return false;
+  }
+
+  bool ParseValue(Json* json, int depth) {
+    p_ = SkipWhitespace(p_, end_);
+    if (p_ == end_) {
+      return Fail("Premature end of input");
+    }
+    switch (*p_) {
+      case '[': return ParseList(json, depth + 1);
+      case '{': return ParseDictionary(json, depth + 1);
+      case '"': {
+        p_++;
+        std::string_view value;
+        if (!ParseString(&value)) {
+          return false;
         }
-        result.append(json.ToString());
+        json->type_ = Json::STRING;
+        json->size_ = value.size();
+        json->s_ = document_->CopyString(value).data();
+        return true;
       }
-      result.append(1, ']');
-      return result;
-    }
-    case DICTIONARY: {
-      std::string result;
-      result.append(1, '{');
-      const DictionaryType& o = *o_;
-      bool first = true;
-      for (const auto& p : o) {
-        if (first) {
-          first = false;
+      case 't': return ParseLiteral("true", json);
+      case 'f': return ParseLiteral("false", json);
+      case 'n': return ParseLiteral("null", json);
+      default: return ParseNumber(json);
+    }
+  }
+
+  bool ParseList(Json* json, int depth) {
+    if (depth > kMaxDepth) {
+      return Fail("Too deeply nested");
+    }
+    p_++;
+    const size_t base = items_.size();
+    p_ = SkipWhitespace(p_, end_);
+    if (p_ < end_ && *p_ == ']') {
+      p_++;
+    } else {
+      for (;;) {
+        Json item;
+        if (!ParseValue(&item, depth)) {
+          return false;
+        }
+        items_.push_back(item);
+        p_ = SkipWhitespace(p_, end_);
+        if (p_ < end_ && *p_ == ',') {
+          p_++;
+        } else if (p_ < end_ && *p_ == ']') {
+          p_++;
+          break;
         } else {
-          result.append(1, ',');
+          return Fail("Expected , or ]");
         }
-        result.append(EscapeString(p.first));
-        result.append(1, ':');
-        result.append(p.second.ToString());
       }
-      result.append(1, '}');
-      return result;
     }
+
+    const size_t size = items_.size() - base;
+    Json* items = static_cast<Json*>(document_->Allocate(size * sizeof(Json)));
+    std::uninitialized_copy(items_.begin() + base, items_.end(), items);
+    items_.resize(base);
+
+    json->type_ = Json::LIST;
+    json->size_ = size;
+    json->items_ = items;
+    return true;
   }
-  ASSERT(false);
-  return {};
-}
 
-std::string Json::ToPrettyString(const std::string& indent) const {
-  switch (type_) {
-    case NUL: return "null";
-    case BOOL: return b_ ? "true" : "false";
-    case INT: return std::to_string(i_);
-    case DOUBLE: return std::to_string(d_);
-    case STRING: return EscapeString(*s_);
-    case LIST: {
-      std::string result;
-      result.append(1, '[');
-      bool first = true;
-      for (const auto& json : *l_) {
-        if (first) {
-          first = false;
+  bool ParseDictionary(Json* json, int depth) {
+    if (depth > kMaxDepth) {
+      return Fail("Too deeply nested");
+    }
+    p_++;
+    const size_t base = members_.size();
+    p_ = SkipWhitespace(p_, end_);
+    if (p_ < end_ && *p_ == '}') {
+      p_++;
+    } else {
+      for (;;) {
+        p_ = SkipWhitespace(p_, end_);
+        if (p_ == end_ || *p_ != '"') {
+          return Fail("Expected string");
+        }
+        p_++;
+        std::string_view key;
+        if (!ParseString(&key)) {
+          return false;
+        }
+        key = document_->InternKey(key);
+
+        p_ = SkipWhitespace(p_, end_);
+        if (p_ == end_ || *p_ != ':') {
+          return Fail("Expected :");
+        }
+        p_++;
+        Json value;
+        if (!ParseValue(&value, depth)) {
+          return false;
+        }
+        // Like JSON.parse, a duplicated key keeps the position of the first
+        // one and the last value.
+        Json::Member* member = FindMember(base, key, depth);
+        if (member) {
+          member->value = value;
         } else {
-          result.append(", ");
+          AddMember(key, value, depth);
         }
-        result.append(json.ToPrettyString(indent));
-      }
-      result.append(1, ']');
-      return result;
-    }
-    case DICTIONARY: {
-      std::string result;
-      const DictionaryType& o = *o_;
-      if (o.empty())
-        return "{}";
-      result.append("{\n");
-      bool first = true;
-      for (const auto& p : o) {
-        if (first) {
-          first = false;
+
+        p_ = SkipWhitespace(p_, end_);
+        if (p_ < end_ && *p_ == ',') {
+          p_++;
+        } else if (p_ < end_ && *p_ == '}') {
+          p_++;
+          break;
         } else {
-          result.append(",\n");
+          return Fail("Expected , or }");
         }
-        result.append(indent).append("  ").append(EscapeString(p.first));
-        result.append(": ");
-        result.append(p.second.ToPrettyString(indent + "  "));
       }
-      result.append("\n").append(indent).append(1, '}');
-      return result;
     }
-  }
-  ASSERT(false);
-  return {};
-}
 
-// static
-std::string Json::EscapeString(std::string_view value) {
-  std::string result;
-  result.reserve(value.size() + 2);
-  result.append(1, '"');
-  for (char c : value) {
-    if (c == '"') {
-      result.append("\\\"");
-    } else if (c == '\\') {
-      result.append("\\\\");
-    } else if (c == '/') {
-      result.append("\\/");
-    } else if (c == '\b') {
-      result.append("\\b");
-    } else if (c == '\f') {
-      result.append("\\f");
-    } else if (c == '\n') {
-      result.append("\\n");
-    } else if (c == '\r') {
-      result.append("\\r");
-    } else if (c == '\t') {
-      result.append("\\t");
-    } else {
-      result.append(1, c);
+    const size_t size = members_.size() - base;
+    if (size > Json::kMaxUnindexedMembers) {
+      indexes_[depth].clear();
+    }
+    Json::Member* members = AllocateMembers(size);
+    std::uninitialized_copy(members_.begin() + base, members_.end(), members);
+    members_.resize(base);
+    if (size > Json::kMaxUnindexedMembers) {
+      BuildIndex(members, size);
     }
+
+    json->type_ = Json::DICTIONARY;
+    json->size_ = size;
+    json->members_ = members;
+    return true;
   }
-  result.append(1, '"');
-  return result;
-}
 
-namespace {
+  // Parses a string after its opening quote. Strings without escapes are
+  // returned as views into the input; otherwise |value| points to scratch_,
+  // which is only valid until the next string.
+  bool ParseString(std::string_view* value) {
+    const char* start = p_;
+    const char* q = FindEscape<false>(p_, end_);
+    if (q < end_ && *q == '"') {
+      p_ = q + 1;
+      *value = std::string_view(start, q - start);
+      return true;
+    }
 
-void SkipWhites(std::string_view& s) {
-  while (!s.empty() && std::isspace(s[0])) {
-    s.remove_prefix(1);
-  }
-}
+    scratch_.assign(start, q);
+    p_ = q;
+    for (;;) {
+      if (p_ == end_) {
+        return Fail("Incomplete string");
+      }
+      if (*p_ == '"') {
+        p_++;
+        *value = scratch_;
+        return true;
+      }
+      if (*p_ != '\\') {
+        return Fail("Control character in string");
+      }
+      if (end_ - p_ < 2) {
+        return Fail("Incomplete string escape");
+      }
+      char c = p_[1];
+      p_ += 2;
+      switch (c) {
+        case '"': scratch_.push_back('"'); break;
+        case '\\': scratch_.push_back('\\'); break;
+        case '/': scratch_.push_back('/'); break;
+        case 'b': scratch_.push_back('\b'); break;
+        case 'f': scratch_.push_back('\f'); break;
+        case 'n': scratch_.push_back('\n'); break;
+        case 'r': scratch_.push_back('\r'); break;
+        case 't': scratch_.push_back('\t'); break;
+        case 'u':
+          if (!ParseUnicodeEscape()) {
+            return false;
+          }
+          break;
+        default: return Fail("Invalid string escape");
+      }
 
-bool Eat(std::string_view& input, char c) {
-  SkipWhites(input);
-  if (input.empty()) {
-    return false;
+      q = FindEscape<false>(p_, end_);
+      scratch_.append(p_, q);
+      p_ = q;
+    }
   }
-  if (input[0] == c) {
-    input.remove_prefix(1);
+
+  // Parses the 4 hex digits of a \u escape, and the low surrogate that
+  // follows a high surrogate. Unpaired surrogates are kept as WTF-8.
+  bool ParseUnicodeEscape() {
+    int c = ParseHex4();
+    if (c < 0) {
+      return Fail("Invalid unicode escape");
+    }
+    while (c >= 0xD800 && c < 0xDC00 && end_ - p_ >= 2 && p_[0] == '\\' &&
+           p_[1] == 'u') {
+      p_ += 2;
+      int low = ParseHex4();
+      if (low < 0) {
+        return Fail("Invalid unicode escape");
+      }
+      if (low >= 0xDC00 && low < 0xE000) {
+        AppendUTF8(0x10000 + ((c - 0xD800) << 10) + (low - 0xDC00), &scratch_);
+        return true;
+      }
+      // |c| is unpaired, but |low| may be a high surrogate too.
+      AppendUTF8(c, &scratch_);
+      c = low;
+    }
+    AppendUTF8(c, &scratch_);
     return true;
   }
-  return false;
-}
 
-std::string_view EatNextWord(std::string_view& input) {
-  size_t k = 0;
-  while (k < input.size() && std::islower(input[k])) {
-    ++k;
+  int ParseHex4() {
+    if (end_ - p_ < 4) {
+      return -1;
+    }
+    int value = 0;
+    for (int i = 0; i < 4; i++) {
+      int digit = HexValue(p_[i]);
+      if (digit < 0) {
+        return -1;
+      }
+      value = value * 16 + digit;
+    }
+    p_ += 4;
+    return value;
   }
-  std::string_view word = input.substr(0, k);
-  input.remove_prefix(k);
-  return word;
-}
 
-bool ParseSomething(std::string_view& input, Json* json, std::string* error);
-
-bool ParseList(std::string_view& input, Json* json, std::string* error) {
-  bool first = true;
-  while (!Eat(input, ']')) {
-    if (first) {
-      first = false;
-    } else if (!Eat(input, ',')) {
-      if (error) {
-        *error = "Expected , or ]";
-      }
-      return false;
+  bool ParseLiteral(std::string_view literal, Json* json) {
+    if (static_cast<size_t>(end_ - p_) < literal.size() ||
+        memcmp(p_, literal.data(), literal.size()) != 0) {
+      return FailUnexpected();
     }
-    Json item;
-    if (!ParseSomething(input, &item, error)) {
-      return false;
+    p_ += literal.size();
+    if (literal[0] == 'n') {
+      json->type_ = Json::NUL;
+    } else {
+      json->type_ = Json::BOOL;
+      json->b_ = literal[0] == 't';
     }
-    json->Append(std::move(item));
+    return true;
   }
-  return true;
-}
 
-bool ParseDictionary(std::string_view& input, Json* json, std::string* error) {
-  bool first = true;
-  while (!Eat(input, '}')) {
-    if (first) {
-      first = false;
-    } else if (!Eat(input, ',')) {
-      if (error) {
-        *error = "Expected , or }";
-      }
-      return false;
+  // Parses a number with the JSON grammar:
+  //
+  //   -?(0|[1-9][0-9]*)(\.[0-9]+)?([eE][+-]?[0-9]+)?
+  bool ParseNumber(Json* json) {
+    const char* q = p_;
+    const bool negative = *q == '-';
+    if (negative) {
+      q++;
     }
-    Json key;
-    if (!ParseSomething(input, &key, error))
-      return false;
-    if (!key.IsString()) {
-      if (error) {
-        *error = "Expected string";
-      }
-      return false;
+    const char* digits = q;
+    uint64_t value = 0;
+    while (q < end_ && IsDigit(*q)) {
+      // This overflows for long numbers, which don't use |value|.
+      value = value * 10 + (*q - '0');
+      q++;
+    }
+    const size_t digit_count = q - digits;
+    if (digit_count == 0) {
+      return FailUnexpected();
     }
-    if (json->Contains(key.String())) {
-      if (error) {
-        *error = "Duplicated key " + key.String();
+    if (*digits == '0' && digit_count > 1) {
+      return Fail("Invalid number");
+    }
+
+    bool integer = true;
+    if (q < end_ && *q == '.') {
+      integer = false;
+      const char* fraction = ++q;
+      while (q < end_ && IsDigit(*q)) {
+        q++;
+      }
+      if (q == fraction) {
+        return Fail("Invalid number");
       }
-      return false;
     }
-    if (!Eat(input, ':')) {
-      if (error) {
-        *error = "Expected :";
+    if (q < end_ && (*q == 'e' || *q == 'E')) {
+      integer = false;
+      q++;
+      if (q < end_ && (*q == '+' || *q == '-')) {
+        q++;
+      }
+      const char* exponent = q;
+      while (q < end_ && IsDigit(*q)) {
+        q++;
+      }
+      if (q == exponent) {
+        return Fail("Invalid number");
       }
-      return false;
     }
-    Json item;
-    if (!ParseSomething(input, &item, error)) {
-      return false;
+
+    // Integers with up to 18 digits fit in int64_t, and are parsed directly
+    // without strtod. -0 is a double, like in Javascript.
+    if (integer && digit_count <= 18 && !(negative && value == 0)) {
+      json->type_ = Json::INT;
+      json->i_ = negative ? -static_cast<int64_t>(value)
+                          : static_cast<int64_t>(value);
+      p_ = q;
+      return true;
+    }
+
+    // strtod needs a null terminated string. Only numbers with many digits
+    // need the heap.
+    const size_t length = q - p_;
+    char buffer[64];
+    std::string long_number;
+    const char* number = buffer;
+    if (length < sizeof(buffer)) {
+      memcpy(buffer, p_, length);
+      buffer[length] = '\0';
+    } else {
+      long_number.assign(p_, length);
+      number = long_number.c_str();
     }
-    (*json)[key.String()] = std::move(item);
+    double d = strtod(number, nullptr);
+    p_ = q;
+
+    // Like JSON.parse, 1.0 is the same as 1. The range is checked before the
+    // cast, which is undefined for values that don't fit.
+    constexpr double kTwoTo63 = 9223372036854775808.0;
+    if (fabs(d) < kTwoTo63 &&
+        d == static_cast<double>(static_cast<int64_t>(d)) &&
+        !(d == 0 && signbit(d))) {
+      json->type_ = Json::INT;
+      json->i_ = static_cast<int64_t>(d);
+    } else {
+      json->type_ = Json::DOUBLE;
+      json->d_ = d;
+    }
+    return true;
   }
-  return true;
-}
 
-bool ParseSomething(std::string_view& input, Json* json, std::string* error) {
-  if (Eat(input, '[')) {
-    *json = Json::EmptyList();
-    return ParseList(input, json, error);
-  } else if (Eat(input, '{')) {
-    *json = Json::EmptyDictionary();
-    return ParseDictionary(input, json, error);
-  } else if (Eat(input, '"')) {
-    std::string result;
-    while (!input.empty() && input[0] != '"') {
-      if (input[0] == '\\') {
-        if (input.size() < 2) {
-          if (error) {
-            *error = "Incomplete string escape";
-          }
-          return false;
+  // Returns the member with |key| in the dictionary that starts at |base| in
+  // members_, or null. Interned keys are equal only if they are the same
+  // view. Large dictionaries are indexed in indexes_, by depth.
+  Json::Member* FindMember(size_t base, std::string_view key, int depth) {
+    const size_t size = members_.size() - base;
+    if (size <= Json::kMaxUnindexedMembers) {
+      for (size_t i = base; i < members_.size(); i++) {
+        if (members_[i].key.data() == key.data()) {
+          return &members_[i];
         }
-        if (input[1] == '"') {
-          result.append(1, '"');
-        } else if (input[1] == '\\') {
-          result.append(1, '\\');
-        } else if (input[1] == '/') {
-          result.append(1, '/');
-        } else if (input[1] == 'b') {
-          result.append(1, '\b');
-        } else if (input[1] == 'f') {
-          result.append(1, '\f');
-        } else if (input[1] == 'n') {
-          result.append(1, '\n');
-        } else if (input[1] == 'r') {
-          result.append(1, '\r');
-        } else if (input[1] == 't') {
-          result.append(1, '\t');
-        } else {
-          result.append(1, input[1]);
-        }
-        input.remove_prefix(2);
-      } else {
-        result.append(1, input[0]);
-        input.remove_prefix(1);
       }
+      return nullptr;
     }
-    if (input.empty()) {
-      if (error) {
-        *error = "Incomplete string";
+    std::unordered_map<const char*, size_t>& index = GetIndex(depth);
+    if (index.empty()) {
+      for (size_t i = base; i < members_.size(); i++) {
+        index.emplace(members_[i].key.data(), i);
       }
-      return false;
     }
-    input.remove_prefix(1);
-    *json = result;
-    return true;
-  } else if (input.empty()) {
-    if (error) {
-      *error = "Premature end of input";
+    auto it = index.find(key.data());
+    return it == index.end() ? nullptr : &members_[it->second];
+  }
+
+  void AddMember(std::string_view key, Json value, int depth) {
+    members_.push_back({key, value});
+    std::unordered_map<const char*, size_t>& index = GetIndex(depth);
+    if (!index.empty()) {
+      index.emplace(key.data(), members_.size() - 1);
     }
-    return false;
-  } else {
-    const char* begin = input.data();
-    char* end = nullptr;
-    double d = strtod(begin, &end);
-    if (end > begin) {
-      input.remove_prefix(end - begin);
-      long l = d;
-      if (d == l) {
-        *json = l;
-      } else {
-        *json = d;
+  }
+
+  std::unordered_map<const char*, size_t>& GetIndex(int depth) {
+    if (indexes_.size() <= static_cast<size_t>(depth)) {
+      indexes_.resize(depth + 1);
+    }
+    return indexes_[depth];
+  }
+
+  // Allocates the members of a dictionary, followed by its hash index if
+  // it's large.
+  Json::Member* AllocateMembers(size_t size) {
+    size_t bytes = size * sizeof(Json::Member);
+    if (size > Json::kMaxUnindexedMembers) {
+      bytes += Json::IndexCapacity(size) * sizeof(uint32_t);
+    }
+    return static_cast<Json::Member*>(document_->Allocate(bytes));
+  }
+
+  // An open addressing table with the index of each member, by the hash of
+  // its key.
+  static void BuildIndex(Json::Member* members, size_t size) {
+    uint32_t* index = reinterpret_cast<uint32_t*>(members + size);
+    const size_t capacity = Json::IndexCapacity(size);
+    std::fill(index, index + capacity, Json::kNoMember);
+    for (size_t i = 0; i < size; i++) {
+      size_t slot = std::hash<std::string_view>()(members[i].key);
+      slot &= capacity - 1;
+      while (index[slot] != Json::kNoMember) {
+        slot = (slot + 1) & (capacity - 1);
       }
-      return true;
+      index[slot] = static_cast<uint32_t>(i);
     }
-    std::string_view word = EatNextWord(input);
-    if (word == "true") {
-      *json = true;
-    } else if (word == "false") {
-      *json = false;
-    } else if (word == "null") {
-      *json = Json();
-    } else {
-      if (error) {
-        *error = "Unrecognized token: \"";
-        *error += word;
-        *error += "\", next input: ";
-        *error += input.substr(0, 20);
+  }
+
+  bool FailUnexpected() {
+    std::string_view next(p_, std::min<size_t>(end_ - p_, 20));
+    return Fail("Unexpected input: " + std::string(next));
+  }
+
+  const char* p_;
+  const char* end_;
+  JsonDocument* document_;
+  std::string* error_;
+
+  std::vector<Json> items_;
+  std::vector<Json::Member> members_;
+  std::vector<std::unordered_map<const char*, size_t>> indexes_;
+  std::string scratch_;
+};
+
+const Json& Json::operator[](std::string_view key) const {
+  const Member* member = FindMember(key);
+  if (member) {
+    return member->value;
+  }
+  static const Json null;
+  return null;
+}
+
+const Json::Member* Json::FindMember(std::string_view key) const {
+  ASSERT(type_ == DICTIONARY);
+  if (size_ <= kMaxUnindexedMembers) {
+    for (uint32_t i = 0; i < size_; i++) {
+      if (members_[i].key == key) {
+        return &members_[i];
       }
-      return false;
     }
-    return true;
+    return nullptr;
+  }
+  const uint32_t* index = reinterpret_cast<const uint32_t*>(members_ + size_);
+  const size_t mask = IndexCapacity(size_) - 1;
+  for (size_t slot = std::hash<std::string_view>()(key) & mask;;
+       slot = (slot + 1) & mask) {
+    if (index[slot] == kNoMember) {
+      return nullptr;
+    }
+    if (members_[index[slot]].key == key) {
+      return &members_[index[slot]];
+    }
   }
 }
 
-}  // namespace
+std::string Json::ToString() const {
+  std::string result;
+  JsonWriter writer(&result);
+  writer.Value(*this);
+  return result;
+}
+
+// static
+std::string Json::EscapeString(std::string_view value) {
+  std::string result;
+  AppendEscapedString(value, &result);
+  return result;
+}
 
 // static
-std::unique_ptr<Json> Json::Parse(std::string_view input, std::string* error) {
-  SkipWhites(input);
-  if (input.empty()) {
-    if (error) {
-      *error = "Empty input";
+void Json::AppendEscapedString(std::string_view value, std::string* out) {
+  out->reserve(out->size() + value.size() + 2);
+  out->push_back('"');
+  const char* p = value.data();
+  const char* end = p + value.size();
+  for (;;) {
+    const char* q = FindEscape<true>(p, end);
+    out->append(p, q);
+    if (q == end) {
+      break;
     }
-    return nullptr;
+    if (static_cast<unsigned char>(*q) == 0xED) {
+      // Unpaired surrogates are escaped, so that the output is valid UTF-8.
+      // Other characters that start with 0xED are copied.
+      if (end - q >= 3 && static_cast<unsigned char>(q[1]) >= 0xA0 &&
+          static_cast<unsigned char>(q[1]) <= 0xBF) {
+        char buffer[8];
+        snprintf(buffer, sizeof(buffer), "\\u%04x",
+                 0xD000 | ((q[1] & 0x3F) << 6) | (q[2] & 0x3F));
+        out->append(buffer);
+        p = q + 3;
+      } else {
+        out->push_back(*q);
+        p = q + 1;
+      }
+      continue;
+    }
+    switch (*q) {
+      case '"': out->append("\\\""); break;
+      case '\\': out->append("\\\\"); break;
+      case '\b': out->append("\\b"); break;
+      case '\f': out->append("\\f"); break;
+      case '\n': out->append("\\n"); break;
+      case '\r': out->append("\\r"); break;
+      case '\t': out->append("\\t"); break;
+      default: {
+        char buffer[8];
+        snprintf(buffer, sizeof(buffer), "\\u%04x",
+                 static_cast<unsigned char>(*q));
+        out->append(buffer);
+        break;
+      }
+    }
+    p = q + 1;
   }
-  std::unique_ptr<Json> json(new Json);
-  if (!ParseSomething(input, json.get(), error)) {
+  out->push_back('"');
+}
+
+JsonDocument::JsonDocument() : next_(nullptr), left_(0), arena_size_(0) {}
+
+// static
+std::unique_ptr<JsonDocument> JsonDocument::Parse(std::string_view input,
+                                                  std::string* error) {
+  std::unique_ptr<JsonDocument> document(new JsonDocument);
+  JsonParser parser(input, document.get(), error);
+  if (!parser.ParseDocument(&document->root_)) {
     return nullptr;
   }
-  SkipWhites(input);
-  if (!input.empty()) {
-    if (error) {
-      *error = "Trailing characters";
+  return document;
+}
+
+void* JsonDocument::Allocate(size_t size) {
+  // Keeps |next_| aligned for Json values.
+  size = (size + 7) & ~static_cast<size_t>(7);
+  if (size > left_) {
+    arena_size_ += std::max(size, kBlockSize);
+    if (size >= kBlockSize / 2) {
+      // Large allocations get their own block, so that the rest of the
+      // current block can still be used.
+      blocks_.emplace_back(new char[size]);
+      return blocks_.back().get();
     }
-    return nullptr;
+    blocks_.emplace_back(new char[kBlockSize]);
+    next_ = blocks_.back().get();
+    left_ = kBlockSize;
   }
-  return json;
+  void* result = next_;
+  next_ += size;
+  left_ -= size;
+  return result;
+}
+
+std::string_view JsonDocument::CopyString(std::string_view value) {
+  char* copy = static_cast<char*>(Allocate(value.size()));
+  memcpy(copy, value.data(), value.size());
+  return std::string_view(copy, value.size());
+}
+
+std::string_view JsonDocument::InternKey(std::string_view key) {
+  auto it = keys_.find(key);
+  if (it != keys_.end()) {
+    return *it;
+  }
+  std::string_view copy = CopyString(key);
+  keys_.insert(copy);
+  return copy;
+}
+
+JsonWriter& JsonWriter::BeginList() {
+  BeginValue();
+  out_->push_back('[');
+  comma_ = false;
+  return *this;
+}
+
+JsonWriter& JsonWriter::EndList() {
+  out_->push_back(']');
+  comma_ = true;
+  return *this;
+}
+
+JsonWriter& JsonWriter::BeginDictionary() {
+  BeginValue();
+  out_->push_back('{');
+  comma_ = false;
+  return *this;
+}
+
+JsonWriter& JsonWriter::EndDictionary() {
+  out_->push_back('}');
+  comma_ = true;
+  return *this;
+}
+
+JsonWriter& JsonWriter::Key(std::string_view key) {
+  BeginValue();
+  Json::AppendEscapedString(key, out_);
+  out_->push_back(':');
+  comma_ = false;
+  return *this;
+}
+
+JsonWriter& JsonWriter::Null() {
+  BeginValue();
+  out_->append("null");
+  return *this;
+}
+
+JsonWriter& JsonWriter::Bool(bool value) {
+  BeginValue();
+  out_->append(value ? "true" : "false");
+  return *this;
+}
+
+JsonWriter& JsonWriter::Int(int64_t value) {
+  BeginValue();
+  char buffer[24];
+  std::to_chars_result result =
+      std::to_chars(buffer, buffer + sizeof(buffer), value);
+  out_->append(buffer, result.ptr);
+  return *this;
+}
+
+JsonWriter& JsonWriter::Double(double value) {
+  if (!isfinite(value)) {
+    return Null();
+  }
+  BeginValue();
+  char buffer[32];
+#if defined(__cpp_lib_to_chars)
+  // The shortest digits that read back as the same value.
+  std::to_chars_result result =
+      std::to_chars(buffer, buffer + sizeof(buffer), value);
+  out_->append(buffer, result.ptr);
+#else
+  // 15 digits are enough for most values, and don't turn 0.1 into
+  // 0.10000000000000001.
+  int length = snprintf(buffer, sizeof(buffer), "%.15g", value);
+  if (strtod(buffer, nullptr) != value) {
+    length = snprintf(buffer, sizeof(buffer), "%.17g", value);
+  }
+  out_->append(buffer, length);
+#endif
+  return *this;
+}
+
+JsonWriter& JsonWriter::String(std::string_view value) {
+  BeginValue();
+  Json::AppendEscapedString(value, out_);
+  return *this;
+}
+
+JsonWriter& JsonWriter::Value(const Json& value) {
+  switch (value.Type()) {
+    case Json::NUL: return Null();
+    case Json::BOOL: return Bool(value.Bool());
+    case Json::INT: return Int(value.Long());
+    case Json::DOUBLE: return Double(value.Double());
+    case Json::STRING: return String(value.String());
+    case Json::LIST:
+      BeginList();
+      for (size_t i = 0; i < value.Size(); i++) {
+        Value(value[i]);
+      }
+      return EndList();
+    case Json::DICTIONARY:
+      BeginDictionary();
+      for (size_t i = 0; i < value.Size(); i++) {
+        const Json::Member& member = value.MemberAt(i);
+        Key(member.key);
+        Value(member.value);
+      }
+      return EndDictionary();
+  }
+  ASSERT(false);
+  return *this;
+}
+
+JsonWriter& JsonWriter::Raw(std::string_view json) {
+  BeginValue();
+  out_->append(json);
+  return *this;
 }
@@ -1,21 +1,26 @@
 #ifndef WINDOWJS_JSON_H
 #define WINDOWJS_JSON_H
 
+#include <stddef.h>
+#include <stdint.h>
+
 #include <memory>
-#include <ostream>
 #include <string>
 #include <string_view>
-#include <unordered_map>
+#include <unordered_set>
 #include <vector>
 
 #include "fail.h"
 
-class Json {
+// A value in a JsonDocument. Values are immutable, and point into the arena of
+// their document, so they are only valid while the document is alive.
+//
+// Strings are UTF-8, except for unpaired surrogates from \u escapes. Those
+// are kept as 3 byte sequences (WTF-8), like JSON.parse() keeps them in its
+// UTF-16 strings, and JsonWriter escapes them again.
+class Json final {
  public:
-  using ListType = std::vector<Json>;
-  using DictionaryType = std::unordered_map<std::string, Json>;
-
-  enum JsonType {
+  enum JsonType : uint8_t {
     NUL,
     BOOL,
     INT,
@@ -25,43 +30,9 @@ class Json {
     DICTIONARY,
   };
 
-  ~Json();
-
-  Json() : type_(NUL) {}
-
-  static Json Null() { return Json(); }
-
-  explicit Json(bool value) : type_(BOOL), b_(value) {}
-
-  explicit Json(int value) : type_(INT), i_(value) {}
-  explicit Json(long value) : type_(INT), i_(value) {}
-
-  explicit Json(double value) : type_(DOUBLE), d_(value) {}
-
-  explicit Json(const char* value)
-      : type_(STRING), s_(new std::string(value)) {}
-  explicit Json(const std::string& value)
-      : type_(STRING), s_(new std::string(value)) {}
-  explicit Json(std::string&& value)
-      : type_(STRING), s_(new std::string(value)) {}
-
-  explicit Json(ListType&& value) : type_(LIST), l_(new ListType(value)) {}
-
-  static Json EmptyList() { return Json(ListType()); }
+  struct Member;
 
-  explicit Json(DictionaryType&& value)
-      : type_(DICTIONARY), o_(new DictionaryType(value)) {}
-
-  static Json EmptyDictionary() { return Json(DictionaryType()); }
-
-  Json(const Json& json) : type_(NUL) { *this = json; }
-  Json(Json&& json) : type_(json.type_), o_(json.o_) { json.type_ = NUL; }
-
-  Json& operator=(const Json& json);
-  Json& operator=(Json&& json);
-
-  bool operator==(const Json& json) const;
-  bool operator!=(const Json& json) const { return !(*this == json); }
+  constexpr Json() : type_(NUL), size_(0), i_(0) {}
 
   // Type check.
 
@@ -71,240 +42,194 @@ class Json {
   bool IsBool() const { return type_ == BOOL; }
   bool IsInt() const { return type_ == INT; }
   bool IsDouble() const { return type_ == DOUBLE; }
+  bool IsNumber() const { return type_ == INT || type_ == DOUBLE; }
   bool IsString() const { return type_ == STRING; }
   bool IsList() const { return type_ == LIST; }
   bool IsDictionary() const { return type_ == DICTIONARY; }
 
-  // Null.
-
-  void Nullify();
-
-  // Booleans.
+  // Values.
 
   bool Bool() const {
     ASSERT(type_ == BOOL);
     return b_;
   }
 
-  Json& operator=(bool value) {
-    Nullify();
-    type_ = BOOL;
-    b_ = value;
-    return *this;
-  }
-
-  // Integers.
-
-  long Long() const {
+  int64_t Long() const {
     ASSERT(type_ == INT);
     return i_;
   }
 
-  Json& operator=(int value) {
-    Nullify();
-    type_ = INT;
-    i_ = value;
-    return *this;
-  }
-
-  Json& operator=(long value) {
-    Nullify();
-    type_ = INT;
-    i_ = value;
-    return *this;
-  }
-
-  // Doubles.
-
   double Double() const {
     ASSERT(type_ == DOUBLE);
     return d_;
   }
 
-  Json& operator=(double value) {
-    Nullify();
-    type_ = DOUBLE;
-    d_ = value;
-    return *this;
-  }
-
-  // Strings.
-
-  const std::string& String() const {
-    ASSERT(type_ == STRING);
-    return *s_;
+  // Integers are converted to double.
+  double Number() const {
+    ASSERT(IsNumber());
+    return type_ == INT ? static_cast<double>(i_) : d_;
   }
 
-  std::string MoveString() {
+  std::string_view String() const {
     ASSERT(type_ == STRING);
-    std::string result = std::move(*s_);
-    Nullify();
-    return result;
+    return std::string_view(s_, size_);
   }
 
-  Json& operator=(const char* value) {
-    Nullify();
-    type_ = STRING;
-    s_ = new std::string(value);
-    return *this;
-  }
+  // Lists and dictionaries.
 
-  Json& operator=(const std::string& value) {
-    Nullify();
-    type_ = STRING;
-    s_ = new std::string(value);
-    return *this;
-  }
-
-  Json& operator=(std::string&& value) {
-    Nullify();
-    type_ = STRING;
-    s_ = new std::string(value);
-    return *this;
+  size_t Size() const {
+    ASSERT(type_ == LIST || type_ == DICTIONARY);
+    return size_;
   }
 
-  // Lists.
-
-  const ListType& List() const {
-    ASSERT(type_ == LIST);
-    return *l_;
+  const Json& operator[](size_t index) const {
+    ASSERT(type_ == LIST && index < size_);
+    return items_[index];
   }
 
-  ListType& MutableList() {
-    ASSERT(type_ == LIST);
-    return *l_;
-  }
+  // Dictionaries keep their members in the order of the input.
+  const Member& MemberAt(size_t index) const;
 
-  int Size() const {
-    ASSERT(type_ == LIST || type_ == DICTIONARY);
-    return type_ == LIST ? l_->size() : o_->size();
-  }
+  // Returns a null value if |key| isn't in the dictionary. Large
+  // dictionaries have a hash index, so this doesn't scan all the members.
+  const Json& operator[](std::string_view key) const;
 
-  void Resize(int size) {
-    ASSERT(type_ == LIST);
-    l_->resize(size);
-  }
+  bool Contains(std::string_view key) const { return FindMember(key); }
 
-  void Reserve(int size) {
-    ASSERT(type_ == LIST);
-    l_->reserve(size);
-  }
+  // Serialization.
 
-  Json& Append(bool value) {
-    ASSERT(type_ == LIST);
-    l_->emplace_back(value);
-    return *this;
-  }
+  std::string ToString() const;
 
-  Json& Append(int value) {
-    ASSERT(type_ == LIST);
-    l_->emplace_back(static_cast<long>(value));
-    return *this;
-  }
+  static std::string EscapeString(std::string_view value);
+  // Appends |value| as a quoted JSON string to |out|.
+  static void AppendEscapedString(std::string_view value, std::string* out);
 
-  Json& Append(long value) {
-    ASSERT(type_ == LIST);
-    l_->emplace_back(value);
-    return *this;
-  }
+ private:
+  friend class JsonParser;
 
-  Json& Append(double value) {
-    ASSERT(type_ == LIST);
-    l_->emplace_back(value);
-    return *this;
-  }
+  // Dictionaries with more members than this have a hash index after their
+  // members, with IndexCapacity() slots.
+  static constexpr uint32_t kMaxUnindexedMembers = 16;
+  // Empty slots in the index.
+  static constexpr uint32_t kNoMember = UINT32_MAX;
 
-  Json& Append(const char* value) {
-    ASSERT(type_ == LIST);
-    l_->emplace_back(value);
-    return *this;
+  static size_t IndexCapacity(size_t size) {
+    // A power of two with at least twice as many slots as members.
+    size_t capacity = 1;
+    while (capacity < size * 2) {
+      capacity *= 2;
+    }
+    return capacity;
   }
 
-  Json& Append(const std::string& value) {
-    ASSERT(type_ == LIST);
-    l_->emplace_back(value);
-    return *this;
-  }
+  const Member* FindMember(std::string_view key) const;
 
-  Json& Append(const Json& value) {
-    ASSERT(type_ == LIST);
-    l_->emplace_back(value);
-    return *this;
-  }
+  JsonType type_;
+  // The length of strings, or the number of items or members.
+  uint32_t size_;
+  union {
+    bool b_;
+    int64_t i_;
+    double d_;
+    const char* s_;
+    const Json* items_;
+    const Member* members_;
+  };
+};
 
-  Json& Append(Json&& value) {
-    ASSERT(type_ == LIST);
-    l_->emplace_back(value);
-    return *this;
-  }
+struct Json::Member {
+  std::string_view key;
+  Json value;
+};
 
-  const Json& operator[](int index) const {
-    ASSERT(type_ == LIST);
-    return (*l_)[index];
-  }
+inline const Json::Member& Json::MemberAt(size_t index) const {
+  ASSERT(type_ == DICTIONARY && index < size_);
+  return members_[index];
+}
 
-  Json& operator[](int index) {
-    ASSERT(type_ == LIST);
-    return (*l_)[index];
-  }
+// A parsed JSON document. All of its strings, lists and dictionaries are
+// allocated in an arena that is freed with the document, so parsing makes a
+// few large allocations instead of one per value. The keys of dictionaries are
+// interned, so a key that repeats in a list of dictionaries is stored once.
+class JsonDocument final {
+ public:
+  // Returns null if |input| isn't valid JSON, and sets |error|.
+  static std::unique_ptr<JsonDocument> Parse(std::string_view input,
+                                             std::string* error = nullptr);
 
-  // Dictionaries.
+  JsonDocument(const JsonDocument&) = delete;
+  JsonDocument& operator=(const JsonDocument&) = delete;
 
-  const DictionaryType& Dictionary() const {
-    ASSERT(type_ == DICTIONARY);
-    return *o_;
-  }
+  const Json& root() const { return root_; }
 
-  DictionaryType& MutableDictionary() {
-    ASSERT(type_ == DICTIONARY);
-    return *o_;
-  }
+  // The bytes allocated in the arena.
+  size_t arena_size() const { return arena_size_; }
 
-  bool Contains(const std::string& key) const {
-    ASSERT(type_ == DICTIONARY);
-    return o_->find(key) != o_->end();
-  }
+ private:
+  friend class JsonParser;
 
-  void Remove(const std::string& key) const {
-    ASSERT(type_ == DICTIONARY);
-    o_->erase(key);
-  }
+  static constexpr size_t kBlockSize = 16 * 1024;
 
-  const Json& operator[](const std::string& key) const {
-    ASSERT(type_ == DICTIONARY);
-    return (*o_)[key];
-  }
+  JsonDocument();
 
-  Json& operator[](const std::string& key) {
-    ASSERT(type_ == DICTIONARY);
-    return (*o_)[key];
-  }
+  void* Allocate(size_t size);
+  std::string_view CopyString(std::string_view value);
+  std::string_view InternKey(std::string_view key);
 
-  // Serialization.
+  Json root_;
 
-  std::string ToString() const;
-  std::string ToPrettyString(const std::string& indent = "") const;
+  std::vector<std::unique_ptr<char[]>> blocks_;
+  char* next_;
+  size_t left_;
+  size_t arena_size_;
 
-  static std::string EscapeString(std::string_view value);
+  // Views into the arena.
+  std::unordered_set<std::string_view> keys_;
+};
 
-  static std::unique_ptr<Json> Parse(std::string_view input,
-                                     std::string* error = nullptr);
+// Writes JSON to a string as the values are added, without building a tree of
+// values or intermediate strings. Commas are added as needed:
+//
+//   std::string json;
+//   JsonWriter writer(&json);
+//   writer.BeginDictionary().Key("type").String("log").EndDictionary();
+class JsonWriter final {
+ public:
+  explicit JsonWriter(std::string* out) : out_(out), comma_(false) {}
+
+  JsonWriter(const JsonWriter&) = delete;
+  JsonWriter& operator=(const JsonWriter&) = delete;
+
+  JsonWriter& BeginList();
+  JsonWriter& EndList();
+  JsonWriter& BeginDictionary();
+  JsonWriter& EndDictionary();
+
+  // Must be followed by the value of the member.
+  JsonWriter& Key(std::string_view key);
+
+  JsonWriter& Null();
+  JsonWriter& Bool(bool value);
+  JsonWriter& Int(int64_t value);
+  // Infinities and NaN are written as null, like JSON.stringify().
+  JsonWriter& Double(double value);
+  JsonWriter& String(std::string_view value);
+  JsonWriter& Value(const Json& value);
+  // Appends |json| as is. It must be a valid JSON value already, e.g. from
+  // Json::EscapeString().
+  JsonWriter& Raw(std::string_view json);
 
-  friend std::ostream& operator<<(std::ostream& o, const Json& json) {
-    o << json.ToPrettyString();
-    return o;
+ private:
+  void BeginValue() {
+    if (comma_) {
+      out_->push_back(',');
+    }
+    comma_ = true;
   }
 
- private:
-  JsonType type_;
-  union {
-    bool b_;
-    long i_;
-    double d_;
-    std::string* s_;
-    ListType* l_;
-    DictionaryType* o_;
-  };
+  std::string* out_;
+  // Whether the next value needs a comma before it.
+  bool comma_;
 };
 
 #endif  // WINDOWJS_JSON_H
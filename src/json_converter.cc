@@ -0,0 +1,244 @@
+#include "json_converter.h"
+
+#include <stdint.h>
+
+#include <cmath>
+#include <limits>
+
+#include "clock.h"
+
+namespace {
+
+// How many values are converted between checks of the deadline. Each step has
+// its own HandleScope.
+constexpr size_t kValuesPerStep = 256;
+
+bool IsContainer(const Json& json) {
+  return json.IsList() || json.IsDictionary();
+}
+
+// Returns the position of the next unpaired surrogate in |s| at or after
+// |start|, or npos. The parser keeps those as 3 byte sequences, like UTF-8
+// would encode them if it allowed it.
+size_t FindSurrogate(std::string_view s, size_t start) {
+  for (size_t i = s.find('\xED', start); i != std::string_view::npos;
+       i = s.find('\xED', i + 1)) {
+    if (i + 2 < s.size() && (static_cast<uint8_t>(s[i + 1]) & 0xE0) == 0xA0 &&
+        (static_cast<uint8_t>(s[i + 2]) & 0xC0) == 0x80) {
+      return i;
+    }
+  }
+  return std::string_view::npos;
+}
+
+// Makes a string with the same UTF-16 code units as JSON.parse() would, when
+// |s| contains unpaired surrogates.
+v8::Local<v8::String> MakeJsonString(std::string_view s,
+                                     const JsScope& scope) {
+  size_t surrogate = FindSurrogate(s, 0);
+  if (surrogate == std::string_view::npos) {
+    return scope.MakeString(s);
+  }
+  v8::Local<v8::String> result = v8::String::Empty(scope.isolate);
+  size_t start = 0;
+  while (surrogate != std::string_view::npos) {
+    result = v8::String::Concat(
+        scope.isolate, result,
+        scope.MakeString(s.substr(start, surrogate - start)));
+    const uint16_t c = 0xD000 | ((s[surrogate + 1] & 0x3F) << 6) |
+                       (s[surrogate + 2] & 0x3F);
+    result = v8::String::Concat(
+        scope.isolate, result,
+        v8::String::NewFromTwoByte(scope.isolate, &c,
+                                   v8::NewStringType::kNormal, 1)
+            .ToLocalChecked());
+    start = surrogate + 3;
+    surrogate = FindSurrogate(s, start);
+  }
+  return v8::String::Concat(scope.isolate, result,
+                            scope.MakeString(s.substr(start)));
+}
+
+}  // namespace
+
+JsonConverter::JsonConverter(const Json& root)
+    : root_(root), started_(false), done_(false) {}
+
+bool JsonConverter::Run(const JsScope& scope, double deadline) {
+  if (done_) {
+    return true;
+  }
+
+  // Without a deadline, flat containers of any size are made at once.
+  // Otherwise the larger ones are filled in steps, like the others.
+  const size_t max_flat_size = std::isinf(deadline)
+                                   ? std::numeric_limits<size_t>::max()
+                                   : kValuesPerStep;
+
+  if (!started_) {
+    started_ = true;
+    v8::HandleScope handle_scope(scope.isolate);
+    v8::Local<v8::Value> value;
+    if (ConvertFlat(root_, scope, max_flat_size, &value)) {
+      result_.Reset(scope.isolate, value);
+      done_ = true;
+      return true;
+    }
+    Push(root_, scope);
+  }
+
+  while (!stack_.empty()) {
+    v8::HandleScope handle_scope(scope.isolate);
+    v8::Local<v8::Object> object = stack_.back().object.Get(scope.isolate);
+    size_t converted = 0;
+    while (converted < kValuesPerStep && !stack_.empty()) {
+      Frame& frame = stack_.back();
+      if (frame.next == frame.json->Size()) {
+        // This object is complete, and is the next value of its parent.
+        v8::Local<v8::Value> value = object;
+        stack_.pop_back();
+        if (stack_.empty()) {
+          result_.Reset(scope.isolate, value);
+          done_ = true;
+          break;
+        }
+        object = stack_.back().object.Get(scope.isolate);
+        Add(object, value, scope);
+        continue;
+      }
+
+      const Json& json = frame.json->IsList()
+                             ? (*frame.json)[frame.next]
+                             : frame.json->MemberAt(frame.next).value;
+      v8::Local<v8::Value> value;
+      if (ConvertFlat(json, scope, max_flat_size, &value)) {
+        Add(object, value, scope);
+        converted += IsContainer(json) ? json.Size() + 1 : 1;
+      } else {
+        object = Push(json, scope);
+        converted++;
+      }
+    }
+    if (!done_ && GetClockTime() >= deadline) {
+      return false;
+    }
+  }
+
+  return done_;
+}
+
+// static
+v8::Local<v8::Value> JsonConverter::Convert(const Json& json,
+                                            const JsScope& scope) {
+  JsonConverter converter(json);
+  ASSERT(converter.Run(scope, std::numeric_limits<double>::infinity()));
+  return converter.result(scope.isolate);
+}
+
+bool JsonConverter::ConvertFlat(const Json& json, const JsScope& scope,
+                                size_t max_size, v8::Local<v8::Value>* value) {
+  if (!IsContainer(json)) {
+    *value = ConvertPrimitive(json, scope);
+    return true;
+  }
+
+  const size_t size = json.Size();
+  if (size > max_size) {
+    return false;
+  }
+  if (json.IsList()) {
+    for (size_t i = 0; i < size; i++) {
+      if (IsContainer(json[i])) {
+        return false;
+      }
+    }
+    values_.clear();
+    for (size_t i = 0; i < size; i++) {
+      values_.push_back(ConvertPrimitive(json[i], scope));
+    }
+    *value = v8::Array::New(scope.isolate, values_.data(), size);
+    values_.clear();
+    return true;
+  }
+
+  for (size_t i = 0; i < size; i++) {
+    if (IsContainer(json.MemberAt(i).value)) {
+      return false;
+    }
+  }
+  if (object_prototype_.IsEmpty()) {
+    object_prototype_.Reset(scope.isolate,
+                            v8::Object::New(scope.isolate)->GetPrototype());
+  }
+  names_.clear();
+  values_.clear();
+  for (size_t i = 0; i < size; i++) {
+    const Json::Member& member = json.MemberAt(i);
+    names_.push_back(GetKey(member.key, scope));
+    values_.push_back(ConvertPrimitive(member.value, scope));
+  }
+  // The parser merges duplicated keys, which this constructor doesn't
+  // support.
+  *value = v8::Object::New(scope.isolate, object_prototype_.Get(scope.isolate),
+                           names_.data(), values_.data(), size);
+  names_.clear();
+  values_.clear();
+  return true;
+}
+
+v8::Local<v8::Value> JsonConverter::ConvertPrimitive(const Json& json,
+                                                     const JsScope& scope) {
+  switch (json.Type()) {
+    case Json::NUL: return v8::Null(scope.isolate);
+    case Json::BOOL: return v8::Boolean::New(scope.isolate, json.Bool());
+    case Json::INT: return v8::Number::New(scope.isolate, json.Long());
+    case Json::DOUBLE: return v8::Number::New(scope.isolate, json.Double());
+    case Json::STRING: return MakeJsonString(json.String(), scope);
+    case Json::LIST:
+    case Json::DICTIONARY: break;
+  }
+  ASSERT(false);
+  return {};
+}
+
+v8::Local<v8::String> JsonConverter::GetKey(std::string_view key,
+                                            const JsScope& scope) {
+  v8::Global<v8::String>& global = keys_[key.data()];
+  if (global.IsEmpty()) {
+    if (FindSurrogate(key, 0) != std::string_view::npos) {
+      global.Reset(scope.isolate, MakeJsonString(key, scope));
+    } else {
+      global.Reset(scope.isolate,
+                   v8::String::NewFromUtf8(scope.isolate, key.data(),
+                                           v8::NewStringType::kInternalized,
+                                           key.size())
+                       .ToLocalChecked());
+    }
+  }
+  return global.Get(scope.isolate);
+}
+
+v8::Local<v8::Object> JsonConverter::Push(const Json& json,
+                                          const JsScope& scope) {
+  v8::Local<v8::Object> object;
+  if (json.IsList()) {
+    object = v8::Array::New(scope.isolate, json.Size());
+  } else {
+    object = v8::Object::New(scope.isolate);
+  }
+  stack_.push_back({&json, 0, v8::Global<v8::Object>(scope.isolate, object)});
+  return object;
+}
+
+void JsonConverter::Add(v8::Local<v8::Object> object,
+                        v8::Local<v8::Value> value, const JsScope& scope) {
+  Frame& frame = stack_.back();
+  if (frame.json->IsList()) {
+    IGNORE_RESULT(object->CreateDataProperty(scope.context, frame.next, value));
+  } else {
+    const Json::Member& member = frame.json->MemberAt(frame.next);
+    IGNORE_RESULT(object->CreateDataProperty(
+        scope.context, GetKey(member.key, scope), value));
+  }
+  frame.next++;
+}
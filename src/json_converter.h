@@ -0,0 +1,79 @@
+#ifndef WINDOWJS_JSON_CONVERTER_H
+#define WINDOWJS_JSON_CONVERTER_H
+
+#include <stddef.h>
+
+#include <unordered_map>
+#include <vector>
+
+#include <v8/include/v8.h>
+
+#include "js_scope.h"
+#include "json.h"
+
+// Converts a Json value to the Javascript values that JSON.parse() would make.
+// The conversion can be split into steps with a deadline, so that a large
+// document can be converted across several frames.
+//
+// Lists and dictionaries that only contain primitives are made at once, with
+// all of their values, unless they have more values than a single step
+// converts. The others are made empty and filled as their values are
+// converted.
+class JsonConverter final {
+ public:
+  // |root| must outlive the JsonConverter.
+  explicit JsonConverter(const Json& root);
+
+  JsonConverter(const JsonConverter&) = delete;
+  JsonConverter& operator=(const JsonConverter&) = delete;
+
+  // Converts values until GetClockTime() reaches |deadline|, or until all of
+  // the root is converted. Returns true when done.
+  bool Run(const JsScope& scope, double deadline);
+
+  // The converted root, after Run() returns true.
+  v8::Local<v8::Value> result(v8::Isolate* isolate) const {
+    return result_.Get(isolate);
+  }
+
+  // Converts all of |json| at once.
+  static v8::Local<v8::Value> Convert(const Json& json, const JsScope& scope);
+
+ private:
+  // A list or dictionary with values that are still being converted.
+  struct Frame {
+    const Json* json;
+    // The index of the next value to add.
+    size_t next;
+    v8::Global<v8::Object> object;
+  };
+
+  // Converts |json| if it's a primitive, or a list or dictionary of at most
+  // |max_size| primitives. Returns false if it needs a Frame instead.
+  bool ConvertFlat(const Json& json, const JsScope& scope, size_t max_size,
+                   v8::Local<v8::Value>* value);
+  v8::Local<v8::Value> ConvertPrimitive(const Json& json,
+                                        const JsScope& scope);
+  v8::Local<v8::String> GetKey(std::string_view key, const JsScope& scope);
+
+  v8::Local<v8::Object> Push(const Json& json, const JsScope& scope);
+  // Adds |value| as the next value of the top Frame, whose object is |object|.
+  void Add(v8::Local<v8::Object> object, v8::Local<v8::Value> value,
+           const JsScope& scope);
+
+  const Json& root_;
+  bool started_;
+  bool done_;
+  std::vector<Frame> stack_;
+  v8::Global<v8::Value> result_;
+
+  v8::Global<v8::Value> object_prototype_;
+  // Keyed by the interned keys of the document.
+  std::unordered_map<const char*, v8::Global<v8::String>> keys_;
+
+  // Reused for each flat list and dictionary.
+  std::vector<v8::Local<v8::Name>> names_;
+  std::vector<v8::Local<v8::Value>> values_;
+};
+
+#endif  // WINDOWJS_JSON_CONVERTER_H
@@ -0,0 +1,316 @@
+#ifndef WINDOWJS_JSON_LEGACY_H
+#define WINDOWJS_JSON_LEGACY_H
+
+#include <memory>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "fail.h"
+
+// The previous implementation of Json, which allocates every string, list and
+// dictionary on the heap. It's kept only to compare it with Json in
+// window.debug.benchmarkJson().
+class LegacyJson {
+ public:
+  using ListType = std::vector<LegacyJson>;
+  using DictionaryType = std::unordered_map<std::string, LegacyJson>;
+
+  enum JsonType {
+    NUL,
+    BOOL,
+    INT,
+    DOUBLE,
+    STRING,
+    LIST,
+    DICTIONARY,
+  };
+
+  ~LegacyJson();
+
+  LegacyJson() : type_(NUL) {}
+
+  static LegacyJson Null() { return LegacyJson(); }
+
+  explicit LegacyJson(bool value) : type_(BOOL), b_(value) {}
+
+  explicit LegacyJson(int value) : type_(INT), i_(value) {}
+  explicit LegacyJson(long value) : type_(INT), i_(value) {}
+
+  explicit LegacyJson(double value) : type_(DOUBLE), d_(value) {}
+
+  explicit LegacyJson(const char* value)
+      : type_(STRING), s_(new std::string(value)) {}
+  explicit LegacyJson(const std::string& value)
+      : type_(STRING), s_(new std::string(value)) {}
+  explicit LegacyJson(std::string&& value)
+      : type_(STRING), s_(new std::string(value)) {}
+
+  explicit LegacyJson(ListType&& value)
+      : type_(LIST), l_(new ListType(value)) {}
+
+  static LegacyJson EmptyList() { return LegacyJson(ListType()); }
+
+  explicit LegacyJson(DictionaryType&& value)
+      : type_(DICTIONARY), o_(new DictionaryType(value)) {}
+
+  static LegacyJson EmptyDictionary() { return LegacyJson(DictionaryType()); }
+
+  LegacyJson(const LegacyJson& json) : type_(NUL) { *this = json; }
+  LegacyJson(LegacyJson&& json) : type_(json.type_), o_(json.o_) {
+    json.type_ = NUL;
+  }
+
+  LegacyJson& operator=(const LegacyJson& json);
+  LegacyJson& operator=(LegacyJson&& json);
+
+  bool operator==(const LegacyJson& json) const;
+  bool operator!=(const LegacyJson& json) const { return !(*this == json); }
+
+  // Type check.
+
+  JsonType Type() const { return type_; }
+
+  bool IsNull() const { return type_ == NUL; }
+  bool IsBool() const { return type_ == BOOL; }
+  bool IsInt() const { return type_ == INT; }
+  bool IsDouble() const { return type_ == DOUBLE; }
+  bool IsString() const { return type_ == STRING; }
+  bool IsList() const { return type_ == LIST; }
+  bool IsDictionary() const { return type_ == DICTIONARY; }
+
+  // Null.
+
+  void Nullify();
+
+  // Booleans.
+
+  bool Bool() const {
+    ASSERT(type_ == BOOL);
+    return b_;
+  }
+
+  LegacyJson& operator=(bool value) {
+    Nullify();
+    type_ = BOOL;
+    b_ = value;
+    return *this;
+  }
+
+  // Integers.
+
+  long Long() const {
+    ASSERT(type_ == INT);
+    return i_;
+  }
+
+  LegacyJson& operator=(int value) {
+    Nullify();
+    type_ = INT;
+    i_ = value;
+    return *this;
+  }
+
+  LegacyJson& operator=(long value) {
+    Nullify();
+    type_ = INT;
+    i_ = value;
+    return *this;
+  }
+
+  // Doubles.
+
+  double Double() const {
+    ASSERT(type_ == DOUBLE);
+    return d_;
+  }
+
+  LegacyJson& operator=(double value) {
+    Nullify();
+    type_ = DOUBLE;
+    d_ = value;
+    return *this;
+  }
+
+  // Strings.
+
+  const std::string& String() const {
+    ASSERT(type_ == STRING);
+    return *s_;
+  }
+
+  std::string MoveString() {
+    ASSERT(type_ == STRING);
+    std::string result = std::move(*s_);
+    Nullify();
+    return result;
+  }
+
+  LegacyJson& operator=(const char* value) {
+    Nullify();
+    type_ = STRING;
+    s_ = new std::string(value);
+    return *this;
+  }
+
+  LegacyJson& operator=(const std::string& value) {
+    Nullify();
+    type_ = STRING;
+    s_ = new std::string(value);
+    return *this;
+  }
+
+  LegacyJson& operator=(std::string&& value) {
+    Nullify();
+    type_ = STRING;
+    s_ = new std::string(value);
+    return *this;
+  }
+
+  // Lists.
+
+  const ListType& List() const {
+    ASSERT(type_ == LIST);
+    return *l_;
+  }
+
+  ListType& MutableList() {
+    ASSERT(type_ == LIST);
+    return *l_;
+  }
+
+  int Size() const {
+    ASSERT(type_ == LIST || type_ == DICTIONARY);
+    return type_ == LIST ? l_->size() : o_->size();
+  }
+
+  void Resize(int size) {
+    ASSERT(type_ == LIST);
+    l_->resize(size);
+  }
+
+  void Reserve(int size) {
+    ASSERT(type_ == LIST);
+    l_->reserve(size);
+  }
+
+  LegacyJson& Append(bool value) {
+    ASSERT(type_ == LIST);
+    l_->emplace_back(value);
+    return *this;
+  }
+
+  LegacyJson& Append(int value) {
+    ASSERT(type_ == LIST);
+    l_->emplace_back(static_cast<long>(value));
+    return *this;
+  }
+
+  LegacyJson& Append(long value) {
+    ASSERT(type_ == LIST);
+    l_->emplace_back(value);
+    return *this;
+  }
+
+  LegacyJson& Append(double value) {
+    ASSERT(type_ == LIST);
+    l_->emplace_back(value);
+    return *this;
+  }
+
+  LegacyJson& Append(const char* value) {
+    ASSERT(type_ == LIST);
+    l_->emplace_back(value);
+    return *this;
+  }
+
+  LegacyJson& Append(const std::string& value) {
+    ASSERT(type_ == LIST);
+    l_->emplace_back(value);
+    return *this;
+  }
+
+  LegacyJson& Append(const LegacyJson& value) {
+    ASSERT(type_ == LIST);
+    l_->emplace_back(value);
+    return *this;
+  }
+
+  LegacyJson& Append(LegacyJson&& value) {
+    ASSERT(type_ == LIST);
+    l_->emplace_back(value);
+    return *this;
+  }
+
+  const LegacyJson& operator[](int index) const {
+    ASSERT(type_ == LIST);
+    return (*l_)[index];
+  }
+
+  LegacyJson& operator[](int index) {
+    ASSERT(type_ == LIST);
+    return (*l_)[index];
+  }
+
+  // Dictionaries.
+
+  const DictionaryType& Dictionary() const {
+    ASSERT(type_ == DICTIONARY);
+    return *o_;
+  }
+
+  DictionaryType& MutableDictionary() {
+    ASSERT(type_ == DICTIONARY);
+    return *o_;
+  }
+
+  bool Contains(const std::string& key) const {
+    ASSERT(type_ == DICTIONARY);
+    return o_->find(key) != o_->end();
+  }
+
+  void Remove(const std::string& key) const {
+    ASSERT(type_ == DICTIONARY);
+    o_->erase(key);
+  }
+
+  const LegacyJson& operator[](const std::string& key) const {
+    ASSERT(type_ == DICTIONARY);
+    return (*o_)[key];
+  }
+
+  LegacyJson& operator[](const std::string& key) {
+    ASSERT(type_ == DICTIONARY);
+    return (*o_)[key];
+  }
+
+  // Serialization.
+
+  std::string ToString() const;
+  std::string ToPrettyString(const std::string& indent = "") const;
+
+  static std::string EscapeString(std::string_view value);
+
+  static std::unique_ptr<LegacyJson> Parse(std::string_view input,
+                                     std::string* error = nullptr);
+
+  friend std::ostream& operator<<(std::ostream& o, const LegacyJson& json) {
+    o << json.ToPrettyString();
+    return o;
+  }
+
+ private:
+  JsonType type_;
+  union {
+    bool b_;
+    long i_;
+    double d_;
+    std::string* s_;
+    ListType* l_;
+    DictionaryType* o_;
+  };
+};
+
+#endif  // WINDOWJS_JSON_LEGACY_H
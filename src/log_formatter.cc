@@ -0,0 +1,976 @@
+#include "log_formatter.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <condition_variable>
+#include <map>
+#include <mutex>
+
+#include "fail.h"
+#include "js.h"
+#include "js_strings.h"
+
+namespace {
+
+// Nested objects deeper than this are shown as [Object] or [Array].
+constexpr int kMaxDepth = 2;
+// Longer messages are cut.
+constexpr size_t kMaxMessageLength = 16 * 1024;
+
+LogFormatter* g_log_formatter = nullptr;
+
+class SnapshotDelegate final : public v8::ValueSerializer::Delegate {
+ public:
+  explicit SnapshotDelegate(v8::Isolate* isolate) : isolate_(isolate) {}
+
+  void ThrowDataCloneError(v8::Local<v8::String> message) override {
+    isolate_->ThrowException(v8::Exception::Error(message));
+  }
+
+ private:
+  v8::Isolate* isolate_;
+};
+
+// Plain objects and Arrays can be serialized without losing information.
+// Instances of classes would lose their prototype, and other objects are
+// either not serializable or print better with their toString().
+bool IsSnapshotCandidate(Js* js, v8::Local<v8::Value> value) {
+  if (value->IsArray()) {
+    return true;
+  }
+  if (!value->IsObject() || value->IsFunction() || value->IsProxy()) {
+    return false;
+  }
+  v8::Local<v8::Object> object = value.As<v8::Object>();
+  if (object->InternalFieldCount() > 0) {
+    return false;
+  }
+  return object->GetConstructorName()->StringEquals(
+      js->strings()->GetConstantString(StringId::Object, js->isolate()));
+}
+
+bool Serialize(Js* js, v8::Local<v8::Value> value, std::string* snapshot) {
+  v8::Isolate* isolate = js->isolate();
+  // Failures, like objects with functions or native objects, fall back to
+  // the toString() of |value|.
+  v8::TryCatch try_catch(isolate);
+  SnapshotDelegate delegate(isolate);
+  v8::ValueSerializer serializer(isolate, &delegate);
+  serializer.WriteHeader();
+  if (!serializer.WriteValue(js->context(), value).FromMaybe(false)) {
+    return false;
+  }
+  std::pair<uint8_t*, size_t> buffer = serializer.Release();
+  snapshot->assign(reinterpret_cast<const char*>(buffer.first), buffer.second);
+  free(buffer.first);
+  return true;
+}
+
+void AppendQuoted(std::string* out, std::string_view s) {
+  out->push_back('"');
+  for (char c : s) {
+    if (c == '"' || c == '\\') {
+      out->push_back('\\');
+      out->push_back(c);
+    } else if (c == '\n') {
+      out->append("\\n");
+    } else {
+      out->push_back(c);
+    }
+  }
+  out->push_back('"');
+}
+
+// Keys like 0 and 12 are shown without quotes, like identifiers.
+bool IsArrayIndex(std::string_view s) {
+  if (s.empty() || (s.size() > 1 && s[0] == '0')) {
+    return false;
+  }
+  for (char c : s) {
+    if (c < '0' || c > '9') {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool IsIdentifier(std::string_view s) {
+  if (s.empty() || (s[0] >= '0' && s[0] <= '9')) {
+    return false;
+  }
+  for (char c : s) {
+    bool valid = (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') ||
+                 (c >= '0' && c <= '9') || c == '_' || c == '$';
+    if (!valid) {
+      return false;
+    }
+  }
+  return true;
+}
+
+void AppendUtf8(std::string* out, uint32_t c) {
+  if (c < 0x80) {
+    out->push_back(c);
+  } else if (c < 0x800) {
+    out->push_back(0xC0 | (c >> 6));
+    out->push_back(0x80 | (c & 0x3F));
+  } else if (c < 0x10000) {
+    out->push_back(0xE0 | (c >> 12));
+    out->push_back(0x80 | ((c >> 6) & 0x3F));
+    out->push_back(0x80 | (c & 0x3F));
+  } else {
+    out->push_back(0xF0 | (c >> 18));
+    out->push_back(0x80 | ((c >> 12) & 0x3F));
+    out->push_back(0x80 | ((c >> 6) & 0x3F));
+    out->push_back(0x80 | (c & 0x3F));
+  }
+}
+
+// |digits| is the magnitude in little endian. Very large values aren't
+// converted to decimal, since that takes quadratic time.
+void AppendBigInt(std::string* out, std::string_view digits, bool negative) {
+  std::vector<uint8_t> magnitude(digits.rbegin(), digits.rend());
+  if (magnitude.size() > 128) {
+    out->append("[BigInt]");
+    return;
+  }
+  std::string decimal;
+  for (;;) {
+    while (!magnitude.empty() && magnitude.front() == 0) {
+      magnitude.erase(magnitude.begin());
+    }
+    if (magnitude.empty()) {
+      break;
+    }
+    // Divides |magnitude| by 10, from the most significant byte.
+    uint32_t remainder = 0;
+    for (uint8_t& byte : magnitude) {
+      uint32_t value = (remainder << 8) | byte;
+      byte = value / 10;
+      remainder = value % 10;
+    }
+    decimal.push_back('0' + remainder);
+  }
+  if (decimal.empty()) {
+    decimal.push_back('0');
+  }
+  if (negative) {
+    out->push_back('-');
+  }
+  out->append(decimal.rbegin(), decimal.rend()).append("n");
+}
+
+const char* GetErrorName(uint8_t tag) {
+  switch (tag) {
+    case 'E': return "EvalError";
+    case 'R': return "RangeError";
+    case 'F': return "ReferenceError";
+    case 'S': return "SyntaxError";
+    case 'T': return "TypeError";
+    case 'U': return "URIError";
+  }
+  return nullptr;
+}
+
+const char* GetArrayBufferViewName(uint8_t tag, size_t* element_size) {
+  *element_size = 1;
+  switch (tag) {
+    case 'b': return "Int8Array";
+    case 'B': return "Uint8Array";
+    case 'C': return "Uint8ClampedArray";
+    case '?': return "DataView";
+  }
+  *element_size = 2;
+  switch (tag) {
+    case 'w': return "Int16Array";
+    case 'W': return "Uint16Array";
+    case 'h': return "Float16Array";
+  }
+  *element_size = 4;
+  switch (tag) {
+    case 'd': return "Int32Array";
+    case 'D': return "Uint32Array";
+    case 'f': return "Float32Array";
+  }
+  *element_size = 8;
+  switch (tag) {
+    case 'F': return "Float64Array";
+    case 'q': return "BigInt64Array";
+    case 'Q': return "BigUint64Array";
+  }
+  return nullptr;
+}
+
+// Formats the output of a v8::ValueSerializer. This runs in the formatter
+// thread, without access to v8.
+//
+// Objects are numbered in the order they are written, and later references
+// to them are written as just their number. Those are formatted again from
+// their offset, unless they are still open, which means the reference is
+// circular.
+class SnapshotReader final {
+ public:
+  explicit SnapshotReader(std::string_view data) : data_(data), pos_(0) {}
+
+  bool ReadHeader() {
+    uint64_t version = 0;
+    if (!ReadByte(0xFF) || !ReadVarint(&version)) {
+      return false;
+    }
+    version_ = version;
+    return version_ >= 13;
+  }
+
+  // Appends |value| formatted to |out|, or skips it if |out| is null.
+  bool ReadValue(std::string* out, int depth) {
+    size_t start = out ? out->size() : 0;
+    uint8_t tag;
+    if (!ReadTag(&tag)) {
+      return false;
+    }
+    bool ok = ReadValueWithTag(tag, out, depth);
+    // Views follow their ArrayBuffer, and replace it in the output.
+    if (ok && (tag == 'B' || tag == '~' || tag == '^') && PeekTag() == 'V') {
+      if (out) {
+        out->resize(start);
+      }
+      ReadTag(&tag);
+      ok = ReadArrayBufferView(out);
+    }
+    return ok;
+  }
+
+  // Reads the properties of the top level object for console.dir() into
+  // |properties|, with their values described briefly.
+  bool ReadDirProperties(std::map<std::string, std::string>* properties) {
+    uint8_t tag;
+    if (!ReadTag(&tag) || tag != 'o') {
+      return false;
+    }
+    AddObject(pos_ - 1);
+    for (;;) {
+      if (PeekTag() == '{') {
+        ReadTag(&tag);
+        uint64_t count;
+        return ReadVarint(&count);
+      }
+      std::string key;
+      if (!ReadKey(&key)) {
+        return false;
+      }
+      std::string value;
+      if (!ReadTag(&tag)) {
+        return false;
+      }
+      bool ok = true;
+      if (tag == '"' || tag == 'S' || tag == 'c') {
+        ok = ReadString(tag, &value);
+        value = std::string("\"").append(value).append("\"");
+      } else if (strchr("_0TFINUZ", tag)) {
+        ok = ReadValueWithTag(tag, &value, 0);
+      } else {
+        pos_--;
+        ok = ReadValue(nullptr, 0);
+        value = "object";
+      }
+      if (!ok) {
+        return false;
+      }
+      if (!key.empty()) {
+        (*properties)[key] = std::move(value);
+      }
+    }
+  }
+
+ private:
+  SnapshotReader(const SnapshotReader& reader, size_t pos, uint32_t id)
+      : data_(reader.data_),
+        pos_(pos),
+        version_(reader.version_),
+        first_id_(id),
+        objects_(reader.objects_),
+        open_(reader.open_) {}
+
+  bool ReadByte(uint8_t expected) {
+    if (pos_ >= data_.size() || (uint8_t) data_[pos_] != expected) {
+      return false;
+    }
+    pos_++;
+    return true;
+  }
+
+  bool ReadTag(uint8_t* tag) {
+    while (pos_ < data_.size() && data_[pos_] == '\0') {
+      pos_++;
+    }
+    if (pos_ >= data_.size()) {
+      return false;
+    }
+    *tag = data_[pos_++];
+    return true;
+  }
+
+  uint8_t PeekTag() {
+    size_t pos = pos_;
+    uint8_t tag = 0;
+    if (!ReadTag(&tag)) {
+      tag = 0;
+    }
+    pos_ = pos;
+    return tag;
+  }
+
+  bool ReadVarint(uint64_t* value) {
+    *value = 0;
+    for (int shift = 0; shift < 64; shift += 7) {
+      if (pos_ >= data_.size()) {
+        return false;
+      }
+      uint8_t byte = data_[pos_++];
+      *value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+      if ((byte & 0x80) == 0) {
+        return true;
+      }
+    }
+    return false;
+  }
+
+  bool ReadDouble(double* value) {
+    if (data_.size() - pos_ < sizeof(double)) {
+      return false;
+    }
+    memcpy(value, data_.data() + pos_, sizeof(double));
+    pos_ += sizeof(double);
+    return true;
+  }
+
+  bool ReadRaw(uint64_t size, std::string_view* bytes) {
+    if (data_.size() - pos_ < size) {
+      return false;
+    }
+    *bytes = data_.substr(pos_, size);
+    pos_ += size;
+    return true;
+  }
+
+  // Reads a string with |tag| as UTF-8.
+  bool ReadString(uint8_t tag, std::string* s) {
+    uint64_t size;
+    std::string_view bytes;
+    if (!ReadVarint(&size) || !ReadRaw(size, &bytes)) {
+      return false;
+    }
+    s->clear();
+    if (tag == 'S') {
+      s->assign(bytes);
+    } else if (tag == '"') {
+      // Latin-1.
+      for (char c : bytes) {
+        AppendUtf8(s, (uint8_t) c);
+      }
+    } else if (tag == 'c') {
+      // UTF-16, little endian.
+      for (size_t i = 0; i + 1 < bytes.size(); i += 2) {
+        uint32_t c = (uint8_t) bytes[i] | ((uint8_t) bytes[i + 1] << 8);
+        if (c >= 0xD800 && c < 0xDC00 && i + 3 < bytes.size()) {
+          uint32_t low = (uint8_t) bytes[i + 2] | ((uint8_t) bytes[i + 3] << 8);
+          if (low >= 0xDC00 && low < 0xE000) {
+            c = 0x10000 + ((c - 0xD800) << 10) + (low - 0xDC00);
+            i += 2;
+          }
+        }
+        AppendUtf8(s, c);
+      }
+    } else {
+      return false;
+    }
+    return true;
+  }
+
+  // Property keys are strings or numbers.
+  bool ReadKey(std::string* key) {
+    uint8_t tag;
+    if (!ReadTag(&tag)) {
+      return false;
+    }
+    if (tag == '"' || tag == 'S' || tag == 'c') {
+      return ReadString(tag, key);
+    }
+    key->clear();
+    return (tag == 'I' || tag == 'U' || tag == 'N') &&
+           ReadValueWithTag(tag, key, 0);
+  }
+
+  void AppendKey(std::string* out, std::string_view key) {
+    if (IsIdentifier(key) || IsArrayIndex(key)) {
+      out->append(key);
+    } else {
+      AppendQuoted(out, key);
+    }
+  }
+
+  // Returns the id of the object whose tag is at |start|.
+  uint32_t AddObject(size_t start) {
+    uint32_t id = first_id_ + next_id_++;
+    if (id == objects_->size()) {
+      objects_->push_back(start);
+      open_->push_back(false);
+    }
+    return id;
+  }
+
+  bool Overflows(std::string* out) {
+    return out && out->size() > kMaxMessageLength;
+  }
+
+  // Reads the properties of an object until |end_tag|, followed by
+  // |end_varints| varints.
+  bool ReadProperties(std::string* out, int depth, uint8_t end_tag,
+                      int end_varints, bool first) {
+    for (;;) {
+      if (PeekTag() == end_tag) {
+        uint8_t tag;
+        ReadTag(&tag);
+        for (int i = 0; i < end_varints; i++) {
+          uint64_t ignored;
+          if (!ReadVarint(&ignored)) {
+            return false;
+          }
+        }
+        return true;
+      }
+      std::string key;
+      if (!ReadKey(&key)) {
+        return false;
+      }
+      if (out) {
+        out->append(first ? "" : ", ");
+        AppendKey(out, key);
+        out->append(": ");
+      }
+      first = false;
+      if (!ReadValue(out, depth + 1) || Overflows(out)) {
+        return false;
+      }
+    }
+  }
+
+  bool ReadArrayBufferView(std::string* out) {
+    AddObject(pos_ - 1);
+    uint8_t subtag;
+    uint64_t offset, length, flags = 0;
+    if (!ReadTag(&subtag) || !ReadVarint(&offset) || !ReadVarint(&length)) {
+      return false;
+    }
+    if (version_ >= 14 && !ReadVarint(&flags)) {
+      return false;
+    }
+    if (out) {
+      size_t element_size;
+      const char* name = GetArrayBufferViewName(subtag, &element_size);
+      if (!name) {
+        return false;
+      }
+      out->append(name);
+      // Views that track the length of a resizable ArrayBuffer don't have
+      // their own length.
+      if ((flags & 1) == 0) {
+        out->append("(");
+        out->append(std::to_string(length / element_size)).append(")");
+      }
+    }
+    return true;
+  }
+
+  bool ReadValueWithTag(uint8_t tag, std::string* out, int depth) {
+    std::string ignored;
+    std::string& s = out ? *out : ignored;
+    switch (tag) {
+      case '_': s.append("undefined"); return true;
+      case '0': s.append("null"); return true;
+      case 'T': s.append("true"); return true;
+      case 'F': s.append("false"); return true;
+      case '-': s.append("<empty>"); return true;
+      case 'I': {
+        uint64_t value;
+        if (!ReadVarint(&value)) {
+          return false;
+        }
+        int32_t n = static_cast<int32_t>((value >> 1) ^ -(value & 1));
+        s.append(std::to_string(n));
+        return true;
+      }
+      case 'U': {
+        uint64_t value;
+        if (!ReadVarint(&value)) {
+          return false;
+        }
+        s.append(std::to_string(value));
+        return true;
+      }
+      case 'N': {
+        double value;
+        if (!ReadDouble(&value)) {
+          return false;
+        }
+        s.append(FormatNumber(value));
+        return true;
+      }
+      case 'Z': return ReadBigInt(out);
+      case 'V': return ReadArrayBufferView(out);
+      case '"':
+      case 'S':
+      case 'c': {
+        std::string value;
+        if (!ReadString(tag, &value)) {
+          return false;
+        }
+        if (depth == 0) {
+          s.append(value);
+        } else {
+          AppendQuoted(&s, value);
+        }
+        return true;
+      }
+      case '^': {
+        uint64_t id;
+        if (!ReadVarint(&id) || id >= objects_->size()) {
+          return false;
+        }
+        if (!out) {
+          return true;
+        }
+        if ((*open_)[id]) {
+          s.append("[Circular]");
+          return true;
+        }
+        SnapshotReader reader(*this, (*objects_)[id], id);
+        return reader.ReadValue(out, depth);
+      }
+    }
+    return ReadObject(tag, out, depth);
+  }
+
+  bool ReadBigInt(std::string* out) {
+    uint64_t bitfield;
+    std::string_view digits;
+    if (!ReadVarint(&bitfield) ||
+        !ReadRaw((bitfield >> 1) & 0x3FFFFFFF, &digits)) {
+      return false;
+    }
+    if (out) {
+      AppendBigInt(out, digits, bitfield & 1);
+    }
+    return true;
+  }
+
+  // Reads the objects, which get an id.
+  bool ReadObject(uint8_t tag, std::string* out, int depth) {
+    uint32_t id = AddObject(pos_ - 1);
+    // Objects too deep are skipped, and then described briefly.
+    std::string* o = depth > kMaxDepth ? nullptr : out;
+    (*open_)[id] = true;
+    bool ok = ReadObjectContents(tag, o, depth);
+    (*open_)[id] = false;
+    if (ok && out && !o) {
+      out->append(tag == 'A' || tag == 'a' ? "[Array]" : "[Object]");
+    }
+    return ok;
+  }
+
+  bool ReadObjectContents(uint8_t tag, std::string* out, int depth) {
+    std::string ignored;
+    std::string& s = out ? *out : ignored;
+    switch (tag) {
+      case 'o': {
+        s.append("{");
+        if (!ReadProperties(out, depth, '{', 1, true)) {
+          return false;
+        }
+        s.append("}");
+        return true;
+      }
+      case 'A': {
+        uint64_t length;
+        if (!ReadVarint(&length)) {
+          return false;
+        }
+        s.append("[");
+        for (uint64_t i = 0; i < length; i++) {
+          s.append(i == 0 ? "" : ", ");
+          if (!ReadValue(out, depth + 1) || Overflows(out)) {
+            return false;
+          }
+        }
+        if (!ReadProperties(out, depth, '$', 2, length == 0)) {
+          return false;
+        }
+        s.append("]");
+        return true;
+      }
+      case 'a': {
+        uint64_t length;
+        if (!ReadVarint(&length)) {
+          return false;
+        }
+        s.append("[");
+        if (!ReadProperties(out, depth, '@', 2, true)) {
+          return false;
+        }
+        s.append("]");
+        return true;
+      }
+      case 'D': {
+        double time;
+        if (!ReadDouble(&time)) {
+          return false;
+        }
+        s.append("Date(").append(FormatNumber(time)).append(")");
+        return true;
+      }
+      case 'y': s.append("[Boolean: true]"); return true;
+      case 'x': s.append("[Boolean: false]"); return true;
+      // Boxed numbers and BigInts are followed by their value without a
+      // tag, and boxed strings by a string with its tag.
+      case 'n': {
+        double value;
+        if (!ReadDouble(&value)) {
+          return false;
+        }
+        s.append("[Number: ").append(FormatNumber(value)).append("]");
+        return true;
+      }
+      case 'z': {
+        s.append("[BigInt: ");
+        if (!ReadBigInt(out)) {
+          return false;
+        }
+        s.append("]");
+        return true;
+      }
+      case 's': {
+        s.append("[String: ");
+        if (!ReadValue(out, depth + 1)) {
+          return false;
+        }
+        s.append("]");
+        return true;
+      }
+      case 'R': {
+        uint8_t string_tag;
+        std::string source;
+        uint64_t flags;
+        if (!ReadTag(&string_tag) || !ReadString(string_tag, &source) ||
+            !ReadVarint(&flags)) {
+          return false;
+        }
+        s.append("/").append(source).append("/");
+        // The order of the flags in v8::RegExp::Flags.
+        static const char kFlags[] = "gimyusldv";
+        static const char kOrder[] = "dgimsuvy";
+        for (const char* c = kOrder; *c; c++) {
+          size_t bit = strchr(kFlags, *c) - kFlags;
+          if (flags & (1 << bit)) {
+            s.push_back(*c);
+          }
+        }
+        return true;
+      }
+      case ';':
+      case '\'': {
+        bool is_map = tag == ';';
+        uint8_t end_tag = is_map ? ':' : ',';
+        s.append(is_map ? "Map {" : "Set {");
+        for (bool first = true;; first = false) {
+          if (PeekTag() == end_tag) {
+            ReadTag(&tag);
+            uint64_t length;
+            s.append("}");
+            return ReadVarint(&length);
+          }
+          s.append(first ? "" : ", ");
+          if (!ReadValue(out, depth + 1)) {
+            return false;
+          }
+          if (is_map) {
+            s.append(" => ");
+            if (!ReadValue(out, depth + 1)) {
+              return false;
+            }
+          }
+          if (Overflows(out)) {
+            return false;
+          }
+        }
+      }
+      case 'B': {
+        uint64_t size;
+        std::string_view bytes;
+        if (!ReadVarint(&size) || !ReadRaw(size, &bytes)) {
+          return false;
+        }
+        s.append("ArrayBuffer { byteLength: ");
+        s.append(std::to_string(size)).append(" }");
+        return true;
+      }
+      case '~': {
+        // A resizable ArrayBuffer.
+        uint64_t size, max_size;
+        std::string_view bytes;
+        if (!ReadVarint(&size) || !ReadVarint(&max_size) ||
+            !ReadRaw(size, &bytes)) {
+          return false;
+        }
+        s.append("ArrayBuffer { byteLength: ");
+        s.append(std::to_string(size)).append(" }");
+        return true;
+      }
+      case 'r': return ReadError(out, depth);
+    }
+    // Host objects, shared memory and WebAssembly aren't serialized, since
+    // the delegate throws for them.
+    return false;
+  }
+
+  bool ReadError(std::string* out, int depth) {
+    const char* name = "Error";
+    std::string message;
+    for (;;) {
+      uint8_t tag;
+      if (!ReadTag(&tag)) {
+        return false;
+      }
+      if (tag == '.') {
+        break;
+      } else if (GetErrorName(tag)) {
+        name = GetErrorName(tag);
+      } else if (tag == 'm' || tag == 's') {
+        uint8_t string_tag;
+        std::string value;
+        if (!ReadTag(&string_tag) || !ReadString(string_tag, &value)) {
+          return false;
+        }
+        if (tag == 'm') {
+          message = std::move(value);
+        }
+      } else if (tag == 'c') {
+        if (!ReadValue(nullptr, depth + 1)) {
+          return false;
+        }
+      } else {
+        return false;
+      }
+    }
+    if (out) {
+      out->append(name);
+      if (!message.empty()) {
+        out->append(": ").append(message);
+      }
+    }
+    return true;
+  }
+
+  std::string_view data_;
+  size_t pos_;
+  uint32_t version_ = 0;
+
+  // The ids of the objects read by this reader start at |first_id_|.
+  uint32_t first_id_ = 0;
+  uint32_t next_id_ = 0;
+
+  // Shared with the readers of references. The offset where each object
+  // starts, and whether the object is being read.
+  std::vector<size_t> own_objects_;
+  std::vector<bool> own_open_;
+  std::vector<size_t>* objects_ = &own_objects_;
+  std::vector<bool>* open_ = &own_open_;
+};
+
+// Formats a snapshot written by Serialize(). Top level strings aren't quoted.
+std::string FormatSnapshot(std::string_view snapshot) {
+  std::string out;
+  SnapshotReader reader(snapshot);
+  if (!reader.ReadHeader()) {
+    return "[Object]";
+  }
+  if (!reader.ReadValue(&out, 0) && out.size() <= kMaxMessageLength) {
+    return "[Object]";
+  }
+  if (out.size() > kMaxMessageLength) {
+    // Cut at the start of a UTF-8 sequence, so that it stays valid.
+    size_t size = kMaxMessageLength;
+    while (size > 0 && (static_cast<uint8_t>(out[size]) & 0xC0) == 0x80) {
+      size--;
+    }
+    out.resize(size);
+    out.append("…");
+  }
+  return out;
+}
+
+}  // namespace
+
+LogArgument CaptureLogArgument(Js* js, v8::Local<v8::Value> value) {
+  LogArgument arg;
+  if (value->IsNumber()) {
+    arg.type = LogArgument::NUMBER;
+    arg.number = value.As<v8::Number>()->Value();
+  } else if (!value->IsString() && IsSnapshotCandidate(js, value) &&
+             Serialize(js, value, &arg.text)) {
+    arg.type = LogArgument::SNAPSHOT;
+  } else {
+    arg.text = js->ToString(value);
+  }
+  return arg;
+}
+
+bool CaptureDirSnapshot(Js* js, v8::Local<v8::Value> value,
+                        std::string* snapshot) {
+  return !value->IsArray() && IsSnapshotCandidate(js, value) &&
+         Serialize(js, value, snapshot);
+}
+
+std::string FormatLogArguments(const std::vector<LogArgument>& args) {
+  std::string out;
+  for (size_t i = 0; i < args.size(); i++) {
+    const LogArgument& arg = args[i];
+    if (i > 0) {
+      out.push_back(' ');
+    }
+    if (arg.type == LogArgument::NUMBER) {
+      out.append(FormatNumber(arg.number));
+    } else if (arg.type == LogArgument::SNAPSHOT) {
+      out.append(FormatSnapshot(arg.text));
+    } else {
+      out.append(arg.text);
+    }
+  }
+  return out;
+}
+
+std::string FormatDirSnapshot(std::string_view snapshot) {
+  // Like the synchronous console.dir(): property names are sorted, and
+  // objects are described by their type.
+  std::map<std::string, std::string> properties;
+  SnapshotReader reader(snapshot);
+  std::string out = "Object";
+  if (!reader.ReadHeader() || !reader.ReadDirProperties(&properties)) {
+    return out;
+  }
+  for (const auto& [key, value] : properties) {
+    out.append("\n    ").append(key).append(": ").append(value);
+  }
+  return out;
+}
+
+std::string FormatNumber(double value) {
+  if (isnan(value)) {
+    return "NaN";
+  } else if (isinf(value)) {
+    return value < 0 ? "-Infinity" : "Infinity";
+  } else if (value == 0) {
+    return "0";
+  }
+
+  // The shortest digits that read back as the same value.
+  char buffer[32];
+  for (int precision = 1; precision <= 17; precision++) {
+    snprintf(buffer, sizeof(buffer), "%.*e", precision - 1, value);
+    if (strtod(buffer, nullptr) == value) {
+      break;
+    }
+  }
+
+  // |buffer| is like "-1.2345e+02".
+  std::string out = value < 0 ? "-" : "";
+  std::string digits;
+  const char* p = buffer + (value < 0 ? 1 : 0);
+  for (; *p != 'e'; p++) {
+    if (*p != '.') {
+      digits.push_back(*p);
+    }
+  }
+  while (digits.size() > 1 && digits.back() == '0') {
+    digits.pop_back();
+  }
+  int k = digits.size();
+  int n = atoi(p + 1) + 1;
+
+  // The steps of Number::toString in the ECMAScript spec.
+  if (k <= n && n <= 21) {
+    out.append(digits).append(n - k, '0');
+  } else if (0 < n && n <= 21) {
+    out.append(digits, 0, n).append(".").append(digits, n);
+  } else if (-6 < n && n <= 0) {
+    out.append("0.").append(-n, '0').append(digits);
+  } else {
+    out.push_back(digits[0]);
+    if (k > 1) {
+      out.append(".").append(digits, 1);
+    }
+    out.append(n - 1 >= 0 ? "e+" : "e-").append(std::to_string(abs(n - 1)));
+  }
+  return out;
+}
+
+LogFormatter::LogFormatter() : frame_bytes_(0), dropped_(0), queue_(1) {}
+
+LogFormatter::~LogFormatter() {
+  Flush();
+}
+
+void LogFormatter::Post(std::vector<LogArgument> args, ConsoleLogLevel level) {
+  for (const LogArgument& arg : args) {
+    frame_bytes_ += arg.text.size() + sizeof(arg);
+  }
+  queue_.Post([args = std::move(args), level] {
+    ::Log(FormatLogArguments(args), level);
+  });
+}
+
+void LogFormatter::PostDir(std::string snapshot) {
+  frame_bytes_ += snapshot.size();
+  queue_.Post([snapshot = std::move(snapshot)] {
+    ::Log(FormatDirSnapshot(snapshot), ConsoleLogLevel::CONSOLE_LOG);
+  });
+}
+
+void LogFormatter::PostClear() {
+  queue_.Post([] { ClearLogs(); });
+}
+
+void LogFormatter::Flush() {
+  std::mutex lock;
+  std::condition_variable cond_var;
+  bool done = false;
+  queue_.Post([&] {
+    std::lock_guard<std::mutex> guard(lock);
+    done = true;
+    cond_var.notify_one();
+  });
+  std::unique_lock<std::mutex> guard(lock);
+  cond_var.wait(guard, [&] { return done; });
+}
+
+void LogFormatter::EndFrame() {
+  frame_bytes_ = 0;
+  if (dropped_ > 0) {
+    std::string message = std::to_string(dropped_) +
+                          " console messages were dropped in the last frame";
+    queue_.Post([message = std::move(message)] {
+      ::Log(std::move(message), ConsoleLogLevel::CONSOLE_WARN);
+    });
+    dropped_ = 0;
+  }
+}
+
+void SetLogFormatter(LogFormatter* formatter) {
+  g_log_formatter = formatter;
+}
+
+LogFormatter* GetLogFormatter() {
+  return g_log_formatter;
+}
@@ -0,0 +1,100 @@
+#ifndef WINDOWJS_LOG_FORMATTER_H
+#define WINDOWJS_LOG_FORMATTER_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <v8/include/v8.h>
+
+#include "console.h"
+#include "task_queue.h"
+
+class Js;
+
+// An argument of a console call, captured in the main thread so that it can be
+// formatted in a background thread.
+struct LogArgument {
+  enum Type : uint8_t {
+    // |text| is the argument converted to a string already.
+    TEXT,
+    NUMBER,
+    // |text| has a snapshot of a plain object or Array, written by a
+    // v8::ValueSerializer.
+    SNAPSHOT,
+  };
+
+  Type type = TEXT;
+  double number = 0;
+  std::string text;
+};
+
+// Captures |value| cheaply: primitives are copied, and plain objects and
+// Arrays are serialized. Other objects, like functions, Errors and native
+// objects, are converted to strings right away, since that may call into
+// Javascript.
+LogArgument CaptureLogArgument(Js* js, v8::Local<v8::Value> value);
+
+// Captures a snapshot of |value| for console.dir, if it's a plain object.
+bool CaptureDirSnapshot(Js* js, v8::Local<v8::Value> value,
+                        std::string* snapshot);
+
+// Returns the message for a console call with |args|, separated by spaces.
+// Objects are formatted like {a: 1, b: [2, 3]}.
+std::string FormatLogArguments(const std::vector<LogArgument>& args);
+
+// Returns the message for console.dir of a snapshot from CaptureDirSnapshot.
+std::string FormatDirSnapshot(std::string_view snapshot);
+
+// Formats |value| like Number.prototype.toString().
+std::string FormatNumber(double value);
+
+// Formats the console calls in a background thread, in the order they were
+// made, and then passes them to Log(). The arguments captured in each frame
+// are limited to kFrameBudget bytes; the calls over the budget are dropped.
+//
+// All the methods must be called in the main thread.
+class LogFormatter final {
+ public:
+  static constexpr size_t kFrameBudget = 1024 * 1024;
+
+  LogFormatter();
+  // Formats all the pending calls before returning.
+  ~LogFormatter();
+
+  LogFormatter(const LogFormatter&) = delete;
+  LogFormatter& operator=(const LogFormatter&) = delete;
+
+  // Whether the console calls in this frame have used the budget already.
+  // Calls over the budget should be dropped without capturing their
+  // arguments.
+  bool IsOverBudget() const { return frame_bytes_ >= kFrameBudget; }
+  void Drop() { dropped_++; }
+
+  void Post(std::vector<LogArgument> args, ConsoleLogLevel level);
+  void PostDir(std::string snapshot);
+  // Clears the logs after the pending calls are formatted.
+  void PostClear();
+
+  // Blocks until all the pending calls have been formatted and logged.
+  void Flush();
+
+  // Resets the budget, and logs how many calls were dropped in the last
+  // frame.
+  void EndFrame();
+
+ private:
+  size_t frame_bytes_;
+  uint32_t dropped_;
+  // A single thread, so that the calls are logged in order.
+  ThreadPoolTaskQueue queue_;
+};
+
+// The LogFormatter used by the console, or null to format in the main thread.
+void SetLogFormatter(LogFormatter* formatter);
+LogFormatter* GetLogFormatter();
+
+#endif  // WINDOWJS_LOG_FORMATTER_H
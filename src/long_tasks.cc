@@ -0,0 +1,70 @@
+#include "long_tasks.h"
+
+#include <algorithm>
+#include <sstream>
+
+namespace {
+
+// Reported tasks are kept until the main loop takes them. This bounds them
+// if it doesn't, e.g. while the main module is loading.
+constexpr size_t kMaxReported = 100;
+
+}  // namespace
+
+LongTasks::LongTasks() {
+  Reset();
+}
+
+void LongTasks::Report(std::string name, std::string source, double start,
+                       double duration) {
+  count_++;
+  total_duration_ += duration;
+  max_duration_ = std::max(max_duration_, duration);
+  last_report_start_ = start;
+  if (reported_.size() < kMaxReported) {
+    reported_.push_back({std::move(name), std::move(source), start, duration});
+  }
+}
+
+void LongTasks::OnTaskFinished(double start, double duration) {
+  if (IsLong(duration) && last_report_start_ < start) {
+    Report("task", "", start, duration);
+  }
+}
+
+std::vector<LongTasks::Task> LongTasks::TakeReported() {
+  std::vector<Task> reported;
+  reported.swap(reported_);
+  return reported;
+}
+
+void LongTasks::ResetTotals() {
+  count_ = 0;
+  total_duration_ = 0;
+  max_duration_ = 0;
+}
+
+void LongTasks::Reset() {
+  threshold_ = kDefaultThreshold;
+  last_report_start_ = -1;
+  reported_.clear();
+  ResetTotals();
+}
+
+std::string DescribeFunction(v8::Isolate* isolate, v8::Local<v8::Function> f) {
+  std::stringstream ss;
+  v8::String::Utf8Value name(isolate, f->GetDebugName());
+  if (*name && name.length() > 0) {
+    ss << *name;
+  } else {
+    ss << "(anonymous)";
+  }
+  v8::Local<v8::Value> resource = f->GetScriptOrigin().ResourceName();
+  int line = f->GetScriptLineNumber();
+  if (!resource.IsEmpty() && resource->IsString() && line >= 0) {
+    v8::String::Utf8Value url(isolate, resource);
+    ss << " (" << *url << ":" << line + 1 << ":"
+       << f->GetScriptColumnNumber() + 1 << ")";
+  }
+  return ss.str();
+}
@@ -0,0 +1,75 @@
+#ifndef WINDOWJS_LONG_TASKS_H
+#define WINDOWJS_LONG_TASKS_H
+
+#include <stdint.h>
+
+#include <string>
+#include <vector>
+
+#include <v8/include/v8.h>
+
+// Detects the Javascript callbacks and tasks that run for longer than a
+// threshold. Those block the main loop, and a single one can delay a whole
+// frame.
+//
+// Event listeners, setTimeout and requestAnimationFrame callbacks are reported
+// with the function that ran. Other tasks in the main TaskQueue, like Promise
+// resolutions, are timed as a whole.
+class LongTasks final {
+ public:
+  // In seconds, like the 50ms of the web's Long Tasks API.
+  static constexpr double kDefaultThreshold = 0.05;
+
+  struct Task {
+    // An event type, "setTimeout", "requestAnimationFrame", or "task" for the
+    // other tasks.
+    std::string name;
+    // The function that ran, from DescribeFunction(). Empty for tasks.
+    std::string source;
+    // In seconds, from GetClockTime().
+    double start;
+    double duration;
+  };
+
+  LongTasks();
+
+  double threshold() const { return threshold_; }
+  void SetThreshold(double seconds) { threshold_ = seconds; }
+
+  bool IsLong(double duration) const { return duration >= threshold_; }
+
+  // Reports a callback that took longer than the threshold.
+  void Report(std::string name, std::string source, double start,
+              double duration);
+
+  // Called after each task of the main TaskQueue. Reports the task if it was
+  // long, unless a callback that it ran was reported already.
+  void OnTaskFinished(double start, double duration);
+
+  // Returns the tasks reported since the last call.
+  std::vector<Task> TakeReported();
+
+  // Totals since the last ResetTotals().
+  uint32_t count() const { return count_; }
+  double total_duration() const { return total_duration_; }
+  double max_duration() const { return max_duration_; }
+
+  void ResetTotals();
+
+  // Also drops any reported tasks, and restores the default threshold.
+  void Reset();
+
+ private:
+  double threshold_;
+  double last_report_start_;
+  std::vector<Task> reported_;
+
+  uint32_t count_;
+  double total_duration_;
+  double max_duration_;
+};
+
+// Returns a description of |f| for the logs, like "update (main.js:12:3)".
+std::string DescribeFunction(v8::Isolate* isolate, v8::Local<v8::Function> f);
+
+#endif  // WINDOWJS_LONG_TASKS_H
@@ -1,12 +1,16 @@
 #include "main.h"
 
+#include <algorithm>
 #include <filesystem>
+#include <iomanip>
 #include <iostream>
 #include <memory>
+#include <sstream>
 
 #include <skia/include/core/SkEncodedImageFormat.h>
 
 #include "args.h"
+#include "clock.h"
 #include "fail.h"
 #include "file.h"
 #include "js_api_process.h"
@@ -19,6 +23,7 @@ int main(int argc, char* argv[]) {
   InitArgs(argc, argv);
   InitLog();
   InitMainThread();
+  InitClock();
   uv_setup_args(argc, argv);
   uv_disable_stdio_inheritance();
 
@@ -28,7 +33,7 @@ int main(int argc, char* argv[]) {
   }
 
   if (Args().profile_startup) {
-    $(DEV) << "[profile-startup] main() enter: " << glfwGetTime();
+    $(DEV) << "[profile-startup] main() enter: " << GetClockTime();
   }
 
   Js::Init(argv[0]);
@@ -63,17 +68,46 @@ Main::Main()
       gc_quit_(false),
       main_module_loaded_(false),
       reload_requested_(false),
-      first_load_(true) {
+      first_load_(true),
+      last_animation_frame_time_(0),
+      frame_(0),
+      replay_start_time_(0),
+      dropped_logs_(0) {
   ASSERT(IsMainThread());
   SetLogHandler(this);
-  task_queue_.SetPostsEmptyEvents(true);
+  SetLogFormatter(&log_formatter_);
+  // Without a window, RunUntilClosed waits on the task_queue_ instead.
+  task_queue_.SetPostsEmptyEvents(!Args().no_window);
+  task_queue_.SetTaskObserver([this](double start, double duration) {
+    window_.stats()->long_tasks()->OnTaskFinished(start, duration);
+  });
+  events_.SetLongTasks(window_.stats()->long_tasks());
   window_.SetDelegate(this);
   window_.SetTitle(Args().initial_module);
+  if (!Args().record_input.empty()) {
+    input_recorder_ = std::make_unique<InputRecorder>(Args().record_input);
+  }
+  if (!Args().metrics_file.empty()) {
+    metrics_ = std::make_unique<Metrics>(Args().metrics_file,
+                                         Args().metrics_interval);
+  }
+  if (!Args().replay_input.empty()) {
+    input_replayer_ = std::make_unique<InputReplayer>(Args().replay_input);
+    // Replays run as fast as possible, and ignore any live input.
+    window_.SetIgnoreInput(true);
+    window_.SetVsync(false);
+    replay_start_time_ = uv_hrtime();
+  }
   Reload();
 }
 
 Main::~Main() {
   ASSERT(IsMainThread());
+  if (input_recorder_) {
+    input_recorder_->SetLastFrame(frame_);
+    input_recorder_.reset();
+  }
+  SetLogFormatter(nullptr);
   SetLogHandler(nullptr);
   events_.RemoveAll();
   gc_quit_ = true;
@@ -88,7 +122,8 @@ void Main::Reload() {
 
   // Shutdown objects that will be recreated.
   if (!first_load_) {
-    glfwSetTime(0.0);
+    ResetClock();
+    last_animation_frame_time_ = 0;
     window_.stats()->Reset();
     messages_to_console_.clear();
     gc_quit_ = true;
@@ -102,8 +137,17 @@ void Main::Reload() {
     window_.console_overlay()->SetEnabled(false);
     window_.console_overlay()->SetEnableOnErrors(true);
     pending_events_.clear();
+    // Logs of the previous page that are still being formatted are dropped
+    // with the other pending logs below.
+    log_formatter_.Flush();
     background_queue_.ResetDropAllTasks();
     task_queue_.ResetDropAllTasks();
+    {
+      // The task to flush these logs was just dropped too.
+      std::lock_guard<std::mutex> lock(logs_lock_);
+      pending_logs_.clear();
+      dropped_logs_ = 0;
+    }
   }
 
   // Recreate those objects now.
@@ -119,6 +163,12 @@ void Main::Reload() {
 
   window_.stats()->SetJs(js_.get(), api_.get());
 
+  if (metrics_) {
+    metrics_->SetIsolate(js_->isolate());
+    // The previous task was dropped with the others.
+    ScheduleMetrics();
+  }
+
   gc_quit_ = false;
   gc_thread_ = std::thread([this] {
     GcThread();
@@ -126,25 +176,27 @@ void Main::Reload() {
 
   // Load the initial module again.
   if (first_load_ && Args().profile_startup) {
-    $(DEV) << "[profile-startup] load initial module start: " << glfwGetTime();
+    $(DEV) << "[profile-startup] load initial module start: " << GetClockTime();
   }
 
   main_module_loaded_ = false;
   js_->LoadMainModule(Args().initial_module);
 
   if (first_load_ && Args().profile_startup) {
-    $(DEV) << "[profile-startup] load initial module end: " << glfwGetTime();
+    $(DEV) << "[profile-startup] load initial module end: " << GetClockTime();
   }
 }
 
 void Main::OnMainModuleLoaded() {
   main_module_loaded_ = true;
   window_.OnLoadingFinished();
-  glfwPostEmptyEvent();
+  if (window_.window()) {
+    glfwPostEmptyEvent();
+  }
 }
 
 void Main::RunUntilClosed() {
-  while (!glfwWindowShouldClose(window_.window())) {
+  while (!window_.should_close()) {
     // === Loop part 1 ===
     //
     // This part of the loop runs inside Javascript, so this blocks waiting
@@ -163,6 +215,9 @@ void Main::RunUntilClosed() {
       std::vector<PendingEvent> events;
       events.swap(pending_events_);
       for (const PendingEvent& event : events) {
+        if (event.timestamp > 0) {
+          window_.stats()->OnInputDispatched(event.timestamp);
+        }
         if (events_.HasListeners(event.type)) {
           events_.Dispatch(event.type, event.f(scope), scope);
           if (try_catch.HasCaught()) {
@@ -179,13 +234,32 @@ void Main::RunUntilClosed() {
       window_.stats()->OnJsFinished();
 
       // CallAnimationFrameCallbacks handles exceptions internally too.
-      api_->CallAnimationFrameCallbacks(scope);
-      ASSERT(!try_catch.HasCaught());
+      if (IsAnimationFrameDue()) {
+        last_animation_frame_time_ = GetClockTime();
+        api_->CallAnimationFrameCallbacks(scope);
+        ASSERT(!try_catch.HasCaught());
+      }
       window_.stats()->OnRafFinished();
 
+      // Prewarm fonts in the time left after this frame's Javascript.
+      api_->RunFontPrewarms(scope, kFontPrewarmBudget);
+      // And convert the JSON files read with {incremental: true}.
+      api_->RunJsonConversions(scope, kJsonConversionBudget);
+
+      DispatchLongTasks(scope);
+
+      // Listeners, tasks and animation frame callbacks have all seen this
+      // frame's input state now.
+      window_.input()->EndFrame();
+      log_formatter_.EndFrame();
+
       if (first_load_ && Args().profile_startup) {
         $(DEV) << "[profile-startup] first requestAnimationFrame: "
-               << glfwGetTime();
+               << GetClockTime();
+        $(DEV) << "[profile-startup] constant strings made: "
+               << js_->strings()->made_count() << " of "
+               << static_cast<int>(StringId::LAST_STRING_ID) << " in "
+               << js_->strings()->made_time() * 1000 << " ms";
       }
 
       // Log any Promise failures that didn't have a handler.
@@ -228,8 +302,13 @@ void Main::RunUntilClosed() {
     // Case (1) just polls for events now and immediately goes into the next
     // frame. Case (2) waits "forever" until an event arrives. Case (3) waits
     // for T seconds or until an input event is received.
+    //
+    // Without a window there are no input events, and the loop waits for
+    // posted tasks instead.
     double timeout = GetTimeoutUntilNextFrame();
-    if (timeout < 0) {
+    if (!window_.window()) {
+      task_queue_.Wait(timeout);
+    } else if (timeout < 0) {
       glfwWaitEvents();
     } else if (timeout == 0) {
       glfwPollEvents();
@@ -237,9 +316,14 @@ void Main::RunUntilClosed() {
       glfwWaitEventsTimeout(timeout);
     }
 
+    if (input_replayer_) {
+      ReplayInput();
+    }
+
     window_.stats()->OnWaitFinished();
 
     first_load_ = false;
+    frame_++;
   }
 }
 
@@ -248,19 +332,49 @@ double Main::GetTimeoutUntilNextFrame() const {
 
   // Draw the next frame as soon as possible if there is a callback to
   // requestAnimationFrame.
-  if (api_->has_animation_frame_callbacks() || window_.wants_frames()) {
-    timeout = 0;
+  if (api_->has_animation_frame_callbacks() || api_->has_font_prewarms() ||
+      api_->has_json_conversions() || window_.wants_frames()) {
+    if (window_.window()) {
+      timeout = 0;
+    } else {
+      // There is no vsync to wait on without a window.
+      double next_frame = std::max(
+          0.0, last_animation_frame_time_ + kNoWindowFrameInterval -
+                   GetClockTime());
+      timeout = timeout < 0 ? next_frame : std::min(timeout, next_frame);
+    }
   }
 
   // If the window is minimized then don't render on every vsync until it's
   // restored again.
-  if (timeout == 0 && glfwGetWindowAttrib(window_.window(), GLFW_ICONIFIED)) {
+  if (timeout == 0 && window_.minimized()) {
     timeout = -1;
+    // But keep converting JSON files and prewarming fonts, so that their
+    // promises still resolve; there's no vsync to pace that either.
+    if (api_->has_font_prewarms() || api_->has_json_conversions()) {
+      const double next_task = task_queue_.GetSecondsToNextTask();
+      timeout = next_task < 0 ? kNoWindowFrameInterval
+                              : std::min(next_task, kNoWindowFrameInterval);
+    }
+  }
+
+  // Keep going while there is recorded input left to replay, since live
+  // input won't wake up the loop.
+  if (input_replayer_ && !input_replayer_->finished()) {
+    timeout = 0;
   }
 
   return timeout;
 }
 
+bool Main::IsAnimationFrameDue() const {
+  // Frames are paced by vsync when there is a window.
+  if (window_.window()) {
+    return true;
+  }
+  return GetClockTime() >= last_animation_frame_time_ + kNoWindowFrameInterval;
+}
+
 void Main::GcThread() {
   for (;;) {
     gc_signal_.WaitAndClear();
@@ -294,19 +408,31 @@ void Main::ShowConsole() {
             HandleConsoleProcessExit(std::move(error));
           });
         });
-    std::stringstream json;
-    json << "{\"type\":\"init\"";
-    json << ",\"x\":" << window_.x();
-    json << ",\"y\":" << window_.y();
-    json << ",\"width\":" << window_.width();
-    json << ",\"height\":" << window_.height();
-    json << ",\"frameLeft\":" << window_.frame_left();
-    json << ",\"frameRight\":" << window_.frame_right();
-    json << ",\"frameTop\":" << window_.frame_top();
-    json << ",\"frameBottom\":" << window_.frame_bottom();
-    json << ",\"title\":" << Json::EscapeString(window_.title());
-    json << "}";
-    console_->SendMessage(0, json.str());
+    std::string json;
+    JsonWriter(&json)
+        .BeginDictionary()
+        .Key("type")
+        .String("init")
+        .Key("x")
+        .Int(window_.x())
+        .Key("y")
+        .Int(window_.y())
+        .Key("width")
+        .Int(window_.width())
+        .Key("height")
+        .Int(window_.height())
+        .Key("frameLeft")
+        .Int(window_.frame_left())
+        .Key("frameRight")
+        .Int(window_.frame_right())
+        .Key("frameTop")
+        .Int(window_.frame_top())
+        .Key("frameBottom")
+        .Int(window_.frame_bottom())
+        .Key("title")
+        .String(window_.title())
+        .EndDictionary();
+    console_->SendMessage(0, std::move(json));
   }
 
   for (std::string& message : messages_to_console_) {
@@ -327,37 +453,95 @@ void Main::SaveScreenshot() {
   background_queue_.Post([image]() {
     sk_sp<SkData> data = image->encodeToData(SkEncodedImageFormat::kPNG, 100);
     ASSERT(data);
-    for (int i = 1; i < 1000; i++) {
-      std::string name;
-      if (i == 1) {
-        name = "Screenshot.png";
-      } else {
-        name = "Screenshot-" + std::to_string(i) + ".png";
-      }
-      std::filesystem::path path = GetCwd() / name;
-      std::string error;
-      if (IsFile(path, &error) || !error.empty()) {
-        continue;
-      }
-      if (WriteFile(path, data->data(), data->size(), &error)) {
-        $(DEV) << "Saved screenshot to " << name << ".";
-      } else {
-        $(DEV) << "Screenshot couldn't be saved to " << name << ": " << error;
+    std::filesystem::path path = GetNewFilePath("Screenshot", ".png");
+    if (path.empty()) {
+      $(DEV) << "Screenshot couldn't be saved: too many screenshots!";
+      return;
+    }
+    std::string name = path.filename().u8string();
+    std::string error;
+    if (WriteFile(path, data->data(), data->size(), &error)) {
+      $(DEV) << "Saved screenshot to " << name << ".";
+    } else {
+      $(DEV) << "Screenshot couldn't be saved to " << name << ": " << error;
+    }
+  });
+}
+
+void Main::DispatchLongTasks(const JsScope& scope) {
+  std::vector<LongTasks::Task> tasks =
+      window_.stats()->long_tasks()->TakeReported();
+  for (const LongTasks::Task& task : tasks) {
+    std::stringstream ss;
+    ss << "Long task: " << task.name;
+    if (!task.source.empty()) {
+      ss << " " << task.source;
+    }
+    ss << " took " << std::fixed << std::setprecision(1)
+       << task.duration * 1000 << " ms";
+    $(WARN) << ss.str();
+    if (events_.HasListeners(JsEventType::LONGTASK)) {
+      v8::TryCatch try_catch(scope.isolate);
+      events_.Dispatch(JsEventType::LONGTASK, MakeLongTaskEvent(task, scope),
+                       scope);
+      if (try_catch.HasCaught()) {
+        js_->ReportException(try_catch.Message());
       }
+    }
+  }
+}
+
+void Main::ScheduleMetrics() {
+  task_queue_.Post(metrics_->interval(), [this] {
+    metrics_->Collect(window_.stats(),
+                      window_.shared_context()->skia_context(), task_queue_,
+                      &background_queue_);
+    ScheduleMetrics();
+  });
+}
+
+void Main::ToggleCpuProfiling() {
+  static const char* kTitle = "console";
+  v8::Locker locker(js_->isolate());
+  JsScope scope(js_.get());
+  CpuProfiler* profiler = api_->cpu_profiler();
+  if (!profiler->IsProfiling(kTitle)) {
+    if (profiler->Start(kTitle, CpuProfiler::kDefaultSampleIntervalUs)) {
+      $(DEV) << "Started CPU profiling.";
+    }
+    return;
+  }
+  std::shared_ptr<CpuProfileData> profile = profiler->Stop(kTitle);
+  if (!profile) {
+    return;
+  }
+  background_queue_.Post([profile]() {
+    std::string json = profile->ToJson();
+    std::filesystem::path path = GetNewFilePath("Profile", ".cpuprofile");
+    if (path.empty()) {
+      $(DEV) << "CPU profile couldn't be saved: too many profiles!";
       return;
     }
-    $(DEV) << "Screenshot couldn't be saved: too many screenshots!";
+    std::string name = path.filename().u8string();
+    std::string error;
+    if (WriteFile(path, json, &error)) {
+      $(DEV) << "Saved CPU profile to " << name << ".";
+    } else {
+      $(DEV) << "CPU profile couldn't be saved to " << name << ": " << error;
+    }
   });
 }
 
 void Main::HandleMessageFromConsoleProcess(std::string message) {
   ASSERT(IsMainThread());
   std::string error;
-  std::unique_ptr<Json> json = Json::Parse(message, &error);
+  std::unique_ptr<JsonDocument> document =
+      JsonDocument::Parse(message, &error);
   // Validated at the sender.
-  ASSERT(json);
-  ASSERT(json->IsDictionary());
-  const Json& type = (*json)["type"];
+  ASSERT(document);
+  const Json& json = document->root();
+  ASSERT(json.IsDictionary());
+  const Json& type = json["type"];
   ASSERT(type.IsString());
   if (type.String() == "close") {
     OnClose();
@@ -372,6 +556,11 @@ void Main::HandleMessageFromConsoleProcess(std::string message) {
   } else if (type.String() == "profile-frames") {
     window_.stats()->SetPrintFrameTimes(
         !window_.stats()->is_print_frame_times());
+  } else if (type.String() == "api-counters") {
+    window_.stats()->SetShowApiCounters(
+        !window_.stats()->is_show_api_counters());
+  } else if (type.String() == "profile-cpu") {
+    ToggleCpuProfiling();
   } else if (type.String() == "overlay-console") {
     window_.console_overlay()->SetEnabled(
         !window_.console_overlay()->is_enabled());
@@ -380,13 +569,19 @@ void Main::HandleMessageFromConsoleProcess(std::string message) {
   } else if (type.String() == "clear-logs") {
     OnClearLogs();
   } else if (type.String() == "eval") {
-    const Json& source = (*json)["source"];
+    const Json& source = json["source"];
     ASSERT(source.IsString());
     std::unique_ptr<std::string> result = js_->ExecuteScript(source.String());
     if (result) {
-      std::string json = "{\"type\":\"evalResponse\", \"result\":" +
-                         Json::EscapeString(*result) + "}";
-      console_->SendMessage(0, std::move(json));
+      std::string response;
+      JsonWriter(&response)
+          .BeginDictionary()
+          .Key("type")
+          .String("evalResponse")
+          .Key("result")
+          .String(*result)
+          .EndDictionary();
+      console_->SendMessage(0, std::move(response));
     }
   }
 }
@@ -413,18 +608,91 @@ void Main::PostMessageToConsole(std::string json) {
 
 void Main::OnLog(std::string message, ConsoleLogLevel level) {
   // Can be called on any thread. This is synchronized via SetLogHandler.
-  std::string json =
-      "{\"type\": \"log\", \"message\":" + Json::EscapeString(message) +
-      ", \"level\":\"" + ConsoleLogLevelToString(level) + "\"}";
-  task_queue_.Post(
-      [this, json = std::move(json), message = std::move(message), level] {
-        if (Args().is_child_process) {
-          api_->parent_process()->SendMessage(ProcessApi::LOG, std::move(json));
-        } else {
-          PostMessageToConsole(std::move(json));
-          window_.console_overlay()->OnLog(std::move(message), level);
-        }
-      });
+  // Escaping is done here too, to keep it out of the main thread when logs
+  // come from the LogFormatter.
+  std::string json = Json::EscapeString(message);
+  bool post_flush = false;
+  {
+    std::lock_guard<std::mutex> lock(logs_lock_);
+    post_flush = pending_logs_.empty();
+    if (pending_logs_.size() >= kMaxPendingLogs) {
+      pending_logs_.pop_front();
+      dropped_logs_++;
+    }
+    pending_logs_.push_back({std::move(message), std::move(json), level});
+  }
+  // Only the first log after a flush posts a task; the others are batched
+  // into the same flush.
+  if (post_flush) {
+    task_queue_.Post([this] {
+      FlushLogs();
+    });
+  }
+}
+
+void Main::FlushLogs() {
+  ASSERT(IsMainThread());
+
+  std::deque<PendingLog> logs;
+  int dropped = 0;
+  {
+    std::lock_guard<std::mutex> lock(logs_lock_);
+    logs.swap(pending_logs_);
+    dropped = dropped_logs_;
+    dropped_logs_ = 0;
+  }
+
+  if (dropped > 0) {
+    // The oldest messages were dropped, so the summary goes first.
+    std::string message = std::to_string(dropped) + " log messages dropped.";
+    std::string json = Json::EscapeString(message);
+    logs.push_front({std::move(message), std::move(json),
+                     ConsoleLogLevel::CONSOLE_WARN});
+  }
+
+  if (logs.empty()) {
+    return;
+  }
+
+  if (Args().is_child_process) {
+    // The parent gets one "log" event per message.
+    for (const PendingLog& log : logs) {
+      std::string json;
+      JsonWriter(&json)
+          .BeginDictionary()
+          .Key("type")
+          .String("log")
+          .Key("message")
+          .Raw(log.json)
+          .Key("level")
+          .String(ConsoleLogLevelToString(log.level))
+          .EndDictionary();
+      api_->parent_process()->SendMessage(ProcessApi::LOG, std::move(json));
+    }
+    return;
+  }
+
+  // Send all the messages to the console in a single batch.
+  std::string json;
+  JsonWriter writer(&json);
+  writer.BeginDictionary().Key("type").String("logs").Key("messages");
+  writer.BeginList();
+  for (const PendingLog& log : logs) {
+    writer.BeginDictionary()
+        .Key("message")
+        .Raw(log.json)
+        .Key("level")
+        .String(ConsoleLogLevelToString(log.level))
+        .EndDictionary();
+  }
+  writer.EndList().EndDictionary();
+  PostMessageToConsole(std::move(json));
+
+  // The overlay only shows the last few lines, but errors anywhere in the
+  // batch can still enable it.
+  for (PendingLog& log : logs) {
+    window_.console_overlay()->OnLog(std::move(log.message), log.level);
+  }
 }
 
 void Main::OnClearLogs() {
@@ -446,20 +714,24 @@ void Main::OnClearLogs() {
 void Main::OnJavascriptException(std::string message,
                                  std::vector<std::string> stack_trace) {
   ASSERT(IsMainThread());
-  std::string json =
-      "{\"type\": \"exception\", \"message\":" + Json::EscapeString(message) +
-      ", \"stacktrace\":[";
+  // Keep the exception ordered after any logs that preceded it.
+  log_formatter_.Flush();
+  FlushLogs();
+  std::string json;
+  JsonWriter writer(&json);
+  writer.BeginDictionary()
+      .Key("type")
+      .String("exception")
+      .Key("message")
+      .String(message)
+      .Key("stacktrace")
+      .BeginList();
   std::string merged = message;
-  bool first = true;
   for (const std::string& frame : stack_trace) {
-    if (!first) {
-      json.append(1, ',');
-    }
-    first = false;
-    json.append(Json::EscapeString(frame));
+    writer.String(frame);
     merged.append("\n  ").append(frame);
   }
-  json.append("]}");
+  writer.EndList().EndDictionary();
   if (Args().is_child_process) {
     api_->parent_process()->SendMessage(ProcessApi::EXCEPTION, std::move(json));
   } else {
@@ -475,7 +747,58 @@ void Main::OnJavascriptException(std::string message,
   }
 }
 
+void Main::RecordInput(RecordedInput input, double timestamp) {
+  input.frame = frame_;
+  input.timestamp = timestamp;
+  input_recorder_->Record(input);
+}
+
+void Main::ReplayInput() {
+  while (const RecordedInput* input = input_replayer_->Next(frame_)) {
+    switch (input->type) {
+      case RecordedInput::KEY:
+        window_.HandleKey(input->key, input->scancode, input->action,
+                          input->mods);
+        break;
+      case RecordedInput::CHARACTER:
+        window_.HandleCharacter(input->key);
+        break;
+      case RecordedInput::MOUSE_MOVE:
+        window_.HandleMouseMove(input->x, input->y);
+        break;
+      case RecordedInput::MOUSE_BUTTON:
+        window_.HandleMouseButton(input->key, input->action != 0, input->x,
+                                  input->y);
+        break;
+      case RecordedInput::MOUSE_WHEEL:
+        window_.HandleMouseWheel(input->x, input->y);
+        break;
+      case RecordedInput::MOUSE_ENTER:
+        window_.HandleMouseEnter(input->action != 0);
+        break;
+      case RecordedInput::END: {
+        double elapsed = (uv_hrtime() - replay_start_time_) / 1e9;
+        $(DEV) << "[replay-input] Replayed " << input_replayer_->size() - 1
+               << " inputs in " << frame_ + 1 << " frames and " << elapsed
+               << " seconds";
+        window_.Close();
+        break;
+      }
+    }
+  }
+}
+
 void Main::OnKey(int key, int scancode, int action, int mods) {
+  double timestamp = GetClockTime();
+  if (input_recorder_) {
+    RecordedInput input;
+    input.type = RecordedInput::KEY;
+    input.key = key;
+    input.scancode = scancode;
+    input.action = action;
+    input.mods = mods;
+    RecordInput(input, timestamp);
+  }
   if (!Args().disable_dev_keys) {
     if (!Args().is_child_process) {
       if (key == GLFW_KEY_ESCAPE && action == GLFW_PRESS) {
@@ -490,8 +813,13 @@ void Main::OnKey(int key, int scancode, int action, int mods) {
       } else if (key == GLFW_KEY_F4 && action == GLFW_PRESS) {
         window_.console_overlay()->SetEnabled(
             !window_.console_overlay()->is_enabled());
+      } else if (key == GLFW_KEY_F7 && action == GLFW_PRESS) {
+        ToggleCpuProfiling();
       } else if (key == GLFW_KEY_F8 && action == GLFW_PRESS) {
         SaveScreenshot();
+      } else if (key == GLFW_KEY_F9 && action == GLFW_PRESS) {
+        window_.stats()->SetShowApiCounters(
+            !window_.stats()->is_show_api_counters());
       }
     }
     if (key == GLFW_KEY_F5 && action == GLFW_PRESS) {
@@ -515,49 +843,91 @@ void Main::OnKey(int key, int scancode, int action, int mods) {
     }
   }
   auto f = [=](const JsScope& scope) {
-    return MakeKeyEvent(key, scancode, action, mods, scope);
+    return MakeKeyEvent(key, scancode, action, mods, timestamp, scope);
   };
   JsEventType type =
       action == GLFW_RELEASE ? JsEventType::KEYUP : JsEventType::KEYDOWN;
-  pending_events_.push_back({type, f});
+  pending_events_.push_back({type, f, timestamp});
 }
 
 void Main::OnCharacter(unsigned int codepoint) {
+  double timestamp = GetClockTime();
+  if (input_recorder_) {
+    RecordedInput input;
+    input.type = RecordedInput::CHARACTER;
+    input.key = codepoint;
+    RecordInput(input, timestamp);
+  }
   auto f = [=](const JsScope& scope) {
-    return MakeKeyPressEvent(codepoint, scope);
+    return MakeKeyPressEvent(codepoint, timestamp, scope);
   };
-  pending_events_.push_back({JsEventType::KEYPRESS, f});
+  pending_events_.push_back({JsEventType::KEYPRESS, f, timestamp});
 }
 
 void Main::OnMouseMove(double x, double y) {
+  double timestamp = GetClockTime();
+  if (input_recorder_) {
+    RecordedInput input;
+    input.type = RecordedInput::MOUSE_MOVE;
+    input.x = x;
+    input.y = y;
+    RecordInput(input, timestamp);
+  }
   auto f = [=](const JsScope& scope) {
-    return MakeMouseMoveEvent(x, y, scope);
+    return MakeMouseMoveEvent(x, y, timestamp, scope);
   };
-  pending_events_.push_back({JsEventType::MOUSEMOVE, f});
+  pending_events_.push_back({JsEventType::MOUSEMOVE, f, timestamp});
 }
 
 void Main::OnMouseButton(int button, bool pressed, double x, double y) {
+  double timestamp = GetClockTime();
+  if (input_recorder_) {
+    RecordedInput input;
+    input.type = RecordedInput::MOUSE_BUTTON;
+    input.key = button;
+    input.action = pressed ? 1 : 0;
+    input.x = x;
+    input.y = y;
+    RecordInput(input, timestamp);
+  }
   JsEventType type = pressed ? JsEventType::MOUSEDOWN : JsEventType::MOUSEUP;
   auto f = [=](const JsScope& scope) {
-    return MakeMouseButtonEvent(type, button, x, y, scope);
+    return MakeMouseButtonEvent(type, button, x, y, timestamp, scope);
   };
-  pending_events_.push_back({type, f});
+  pending_events_.push_back({type, f, timestamp});
   if (!pressed) {
     auto f = [=](const JsScope& scope) {
-      return MakeMouseButtonEvent(JsEventType::CLICK, button, x, y, scope);
+      return MakeMouseButtonEvent(JsEventType::CLICK, button, x, y, timestamp,
+                                  scope);
     };
+    // The click comes from the same input as the mouseup, which already
+    // accounts for its latency.
     pending_events_.push_back({JsEventType::CLICK, f});
   }
 }
 
 void Main::OnMouseWheel(double x, double y) {
+  double timestamp = GetClockTime();
+  if (input_recorder_) {
+    RecordedInput input;
+    input.type = RecordedInput::MOUSE_WHEEL;
+    input.x = x;
+    input.y = y;
+    RecordInput(input, timestamp);
+  }
   auto f = [=](const JsScope& scope) {
-    return MakeMouseWheelEvent(x, y, scope);
+    return MakeMouseWheelEvent(x, y, timestamp, scope);
   };
-  pending_events_.push_back({JsEventType::WHEEL, f});
+  pending_events_.push_back({JsEventType::WHEEL, f, timestamp});
 }
 
 void Main::OnMouseEnter(bool entered) {
+  if (input_recorder_) {
+    RecordedInput input;
+    input.type = RecordedInput::MOUSE_ENTER;
+    input.action = entered ? 1 : 0;
+    RecordInput(input, GetClockTime());
+  }
   auto f = [=](const JsScope& scope) {
     return MakeEvent(entered ? StringId::mouseenter : StringId::mouseleave,
                      scope);
@@ -650,9 +1020,7 @@ void Main::OnClose() {
     }
   }
 
-  glfwSetWindowShouldClose(window_.window(),
-                           should_close ? GLFW_TRUE : GLFW_FALSE);
-  glfwPostEmptyEvent();
+  window_.SetShouldClose(should_close);
 }
 
 void Main::OnDrop(std::vector<std::string> paths) {
@@ -685,8 +1053,14 @@ void Main::OnRestore() {
 
 void Main::OnTitleChanged() {
   if (console_) {
-    std::string json = "{\"type\":\"titleChanged\", \"title\":" +
-                       Json::EscapeString(window_.title()) + "}";
+    std::string json;
+    JsonWriter(&json)
+        .BeginDictionary()
+        .Key("type")
+        .String("titleChanged")
+        .Key("title")
+        .String(window_.title())
+        .EndDictionary();
     console_->SendMessage(0, std::move(json));
   }
 }
@@ -7,13 +7,17 @@
 #include <mutex>
 #include <string>
 #include <thread>
+#include <utility>
 #include <vector>
 
 #include "console.h"
+#include "input_log.h"
 #include "js.h"
 #include "js_api.h"
 #include "js_events.h"
 #include "js_scope.h"
+#include "log_formatter.h"
+#include "metrics.h"
 #include "signal.h"
 #include "subprocess.h"
 #include "task_queue.h"
@@ -49,27 +53,48 @@ class Main final : public Js::Delegate, public Window::Delegate, LogHandler {
   void OnTitleChanged() override;
 
  private:
+  struct PendingLog {
+    std::string message;
+    // The message escaped for JSON, in the thread that logged it.
+    std::string json;
+    ConsoleLogLevel level;
+  };
+
   struct PendingEvent {
     JsEventType type;
     std::function<v8::Local<v8::Value>(const JsScope&)> f;
+    // When the input was received, for the input latency stats. This is 0 for
+    // events that don't correspond to a new input.
+    double timestamp = 0;
   };
 
   void Reload();
   void AttachToParentProcess();
   double GetTimeoutUntilNextFrame() const;
+  bool IsAnimationFrameDue() const;
   void UpdateStats();
   void GcThread();
   void ShowConsole();
   void SaveScreenshot();
+  void ToggleCpuProfiling();
+  void DispatchLongTasks(const JsScope& scope);
+  void ScheduleMetrics();
   void HandleMessageFromConsoleProcess(std::string message);
   void HandleConsoleProcessExit(std::string error);
   void PostMessageToConsole(std::string json);
+  void FlushLogs();
+  void RecordInput(RecordedInput input, double timestamp);
+  void ReplayInput();
 
   // This order is important. Background tasks may reference the TaskQueue
   // and post tasks to the foreground, so task_queue_ must be valid as long as
   // background_queue_ is still valid too. See PostToBackgroundAndResolve.
+  // The Metrics are written by background tasks too.
   TaskQueue task_queue_;
+  std::unique_ptr<Metrics> metrics_;
   ThreadPoolTaskQueue background_queue_;
+  // Its thread logs into the task_queue_ too.
+  LogFormatter log_formatter_;
 
   std::vector<PendingEvent> pending_events_;
   JsEvents events_;
@@ -85,8 +110,33 @@ class Main final : public Js::Delegate, public Window::Delegate, LogHandler {
   bool reload_requested_;
   bool first_load_;
 
+  // requestAnimationFrame callbacks run at 60 fps with --no-window.
+  static constexpr double kNoWindowFrameInterval = 1.0 / 60;
+  // How long each frame can spend on the fonts queued with
+  // window.prewarmFonts().
+  static constexpr double kFontPrewarmBudget = 0.002;
+  // How long each frame can spend converting the JSON files read with
+  // File.readJSON(path, {incremental: true}).
+  static constexpr double kJsonConversionBudget = 0.004;
+  double last_animation_frame_time_;
+
+  // Counts the iterations of the main loop, to record and replay input at
+  // the same frames.
+  uint32_t frame_;
+  std::unique_ptr<InputRecorder> input_recorder_;
+  std::unique_ptr<InputReplayer> input_replayer_;
+  uint64_t replay_start_time_;
+
   std::unique_ptr<Pipe> console_;
   std::deque<std::string> messages_to_console_;
+
+  // Logs from any thread are buffered here, and sent to the console and
+  // overlay in batches by FlushLogs. When full, the oldest logs are dropped
+  // and counted in dropped_logs_.
+  static constexpr size_t kMaxPendingLogs = 1000;
+  std::mutex logs_lock_;
+  std::deque<PendingLog> pending_logs_;
+  int dropped_logs_;
 };
 
 #endif  // WINDOWJS_MAIN_H
@@ -0,0 +1,193 @@
+#include "metrics.h"
+
+#include <string.h>
+
+#include <chrono>
+#include <iomanip>
+#include <sstream>
+
+#include <uv.h>
+
+#include <skia/include/gpu/GrDirectContext.h>
+
+#include "clock.h"
+#include "console.h"
+#include "fail.h"
+#include "file.h"
+#include "task_queue.h"
+#include "thread.h"
+
+namespace {
+
+// Returns the upper bound of the bucket that contains the percentile |p| of
+// |counts|, which has |total| entries.
+double GetPercentile(const uint32_t* counts, uint32_t total, double p) {
+  if (total == 0) {
+    return 0;
+  }
+  double target = p / 100 * total;
+  uint32_t seen = 0;
+  for (size_t i = 0; i < DurationHistogram::kBuckets - 1; i++) {
+    seen += counts[i];
+    if (seen >= target) {
+      return DurationHistogram::BucketLowerBound(i + 1);
+    }
+  }
+  return DurationHistogram::BucketLowerBound(DurationHistogram::kBuckets - 1);
+}
+
+// Returns how much |value| increased since |last|. Counters that went down
+// were reset in the meantime.
+uint32_t Delta(uint32_t value, uint32_t last) {
+  return value >= last ? value - last : value;
+}
+
+}  // namespace
+
+std::string MetricsSample::ToJson() const {
+  std::stringstream json;
+  json << std::fixed << std::setprecision(3);
+  json << "{\"time\":" << time;
+  json << ",\"uptime\":" << uptime;
+  json << ",\"interval\":" << interval;
+  json << ",\"frames\":" << frames;
+  json << ",\"fps\":" << fps;
+  json << ",\"frameTime\":{\"p50\":" << frame_p50 << ",\"p95\":" << frame_p95
+       << ",\"p99\":" << frame_p99 << "}";
+  json << ",\"jank\":" << jank;
+  json << ",\"longTasks\":" << long_tasks;
+  json << ",\"gc\":{\"count\":" << gc_count << ",\"time\":" << gc_time << "}";
+  json << ",\"memory\":{\"heapUsed\":" << heap_used
+       << ",\"heapTotal\":" << heap_total
+       << ",\"external\":" << external_memory << ",\"gpu\":" << gpu_memory
+       << ",\"gpuResources\":" << gpu_resources << ",\"rss\":" << rss << "}";
+  json << ",\"tasks\":{\"ready\":" << tasks << ",\"delayed\":" << delayed_tasks
+       << ",\"background\":" << background_tasks
+       << ",\"backgroundLatency\":" << background_latency << "}}";
+  return json.str();
+}
+
+Metrics::Metrics(std::filesystem::path path, double interval)
+    : path_(std::move(path)),
+      interval_(interval),
+      isolate_(nullptr),
+      gc_count_(0),
+      gc_time_(0),
+      gc_start_(0),
+      last_uptime_(GetUptime()),
+      last_frames_(0),
+      last_jank_(0),
+      last_long_tasks_(0) {
+  ASSERT(interval_ > 0);
+  memset(last_counts_, 0, sizeof(last_counts_));
+  std::string error;
+  file_size_ = GetFileSize(path_, &error);
+}
+
+void Metrics::SetIsolate(v8::Isolate* isolate) {
+  isolate_ = isolate;
+  isolate_->AddGCPrologueCallback(OnGcPrologue, this);
+  isolate_->AddGCEpilogueCallback(OnGcEpilogue, this);
+}
+
+void Metrics::Collect(Stats* stats, GrDirectContext* gpu,
+                      const TaskQueue& task_queue,
+                      ThreadPoolTaskQueue* background_queue) {
+  ASSERT(IsMainThread());
+
+  MetricsSample sample;
+  sample.time = std::chrono::duration<double>(
+                    std::chrono::system_clock::now().time_since_epoch())
+                    .count();
+  sample.uptime = GetUptime();
+  sample.interval = sample.uptime - last_uptime_;
+  last_uptime_ = sample.uptime;
+
+  // The frame stats may have been reset by performance.resetFrameStats() or
+  // by a reload since the last sample.
+  const uint32_t* counts = stats->histogram(Stats::TOTAL).counts();
+  bool reset = stats->frames() < last_frames_;
+  for (size_t i = 0; i < DurationHistogram::kBuckets && !reset; i++) {
+    reset = counts[i] < last_counts_[i];
+  }
+  uint32_t deltas[DurationHistogram::kBuckets];
+  for (size_t i = 0; i < DurationHistogram::kBuckets; i++) {
+    deltas[i] = reset ? counts[i] : counts[i] - last_counts_[i];
+    last_counts_[i] = counts[i];
+  }
+  sample.frames = reset ? stats->frames() : stats->frames() - last_frames_;
+  last_frames_ = stats->frames();
+  if (sample.interval > 0) {
+    sample.fps = sample.frames / sample.interval;
+  }
+  sample.frame_p50 = GetPercentile(deltas, sample.frames, 50);
+  sample.frame_p95 = GetPercentile(deltas, sample.frames, 95);
+  sample.frame_p99 = GetPercentile(deltas, sample.frames, 99);
+
+  sample.jank = Delta(stats->jank()[0], last_jank_);
+  last_jank_ = stats->jank()[0];
+  sample.long_tasks = Delta(stats->long_tasks()->count(), last_long_tasks_);
+  last_long_tasks_ = stats->long_tasks()->count();
+
+  sample.gc_count = gc_count_;
+  sample.gc_time = gc_time_ * 1000;
+
+  if (isolate_) {
+    v8::HeapStatistics heap;
+    isolate_->GetHeapStatistics(&heap);
+    sample.heap_used = heap.used_heap_size();
+    sample.heap_total = heap.total_heap_size();
+    sample.external_memory = heap.external_memory();
+  }
+  if (gpu) {
+    gpu->getResourceCacheUsage(&sample.gpu_resources, &sample.gpu_memory);
+  }
+  if (uv_resident_set_memory(&sample.rss) != 0) {
+    sample.rss = 0;
+  }
+
+  sample.tasks = task_queue.size();
+  sample.delayed_tasks = task_queue.delayed_size();
+  sample.background_tasks = background_queue->size();
+
+  // The latency of the background queue is measured with the task that
+  // writes the sample.
+  background_queue->Post([this, sample]() mutable {
+    sample.background_latency = (GetUptime() - sample.uptime) * 1000;
+    Write(sample.ToJson());
+  });
+}
+
+// static
+void Metrics::OnGcPrologue(v8::Isolate* isolate, v8::GCType type,
+                           v8::GCCallbackFlags flags, void* data) {
+  Metrics* metrics = static_cast<Metrics*>(data);
+  metrics->gc_start_ = GetClockTime();
+}
+
+// static
+void Metrics::OnGcEpilogue(v8::Isolate* isolate, v8::GCType type,
+                           v8::GCCallbackFlags flags, void* data) {
+  Metrics* metrics = static_cast<Metrics*>(data);
+  metrics->gc_count_++;
+  metrics->gc_time_ += GetClockTime() - metrics->gc_start_;
+}
+
+void Metrics::Write(const std::string& line) {
+  std::lock_guard<std::mutex> lock(lock_);
+  std::string error;
+  if (file_size_ > 0 && file_size_ + line.size() + 1 > kMaxFileSize) {
+    std::filesystem::path rotated = path_;
+    rotated += ".1";
+    if (!Rename(path_, rotated, &error)) {
+      $(WARN) << "Failed to rotate " << path_.u8string() << ": " << error;
+      return;
+    }
+    file_size_ = 0;
+  }
+  if (!AppendFile(path_, line + "\n", &error)) {
+    $(WARN) << error;
+    return;
+  }
+  file_size_ += line.size() + 1;
+}
@@ -0,0 +1,109 @@
+#ifndef WINDOWJS_METRICS_H
+#define WINDOWJS_METRICS_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <filesystem>
+#include <mutex>
+#include <string>
+
+#include <v8/include/v8.h>
+
+#include "stats.h"
+
+class GrDirectContext;
+class TaskQueue;
+class ThreadPoolTaskQueue;
+
+// The metrics exported by --metrics-file in each interval. Memory sizes are in
+// bytes and durations in milliseconds.
+struct MetricsSample {
+  // When the sample was taken, in seconds since the Unix epoch.
+  double time = 0;
+  // When the sample was taken, from GetUptime(), in seconds. Unlike
+  // GetClockTime(), this isn't reset when the page reloads.
+  double uptime = 0;
+  // The duration of the interval, in seconds.
+  double interval = 0;
+
+  uint32_t frames = 0;
+  double fps = 0;
+  // Approximate percentiles of the frame times in the interval.
+  double frame_p50 = 0;
+  double frame_p95 = 0;
+  double frame_p99 = 0;
+  uint32_t jank = 0;
+  uint32_t long_tasks = 0;
+
+  // Totals since the process started.
+  uint64_t gc_count = 0;
+  double gc_time = 0;
+
+  size_t heap_used = 0;
+  size_t heap_total = 0;
+  size_t external_memory = 0;
+  size_t gpu_memory = 0;
+  int gpu_resources = 0;
+  size_t rss = 0;
+
+  size_t tasks = 0;
+  size_t delayed_tasks = 0;
+  size_t background_tasks = 0;
+  // How long the background task that writes this sample waited for a thread.
+  double background_latency = 0;
+
+  std::string ToJson() const;
+};
+
+// Periodically appends a MetricsSample as a line of JSON to a file, to monitor
+// applications deployed in the field. Samples are collected in the main thread
+// and written in a background thread. The file is rotated to "path.1" when it
+// grows over kMaxFileSize.
+class Metrics final {
+ public:
+  static constexpr size_t kMaxFileSize = 8 * 1024 * 1024;
+
+  Metrics(std::filesystem::path path, double interval);
+
+  double interval() const { return interval_; }
+
+  // Starts counting the garbage collections of |isolate|. This must be called
+  // again for each new isolate.
+  void SetIsolate(v8::Isolate* isolate);
+
+  // Collects a sample and posts it to |background_queue|, to be written to the
+  // file. Must be called in the main thread, with the isolate locked.
+  void Collect(Stats* stats, GrDirectContext* gpu, const TaskQueue& task_queue,
+               ThreadPoolTaskQueue* background_queue);
+
+ private:
+  static void OnGcPrologue(v8::Isolate* isolate, v8::GCType type,
+                           v8::GCCallbackFlags flags, void* data);
+  static void OnGcEpilogue(v8::Isolate* isolate, v8::GCType type,
+                           v8::GCCallbackFlags flags, void* data);
+
+  // Called in a background thread.
+  void Write(const std::string& line);
+
+  const std::filesystem::path path_;
+  const double interval_;
+
+  v8::Isolate* isolate_;
+  // Updated in the thread that holds the isolate lock.
+  uint64_t gc_count_;
+  double gc_time_;
+  double gc_start_;
+
+  double last_uptime_;
+  uint32_t last_frames_;
+  uint32_t last_jank_;
+  uint32_t last_long_tasks_;
+  uint32_t last_counts_[DurationHistogram::kBuckets];
+
+  // Guards the file, which is written by the background threads.
+  std::mutex lock_;
+  size_t file_size_;
+};
+
+#endif  // WINDOWJS_METRICS_H
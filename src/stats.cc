@@ -1,12 +1,20 @@
 #include "stats.h"
 
+#include <math.h>
+#include <string.h>
+
+#include <algorithm>
+#include <iterator>
 #include <sstream>
 
 #include <uv.h>
 
 #include <skia/include/core/SkCanvas.h>
 #include <skia/include/core/SkFont.h>
+#include <skia/include/core/SkGraphics.h>
 
+#include "api_counters.h"
+#include "clock.h"
 #include "console.h"
 #include "css.h"
 #include "fail.h"
@@ -26,23 +34,114 @@ double DeltaTimevalMs(uv_timeval_t before, uv_timeval_t after) {
   return a - b;
 }
 
+LatencySamples::LatencySamples() : next_(0), count_(0) {}
+
+void LatencySamples::Add(double latency) {
+  if (samples_.size() < kMaxSamples) {
+    samples_.push_back(latency);
+  } else {
+    samples_[next_] = latency;
+  }
+  next_ = (next_ + 1) % kMaxSamples;
+  count_++;
+}
+
+void LatencySamples::Clear() {
+  samples_.clear();
+  next_ = 0;
+  count_ = 0;
+}
+
+double LatencySamples::max() const {
+  if (samples_.empty()) {
+    return 0;
+  }
+  return *std::max_element(samples_.begin(), samples_.end());
+}
+
+double LatencySamples::Percentile(double p) const {
+  if (samples_.empty()) {
+    return 0;
+  }
+  std::vector<double> sorted = samples_;
+  size_t n = std::min(sorted.size() - 1, (size_t) (p / 100 * sorted.size()));
+  std::nth_element(sorted.begin(), sorted.begin() + n, sorted.end());
+  return sorted[n];
+}
+
+DurationHistogram::DurationHistogram() {
+  Clear();
+}
+
+void DurationHistogram::Add(double ms) {
+  int index = 0;
+  if (ms >= ldexp(1, kMinExponent)) {
+    // ms = fraction * 2^exponent, with fraction in [0.5, 1).
+    int exponent = 0;
+    double fraction = frexp(ms, &exponent);
+    int sub_bucket = (int) ((fraction * 2 - 1) * kSubBuckets);
+    index = (exponent - 1 - kMinExponent) * kSubBuckets + sub_bucket;
+    index = std::min<int>(index, kBuckets - 1);
+  }
+  counts_[index]++;
+}
+
+void DurationHistogram::Clear() {
+  memset(counts_, 0, sizeof(counts_));
+}
+
+// static
+double DurationHistogram::BucketLowerBound(size_t index) {
+  int exponent = kMinExponent + index / kSubBuckets;
+  double fraction = 1 + (double) (index % kSubBuckets) / kSubBuckets;
+  return ldexp(fraction, exponent);
+}
+
 Stats::Stats(Window* window)
     : window_(window),
       js_(nullptr),
       frames_count_(0),
       last_stats_update_(-1),
       fps_(0),
+      previous_timestamp_(0),
+      frame_start_timestamp_(0),
+      elapsed_wait_(0),
+      elapsed_gc_(0),
+      elapsed_js_(0),
+      elapsed_raf_(0),
+      elapsed_swap_(0),
+      frames_(0),
+      refresh_interval_(0),
+      frame_history_next_(0),
+      gc_count_(0),
+      last_gc_count_(0),
+      last_long_tasks_(0),
+      graph_frames_(0),
+      graph_scale_(0),
+      last_frame_end_(0),
       redraw_(false),
-      print_frame_times_(false) {}
+      print_frame_times_(false),
+      show_api_counters_(false) {
+  for (std::vector<double>& history : frame_history_) {
+    history.resize(kFrameHistorySize);
+  }
+  frame_markers_.resize(kFrameHistorySize);
+  ResetFrameStats();
+}
 
 Stats::~Stats() {}
 
 int Stats::width() const {
-  return 160 * window_->device_pixel_ratio();
+  return (kFrameHistorySize + 8) * window_->device_pixel_ratio();
 }
 
 int Stats::height() const {
-  return 76 * window_->device_pixel_ratio();
+  int height = kGraphTop + kGraphHeight + 4;
+  if (show_api_counters_) {
+    // One line per API, and two lines for the native counters.
+    height += (kTopApiCalls + 2) * 14;
+  }
+  return height * window_->device_pixel_ratio();
 }
 
 void Stats::SetEnabled(bool enabled) {
@@ -52,27 +151,151 @@ void Stats::SetEnabled(bool enabled) {
                                Canvas::TEXTURE));
       redraw_ = true;
     }
+    if (!graph_) {
+      int column = std::max<int>(1, window_->device_pixel_ratio());
+      graph_.reset(new Canvas(window_->shared_context(),
+                              kFrameHistorySize * column,
+                              kGraphHeight * window_->device_pixel_ratio(),
+                              Canvas::TEXTURE));
+      graph_scale_ = 0;
+    }
   } else {
     canvas_.reset();
+    graph_.reset();
+  }
+}
+
+void Stats::SetShowApiCounters(bool show) {
+  show_api_counters_ = show;
+  if (canvas_) {
+    // Recreate the canvas with the new height.
+    SetEnabled(false);
+    SetEnabled(true);
   }
 }
 
+void Stats::SetJs(Js* js, JsApi* api) {
+  js_ = js;
+  api_ = api;
+  js_->isolate()->AddGCEpilogueCallback(OnGcEpilogue, this);
+}
+
+// static
+void Stats::OnGcEpilogue(v8::Isolate* isolate, v8::GCType type,
+                         v8::GCCallbackFlags flags, void* data) {
+  static_cast<Stats*>(data)->gc_count_++;
+}
+
 void Stats::Reset() {
   frames_count_ = 0;
   last_stats_update_ = -1;
   fps_ = 0;
+  input_to_dispatch_.Clear();
+  input_to_swap_.Clear();
+  inputs_waiting_for_swap_.clear();
+  ResetFrameStats();
+  user_timing_.Reset();
+  long_tasks_.Reset();
+  ApiCounters::Get()->Reset();
   redraw_ = true;
 }
 
+void Stats::CopyFrameHistory(Phase phase, double* out) const {
+  const std::vector<double>& history = frame_history_[phase];
+  size_t size = frame_history_size();
+  size_t start = (frame_history_next_ + kFrameHistorySize - size) %
+                 kFrameHistorySize;
+  for (size_t i = 0; i < size; i++) {
+    out[i] = history[(start + i) % kFrameHistorySize];
+  }
+}
+
+void Stats::ResetFrameStats() {
+  frames_ = 0;
+  refresh_interval_ = 0;
+  memset(jank_, 0, sizeof(jank_));
+  for (DurationHistogram& histogram : histograms_) {
+    histogram.Clear();
+  }
+  frame_history_next_ = 0;
+  last_long_tasks_ = 0;
+  last_frame_end_ = 0;
+  for (double& elapsed : last_frame_phases_) {
+    elapsed = 0;
+  }
+  long_tasks_.ResetTotals();
+}
+
+void Stats::RecordFrame() {
+  if (refresh_interval_ == 0) {
+    refresh_interval_ = 1000.0 / window_->refresh_rate();
+  }
+
+  double elapsed[PHASE_COUNT];
+  elapsed[WAIT] = elapsed_wait_ * 1000;
+  elapsed[GC] = elapsed_gc_ * 1000;
+  elapsed[JS] = elapsed_js_ * 1000;
+  elapsed[RAF] = elapsed_raf_ * 1000;
+  elapsed[SWAP] = elapsed_swap_ * 1000;
+  elapsed[TOTAL] = elapsed[WAIT] + elapsed[GC] + elapsed[JS] + elapsed[RAF] +
+                   elapsed[SWAP];
+
+  for (int phase = 0; phase < PHASE_COUNT; phase++) {
+    histograms_[phase].Add(elapsed[phase]);
+    frame_history_[phase][frame_history_next_] = elapsed[phase];
+    last_frame_phases_[phase] = elapsed[phase] / 1000;
+  }
+
+  uint8_t markers = 0;
+  uint32_t gc_count = gc_count_;
+  if (gc_count != last_gc_count_) {
+    last_gc_count_ = gc_count;
+    markers |= GC_MARKER;
+  }
+  if (long_tasks_.count() > last_long_tasks_) {
+    last_long_tasks_ = long_tasks_.count();
+    markers |= LONG_TASK_MARKER;
+  }
+  frame_markers_[frame_history_next_] = markers;
+
+  last_frame_end_ = previous_timestamp_;
+  frame_history_next_ = (frame_history_next_ + 1) % kFrameHistorySize;
+  frames_++;
+
+  // The wait phase blocks for input when there are no animation frames, so
+  // it doesn't count towards jank.
+  double busy = elapsed[TOTAL] - elapsed[WAIT];
+  for (size_t i = 0; i < kJankCounters; i++) {
+    if (busy > kJankMultiples[i] * refresh_interval_) {
+      jank_[i]++;
+    }
+  }
+}
+
 void Stats::UpdateTimestamp(double* timestamp) {
-  double now = glfwGetTime();
+  double now = GetClockTime();
   *timestamp = now - previous_timestamp_;
   previous_timestamp_ = now;
 }
 
+void Stats::OnSwapFinished() {
+  UpdateTimestamp(&elapsed_swap_);
+  RecordFrame();
+  ApiCounters::Get()->EndFrame();
+  for (double timestamp : inputs_waiting_for_swap_) {
+    input_to_swap_.Add(previous_timestamp_ - timestamp);
+  }
+  inputs_waiting_for_swap_.clear();
+}
+
+void Stats::OnInputDispatched(double timestamp) {
+  input_to_dispatch_.Add(GetClockTime() - timestamp);
+  inputs_waiting_for_swap_.push_back(timestamp);
+}
+
 void Stats::OnFrameFinished() {
   if (print_frame_times_) {
-    double now = glfwGetTime();
+    double now = GetClockTime();
     double elapsed = now - frame_start_timestamp_;
     frame_start_timestamp_ = now;
 
@@ -89,7 +312,7 @@ void Stats::OnFrameFinished() {
   }
 
   frames_count_++;
-  double now = glfwGetTime();
+  double now = GetClockTime();
   if (now >= last_stats_update_ + 0.5) {
     double elapsed = now - last_stats_update_;
     last_stats_update_ = now;
@@ -103,17 +326,24 @@ void Stats::OnFrameFinished() {
 void Stats::Draw() {
   ASSERT(is_enabled());
 
-  if (!redraw_) {
-    return;
+  if (redraw_) {
+    DrawCounters();
+    redraw_ = false;
   }
 
+  UpdateFrameGraph();
+  DrawFrameGraph(canvas_->canvas(), window_->device_pixel_ratio());
+}
+
+void Stats::DrawCounters() {
   SkCanvas* canvas = canvas_->canvas();
   canvas->clear(SkColorSetARGB(0x80, 0x00, 0x00, 0x00));
 
   const float ratio = window_->device_pixel_ratio();
 
-  SkFont font;
-  CSSFontToSkFont("11px monospace", &font, api_->fonts(), api_->fonts_cache());
+  std::shared_ptr<FontCache::Font> css_font =
+      api_->font_cache()->Get("11px monospace");
+  SkFont font = api_->font_cache()->Resolve(css_font.get());
   font.setSize(11 * ratio);
   font.setScaleX(1.1);
   font.setSubpixel(true);
@@ -181,6 +411,22 @@ void Stats::Draw() {
     g_prev_rusage = r;
   }
 
+  // Input latencies: p50 / p99 in milliseconds.
+  auto draw_latency = [&](const char* label, const LatencySamples& samples) {
+    std::stringstream ss;
+    ss << label << std::fixed << std::setprecision(1)
+       << samples.Percentile(50) * 1000 << " / "
+       << samples.Percentile(99) * 1000;
+    std::string s = ss.str();
+    canvas->drawSimpleText(s.c_str(), s.size(), SkTextEncoding::kUTF8, 4, y,
+                           font, paint);
+    y += 14 * ratio;
+  };
+
+  paint.setColor(SK_ColorYELLOW);
+  draw_latency("Dispatch ", input_to_dispatch_);
+  draw_latency("Swap ", input_to_swap_);
+
   if (js_) {
     v8::HeapStatistics stats;
     js_->isolate()->GetHeapStatistics(&stats);
@@ -199,5 +445,221 @@ void Stats::Draw() {
     y += 14 * ratio;
   }
 
-  redraw_ = false;
+  {
+    // The occupancy of Skia's glyph cache, shared by all the fonts.
+    std::stringstream ss;
+    ss << std::fixed << std::setprecision(1);
+    constexpr double mb = 1024.0 * 1024.0;
+    ss << "Glyphs: " << SkGraphics::GetFontCacheUsed() / mb << "/"
+       << SkGraphics::GetFontCacheLimit() / mb << " MiB ("
+       << SkGraphics::GetFontCacheCountUsed() << ")";
+    std::string s = ss.str();
+
+    paint.setColor(SK_ColorGREEN);
+    canvas->drawSimpleText(s.c_str(), s.size(), SkTextEncoding::kUTF8, 4, y,
+                           font, paint);
+
+    y += 14 * ratio;
+  }
+
+  DrawTimeline(canvas, 4 * ratio, y - 8 * ratio, width() - 8 * ratio, ratio);
+
+  if (show_api_counters_) {
+    DrawApiCounters(canvas, font, (kGraphTop + kGraphHeight + 15) * ratio,
+                    ratio);
+  }
+}
+
+void Stats::UpdateFrameGraph() {
+  if (refresh_interval_ == 0) {
+    return;
+  }
+
+  SkCanvas* canvas = graph_->canvas();
+  double scale = graph_->height() / (kGraphBudgets * refresh_interval_);
+  uint32_t from = graph_frames_;
+  if (scale != graph_scale_ || from > frames_ ||
+      frames_ - from > kFrameHistorySize) {
+    // The whole graph has to be drawn again.
+    graph_scale_ = scale;
+    canvas->clear(SkColorSetARGB(0x80, 0x00, 0x00, 0x00));
+    from = frames_ - frame_history_size();
+  }
+  for (uint32_t frame = from; frame < frames_; frame++) {
+    DrawFrameGraphColumn(canvas, frame);
+  }
+  graph_frames_ = frames_;
+}
+
+void Stats::DrawFrameGraphColumn(SkCanvas* canvas, uint32_t frame) {
+  static constexpr SkColor colors[] = {
+      SK_ColorDKGRAY, SK_ColorMAGENTA, SK_ColorGREEN,
+      SK_ColorCYAN,   SK_ColorYELLOW,
+  };
+  static_assert(std::size(colors) == TOTAL);
+
+  const size_t index = frame % kFrameHistorySize;
+  const float column = graph_->width() / (float) kFrameHistorySize;
+  const float left = index * column;
+  const float right = left + column;
+  const float height = graph_->height();
+
+  SkPaint paint;
+  paint.setStyle(SkPaint::kFill_Style);
+  paint.setBlendMode(SkBlendMode::kSrc);
+  paint.setColor(SkColorSetARGB(0x80, 0x00, 0x00, 0x00));
+  canvas->drawRect(SkRect::MakeLTRB(left, 0, right, height), paint);
+
+  paint.setBlendMode(SkBlendMode::kSrcOver);
+  float bottom = height;
+  for (int phase = 0; phase < TOTAL && bottom > 0; phase++) {
+    float top = bottom - frame_history_[phase][index] * graph_scale_;
+    paint.setColor(colors[phase]);
+    canvas->drawRect(SkRect::MakeLTRB(left, std::max(top, 0.0f), right,
+                                      bottom),
+                     paint);
+    bottom = top;
+  }
+
+  // Markers on top of the column: GCs in magenta, long tasks in red.
+  const float marker = 3 * column;
+  if (frame_markers_[index] & GC_MARKER) {
+    paint.setColor(SK_ColorMAGENTA);
+    canvas->drawRect(SkRect::MakeLTRB(left, 0, right, marker), paint);
+  }
+  if (frame_markers_[index] & LONG_TASK_MARKER) {
+    paint.setColor(SK_ColorRED);
+    canvas->drawRect(SkRect::MakeLTRB(left, marker, right, 2 * marker),
+                     paint);
+  }
+}
+
+void Stats::DrawFrameGraph(SkCanvas* canvas, float ratio) {
+  const float x = 4 * ratio;
+  const float y = kGraphTop * ratio;
+  const float width = graph_->width();
+  const float height = graph_->height();
+
+  // The ring is drawn in two parts: from the oldest frame in the ring to its
+  // end, and then from its start to the most recent frame.
+  const float split = (graph_frames_ % kFrameHistorySize) *
+                      (width / kFrameHistorySize);
+  SkPaint paint;
+  paint.setBlendMode(SkBlendMode::kSrc);
+  canvas->save();
+  canvas->clipRect(SkRect::MakeXYWH(x, y, width - split, height));
+  graph_->surface()->draw(canvas, x - split, y, &paint);
+  canvas->restore();
+  canvas->save();
+  canvas->clipRect(SkRect::MakeXYWH(x + width - split, y, split, height));
+  graph_->surface()->draw(canvas, x + width - split, y, &paint);
+  canvas->restore();
+
+  // The frame budget.
+  if (graph_scale_ > 0) {
+    float budget = y + height - refresh_interval_ * graph_scale_;
+    paint.setBlendMode(SkBlendMode::kSrcOver);
+    paint.setColor(SkColorSetARGB(0xC0, 0xFF, 0xFF, 0xFF));
+    canvas->drawRect(SkRect::MakeLTRB(x, budget, x + width, budget + ratio),
+                     paint);
+  }
+}
+
+void Stats::DrawTimeline(SkCanvas* canvas, float x, float y, float width,
+                         float ratio) {
+  double duration = last_frame_phases_[TOTAL];
+  if (duration <= 0) {
+    return;
+  }
+
+  // The timeline spans the last frame. The engine phases are drawn on the
+  // top row, and the performance marks and measures on the bottom row.
+  const double start = last_frame_end_ - duration;
+  const double scale = width / duration;
+  const float row = 6 * ratio;
+
+  SkPaint paint;
+  paint.setStyle(SkPaint::kFill_Style);
+
+  static constexpr SkColor colors[] = {
+      SK_ColorDKGRAY, SK_ColorMAGENTA, SK_ColorGREEN,
+      SK_ColorCYAN,   SK_ColorYELLOW,
+  };
+  static_assert(std::size(colors) == TOTAL);
+
+  double left = x;
+  for (int phase = 0; phase < TOTAL; phase++) {
+    double right = left + last_frame_phases_[phase] * scale;
+    paint.setColor(colors[phase]);
+    canvas->drawRect(SkRect::MakeLTRB(left, y, right, y + row), paint);
+    left = right;
+  }
+
+  const float top = y + row + 2 * ratio;
+  user_timing_.ForEach([&](const UserTiming::Entry& entry) {
+    double end = entry.start + entry.duration;
+    if (end < start || entry.start > last_frame_end_) {
+      return;
+    }
+    double from = x + (std::max(entry.start, start) - start) * scale;
+    double to = x + (std::min(end, last_frame_end_) - start) * scale;
+    if (entry.type == UserTiming::MARK) {
+      paint.setColor(SK_ColorWHITE);
+      canvas->drawRect(SkRect::MakeLTRB(from, top, from + ratio, top + row),
+                       paint);
+    } else {
+      paint.setColor(SkColorSetARGB(0xC0, 0xFF, 0xA5, 0x00));
+      canvas->drawRect(SkRect::MakeLTRB(from, top, to, top + row), paint);
+    }
+  });
+}
+
+void Stats::DrawApiCounters(SkCanvas* canvas, const SkFont& font, float y,
+                            float ratio) {
+  const ApiCounters* counters = ApiCounters::Get();
+
+  SkPaint paint;
+  paint.setStyle(SkPaint::kFill_Style);
+
+  auto draw_line = [&](const std::string& s) {
+    canvas->drawSimpleText(s.c_str(), s.size(), SkTextEncoding::kUTF8, 4, y,
+                           font, paint);
+    y += 14 * ratio;
+  };
+
+  // The method names come from js_, which is only null before the first load.
+  std::vector<ApiCounters::Call> calls = counters->last_frame();
+  size_t top = js_ ? std::min(calls.size(), kTopApiCalls) : 0;
+  std::partial_sort(calls.begin(), calls.begin() + top, calls.end(),
+                    [](const ApiCounters::Call& a, const ApiCounters::Call& b) {
+                      return a.count > b.count;
+                    });
+
+  paint.setColor(SK_ColorWHITE);
+  for (size_t i = 0; i < top; i++) {
+    std::stringstream ss;
+    if (calls[i].api == ApiCounters::FILE) {
+      ss << "File.";
+    }
+    ss << js_->strings()->GetName(calls[i].method) << " " << calls[i].count;
+    draw_line(ss.str());
+  }
+  y += (kTopApiCalls - top) * 14 * ratio;
+
+  const uint64_t* native = counters->last_frame_native();
+  paint.setColor(SK_ColorLTGRAY);
+  {
+    std::stringstream ss;
+    ss << "Flush " << native[ApiCounters::FLUSHES] << " Snap "
+       << native[ApiCounters::SNAPSHOTS] << " Tex "
+       << native[ApiCounters::TEXTURE_ALLOCATIONS];
+    draw_line(ss.str());
+  }
+  {
+    std::stringstream ss;
+    ss << "Read " << native[ApiCounters::READ_PIXELS_BYTES] / 1024
+       << " KiB Write " << native[ApiCounters::WRITE_PIXELS_BYTES] / 1024
+       << " KiB";
+    draw_line(ss.str());
+  }
 }
@@ -1,21 +1,108 @@
 #ifndef WINDOWJS_STATS_H
 #define WINDOWJS_STATS_H
 
+#include <algorithm>
+#include <atomic>
 #include <memory>
+#include <vector>
 
 #include "canvas.h"
 #include "js.h"
+#include "long_tasks.h"
+#include "user_timing.h"
 
 class JsApi;
+class SkCanvas;
+class SkFont;
 class Window;
 
+// Keeps the most recent latency samples, to report their percentiles.
+class LatencySamples final {
+ public:
+  static constexpr size_t kMaxSamples = 512;
+
+  LatencySamples();
+
+  void Add(double latency);
+  void Clear();
+
+  // The total number of samples added since the last Clear().
+  size_t count() const { return count_; }
+
+  double max() const;
+
+  // Returns the latency at percentile p, between 0 and 100, over the most
+  // recent samples. Returns 0 if there are no samples.
+  double Percentile(double p) const;
+
+ private:
+  std::vector<double> samples_;
+  size_t next_;
+  size_t count_;
+};
+
+// A histogram of durations in milliseconds, with log-linear buckets like
+// HdrHistogram: each power of two between 2^kMinExponent and 2^kMaxExponent is
+// split into kSubBuckets equal buckets, so that the relative error is the same
+// at every scale.
+class DurationHistogram final {
+ public:
+  static constexpr int kMinExponent = -4;
+  static constexpr int kMaxExponent = 12;
+  static constexpr int kSubBuckets = 8;
+  static constexpr size_t kBuckets =
+      (kMaxExponent - kMinExponent) * kSubBuckets;
+
+  DurationHistogram();
+
+  void Add(double ms);
+  void Clear();
+
+  const uint32_t* counts() const { return counts_; }
+
+  // The lower bound of the bucket at |index|, in milliseconds.
+  static double BucketLowerBound(size_t index);
+
+ private:
+  uint32_t counts_[kBuckets];
+};
+
 class Stats {
  public:
+  // The phases of each frame, in the order they happen in the main loop.
+  enum Phase {
+    WAIT,
+    GC,
+    JS,
+    RAF,
+    SWAP,
+    TOTAL,
+    PHASE_COUNT,
+  };
+
+  // How many of the most recent frames are kept in the frame history.
+  static constexpr size_t kFrameHistorySize = 240;
+
+  // Frames are janky if they take longer than these multiples of the display
+  // refresh interval.
+  static constexpr int kJankMultiples[] = {1, 2, 4};
+  static constexpr size_t kJankCounters = 3;
+
+  // How many of the most called APIs are shown in the overlay.
+  static constexpr size_t kTopApiCalls = 5;
+
+  // The frame graph in the overlay shows one column per frame of the frame
+  // history, scaled so that the refresh interval is at a third of its height.
+  static constexpr int kGraphTop = 136;
+  static constexpr int kGraphHeight = 48;
+  static constexpr int kGraphBudgets = 3;
+
   explicit Stats(Window* window);
   ~Stats();
 
   bool is_enabled() const { return canvas_ != nullptr; }
   bool is_print_frame_times() const { return print_frame_times_; }
+  bool is_show_api_counters() const { return show_api_counters_; }
 
   int width() const;
   int height() const;
@@ -23,26 +110,82 @@ class Stats {
 
   void SetEnabled(bool enabled);
   void SetPrintFrameTimes(bool print) { print_frame_times_ = print; }
-  void SetJs(Js* js, JsApi* api) {
-    js_ = js;
-    api_ = api;
-  }
+  // Shows the APIs called the most in the last frame in the overlay.
+  void SetShowApiCounters(bool show);
+  void SetJs(Js* js, JsApi* api);
 
   void Reset();
 
   void OnGcFinished() { UpdateTimestamp(&elapsed_gc_); }
   void OnJsFinished() { UpdateTimestamp(&elapsed_js_); }
   void OnRafFinished() { UpdateTimestamp(&elapsed_raf_); }
-  void OnSwapFinished() { UpdateTimestamp(&elapsed_swap_); }
+  void OnSwapFinished();
   void OnWaitFinished() { UpdateTimestamp(&elapsed_wait_); }
 
   void OnFrameFinished();
 
+  // Called when an input event received at |timestamp| gets dispatched to
+  // Javascript. The input-to-swap latency is measured at the next
+  // OnSwapFinished().
+  void OnInputDispatched(double timestamp);
+
+  // Latencies in seconds, from the GLFW callback that received an input.
+  const LatencySamples& input_to_dispatch() const {
+    return input_to_dispatch_;
+  }
+  const LatencySamples& input_to_swap() const { return input_to_swap_; }
+
+  // Frame statistics since the last ResetFrameStats(). Durations are in
+  // milliseconds.
+  uint32_t frames() const { return frames_; }
+  double refresh_interval() const { return refresh_interval_; }
+  const uint32_t* jank() const { return jank_; }
+  const DurationHistogram& histogram(Phase phase) const {
+    return histograms_[phase];
+  }
+  size_t frame_history_size() const {
+    return std::min<size_t>(frames_, kFrameHistorySize);
+  }
+  // Copies the durations of |phase| in the frame history into |out|, from the
+  // oldest to the most recent frame. |out| must have space for
+  // frame_history_size() entries.
+  void CopyFrameHistory(Phase phase, double* out) const;
+
+  void ResetFrameStats();
+
+  // The entries of performance.mark() and performance.measure().
+  UserTiming* user_timing() { return &user_timing_; }
+
+  // Its totals are reset with the other frame stats.
+  LongTasks* long_tasks() { return &long_tasks_; }
+
   void Draw();
 
  private:
+  // Flags for the frames in the frame history that are marked in the graph.
+  enum FrameMarker : uint8_t {
+    GC_MARKER = 1,
+    LONG_TASK_MARKER = 2,
+  };
+
+  static void OnGcEpilogue(v8::Isolate* isolate, v8::GCType type,
+                           v8::GCCallbackFlags flags, void* data);
+
   void UpdateTimestamp(double* timestamp);
   void PrintFrameTimes(double elapsed);
+  void RecordFrame();
+  void DrawCounters();
+  // Draws the columns of the frames recorded since the last call into the
+  // graph_, or all of them if its scale has changed.
+  void UpdateFrameGraph();
+  void DrawFrameGraphColumn(SkCanvas* canvas, uint32_t frame);
+  // Draws the graph_ into the canvas_, scrolled so that the most recent frame
+  // is on the right.
+  void DrawFrameGraph(SkCanvas* canvas, float ratio);
+  void DrawTimeline(SkCanvas* canvas, float x, float y, float width,
+                    float ratio);
+  void DrawApiCounters(SkCanvas* canvas, const SkFont& font, float y,
+                       float ratio);
 
   Window* window_;
   Js* js_;
@@ -61,8 +204,43 @@ class Stats {
   double elapsed_raf_;
   double elapsed_swap_;
 
+  LatencySamples input_to_dispatch_;
+  LatencySamples input_to_swap_;
+  std::vector<double> inputs_waiting_for_swap_;
+
+  uint32_t frames_;
+  double refresh_interval_;
+  uint32_t jank_[kJankCounters];
+  DurationHistogram histograms_[PHASE_COUNT];
+  std::vector<double> frame_history_[PHASE_COUNT];
+  std::vector<uint8_t> frame_markers_;
+  size_t frame_history_next_;
+
+  // The garbage collections run while the isolate is locked, which may be in
+  // the GC thread.
+  std::atomic<uint32_t> gc_count_;
+  uint32_t last_gc_count_;
+  uint32_t last_long_tasks_;
+
+  // A ring of kFrameHistorySize columns: the column of each frame is only
+  // drawn once, and then scrolled into place by DrawFrameGraph. The frames
+  // before graph_frames_ have been drawn already, with graph_scale_ pixels per
+  // millisecond.
+  std::unique_ptr<Canvas> graph_;
+  uint32_t graph_frames_;
+  double graph_scale_;
+
+  // The end of the last frame, and the duration of each of its phases, in
+  // seconds. The Stats overlay draws these in its timeline.
+  double last_frame_end_;
+  double last_frame_phases_[PHASE_COUNT];
+
+  UserTiming user_timing_;
+  LongTasks long_tasks_;
+
   bool redraw_;
   bool print_frame_times_;
+  bool show_api_counters_;
 };
 
 #endif  // WINDOWJS_STATS_H
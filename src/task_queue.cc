@@ -1,9 +1,13 @@
 #include "task_queue.h"
 
+#include <algorithm>
+
 #include <GLFW/glfw3.h>
 
+#include "clock.h"
+
 static inline double Now() {
-  return glfwGetTime();
+  return GetClockTime();
 }
 
 TaskQueue::TaskQueue() : post_empty_event_(false) {}
@@ -15,6 +19,7 @@ void TaskQueue::Post(Task task) {
     std::lock_guard<std::mutex> lock(lock_);
     tasks_.emplace(std::move(task));
   }
+  cond_var_.notify_one();
   if (post_empty_event_) {
     glfwPostEmptyEvent();
   }
@@ -26,6 +31,7 @@ void TaskQueue::Post(double delay_in_seconds, Task task) {
     std::lock_guard<std::mutex> lock(lock_);
     delayed_tasks_.emplace(DelayedTask{std::move(task), when});
   }
+  cond_var_.notify_one();
   if (post_empty_event_) {
     glfwPostEmptyEvent();
   }
@@ -43,6 +49,16 @@ double TaskQueue::GetSecondsToNextTask() const {
   return interval <= 0 ? 0 : interval;
 }
 
+size_t TaskQueue::size() const {
+  std::lock_guard<std::mutex> lock(lock_);
+  return tasks_.size();
+}
+
+size_t TaskQueue::delayed_size() const {
+  std::lock_guard<std::mutex> lock(lock_);
+  return delayed_tasks_.size();
+}
+
 void TaskQueue::RunTasks() {
   for (;;) {
     Task task;
@@ -63,7 +79,31 @@ void TaskQueue::RunTasks() {
       }
     }
 
-    task();
+    if (task_observer_) {
+      double start = Now();
+      task();
+      task_observer_(start, Now() - start);
+    } else {
+      task();
+    }
+  }
+}
+
+void TaskQueue::Wait(double timeout_in_seconds) {
+  std::unique_lock<std::mutex> lock(lock_);
+  double timeout = timeout_in_seconds;
+  // A delayed task may have been posted after the caller computed the timeout.
+  if (!delayed_tasks_.empty()) {
+    double next = std::max(0.0, delayed_tasks_.top().when - Now());
+    timeout = timeout < 0 ? next : std::min(timeout, next);
+  }
+  if (!tasks_.empty() || timeout == 0) {
+    return;
+  }
+  if (timeout < 0) {
+    cond_var_.wait(lock);
+  } else {
+    cond_var_.wait_for(lock, std::chrono::duration<double>(timeout));
   }
 }
 
@@ -113,6 +153,11 @@ void ThreadPoolTaskQueue::Post(double delay_in_seconds, Task task) {
   cond_var_.notify_one();
 }
 
+size_t ThreadPoolTaskQueue::size() const {
+  std::lock_guard<std::mutex> lock(lock_);
+  return tasks_.size() + delayed_tasks_.size();
+}
+
 void ThreadPoolTaskQueue::Run() {
   for (;;) {
     Task task;
@@ -30,6 +30,13 @@ class TaskQueue {
   // to wake up any calls blocked on glfwWaitEvents().
   void SetPostsEmptyEvents(bool post) { post_empty_event_ = post; }
 
+  // If set then |observer| is called after each task run by RunTasks(), with
+  // the time when the task started and its duration, in seconds.
+  using TaskObserver = std::function<void(double start, double duration)>;
+  void SetTaskObserver(TaskObserver observer) {
+    task_observer_ = std::move(observer);
+  }
+
   void Post(Task task);
   void Post(double delay_in_seconds, Task task);
 
@@ -40,13 +47,25 @@ class TaskQueue {
   // Runs all the tasks that can be executed now, and returns.
   void RunTasks();
 
+  // The number of tasks that are ready to run, and the number of delayed
+  // tasks.
+  size_t size() const;
+  size_t delayed_size() const;
+
+  // Blocks until a task is posted or "timeout_in_seconds" elapses. A negative
+  // timeout waits until the next Post(). This is the event loop used when
+  // there is no window, and glfwWaitEvents() isn't available.
+  void Wait(double timeout_in_seconds);
+
   void ResetDropAllTasks();
 
  private:
   mutable std::mutex lock_;
+  std::condition_variable cond_var_;
   std::queue<Task> tasks_;
   std::priority_queue<DelayedTask> delayed_tasks_;
   bool post_empty_event_;
+  TaskObserver task_observer_;
 };
 
 class ThreadPoolTaskQueue {
@@ -66,12 +85,15 @@ class ThreadPoolTaskQueue {
   void Post(Task task);
   void Post(double delay_in_seconds, Task task);
 
+  // The number of tasks waiting for a thread, including delayed tasks.
+  size_t size() const;
+
   void ResetDropAllTasks();
 
  private:
   void Run();
 
-  std::mutex lock_;
+  mutable std::mutex lock_;
   std::condition_variable cond_var_;
   std::queue<Task> tasks_;
   std::priority_queue<DelayedTask> delayed_tasks_;
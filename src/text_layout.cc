@@ -0,0 +1,178 @@
+#include "text_layout.h"
+
+#include <math.h>
+
+#include <algorithm>
+
+#include <skia/include/core/SkCanvas.h>
+#include <skia/include/core/SkFontMetrics.h>
+#include <skia/include/core/SkPaint.h>
+
+namespace {
+
+// A line as a range of code points.
+struct LineRange {
+  size_t start;
+  size_t end;
+  float width;
+};
+
+bool IsSpace(SkUnichar c) {
+  return c == ' ' || c == '\t' || c == '\r';
+}
+
+// Decodes the code points in |text|, and the offset of each in |text|.
+void DecodeUTF16(std::u16string_view text, std::vector<SkUnichar>* chars,
+                 std::vector<uint32_t>* offsets) {
+  chars->reserve(text.size());
+  offsets->reserve(text.size() + 1);
+  size_t i = 0;
+  while (i < text.size()) {
+    offsets->push_back(i);
+    SkUnichar c = text[i++];
+    if (c >= 0xD800 && c < 0xDC00 && i < text.size() && text[i] >= 0xDC00 &&
+        text[i] < 0xE000) {
+      c = 0x10000 + ((c - 0xD800) << 10) + (text[i++] - 0xDC00);
+    }
+    chars->push_back(c);
+  }
+  offsets->push_back(text.size());
+}
+
+// Breaks |chars| into lines that are at most |max_width| wide, if |wrap| is
+// set. The ranges don't include the whitespace that ends each line.
+std::vector<LineRange> BreakLines(const std::vector<SkUnichar>& chars,
+                                  const std::vector<float>& advances,
+                                  bool wrap, float max_width) {
+  std::vector<LineRange> lines;
+  const size_t n = chars.size();
+  size_t start = 0;
+  for (;;) {
+    // The end of the text that goes in this line, and where the next line
+    // starts. |x| is the width of [start, i).
+    size_t end = start;
+    size_t next = start;
+    size_t i = start;
+    float x = 0;
+    float width = 0;
+    bool full = false;
+
+    while (i < n && chars[i] != '\n' && !full) {
+      if (IsSpace(chars[i])) {
+        // Spaces can overflow the line; the next word can't.
+        while (i < n && IsSpace(chars[i])) {
+          x += advances[i++];
+        }
+        next = i;
+        continue;
+      }
+
+      size_t word_end = i;
+      float word_width = 0;
+      while (word_end < n && chars[word_end] != '\n' &&
+             !IsSpace(chars[word_end])) {
+        word_width += advances[word_end++];
+      }
+
+      if (!wrap || x + word_width <= max_width) {
+        x += word_width;
+        i = end = next = word_end;
+        width = x;
+      } else if (end > start) {
+        // Move this word to the next line.
+        full = true;
+      } else {
+        // The word doesn't fit in a line of its own, so it's broken between
+        // characters. Each line gets at least one character.
+        do {
+          x += advances[i++];
+        } while (i < word_end && x + advances[i] <= max_width);
+        end = next = i;
+        width = x;
+        full = true;
+      }
+    }
+
+    if (!full && i < n) {
+      // A newline.
+      next = i + 1;
+    }
+    lines.push_back({start, end, width});
+    if (!full && i >= n) {
+      return lines;
+    }
+    start = next;
+  }
+}
+
+}  // namespace
+
+TextLayout::TextLayout(std::u16string_view text, const SkFont& font,
+                       float max_width, Align align, float line_height)
+    : width_(0) {
+  std::vector<SkUnichar> chars;
+  std::vector<uint32_t> offsets;
+  DecodeUTF16(text, &chars, &offsets);
+
+  // This is the same conversion that drawSimpleText does.
+  std::vector<SkGlyphID> glyphs(chars.size());
+  font.unicharsToGlyphs(chars.data(), chars.size(), glyphs.data());
+  std::vector<float> advances(glyphs.size());
+  font.getWidths(glyphs.data(), glyphs.size(), advances.data());
+
+  bool wrap = max_width > 0 && isfinite(max_width);
+  std::vector<LineRange> ranges = BreakLines(chars, advances, wrap, max_width);
+
+  for (const LineRange& range : ranges) {
+    width_ = std::max(width_, range.width);
+  }
+  const float align_width = wrap ? max_width : width_;
+
+  SkFontMetrics metrics;
+  float spacing = font.getMetrics(&metrics);
+  line_height_ = line_height > 0 ? line_height : spacing;
+  // Like in CSS, the extra line height is split evenly above and below the
+  // text.
+  const float first_baseline =
+      (line_height_ - (metrics.fDescent - metrics.fAscent)) / 2 -
+      metrics.fAscent;
+
+  lines_.resize(ranges.size());
+  for (size_t i = 0; i < ranges.size(); i++) {
+    const LineRange& range = ranges[i];
+    Line& line = lines_[i];
+    line.start = offsets[range.start];
+    line.end = offsets[range.end];
+    line.width = range.width;
+    line.baseline = first_baseline + i * line_height_;
+    if (align == CENTER) {
+      line.left = (align_width - range.width) / 2;
+    } else if (align == RIGHT) {
+      line.left = align_width - range.width;
+    }
+
+    int count = range.end - range.start;
+    if (count == 0) {
+      continue;
+    }
+    SkTextBlobBuilder builder;
+    const SkTextBlobBuilder::RunBuffer& run =
+        builder.allocRunPosH(font, count, 0);
+    float x = 0;
+    for (int j = 0; j < count; j++) {
+      run.glyphs[j] = glyphs[range.start + j];
+      run.pos[j] = x;
+      x += advances[range.start + j];
+    }
+    line.blob = builder.make();
+  }
+}
+
+void TextLayout::Draw(SkCanvas* canvas, float x, float y,
+                      const SkPaint& paint) const {
+  for (const Line& line : lines_) {
+    if (line.blob) {
+      canvas->drawTextBlob(line.blob, x + line.left, y + line.baseline, paint);
+    }
+  }
+}
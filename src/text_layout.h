@@ -0,0 +1,68 @@
+#ifndef WINDOWJS_TEXT_LAYOUT_H
+#define WINDOWJS_TEXT_LAYOUT_H
+
+#include <stdint.h>
+
+#include <string_view>
+#include <vector>
+
+#include <skia/include/core/SkFont.h>
+#include <skia/include/core/SkRefCnt.h>
+#include <skia/include/core/SkTextBlob.h>
+
+class SkCanvas;
+class SkPaint;
+
+// A paragraph of text in a single font, broken into lines that fit in a
+// maximum width. The text is converted to glyphs and measured once, and each
+// line is kept as an SkTextBlob that is ready to draw.
+//
+// Lines break at newlines, and after spaces when the next word doesn't fit.
+// Words longer than the maximum width are broken between characters.
+class TextLayout final {
+ public:
+  enum Align {
+    LEFT,
+    CENTER,
+    RIGHT,
+  };
+
+  struct Line {
+    // The range of the line in the UTF-16 text, without the whitespace that
+    // ends it.
+    uint32_t start = 0;
+    uint32_t end = 0;
+    // The horizontal offset of the line within the layout, after alignment.
+    float left = 0;
+    float width = 0;
+    // The baseline of the line, from the top of the layout.
+    float baseline = 0;
+    // Null for empty lines.
+    sk_sp<SkTextBlob> blob;
+  };
+
+  // Lines are aligned within |max_width|, or within the widest line if
+  // |max_width| is 0 or infinite. The |line_height| defaults to the spacing
+  // of |font| if it's 0.
+  TextLayout(std::u16string_view text, const SkFont& font, float max_width,
+             Align align, float line_height);
+
+  TextLayout(const TextLayout&) = delete;
+  TextLayout& operator=(const TextLayout&) = delete;
+
+  const std::vector<Line>& lines() const { return lines_; }
+  // The width of the widest line.
+  float width() const { return width_; }
+  float height() const { return line_height_ * lines_.size(); }
+  float line_height() const { return line_height_; }
+
+  // Draws the layout with its top left corner at |x|, |y|.
+  void Draw(SkCanvas* canvas, float x, float y, const SkPaint& paint) const;
+
+ private:
+  std::vector<Line> lines_;
+  float width_;
+  float line_height_;
+};
+
+#endif  // WINDOWJS_TEXT_LAYOUT_H
@@ -0,0 +1,129 @@
+#include "user_timing.h"
+
+UserTiming::UserTiming() : next_(0), size_(0) {
+  entries_.resize(kCapacity);
+}
+
+uint32_t UserTiming::InternName(const std::string& name) {
+  auto it = name_ids_.find(name);
+  if (it != name_ids_.end()) {
+    return it->second;
+  }
+  uint32_t id;
+  if (free_names_.empty()) {
+    id = names_.size();
+    names_.push_back(name);
+    last_mark_time_.push_back(-1);
+    entry_counts_.push_back(0);
+  } else {
+    id = free_names_.back();
+    free_names_.pop_back();
+    names_[id] = name;
+  }
+  name_ids_.emplace(name, id);
+  return id;
+}
+
+bool UserTiming::FindName(const std::string& name, uint32_t* id) const {
+  auto it = name_ids_.find(name);
+  if (it == name_ids_.end()) {
+    return false;
+  }
+  *id = it->second;
+  return true;
+}
+
+void UserTiming::Mark(uint32_t name, double time) {
+  Add({name, MARK, time, 0});
+  last_mark_time_[name] = time;
+}
+
+void UserTiming::Measure(uint32_t name, double start, double end) {
+  Add({name, MEASURE, start, end - start});
+}
+
+double UserTiming::GetMarkTime(uint32_t name) const {
+  return last_mark_time_[name];
+}
+
+void UserTiming::ForEach(std::function<void(const Entry&)> f) const {
+  size_t start = (next_ + kCapacity - size_) % kCapacity;
+  for (size_t i = 0; i < size_; i++) {
+    const Entry& entry = entries_[(start + i) % kCapacity];
+    if (entry.type != CLEARED) {
+      f(entry);
+    }
+  }
+}
+
+void UserTiming::Clear(Type type) {
+  for (size_t i = 0; i < size_; i++) {
+    Entry& entry = entries_[i];
+    if (entry.type == type) {
+      entry.type = CLEARED;
+      Release(entry);
+    }
+  }
+  if (type == MARK) {
+    for (double& time : last_mark_time_) {
+      time = -1;
+    }
+  }
+}
+
+void UserTiming::Clear(Type type, uint32_t name) {
+  if (type == MARK) {
+    last_mark_time_[name] = -1;
+  }
+  for (size_t i = 0; i < size_; i++) {
+    Entry& entry = entries_[i];
+    if (entry.type == type && entry.name == name) {
+      entry.type = CLEARED;
+      Release(entry);
+    }
+  }
+}
+
+void UserTiming::Reset() {
+  next_ = 0;
+  size_ = 0;
+  name_ids_.clear();
+  names_.clear();
+  last_mark_time_.clear();
+  entry_counts_.clear();
+  free_names_.clear();
+}
+
+void UserTiming::Add(const Entry& entry) {
+  // The new entry is counted first, in case it has the name of the entry
+  // that it overwrites.
+  entry_counts_[entry.name]++;
+  if (size_ == kCapacity) {
+    const Entry& oldest = entries_[next_];
+    if (oldest.type == MARK && oldest.start == last_mark_time_[oldest.name]) {
+      // That was the most recent mark with its name, since the others were
+      // overwritten before it.
+      last_mark_time_[oldest.name] = -1;
+    }
+    if (oldest.type != CLEARED) {
+      Release(oldest);
+    }
+  }
+  entries_[next_] = entry;
+  next_ = (next_ + 1) % kCapacity;
+  if (size_ < kCapacity) {
+    size_++;
+  }
+}
+
+void UserTiming::Release(const Entry& entry) {
+  uint32_t& count = entry_counts_[entry.name];
+  if (--count > 0) {
+    return;
+  }
+  std::string& name = names_[entry.name];
+  name_ids_.erase(name);
+  std::string().swap(name);
+  last_mark_time_[entry.name] = -1;
+  free_names_.push_back(entry.name);
+}
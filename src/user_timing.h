@@ -0,0 +1,80 @@
+#ifndef WINDOWJS_USER_TIMING_H
+#define WINDOWJS_USER_TIMING_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <functional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Stores the entries of performance.mark() and performance.measure() in a
+// preallocated ring buffer, so that recording them doesn't allocate.
+// When the buffer is full, the oldest entries are overwritten.
+//
+// The names are kept while there are entries with them, so there are at most
+// kCapacity names; the ids of the others are reused.
+class UserTiming final {
+ public:
+  static constexpr size_t kCapacity = 4096;
+
+  enum Type : uint8_t {
+    MARK,
+    MEASURE,
+    CLEARED,
+  };
+
+  struct Entry {
+    uint32_t name;
+    Type type;
+    // In seconds, from GetClockTime(). Marks have a duration of 0.
+    double start;
+    double duration;
+  };
+
+  UserTiming();
+
+  // Returns the id for |name|, which is used in Entry::name. The id is valid
+  // until the entries with it are cleared or overwritten, so it must be used
+  // in a Mark() or Measure() right away.
+  uint32_t InternName(const std::string& name);
+  // Sets |id| to the id of |name|, if there are entries with it.
+  bool FindName(const std::string& name, uint32_t* id) const;
+  const std::string& GetName(uint32_t name) const { return names_[name]; }
+
+  void Mark(uint32_t name, double time);
+  void Measure(uint32_t name, double start, double end);
+
+  // Returns the time of the most recent mark with |name|, or a negative
+  // number if there is no such mark.
+  double GetMarkTime(uint32_t name) const;
+
+  // Calls |f| for each entry, from the oldest to the most recent.
+  void ForEach(std::function<void(const Entry&)> f) const;
+
+  void Clear(Type type);
+  void Clear(Type type, uint32_t name);
+
+  // Clears all the entries and names.
+  void Reset();
+
+ private:
+  void Add(const Entry& entry);
+  // Called when |entry| is cleared or overwritten. Frees its name if it was
+  // the last entry with it.
+  void Release(const Entry& entry);
+
+  std::vector<Entry> entries_;
+  size_t next_;
+  size_t size_;
+
+  std::unordered_map<std::string, uint32_t> name_ids_;
+  std::vector<std::string> names_;
+  std::vector<double> last_mark_time_;
+  // How many entries in the buffer have each name.
+  std::vector<uint32_t> entry_counts_;
+  std::vector<uint32_t> free_names_;
+};
+
+#endif  // WINDOWJS_USER_TIMING_H
@@ -1,6 +1,7 @@
 #include "window.h"
 
 #include "args.h"
+#include "clock.h"
 #include "fail.h"
 #include "platform.h"
 
@@ -10,6 +11,10 @@ extern "C" unsigned int eglWaitClient();
 
 // static
 void Window::Init() {
+  if (Args().no_window) {
+    return;
+  }
+
   // See Main::OnResize. This hint makes GLFW pump the main event loop during
   // resizes, using a timer internally.
   glfwInitHint(GLFW_WIN32_MESSAGES_IN_FIBER, GLFW_TRUE);
@@ -19,11 +24,15 @@ void Window::Init() {
 
 // static
 void Window::Shutdown() {
+  if (Args().no_window) {
+    return;
+  }
   glfwTerminate();
 }
 
 Window::Window(Delegate* delegate, int width, int height)
     : delegate_(delegate),
+      window_(nullptr),
       width_(width),
       height_(height),
       retina_scale_(1.0f),
@@ -32,10 +41,22 @@ Window::Window(Delegate* delegate, int width, int height)
       keep_aspect_ratio_(false),
       loading_(true),
       reloading_(false),
+      should_close_(false),
+      ignore_input_(false),
       block_visibility_for_n_frames_(1),
       canvas_(nullptr),
       console_overlay_(new ConsoleOverlay(this)),
       stats_(new Stats(this)) {
+  if (Args().no_window) {
+    // Without a window there is no GL context, and canvases are rendered with
+    // the CPU raster backend instead. There is no framebuffer_ either, and
+    // RenderAndSwapBuffers does nothing.
+    visible_ = false;
+    block_visibility_for_n_frames_ = 0;
+    shared_context_.reset(new CanvasSharedContext(this));
+    return;
+  }
+
   glfwWindowHint(GLFW_CONTEXT_CREATION_API, GLFW_EGL_CONTEXT_API);
   glfwWindowHint(GLFW_CLIENT_API, GLFW_OPENGL_ES_API);
   glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
@@ -53,7 +74,7 @@ Window::Window(Delegate* delegate, int width, int height)
   glfwWindowHint(GLFW_COCOA_RETINA_FRAMEBUFFER, GLFW_TRUE);
 
   if (Args().profile_startup) {
-    $(DEV) << "[profile-startup] create window start: " << glfwGetTime();
+    $(DEV) << "[profile-startup] create window start: " << GetClockTime();
   }
 
   window_ = glfwCreateWindow(width, height, "window.js", nullptr, nullptr);
@@ -65,7 +86,7 @@ Window::Window(Delegate* delegate, int width, int height)
   }
 
   if (Args().profile_startup) {
-    $(DEV) << "[profile-startup] create window end: " << glfwGetTime();
+    $(DEV) << "[profile-startup] create window end: " << GetClockTime();
   }
 
 #if defined(WINDOWJS_WIN)
@@ -74,7 +95,7 @@ Window::Window(Delegate* delegate, int width, int height)
   // by focusing the window from here.
   glfwFocusWindow(window_);
   if (Args().profile_startup) {
-    $(DEV) << "[profile-startup] focusing window hack: " << glfwGetTime();
+    $(DEV) << "[profile-startup] focusing window hack: " << GetClockTime();
   }
 #endif
 
@@ -112,7 +133,7 @@ Window::Window(Delegate* delegate, int width, int height)
   ASSERT_NO_GL_ERROR();
 
   if (Args().profile_startup) {
-    $(DEV) << "[profile-startup] Created texture shader: " << glfwGetTime();
+    $(DEV) << "[profile-startup] Created texture shader: " << GetClockTime();
   }
 
   shared_context_.reset(new CanvasSharedContext(this));
@@ -125,8 +146,10 @@ Window::~Window() {
   console_overlay_.reset();
   stats_.reset();
   shared_context_.reset();
-  glfwMakeContextCurrent(nullptr);
-  glfwDestroyWindow(window_);
+  if (window_) {
+    glfwMakeContextCurrent(nullptr);
+    glfwDestroyWindow(window_);
+  }
 }
 
 void Window::OnLoadingStart() {
@@ -148,6 +171,10 @@ void Window::OnLoadingFinished() {
   loading_ = false;
   reloading_ = false;
 
+  if (!window_) {
+    return;
+  }
+
   int width = 0;
   int height = 0;
   glfwGetWindowSize(window_, &width, &height);
@@ -170,7 +197,7 @@ void Window::SetWindowCanvas(Canvas* canvas) {
 }
 
 void Window::RenderAndSwapBuffers() {
-  if (loading_) {
+  if (loading_ || !window_) {
     return;
   }
 
@@ -204,25 +231,49 @@ void Window::RenderAndSwapBuffers() {
 
   if (block_visibility_for_n_frames_ > 0) {
     if (Args().profile_startup) {
-      $(DEV) << "[profile-startup] swap buffers: " << glfwGetTime();
+      $(DEV) << "[profile-startup] swap buffers: " << GetClockTime();
     }
     block_visibility_for_n_frames_--;
     if (block_visibility_for_n_frames_ == 0 && visible_) {
       SetVisible(true);
       if (Args().profile_startup) {
-        $(DEV) << "[profile-startup] set visible and finish: " << glfwGetTime();
+        $(DEV) << "[profile-startup] set visible and finish: "
+               << GetClockTime();
       }
     } else if (Args().profile_startup) {
       $(DEV) << "[profile-startup] skipping a frame on startup... "
-             << glfwGetTime();
+             << GetClockTime();
     }
   }
 
   stats_->OnFrameFinished();
 }
 
+bool Window::should_close() const {
+  if (!window_) {
+    return should_close_;
+  }
+  return glfwWindowShouldClose(window_);
+}
+
+void Window::SetShouldClose(bool should_close) {
+  if (!window_) {
+    should_close_ = should_close;
+    return;
+  }
+  glfwSetWindowShouldClose(window_, should_close ? GLFW_TRUE : GLFW_FALSE);
+  glfwPostEmptyEvent();
+}
+
+void Window::Close() {
+  SetShouldClose(true);
+}
+
 void Window::SetVisible(bool visible) {
   visible_ = visible;
+  if (!window_) {
+    return;
+  }
   if (visible_ && block_visibility_for_n_frames_ == 0) {
     glfwShowWindow(window_);
   } else {
@@ -231,62 +282,124 @@ void Window::SetVisible(bool visible) {
 }
 
 bool Window::focused() const {
+  if (!window_) {
+    return false;
+  }
   return glfwGetWindowAttrib(window_, GLFW_FOCUSED);
 }
 
 void Window::Focus() {
+  if (!window_) {
+    return;
+  }
   glfwFocusWindow(window_);
 }
 
 void Window::RequestAttention() {
+  if (!window_) {
+    return;
+  }
   glfwRequestWindowAttention(window_);
 }
 
 bool Window::maximized() const {
+  if (!window_) {
+    return false;
+  }
   return glfwGetWindowAttrib(window_, GLFW_MAXIMIZED);
 }
 
 bool Window::minimized() const {
+  if (!window_) {
+    return false;
+  }
   return glfwGetWindowAttrib(window_, GLFW_ICONIFIED);
 }
 
 void Window::Maximize() {
+  if (!window_) {
+    return;
+  }
   glfwMaximizeWindow(window_);
 }
 
 void Window::Minimize() {
+  if (!window_) {
+    return;
+  }
   glfwIconifyWindow(window_);
 }
 
 void Window::Restore() {
+  if (!window_) {
+    return;
+  }
   glfwRestoreWindow(window_);
 }
 
 bool Window::decorated() const {
+  if (!window_) {
+    return false;
+  }
   return glfwGetWindowAttrib(window_, GLFW_DECORATED);
 }
 
 void Window::SetDecorated(bool decorated) {
+  if (!window_) {
+    return;
+  }
   glfwSetWindowAttrib(window_, GLFW_DECORATED,
                       decorated ? GLFW_TRUE : GLFW_FALSE);
 }
 
 void Window::SetTitle(std::string title) {
-  glfwSetWindowTitle(window_, title.c_str());
+  if (window_) {
+    glfwSetWindowTitle(window_, title.c_str());
+  }
   title_ = title;
   delegate_->OnTitleChanged();
 }
 
 void Window::SetIcons(std::vector<GLFWimage> icons) {
+  if (!window_) {
+    return;
+  }
   glfwSetWindowIcon(window_, icons.size(), icons.data());
 }
 
 void Window::SetCursor(GLFWcursor* cursor) {
+  if (!window_) {
+    return;
+  }
   glfwSetCursor(window_, cursor);
 }
 
+void Window::SetCursorMode(int mode) {
+  if (!window_) {
+    return;
+  }
+  glfwSetInputMode(window_, GLFW_CURSOR, mode);
+}
+
+std::string Window::GetClipboardText() const {
+  if (!window_) {
+    return "";
+  }
+  const char* text = glfwGetClipboardString(window_);
+  return text ? text : "";
+}
+
+void Window::SetClipboardText(const std::string& text) {
+  if (!window_) {
+    return;
+  }
+  glfwSetClipboardString(window_, text.c_str());
+}
+
 void Window::SetWidth(int width) {
-  if (loading_) {
+  if (!window_) {
+    OnResize(width, height_);
+  } else if (loading_) {
     if (!reloading_) {
       OnResize(width, height_);
     }
@@ -296,7 +409,9 @@ void Window::SetWidth(int width) {
 }
 
 void Window::SetHeight(int height) {
-  if (loading_) {
+  if (!window_) {
+    OnResize(width_, height);
+  } else if (loading_) {
     if (!reloading_) {
       OnResize(width_, height);
     }
@@ -307,6 +422,9 @@ void Window::SetHeight(int height) {
 
 void Window::SetKeepAspectRatio(bool keep) {
   keep_aspect_ratio_ = keep;
+  if (!window_) {
+    return;
+  }
   if (keep) {
     if (loading_) {
       // Make sure that the window size reflects its intended size before
@@ -323,28 +441,46 @@ void Window::SetKeepAspectRatio(bool keep) {
 }
 
 bool Window::resizable() const {
+  if (!window_) {
+    return false;
+  }
   return glfwGetWindowAttrib(window_, GLFW_RESIZABLE) == GLFW_TRUE;
 }
 
 void Window::SetResizable(bool resizable) {
+  if (!window_) {
+    return;
+  }
   glfwSetWindowAttrib(window_, GLFW_RESIZABLE,
                       resizable ? GLFW_TRUE : GLFW_FALSE);
 }
 
 bool Window::always_on_top() const {
+  if (!window_) {
+    return false;
+  }
   return glfwGetWindowAttrib(window_, GLFW_FLOATING) == GLFW_TRUE;
 }
 
 void Window::SetAlwaysOnTop(bool always_on_top) {
+  if (!window_) {
+    return;
+  }
   glfwSetWindowAttrib(window_, GLFW_FLOATING,
                       always_on_top ? GLFW_TRUE : GLFW_FALSE);
 }
 
 bool Window::fullscreen() const {
+  if (!window_) {
+    return false;
+  }
   return glfwGetWindowMonitor(window_) != nullptr;
 }
 
 void Window::SetFullscreen(bool fullscreen) {
+  if (!window_) {
+    return;
+  }
   if (fullscreen) {
     GLFWmonitor* monitor = glfwGetPrimaryMonitor();
     const GLFWvidmode* mode = glfwGetVideoMode(monitor);
@@ -363,10 +499,16 @@ bool Window::vsync() const {
 
 void Window::SetVsync(bool wait_for_vsync) {
   vsync_ = wait_for_vsync;
+  if (!window_) {
+    return;
+  }
   glfwSwapInterval(wait_for_vsync ? 1 : 0);
 }
 
 int Window::frame_left() const {
+  if (!window_) {
+    return 0;
+  }
   int value;
   glfwGetWindowFrameSize(window_, &value, nullptr, nullptr, nullptr);
   value *= retina_scale_;
@@ -374,6 +516,9 @@ int Window::frame_left() const {
 }
 
 int Window::frame_right() const {
+  if (!window_) {
+    return 0;
+  }
   int value;
   glfwGetWindowFrameSize(window_, nullptr, nullptr, &value, nullptr);
   value *= retina_scale_;
@@ -381,6 +526,9 @@ int Window::frame_right() const {
 }
 
 int Window::frame_top() const {
+  if (!window_) {
+    return 0;
+  }
   int value;
   glfwGetWindowFrameSize(window_, nullptr, &value, nullptr, nullptr);
   value *= retina_scale_;
@@ -388,6 +536,9 @@ int Window::frame_top() const {
 }
 
 int Window::frame_bottom() const {
+  if (!window_) {
+    return 0;
+  }
   int value;
   glfwGetWindowFrameSize(window_, nullptr, nullptr, nullptr, &value);
   value *= retina_scale_;
@@ -395,6 +546,9 @@ int Window::frame_bottom() const {
 }
 
 int Window::avail_width() const {
+  if (!window_) {
+    return 0;
+  }
   GLFWmonitor* monitor = glfwGetPrimaryMonitor();
   ASSERT(monitor);
   int value;
@@ -404,6 +558,9 @@ int Window::avail_width() const {
 }
 
 int Window::avail_height() const {
+  if (!window_) {
+    return 0;
+  }
   GLFWmonitor* monitor = glfwGetPrimaryMonitor();
   ASSERT(monitor);
   int value;
@@ -413,6 +570,9 @@ int Window::avail_height() const {
 }
 
 int Window::screen_width() const {
+  if (!window_) {
+    return 0;
+  }
   GLFWmonitor* monitor = glfwGetPrimaryMonitor();
   ASSERT(monitor);
   const GLFWvidmode* mode = glfwGetVideoMode(monitor);
@@ -421,6 +581,9 @@ int Window::screen_width() const {
 }
 
 int Window::screen_height() const {
+  if (!window_) {
+    return 0;
+  }
   GLFWmonitor* monitor = glfwGetPrimaryMonitor();
   ASSERT(monitor);
   const GLFWvidmode* mode = glfwGetVideoMode(monitor);
@@ -428,41 +591,70 @@ int Window::screen_height() const {
   return mode->height * retina_scale_;
 }
 
+int Window::refresh_rate() const {
+  // requestAnimationFrame runs at 60 fps without a window.
+  if (!window_) {
+    return 60;
+  }
+  GLFWmonitor* monitor = glfwGetPrimaryMonitor();
+  ASSERT(monitor);
+  const GLFWvidmode* mode = glfwGetVideoMode(monitor);
+  ASSERT(mode);
+  return mode->refreshRate > 0 ? mode->refreshRate : 60;
+}
+
 float Window::device_pixel_ratio() const {
+  if (!window_) {
+    return 1.0f;
+  }
   float value;
   glfwGetWindowContentScale(window_, &value, nullptr);
   return value;
 }
 
 int Window::x() const {
+  if (!window_) {
+    return 0;
+  }
   int value;
   glfwGetWindowPos(window_, &value, nullptr);
   return value;
 }
 
 int Window::y() const {
+  if (!window_) {
+    return 0;
+  }
   int value;
   glfwGetWindowPos(window_, nullptr, &value);
   return value;
 }
 
 void Window::SetX(int x) {
+  if (!window_) {
+    return;
+  }
   glfwSetWindowPos(window_, x, y());
 }
 
 void Window::SetY(int y) {
+  if (!window_) {
+    return;
+  }
   glfwSetWindowPos(window_, x(), y);
 }
 
 void Window::OnResize(int width, int height) {
   width_ = width;
   height_ = height;
-  ASSERT_NO_GL_ERROR();
   if (canvas_) {
     canvas_->Resize(width, height);
   }
-  framebuffer_->Resize(width, height);
-  ASSERT_NO_GL_ERROR();
+  if (framebuffer_) {
+    ASSERT_NO_GL_ERROR();
+    framebuffer_->Resize(width, height);
+    ASSERT_NO_GL_ERROR();
+  }
 }
 
 // static
@@ -475,23 +667,57 @@ Window::Delegate* Window::GetDelegate(GLFWwindow* window) {
   return Get(window)->delegate_;
 }
 
+void Window::HandleKey(int key, int scancode, int action, int mods) {
+  input_.OnKey(key, action);
+  delegate_->OnKey(key, scancode, action, mods);
+}
+
+void Window::HandleCharacter(unsigned int codepoint) {
+  delegate_->OnCharacter(codepoint);
+}
+
+void Window::HandleMouseMove(double x, double y) {
+  input_.OnMouseMove(x, y);
+  delegate_->OnMouseMove(x, y);
+}
+
+void Window::HandleMouseButton(int button, bool pressed, double x, double y) {
+  input_.OnMouseButton(button, pressed);
+  delegate_->OnMouseButton(button, pressed, x, y);
+}
+
+void Window::HandleMouseWheel(double x, double y) {
+  input_.OnMouseWheel(x, y);
+  delegate_->OnMouseWheel(x, y);
+}
+
+void Window::HandleMouseEnter(bool entered) {
+  delegate_->OnMouseEnter(entered);
+}
+
 // static
 void Window::KeyCallback(GLFWwindow* window, int key, int scancode, int action,
                          int mods) {
-  GetDelegate(window)->OnKey(key, scancode, action, mods);
+  Window* w = Get(window);
+  if (!w->ignore_input_) {
+    w->HandleKey(key, scancode, action, mods);
+  }
 }
 
 // static
 void Window::CharCallback(GLFWwindow* window, unsigned int codepoint) {
-  GetDelegate(window)->OnCharacter(codepoint);
+  Window* w = Get(window);
+  if (!w->ignore_input_) {
+    w->HandleCharacter(codepoint);
+  }
 }
 
 // static
 void Window::CursorPosCallback(GLFWwindow* window, double x, double y) {
   Window* w = Get(window);
-  x *= w->retina_scale_;
-  y *= w->retina_scale_;
-  w->delegate_->OnMouseMove(x, y);
+  if (!w->ignore_input_) {
+    w->HandleMouseMove(x * w->retina_scale_, y * w->retina_scale_);
+  }
 }
 
 // static
@@ -501,19 +727,26 @@ void Window::MouseButtonCallback(GLFWwindow* window, int button, int action,
   double y = 0;
   glfwGetCursorPos(window, &x, &y);
   Window* w = Get(window);
-  x *= w->retina_scale_;
-  y *= w->retina_scale_;
-  w->delegate_->OnMouseButton(button, action == GLFW_PRESS, x, y);
+  if (!w->ignore_input_) {
+    w->HandleMouseButton(button, action == GLFW_PRESS, x * w->retina_scale_,
+                         y * w->retina_scale_);
+  }
 }
 
 // static
 void Window::ScrollCallback(GLFWwindow* window, double x, double y) {
-  GetDelegate(window)->OnMouseWheel(x, y);
+  Window* w = Get(window);
+  if (!w->ignore_input_) {
+    w->HandleMouseWheel(x, y);
+  }
 }
 
 // static
 void Window::CursorEnterCallback(GLFWwindow* window, int entered) {
-  GetDelegate(window)->OnMouseEnter(entered != 0);
+  Window* w = Get(window);
+  if (!w->ignore_input_) {
+    w->HandleMouseEnter(entered != 0);
+  }
 }
 
 // static
@@ -10,6 +10,7 @@
 
 #include "canvas.h"
 #include "console.h"
+#include "input.h"
 #include "stats.h"
 
 class Window final {
@@ -43,6 +44,7 @@ class Window final {
   Window(Delegate* delegate, int width, int height);
   ~Window();
 
+  // Null when running with --no-window.
   GLFWwindow* window() const { return window_; }
   Canvas* canvas() const { return canvas_; }  // May be null!
   CanvasSharedContext* shared_context() const {
@@ -50,11 +52,24 @@ class Window final {
   }
   ConsoleOverlay* console_overlay() { return console_overlay_.get(); }
   Stats* stats() { return stats_.get(); }
+  InputState* input() { return &input_; }
 
   static Window* Get(GLFWwindow* window);
 
   void SetDelegate(Delegate* delegate) { delegate_ = delegate; }
 
+  // Handles input received from GLFW, or recorded input that is being
+  // replayed. Positions are in pixels, already scaled by retina_scale().
+  void HandleKey(int key, int scancode, int action, int mods);
+  void HandleCharacter(unsigned int codepoint);
+  void HandleMouseMove(double x, double y);
+  void HandleMouseButton(int button, bool pressed, double x, double y);
+  void HandleMouseWheel(double x, double y);
+  void HandleMouseEnter(bool entered);
+
+  // Drops all input received from GLFW; used while replaying recorded input.
+  void SetIgnoreInput(bool ignore) { ignore_input_ = ignore; }
+
   void OnLoadingStart();
   void OnLoadingFinished();
 
@@ -64,6 +79,10 @@ class Window final {
 
   bool wants_frames() const { return block_visibility_for_n_frames_ > 0; }
 
+  bool should_close() const;
+  void SetShouldClose(bool should_close);
+  void Close();
+
   bool visible() const { return visible_; }
   void SetVisible(bool visible);
 
@@ -85,6 +104,12 @@ class Window final {
 
   void SetIcons(std::vector<GLFWimage> icons);
   void SetCursor(GLFWcursor* cursor);
+  // GLFW_CURSOR_NORMAL, GLFW_CURSOR_HIDDEN or GLFW_CURSOR_DISABLED.
+  void SetCursorMode(int mode);
+
+  // The clipboard is empty with --no-window.
+  std::string GetClipboardText() const;
+  void SetClipboardText(const std::string& text);
 
   int width() const { return width_; }
   int height() const { return height_; }
@@ -115,6 +140,7 @@ class Window final {
   int avail_height() const;
   int screen_width() const;
   int screen_height() const;
+  int refresh_rate() const;
   float device_pixel_ratio() const;
 
   int x() const;
@@ -159,6 +185,8 @@ class Window final {
   bool keep_aspect_ratio_;
   bool loading_;
   bool reloading_;
+  bool should_close_;
+  bool ignore_input_;
   int block_visibility_for_n_frames_;
 
   std::unique_ptr<CanvasSharedContext> shared_context_;
@@ -172,6 +200,8 @@ class Window final {
 
   std::unique_ptr<ConsoleOverlay> console_overlay_;
   std::unique_ptr<Stats> stats_;
+
+  InputState input_;
 };
 
 #endif  // WINDOWJS_WINDOW_H
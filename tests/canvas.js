@@ -9,6 +9,8 @@
 // that test.
 
 import {
+  assert,
+  assertEquals,
   createCanvas,
   diffCanvasToFile,
   unwrapCanvas,
@@ -289,3 +291,158 @@ export async function svgPath() {
   canvas.fill(p);
   await diffCanvasToFile('data/svg_path.png', 200);
 }
+
+export async function colorSyntaxes() {
+  const canvas = window.canvas;
+  const colors = {
+    'RED': '#ff0000',
+    ' #f00 ': '#ff0000',
+    'rgb(255, 128, 0)': '#ff8000',
+    'rgb(255 128 0)': '#ff8000',
+    'rgb(100% 50% 0%)': '#ff8000',
+    'rgba(0, 0, 255, 1)': '#0000ff',
+    'hsl(120, 100%, 25%)': '#008000',
+    'hsl(120deg 100% 25%)': '#008000',
+    'hwb(120 0% 50%)': '#008000',
+    'lab(29.2345% 39.3825 20.0664)': '#7d2329',
+    'lch(29.2345% 44.2 27.01)': '#7d2329',
+    'oklab(59.69% 0.1007 0.1191)': '#c65d07',
+    'oklch(59.69% 0.156 49.77)': '#c65d07',
+    'color(srgb 1 0.5 0)': '#ff8000',
+    'color(display-p3 0.5 0.5 0.5)': '#808080',
+    'rgb(none 128 0)': '#008000',
+    'hsl(none 100% 50%)': '#ff0000',
+    'rgb(255 128 0 / 50%)': '#ff800080',
+    'hsl(120 100% 25% / 0.25)': '#00800040',
+    // Out of gamut colors are clamped.
+    'rgb(300 -20 0)': '#ff0000',
+    'color(srgb 1.5 -0.5 0)': '#ff0000',
+    'color(display-p3 0 1 0)': '#00ff00',
+    'oklch(90% 0.4 30)': '#ff0000',
+    'hsla(0.5turn 100% 50% / 1)': '#00ffff',
+  };
+  for (const [css, expected] of Object.entries(colors)) {
+    canvas.fillStyle = 'black';
+    canvas.fillStyle = css;
+    assertEquals(canvas.fillStyle, expected);
+  }
+  // Invalid colors are ignored.
+  canvas.fillStyle = 'rgb(1, 2)';
+  assertEquals(canvas.fillStyle, '#00ffff');
+}
+
+export async function fontShorthand() {
+  const canvas = window.canvas;
+  const sizes = {
+    '16px serif': '16px',
+    'italic 600 condensed 12pt/1.5 "No Such Font", serif': '16px',
+    'small-caps bold 2em monospace': '32px',
+    '150% sans-serif': '24px',
+  };
+  for (const [css, expected] of Object.entries(sizes)) {
+    canvas.font = css;
+    assert(canvas.font.includes(expected));
+  }
+  // Invalid fonts are ignored.
+  canvas.font = '10furlongs serif';
+  assert(canvas.font.includes('24px'));
+}
+
+export async function prewarmText() {
+  const canvas = window.canvas;
+  const count = canvas.prewarmText('bold 24px sans-serif', '0123456789 9876');
+  assert(count > 0 && count <= 11);
+
+  let threw = false;
+  try {
+    canvas.prewarmText('24furlongs sans-serif', '0123456789');
+  } catch (e) {
+    threw = true;
+  }
+  assert(threw);
+}
+
+export async function textLayoutBreaksLines() {
+  const canvas = window.canvas;
+  canvas.font = '10px monospace';
+  const w = canvas.measureText('x').width;
+
+  const layout = new TextLayout(
+      'hello world foo\nbar', '10px monospace', 11.5 * w, 'center', 20);
+  assertEquals(layout.lineStarts.join(), '0,12,16');
+  assertEquals(layout.lineEnds.join(), '11,15,19');
+  assert(Math.abs(layout.lineWidths[0] - 11 * w) < 0.01);
+  assert(Math.abs(layout.lineLefts[1] - 4.25 * w) < 0.01);
+  assert(Math.abs(layout.width - 11 * w) < 0.01);
+  assertEquals(layout.lineHeight, 20);
+  assertEquals(layout.height, 60);
+  const spacing = layout.lineBaselines[1] - layout.lineBaselines[0];
+  assert(Math.abs(spacing - 20) < 0.01);
+
+  // Words that don't fit are broken between characters.
+  const narrow = new TextLayout('abcdefgh', '10px monospace', 3.5 * w);
+  assertEquals(narrow.lineStarts.join(), '0,3,6');
+
+  canvas.fillStyle = 'white';
+  canvas.drawTextLayout(layout, 0, 0);
+
+  let threw = false;
+  try {
+    new TextLayout('text', '10px monospace', 100, 'justify');
+  } catch (e) {
+    threw = true;
+  }
+  assert(threw);
+}
+
+export async function measureTextBatch() {
+  const canvas = window.canvas;
+  canvas.font = '20px sans-serif';
+  const strings = ['hello', '', 'Ag 123', 'hello'];
+  const metrics = canvas.measureTextBatch(strings);
+  assertEquals(metrics.length, 20);
+  for (let i = 0; i < strings.length; i++) {
+    const m = canvas.measureText(strings[i]);
+    assertEquals(metrics[i * 5], Math.fround(m.width));
+    assertEquals(metrics[i * 5 + 1], Math.fround(m.actualBoundingBoxAscent));
+    assertEquals(metrics[i * 5 + 4], Math.fround(m.actualBoundingBoxRight));
+  }
+
+  // The metrics can be written to an existing array.
+  const out = new Float32Array(10);
+  assert(canvas.measureTextBatch(['hello', 'x'], out) === out);
+  assertEquals(out[0], metrics[0]);
+
+  let threw = false;
+  try {
+    canvas.measureTextBatch(strings, out);
+  } catch (e) {
+    threw = true;
+  }
+  assert(threw);
+}
+
+export async function keywordSetters() {
+  const canvas = window.canvas;
+  canvas.textAlign = 'center';
+  assertEquals(canvas.textAlign, 'center');
+  // Strings that are built at runtime aren't internalized like literals, but
+  // must match too.
+  canvas.textAlign = ['ri', 'ght'].join('');
+  assertEquals(canvas.textAlign, 'right');
+  canvas.globalCompositeOperation = 'destination-' + 'over';
+  assertEquals(canvas.globalCompositeOperation, 'destination-over');
+  canvas.lineJoin = 'bev' + 'el'.repeat(1);
+  assertEquals(canvas.lineJoin, 'bevel');
+  // Unknown keywords are ignored.
+  canvas.textAlign = 'middle';
+  assertEquals(canvas.textAlign, 'right');
+  canvas.globalCompositeOperation = 'source-over';
+  assertEquals(canvas.globalCompositeOperation, 'source-over');
+
+  // Non-ASCII text is still converted to UTF-8.
+  canvas.font = '20px sans-serif';
+  assert(canvas.measureText('café').width >
+         canvas.measureText('caf').width);
+  assert(canvas.measureText('日本'.repeat(200)).width > 0);
+}
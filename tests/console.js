@@ -0,0 +1,100 @@
+// Tests for the formatting of console messages. window.debug.formatLog()
+// captures its arguments like console.log() does, with a snapshot of plain
+// objects and Arrays, and returns the message that the LogFormatter makes.
+
+import {assertEquals} from './lib/lib.js';
+
+function assertLog(value, expected) {
+  assertEquals(window.debug.formatLog(value), expected);
+}
+
+export async function primitives() {
+  assertEquals(window.debug.formatLog('a', 1, 1.5, true, null, undefined),
+               'a 1 1.5 true null undefined');
+  assertLog([0, -1, 2 ** 31, 2 ** 32 + 1, 1e21, 1e-7, NaN, -Infinity],
+            '[0, -1, 2147483648, 4294967297, 1e+21, 1e-7, NaN, -Infinity]');
+  assertLog([true, false, null, undefined], '[true, false, null, undefined]');
+  assertLog([1n, -5n, 0n, 2n ** 70n, -(2n ** 64n)],
+            '[1n, -5n, 0n, 1180591620717411303424n, -18446744073709551616n]');
+  assertLog([2n ** 2000n], '[[BigInt]]');
+}
+
+export async function strings() {
+  assertLog(['latin1 é', 'two-byte 日本 😀', 'quote " back \\ nl \n'],
+            '["latin1 é", "two-byte 日本 😀", "quote \\" back \\\\ nl \\n"]');
+
+  // Long messages are cut at the start of a character.
+  const message = window.debug.formatLog(['日'.repeat(6000)]);
+  assertEquals(message.slice(-1), '…');
+  assertEquals(message.slice(0, -1).replaceAll('日', ''), '["');
+}
+
+export async function objects() {
+  assertLog({a: 1, b: 'two', c: [3, 4], 'not id': null, 1: true, u: undefined},
+            '{1: true, a: 1, b: "two", c: [3, 4], "not id": null, ' +
+                'u: undefined}');
+  assertLog({0: 'a', 10: 'b', '01': 'c'}, '{0: "a", 10: "b", "01": "c"}');
+  assertLog({a: {b: {c: {d: 1}}}, l: [[[[1]]]]},
+            '{a: {b: {c: [Object]}}, l: [[[Array]]]}');
+  assertLog([[], {}, new Map(), new Set()], '[[], {}, Map {}, Set {}]');
+}
+
+export async function arrays() {
+  const sparse = [1];
+  sparse[5] = 2;
+  assertLog(sparse, '[0: 1, 5: 2]');
+  const withProperties = [1, 2];
+  withProperties.extra = 'e';
+  assertLog(withProperties, '[1, 2, extra: "e"]');
+}
+
+export async function references() {
+  const circular = {a: 1};
+  circular.self = circular;
+  assertLog(circular, '{a: 1, self: [Circular]}');
+
+  const shared = {x: 1};
+  assertLog([shared, shared, {s: shared}], '[{x: 1}, {x: 1}, {s: {x: 1}}]');
+}
+
+export async function builtins() {
+  assertLog([new Date(0)], '[Date(0)]');
+  assertLog([new Number(3), new String('s'), new Boolean(true),
+             new Boolean(false), Object(7n)],
+            '[[Number: 3], [String: "s"], [Boolean: true], ' +
+                '[Boolean: false], [BigInt: 7n]]');
+  assertLog([/ab+c/gimsuy], '[/ab+c/gimsuy]');
+  assertLog([new Map([[1, 'a'], ['b', {c: 2}]])],
+            '[Map {1 => "a", "b" => {c: 2}}]');
+  assertLog([new Set([1, 'two'])], '[Set {1, "two"}]');
+  assertLog([new Error('boom'), new TypeError('bad'), new RangeError()],
+            '[Error: boom, TypeError: bad, RangeError]');
+}
+
+export async function buffers() {
+  const buffer = new ArrayBuffer(8);
+  assertLog(
+      [buffer, new Uint8Array(4), new Int16Array(buffer), new Float64Array(2),
+       new DataView(buffer), new BigInt64Array(1), new Uint8ClampedArray(3),
+       new Float32Array(3)],
+      '[ArrayBuffer { byteLength: 8 }, Uint8Array(4), Int16Array(4), ' +
+          'Float64Array(2), DataView(8), BigInt64Array(1), ' +
+          'Uint8ClampedArray(3), Float32Array(3)]');
+  assertLog([new Uint8Array(buffer, 0, 2), new Uint8Array(buffer, 2, 2)],
+            '[Uint8Array(2), Uint8Array(2)]');
+
+  // Views of resizable buffers can track their length.
+  const resizable = new ArrayBuffer(4, {maxByteLength: 16});
+  if (resizable.resizable) {
+    assertLog([resizable, new Uint8Array(resizable)],
+              '[ArrayBuffer { byteLength: 4 }, Uint8Array]');
+  }
+}
+
+export async function dir() {
+  assertEquals(
+      window.debug.formatDir(
+          {b: 1, a: 'x', o: {n: 1}, l: [1], t: true, z: null, u: undefined}),
+      'Object\n    a: "x"\n    b: 1\n    l: object\n    o: object\n' +
+          '    t: true\n    u: undefined\n    z: null');
+}
@@ -127,6 +127,93 @@ export async function readJSON() {
   assert(json['object'] instanceof Object);
 }
 
+export async function readJSONIncremental() {
+  const list = [];
+  for (let i = 0; i < 10000; i++) {
+    list.push({id: i, name: 'item ' + i, tags: ['a', 'b'], nested: {i}});
+  }
+  const text = JSON.stringify(list);
+  const dir = await getTmpDir();
+  const path = dir + '/large.json';
+  await File.write(path, text);
+  assertEquals(JSON.stringify(await File.readJSON(path)), text);
+  const json = await File.readJSON(path, {incremental: true});
+  assertEquals(JSON.stringify(json), text);
+
+  // Large lists of primitives are converted in steps too.
+  const flat = JSON.stringify(list.map(item => item.name));
+  await File.write(path, flat);
+  assertEquals(
+      JSON.stringify(await File.readJSON(path, {incremental: true})), flat);
+}
+
+export async function readJSONErrors() {
+  const dir = await getTmpDir();
+  const path = dir + '/object.json';
+  // Duplicated keys keep the last value, like JSON.parse.
+  await File.write(path, '{"a": 1, "b": 2, "a": 3}');
+  assertEquals(JSON.stringify(await File.readJSON(path)), '{"a":3,"b":2}');
+
+  await File.write(path, '{"a": 1,}');
+  let failed = false;
+  try {
+    await File.readJSON(path);
+  } catch (e) {
+    failed = true;
+  }
+  assert(failed);
+}
+
+export async function readJSONLikeJSONParse() {
+  const dir = await getTmpDir();
+  const path = dir + '/values.json';
+  const values = [
+    '["\\ud800", "\\udc00x", "\\ud83d\\ude00", "a\\ud800\\u0041"]',
+    '{"\\ud800": 1}',
+    '[-0, -0.0, 0, 1.5e-7, 9223372036854775808, 12345678901234567890]',
+    '[1.' + '5'.repeat(100) + ', ' + '1'.repeat(70) + ']',
+  ];
+  for (const value of values) {
+    await File.write(path, value);
+    const expected = JSON.parse(value);
+    for (const incremental of [false, true]) {
+      const json = await File.readJSON(path, {incremental});
+      assertEquals(json.length, expected.length);
+      for (const key in expected) {
+        assert(Object.is(json[key], expected[key]));
+      }
+    }
+  }
+
+  for (const value of ['01', '-01', '"\\x"', '[1.]', '"a\tb"']) {
+    await File.write(path, value);
+    let failed = false;
+    try {
+      await File.readJSON(path);
+    } catch (e) {
+      failed = true;
+    }
+    assert(failed);
+  }
+}
+
+export async function readJSONLines() {
+  const dir = await getTmpDir();
+  const path = dir + '/lines.jsonl';
+  await File.write(path, '{"a": 1}\n\n[1, 2]\r\n"three"\n4');
+
+  let result = await File.readJSONLines(path);
+  assertEquals(JSON.stringify(result.values), '[{"a":1},[1,2],"three",4]');
+  assert(result.done);
+
+  result = await File.readJSONLines(path, {maxLines: 2});
+  assertEquals(JSON.stringify(result.values), '[{"a":1},[1,2]]');
+  assert(!result.done);
+  result = await File.readJSONLines(path, {offset: result.offset});
+  assertEquals(JSON.stringify(result.values), '["three",4]');
+  assert(result.done);
+}
+
 export async function readText() {
   const text = await File.readText(__dirname + '/data/copyTree/file.txt');
   assert(text === 'Test file.\n');
@@ -1,6 +1,6 @@
 // Tests for the global functions: https://windowjs.org/doc/global
 
-import {assert, assertEquals} from './lib/lib.js';
+import {assert, assertEquals, getTmpDir} from './lib/lib.js';
 
 export async function devicePixelRatioIsANumber() {
   assert(typeof(devicePixelRatio) == 'number');
@@ -29,3 +29,156 @@ export async function clearTimeoutCancels() {
     clearTimeout(id);
   });
 }
+
+export async function performanceGetInputLatency() {
+  const latency = performance.getInputLatency();
+  for (const stage of [latency.dispatch, latency.swap]) {
+    assert(typeof(stage.count) == 'number');
+    assert(stage.p50 <= stage.p90);
+    assert(stage.p90 <= stage.p99);
+    assert(stage.p99 <= stage.max);
+  }
+}
+
+export async function performanceGetFrameStats() {
+  performance.resetFrameStats();
+  await new Promise((resolve) => requestAnimationFrame(resolve));
+  await new Promise((resolve) => requestAnimationFrame(resolve));
+
+  const stats = performance.getFrameStats();
+  assert(stats.frames > 0);
+  assert(stats.refreshInterval > 0);
+  assertEquals(stats.jank.length, 3);
+  assertEquals(stats.histogramBounds.length, stats.histograms.total.length);
+  for (const phase of ['wait', 'gc', 'js', 'raf', 'swap', 'total']) {
+    assertEquals(stats.history[phase].length, Math.min(stats.frames, 240));
+    assertEquals(stats.histograms[phase].reduce((a, b) => a + b),
+                 stats.frames);
+  }
+
+  performance.resetFrameStats();
+  assertEquals(performance.getFrameStats().frames, 0);
+}
+
+export async function performanceMarkAndMeasure() {
+  performance.mark('test-start');
+  performance.mark('test-end');
+  performance.measure('test', 'test-start', 'test-end');
+  performance.measure('test');
+
+  const marks = performance.getEntriesByName('test-start');
+  assertEquals(marks.length, 1);
+  assertEquals(marks[0].name, 'test-start');
+  assertEquals(marks[0].entryType, 'mark');
+  assertEquals(marks[0].duration, 0);
+
+  const measures = performance.getEntriesByName('test', 'measure');
+  assertEquals(measures.length, 2);
+  assertEquals(measures[0].startTime, marks[0].startTime);
+  assertEquals(measures[1].startTime, 0);
+  assert(measures[0].duration >= 0);
+  assert(measures[1].duration >= measures[0].duration);
+
+  performance.clearMarks('test-start');
+  assertEquals(performance.getEntriesByName('test-start').length, 0);
+  assertEquals(performance.getEntriesByName('test-end').length, 1);
+  performance.clearMarks();
+  performance.clearMeasures();
+  assertEquals(performance.getEntriesByName('test').length, 0);
+
+  let threw = false;
+  try {
+    performance.measure('test', 'no-such-mark');
+  } catch (e) {
+    threw = true;
+  }
+  assert(threw);
+}
+
+export async function performanceMarksAreOverwritten() {
+  // The buffer keeps the 4096 most recent entries, and forgets the names of
+  // the entries that were overwritten.
+  performance.mark('first');
+  for (let i = 0; i < 5000; i++) {
+    performance.mark('mark-' + i);
+  }
+  assertEquals(performance.getEntriesByName('first').length, 0);
+  assertEquals(performance.getEntriesByName('mark-0').length, 0);
+  assertEquals(performance.getEntriesByName('mark-4999').length, 1);
+  performance.measure('last', 'mark-4999');
+
+  let threw = false;
+  try {
+    performance.measure('test', 'first');
+  } catch (e) {
+    threw = true;
+  }
+  assert(threw);
+  performance.clearMarks();
+  performance.clearMeasures();
+}
+
+export async function performanceStartAndStopProfiling() {
+  performance.startProfiling('test', {sampleIntervalUs: 100});
+  let sum = 0;
+  const start = performance.now();
+  while (performance.now() - start < 20) {
+    sum += Math.sqrt(sum + 1);
+  }
+  assert(sum > 0);
+
+  const path = (await getTmpDir()) + '/test.cpuprofile';
+  await performance.stopProfiling('test', path);
+  const profile = await File.readJSON(path);
+  assert(profile.nodes.length > 0);
+  assertEquals(profile.nodes[0].callFrame.functionName, '(root)');
+  assertEquals(profile.samples.length, profile.timeDeltas.length);
+  assert(profile.endTime >= profile.startTime);
+
+  let threw = false;
+  try {
+    performance.stopProfiling('test', path);
+  } catch (e) {
+    threw = true;
+  }
+  assert(threw);
+}
+
+export async function performanceStartProfilingChecksTheInterval() {
+  for (const sampleIntervalUs of [0, -1, NaN, 1e7, 2 ** 32, '100']) {
+    let threw = false;
+    try {
+      performance.startProfiling('test', {sampleIntervalUs});
+    } catch (e) {
+      threw = true;
+    }
+    assert(threw);
+  }
+}
+
+export async function performanceGetApiCounters() {
+  const canvas = new CanvasRenderingContext2D(16, 16);
+  const before = performance.getApiCounters().total;
+  const count = (counters, name) => counters.canvas[name] || 0;
+
+  canvas.beginPath();
+  for (let i = 0; i < 10; i++) {
+    canvas.lineTo(i, i);
+  }
+  canvas.fillStyle = 'red';
+  canvas.getImageData(0, 0, 16, 16);
+  await File.isFile(__filename);
+  await new Promise((resolve) => requestAnimationFrame(resolve));
+  await new Promise((resolve) => requestAnimationFrame(resolve));
+
+  const counters = performance.getApiCounters();
+  const after = counters.total;
+  assert(counters.frames > 0);
+  assertEquals(count(after, 'lineTo') - count(before, 'lineTo'), 10);
+  assertEquals(count(after, 'beginPath') - count(before, 'beginPath'), 1);
+  assertEquals(count(after, 'fillStyle') - count(before, 'fillStyle'), 1);
+  assert(after.file.isFile > 0);
+  assert(after.native.readPixelsBytes - before.native.readPixelsBytes >=
+         16 * 16 * 4);
+  assertEquals(counters.frame.canvas.lineTo, undefined);
+}
@@ -0,0 +1,112 @@
+// Tests for the native JSON parser and writer, used by File.readJSON() and
+// the console messages. window.debug.rewriteJson() parses its argument and
+// writes it again, and the results are compared with JSON.parse().
+
+import {
+  assert,
+  assertEquals,
+} from './lib/lib.js';
+
+// Parses |json| natively and with JSON.parse(), and compares the results.
+function assertSameAsJSONParse(json) {
+  const expected = JSON.parse(json);
+  const actual = JSON.parse(window.debug.rewriteJson(json));
+  assertEquals(JSON.stringify(actual), JSON.stringify(expected));
+  return actual;
+}
+
+function assertInvalid(json) {
+  let threw = false;
+  try {
+    window.debug.rewriteJson(json);
+  } catch (e) {
+    threw = true;
+  }
+  assert(threw);
+}
+
+export async function roundTrips() {
+  assertSameAsJSONParse('null');
+  assertSameAsJSONParse('true');
+  assertSameAsJSONParse('false');
+  assertSameAsJSONParse('""');
+  assertSameAsJSONParse('[]');
+  assertSameAsJSONParse('{}');
+  assertSameAsJSONParse(' [1, "two", {"three": [3, null, false]}] ');
+
+  const level = {name: 'level 1', tiles: [], entities: []};
+  for (let i = 0; i < 1000; i++) {
+    level.tiles.push(i % 7);
+    level.entities.push({id: i, x: i * 0.5, tags: ['a', 'b'], active: true});
+  }
+  assertSameAsJSONParse(JSON.stringify(level));
+  assertSameAsJSONParse(JSON.stringify(level, null, 2));
+}
+
+export async function escapesAndSurrogates() {
+  assertSameAsJSONParse('"\\"\\\\\\/\\b\\f\\n\\r\\t"');
+  assertSameAsJSONParse('"\\u0000\\u001f\\u00e9\\u20ac"');
+  assertSameAsJSONParse('"café 日本 한"');
+  assertSameAsJSONParse('"a long string with an escape in the middle\\n' +
+                        'and more text after it"');
+
+  // Surrogate pairs, and unpaired surrogates like JSON.parse() keeps them.
+  assertEquals(JSON.parse(window.debug.rewriteJson('"\\ud83d\\ude00"')),
+               '😀');
+  assertEquals(JSON.parse(window.debug.rewriteJson('"\\ud800"')), '\ud800');
+  assertEquals(JSON.parse(window.debug.rewriteJson('"\\udc00x"')), '\udc00x');
+  assertEquals(JSON.parse(window.debug.rewriteJson('"\\ud800\\u0041"')),
+               '\ud800A');
+  assertEquals(
+      JSON.parse(window.debug.rewriteJson('"\\ud800\\ud800\\udc00"')),
+      '\ud800𐀀');
+}
+
+export async function numbers() {
+  const numbers = [
+    '0', '1', '-1', '1.5', '0.1', '-1.5e-7', '1E3', '1e+3', '2.5e-3',
+    '999999999999999999', '-999999999999999999',
+    '9007199254740993', '9223372036854775807', '9223372036854775808',
+    '-9223372036854775808', '12345678901234567890', '1e300', '5e-324',
+    '1.7976931348623157e308', '1.0', '-0.0',
+    '1.' + '5'.repeat(100), '1'.repeat(70),
+  ];
+  for (const number of numbers) {
+    const actual = assertSameAsJSONParse('[' + number + ']')[0];
+    assert(Object.is(actual, JSON.parse(number)));
+  }
+
+  // Infinities are written as null, like JSON.stringify() does.
+  assertSameAsJSONParse('[1e400, -1e400]');
+
+  assert(Object.is(JSON.parse(window.debug.rewriteJson('-0')), -0));
+  assert(Object.is(JSON.parse(window.debug.rewriteJson('-0.0')), -0));
+}
+
+export async function duplicateKeys() {
+  // The last value wins, in the position of the first key.
+  assertSameAsJSONParse('{"a": 1, "b": 2, "a": 3}');
+  assertSameAsJSONParse('{"a": {"a": 1, "a": 2}, "a": {"b": 3}}');
+
+  const keys = [];
+  for (let i = 0; i < 1000; i++) {
+    keys.push(`"k${i}": ${i}`);
+  }
+  keys.push('"k10": "again"');
+  assertSameAsJSONParse('{' + keys.join(',') + '}');
+}
+
+export async function malformedInput() {
+  const inputs = [
+    '', ' ', '01', '-01', '00', '1.', '.5', '-', '+1', '1e', '1e+', '0x10',
+    'NaN', 'Infinity', '-Infinity', 'tru', 'nul', '[', ']', '[1,]', '[,1]',
+    '{"a":1,}', '{"a"}', '{a: 1}', '{"a" 1}', '\'a\'', '"abc', '"abc\\',
+    '"\\x"', '"\\u12"', '"\\u12g4"', '"a\tb"', '"a\nb"', '[1] x', '1 2',
+  ];
+  for (const input of inputs) {
+    assertInvalid(input);
+  }
+
+  // Deeper than the maximum depth.
+  assertInvalid('['.repeat(1000) + ']'.repeat(1000));
+}
@@ -48,3 +48,79 @@ export async function minimize() {
   await restoreNotification;
   assert(!window.minimized);
 }
+
+export async function inputState() {
+  const input = window.input;
+  assert(input.keys instanceof Uint8Array);
+  assert(input.pressed instanceof Uint8Array);
+  assert(input.released instanceof Uint8Array);
+  assert(input.pointer instanceof Float64Array);
+  assertEquals(input.pointer.length, 7);
+  assertEquals(input.pressed.length, input.released.length);
+  assert(input.pressed.length * 8 >= input.keys.length);
+  assert(input.codes.KeyA < input.keys.length);
+  assert(input.codes.ArrowLeft < input.keys.length);
+  assert(input.codes.KeyA != input.codes.KeyB);
+  assertEquals(input.codes.Unidentified, undefined);
+  assert(Object.isFrozen(input.codes));
+  assertEquals(window.input, input);
+}
+
+export async function longTasks() {
+  assertEquals(window.debug.longTaskThreshold, 50);
+  window.debug.longTaskThreshold = 5;
+  assertEquals(window.debug.longTaskThreshold, 5);
+  window.debug.longTaskThreshold = -1;
+  assertEquals(window.debug.longTaskThreshold, 5);
+
+  const longTask = resolveOnNextEvent('longtask');
+  setTimeout(function busyLoop() {
+    const start = performance.now();
+    while (performance.now() - start < 10) {}
+  }, 0);
+  const event = await longTask;
+  window.debug.longTaskThreshold = 50;
+
+  assertEquals(event.type, 'longtask');
+  assertEquals(event.name, 'setTimeout');
+  assert(event.source.startsWith('busyLoop'));
+  assert(event.duration >= 10);
+  assert(event.startTime <= performance.now());
+  assert(performance.getFrameStats().longTasks.count > 0);
+}
+
+export async function loadFontsRejectsInvalidFiles() {
+  await window.loadFonts([]);
+
+  const dir = await getTmpDir();
+  let error = null;
+  try {
+    await window.loadFonts([
+      {path: dir + '/missing1.ttf', name: 'Missing 1'},
+      {path: dir + '/missing2.ttf', name: 'Missing 2'},
+    ]);
+  } catch (e) {
+    error = e;
+  }
+  assert(error.startsWith('Failed to load font at ' + dir + '/missing1.ttf'));
+
+  error = null;
+  try {
+    await window.loadFont(__dirname + '/data/binary.bin', 'Binary');
+  } catch (e) {
+    error = e;
+  }
+  assert(error.endsWith('failed to decode'));
+}
+
+export async function prewarmFontsResolves() {
+  await window.prewarmFonts([]);
+  await window.prewarmFonts([
+    {font: '32px serif', characters: 'ABCDEFGHIJKLMNOPQRSTUVWXYZ'},
+    {font: 'italic 12px monospace', characters: 'abcdefghijklmnopqrstuvwxyz'},
+  ]);
+  const glyphCache = performance.getFrameStats().glyphCache;
+  assert(glyphCache.count > 0);
+  assert(glyphCache.used > 0);
+  assert(glyphCache.used <= glyphCache.limit);
+}
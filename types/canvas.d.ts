@@ -145,8 +145,11 @@ interface CanvasFillStrokeStyles {
      * -  `#rgba`
      * -  `#rrggbb`
      * -  `#rrggbbaa`
-     * -  `rgb(r, g, b)`
-     * -  `rgba(r, g, b, a)`
+     * -  `rgb(r, g, b)`, `rgba(r, g, b, a)` or `rgb(r g b / a)`
+     * -  `hsl(h, s, l)`, `hsla(h, s, l, a)` or `hsl(h s l / a)`
+     * -  `hwb()`, `lab()`, `lch()`, `oklab()`, `oklch()` and `color()`, clamped to
+     *    sRGB
+     * -  `transparent`
      * -  A
      * [CSS color name](https://developer.mozilla.org/en-US/docs/Web/CSS/color_value#color_keywords)
      * like `red` or `dodgerblue`.
@@ -167,8 +170,11 @@ interface CanvasFillStrokeStyles {
      * -  `#rgba`
      * -  `#rrggbb`
      * -  `#rrggbbaa`
-     * -  `rgb(r, g, b)`
-     * -  `rgba(r, g, b, a)`
+     * -  `rgb(r, g, b)`, `rgba(r, g, b, a)` or `rgb(r g b / a)`
+     * -  `hsl(h, s, l)`, `hsla(h, s, l, a)` or `hsl(h s l / a)`
+     * -  `hwb()`, `lab()`, `lch()`, `oklab()`, `oklch()` and `color()`, clamped to
+     *    sRGB
+     * -  `transparent`
      * -  A
      * [CSS color name](https://developer.mozilla.org/en-US/docs/Web/CSS/color_value#color_keywords)
      * like `red` or `dodgerblue`.
@@ -555,6 +561,46 @@ declare var Path2D: {
     prototype: Path2D;
 };
 
+/**
+ * A paragraph of text broken into lines that fit in a given width, ready to
+ * be drawn with {@link CanvasText.drawTextLayout drawTextLayout}.
+ *
+ * The indices of the lines in the text are in UTF-16 code units, like the
+ * indices of Javascript strings.
+ */
+interface TextLayout {
+    /** The width of the widest line. */
+    readonly width: number;
+    /** The height of all the lines. */
+    readonly height: number;
+    /** The distance between the baselines of consecutive lines. */
+    readonly lineHeight: number;
+    /** The index in the text where each line starts. */
+    readonly lineStarts: Uint32Array;
+    /** The index in the text where each line ends, without the whitespace that ends it. */
+    readonly lineEnds: Uint32Array;
+    /** The horizontal offset of each line after alignment, from the left of the layout. */
+    readonly lineLefts: Float32Array;
+    /** The width of each line, without the whitespace that ends it. */
+    readonly lineWidths: Float32Array;
+    /** The baseline of each line, from the top of the layout. */
+    readonly lineBaselines: Float32Array;
+}
+
+declare var TextLayout: {
+    prototype: TextLayout;
+
+    /**
+     * Breaks `text` into lines that fit in `maxWidth`.
+     * @param text  The text to lay out.
+     * @param font  The font to use, in the same format as {@link CanvasTextDrawingStyles.font font}.
+     * @param maxWidth  The maximum width of the lines. Lines are only broken at newlines if this is missing or 0.
+     * @param align  How the lines are aligned within `maxWidth`. Defaults to `"left"`.
+     * @param lineHeight  The distance between the baselines of consecutive lines. Defaults to the line spacing of the font.
+     */
+    new(text: string, font: string, maxWidth?: number, align?: CanvasTextAlign, lineHeight?: number): TextLayout;
+};
+
 interface CanvasPathDrawingStyles {
     /**
      * The shape used to draw the end points of lines.
@@ -758,8 +804,11 @@ interface CanvasShadowStyles {
      * *  `#rgba`
      * *  `#rrggbb`
      * *  `#rrggbbaa`
-     * *  `rgb(r, g, b)`
-     * *  `rgba(r, g, b, a)`
+     * *  `rgb(r, g, b)`, `rgba(r, g, b, a)` or `rgb(r g b / a)`
+     * *  `hsl(h, s, l)`, `hsla(h, s, l, a)` or `hsl(h s l / a)`
+     * *  `hwb()`, `lab()`, `lch()`, `oklab()`, `oklch()` and `color()`, clamped to
+     *    sRGB
+     * *  `transparent`
      * *  A
      * [CSS color name](https://developer.mozilla.org/en-US/docs/Web/CSS/color_value#color_keywords)
      * like `red` or `dodgerblue`.
@@ -844,6 +893,43 @@ interface CanvasText {
      */
     measureText(text: string): TextMetrics;
 
+    /**
+     * Measures many strings at once, and returns their metrics in a single
+     * `Float32Array`. This is much cheaper than calling
+     * {@link CanvasText.measureText measureText} for each string.
+     * 
+     * The array returned has 5 values per string: its `width`,
+     * `actualBoundingBoxAscent`, `actualBoundingBoxDescent`,
+     * `actualBoundingBoxLeft` and `actualBoundingBoxRight`. The metrics are
+     * cached for each font.
+     * @param strings  The text strings to measure.
+     * @param out  Optional array to write the metrics to, instead of creating a new one. It must have at least 5 values per string.
+     */
+    measureTextBatch(strings: string[], out?: Float32Array): Float32Array;
+
+    /**
+     * Rasterizes the glyphs of the given characters into the glyph cache, so
+     * that drawing them later doesn't cause a hitch in the first frame that
+     * uses them. Returns the number of distinct glyphs prewarmed.
+     * 
+     * The glyphs are prewarmed for the given font size without any transform.
+     * Use {@link Window.prewarmFonts} to prewarm many fonts in idle time
+     * instead.
+     * @param font  The font to prewarm, in the same format as {@link CanvasTextDrawingStyles.font font}.
+     * @param characters  The characters to prewarm, like `"0123456789"`.
+     */
+    prewarmText(font: string, characters: string): number;
+
+    /**
+     * Draws a {@link TextLayout} with its top left corner at `(x, y)`, using the
+     * current fill style. The font and alignment are the ones of the
+     * `TextLayout`.
+     * @param layout  The text to draw.
+     * @param x  The horizontal coordinate of the left of the layout.
+     * @param y  The vertical coordinate of the top of the layout.
+     */
+    drawTextLayout(layout: TextLayout, x: number, y: number): void;
+
     /**
      * Strokes the outlines the characters of the given text string, at the specified\
      * coordinates.
@@ -868,13 +954,23 @@ interface CanvasTextDrawingStyles {
      * 
      * Custom fonts can be loaded with {@link Window.loadFont}.
      * 
-     * Font names with spaces like "Segoe UI" must be wrapped in double quotes.
+     * The font is set with the
+     * [CSS font shorthand](https://developer.mozilla.org/en-US/docs/Web/CSS/font):
+     * an optional style (`italic`, `oblique`), variant (`small-caps`), weight
+     * (`bold`, `lighter`, `100` to `1000`) and stretch (`condensed`, `expanded`,
+     * ...), then the size (`px`, `pt`, `pc`, `in`, `cm`, `mm`, `em`, `rem` or `%`),
+     * an optional `/ line-height` that is ignored, and a comma-separated list of
+     * font families. The first family that is available is used. Font names with
+     * spaces like "Segoe UI" must be wrapped in quotes.
      * 
-     * The font name can be optionally preceeded by `italic`, `bold` and the font
-     * size as `Npx`. These are all valid font settings:
+     * These are all valid font settings:
      * 
      * -  `monospace`
      * -  `bold 16px "Segoe UI"`
+     * -  `italic 600 condensed 12pt/1.5 "Fira Sans", Arial, sans-serif`
+     * 
+     * Invalid settings are ignored, and the previous font is kept. Parsed fonts are
+     * cached, so switching between a few font settings is cheap.
      * 
      * See also
      * [font](https://developer.mozilla.org/en-US/docs/Web/API/CanvasRenderingContext2D/font)
@@ -90,8 +90,23 @@ interface File {
 
     /**
      * Returns the contents of the given file as a `JSON` object.
+     *
+     * The file is parsed in a background thread. If `incremental` is true
+     * then the conversion to Javascript values is split across several
+     * frames.
      */
-    readJSON(path: string): Promise<Json>;
+    readJSON(path: string, options?: {incremental?: boolean}): Promise<Json>;
+
+    /**
+     * Reads a file in the JSON Lines format, where each line is a `JSON`
+     * value. At most `maxLines` values are read, starting at the byte
+     * `offset` in the file. The result has the `offset` of the next line, and
+     * `done` is true at the end of the file.
+     */
+    readJSONLines(path: string, options?: {
+      offset?: number,
+      maxLines?: number,
+    }): Promise<{values: Json[], offset: number, done: boolean}>;
 
     /**
      * Returns the contents of the given file as a string.
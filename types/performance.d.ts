@@ -19,4 +19,160 @@ interface Performance {
      * source on each supported platform.
      */
     now(): number;
+
+    /**
+     * Records a mark with the given name at the current time.
+     */
+    mark(name: string): void;
+
+    /**
+     * Records a measure with the given name, from the most recent mark named
+     * `startMark` (or the start of the process) to the most recent mark named
+     * `endMark` (or the current time).
+     */
+    measure(name: string, startMark?: string, endMark?: string): void;
+
+    /**
+     * Returns the marks and measures with the given name, from the oldest to the most
+     * recent, optionally filtered by type.
+     */
+    getEntriesByName(name: string, type?: "mark" | "measure"): PerformanceEntry[];
+
+    /**
+     * Removes the marks with the given name, or all the marks.
+     */
+    clearMarks(name?: string): void;
+
+    /**
+     * Removes the measures with the given name, or all the measures.
+     */
+    clearMeasures(name?: string): void;
+
+    /**
+     * Starts a CPU profile with the given name, which samples the Javascript stack
+     * every `sampleIntervalUs` microseconds (1000 by default, at most 1000000).
+     */
+    startProfiling(name: string, options?: { sampleIntervalUs?: number }): void;
+
+    /**
+     * Stops the CPU profile with the given name and saves it to `path` in the
+     * `.cpuprofile` format, in a background thread.
+     */
+    stopProfiling(name: string, path: string): Promise<void>;
+
+    /**
+     * Resets the statistics returned by {@link getFrameStats}.
+     */
+    resetFrameStats(): void;
+
+    /**
+     * Returns statistics for the most recent frames: the duration of each phase of
+     * the main loop, histograms of those durations, and counts of janky frames.
+     */
+    getFrameStats(): FrameStats;
+
+    /**
+     * Returns how many times the native APIs were called in the last frame, and in
+     * total since the page was loaded.
+     */
+    getApiCounters(): {
+        readonly frames: number;
+        readonly frame: ApiCounters;
+        readonly total: ApiCounters;
+    };
+
+    /**
+     * Returns statistics for the latency of input events, in milliseconds, over the
+     * most recent inputs.
+     *
+     * `dispatch` is the latency from receiving an input until its event is dispatched
+     * to Javascript. `swap` is the latency from receiving an input until the first
+     * frame after its dispatch is swapped to the screen.
+     */
+    getInputLatency(): {
+        readonly dispatch: InputLatency;
+        readonly swap: InputLatency;
+    };
+}
+
+interface PerformanceEntry {
+    readonly name: string;
+    readonly entryType: "mark" | "measure";
+    /** When the entry started, in the same time base as {@link Performance.now}. */
+    readonly startTime: number;
+    /** The duration of a measure, in milliseconds. This is 0 for marks. */
+    readonly duration: number;
+}
+
+interface FramePhases<T> {
+    /** Waiting for input or for the next scheduled task. */
+    readonly wait: T;
+    /** Waiting for the garbage collector to finish. */
+    readonly gc: T;
+    /** Dispatching events and running tasks. */
+    readonly js: T;
+    /** Running requestAnimationFrame callbacks. */
+    readonly raf: T;
+    /** Rendering and swapping the frame to the screen. */
+    readonly swap: T;
+    /** The whole frame. */
+    readonly total: T;
+}
+
+interface FrameStats {
+    /** The number of frames measured. */
+    readonly frames: number;
+    /** The display refresh interval, in milliseconds. */
+    readonly refreshInterval: number;
+    /**
+     * The number of frames that took longer than 1, 2 and 4 times the
+     * refresh interval, not counting the wait phase.
+     */
+    readonly jank: Uint32Array;
+    /** The duration of each phase of the most recent frames, in milliseconds, from oldest to newest. */
+    readonly history: FramePhases<Float64Array>;
+    /** Histograms of the duration of each phase; see histogramBounds. */
+    readonly histograms: FramePhases<Uint32Array>;
+    /** The lower bound of each histogram bucket, in milliseconds. */
+    readonly histogramBounds: Float64Array;
+    /** The long tasks reported; see the "longtask" event. */
+    readonly longTasks: {
+        readonly count: number;
+        /** The total duration of the long tasks, in milliseconds. */
+        readonly duration: number;
+        /** The duration of the longest task, in milliseconds. */
+        readonly maxDuration: number;
+    };
+    /** The glyph cache; see window.prewarmFonts(). */
+    readonly glyphCache: {
+        /** The bytes used by the glyph cache. */
+        readonly used: number;
+        /** The maximum bytes used by the glyph cache. */
+        readonly limit: number;
+        /** The number of glyphs cached. */
+        readonly count: number;
+    };
+}
+
+interface InputLatency {
+    /** The total number of inputs measured. */
+    readonly count: number;
+    readonly p50: number;
+    readonly p90: number;
+    readonly p99: number;
+    readonly max: number;
+}
+
+interface ApiCounters {
+    /** The number of calls to each method and property setter of CanvasRenderingContext2D. */
+    readonly canvas: { readonly [name: string]: number };
+    /** The number of calls to each method of File. */
+    readonly file: { readonly [name: string]: number };
+    readonly native: {
+        readonly flushes: number;
+        readonly snapshots: number;
+        readonly textureAllocations: number;
+        readonly readPixelsBytes: number;
+        readonly writePixelsBytes: number;
+    };
 }
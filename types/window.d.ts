@@ -184,6 +184,12 @@ interface Window {
          */
         profileFrameTimes: boolean;
 
+        /**
+         * The duration, in milliseconds, after which callbacks and tasks are
+         * reported as long tasks. Defaults to 50.
+         */
+        longTaskThreshold: number;
+
         /**
          * Whether the overlay console is visible in the main window. It can also be
          * toggled with `F4`.
@@ -196,6 +202,41 @@ interface Window {
         showOverlayConsoleOnErrors: boolean;
     };
 
+    /**
+     * The current state of the keyboard and mouse, updated directly by Window.js
+     * without dispatching any events.
+     */
+    readonly input: {
+        /**
+         * Maps each KeyboardEvent code value to its index in {@link Window.input.keys},
+         * and to its bit in {@link Window.input.pressed} and {@link Window.input.released}.
+         */
+        readonly codes: { readonly [code: string]: number };
+
+        /**
+         * The current state of each key: 1 while the key is down, and 0 otherwise.
+         */
+        readonly keys: Uint8Array;
+
+        /**
+         * The current state of the mouse: the x and y location, a bitmask of the
+         * buttons that are down, bitmasks of the buttons that went down and up since
+         * the last frame, and the horizontal and vertical wheel deltas accumulated
+         * since the last frame.
+         */
+        readonly pointer: Float64Array;
+
+        /**
+         * A bitset of the keys that went down since the last frame.
+         */
+        readonly pressed: Uint8Array;
+
+        /**
+         * A bitset of the keys that went up since the last frame.
+         */
+        readonly released: Uint8Array;
+    };
+
     readonly screen: {
         /**
          * The total height available for non-fullscreen windows, in pixels.
@@ -263,6 +304,18 @@ interface Window {
      */
     loadFont(path: string, name: string): Promise<void>;
 
+    /**
+     * Loads many fonts like {@link loadFont}, in parallel. Each font is given
+     * as an object with a `path` and a `name`.
+     * 
+     * The promise resolves when all the fonts have been loaded. It is rejected
+     * with the first error if any font failed to load; the other fonts are
+     * still loaded.
+     * 
+     * @param fonts  The paths of the font files to load, and their names.
+     */
+    loadFonts(fonts: {path: string, name: string}[]): Promise<void>;
+
     /**
      * Maximizes the window.
      */
@@ -273,6 +326,20 @@ interface Window {
      */
     minimise(): void;
 
+    /**
+     * Queues glyphs to be rasterized into the glyph cache, like
+     * {@link CanvasText.prewarmText prewarmText}, but spread over the next
+     * frames: each frame spends up to 2 milliseconds on them after running its
+     * Javascript.
+     * 
+     * The promise resolves when all the glyphs have been prewarmed.
+     * 
+     * @param fonts  The fonts to prewarm, in the same format as
+     * {@link CanvasTextDrawingStyles.font window.canvas.font}, and the
+     * characters to prewarm for each.
+     */
+    prewarmFonts(fonts: {font: string, characters: string}[]): Promise<void>;
+
     /**
      * Removes an event listener that has previously been registered via
      * {@link Window.addEventListener}.
@@ -312,6 +379,8 @@ interface MouseEvent {
     readonly clientX: number;
     /** The y location in the window where the event occurred. */
     readonly clientY: number;
+    /** When the input was received, in milliseconds. This uses the same clock as {@link Performance.now performance.now}. */
+    readonly timeStamp: number;
 }
 
 interface ClickEvent extends MouseEvent {
@@ -331,6 +400,22 @@ interface DropEvent {
     readonly files: string[];
 }
 
+interface LongTaskEvent {
+    /** "longtask". */
+    readonly type: string;
+    /**
+     * The event type, "setTimeout" or "requestAnimationFrame" for callbacks,
+     * or "task" for other tasks.
+     */
+    readonly name: string;
+    /** The function that ran, with its location. Empty for other tasks. */
+    readonly source: string;
+    /** When the task started, in milliseconds. */
+    readonly startTime: number;
+    /** How long the task took, in milliseconds. */
+    readonly duration: number;
+}
+
 interface KeyboardEvent {
     /** The [key value](https://developer.mozilla.org/en-US/docs/Web/API/KeyboardEvent/key/Key_Values) identifying the key that triggered the event. */
     readonly key: string;
@@ -346,6 +431,8 @@ interface KeyboardEvent {
     readonly metaKey: boolean;
     /** The [keyboard location](https://developer.mozilla.org/en-US/docs/Web/API/KeyboardEvent/location) of the `Alt`, `Ctrl`, `Meta` and `Shift` keys, if the event was triggered by one of those. */
     readonly location: number;
+    /** When the input was received, in milliseconds. This uses the same clock as {@link Performance.now performance.now}. */
+    readonly timeStamp: number;
 }
 
 interface KeyDownEvent extends KeyboardEvent {
@@ -356,6 +443,8 @@ interface KeyDownEvent extends KeyboardEvent {
 interface KeyPressEvent {
     /** The Unicode codepoint for the character that was input. */
     readonly code: number;
+    /** When the input was received, in milliseconds. This uses the same clock as {@link Performance.now performance.now}. */
+    readonly timeStamp: number;
 }
 
 interface WheelEvent {
@@ -363,6 +452,8 @@ interface WheelEvent {
     readonly deltaX: number;
     /** The amount that was scrolled in the vertical axis. */
     readonly deltaY: number;
+    /** When the input was received, in milliseconds. This uses the same clock as {@link Performance.now performance.now}. */
+    readonly timeStamp: number;
 }
 
 interface WindowEventHandlersMap {
@@ -408,6 +499,12 @@ interface WindowEventHandlersMap {
     /** This event is sent by the main window when it receives a key up event. */
     "keyup": KeyboardEvent;
 
+    /**
+     * This event is sent by the main window when a callback or task ran for
+     * longer than {@link Window.debug.longTaskThreshold}.
+     */
+    "longtask": LongTaskEvent;
+
     /** This event is sent by the main window when it becomes maximized. */
     "maximize": Event;
 